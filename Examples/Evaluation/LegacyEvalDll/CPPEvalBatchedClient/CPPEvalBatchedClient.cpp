@@ -0,0 +1,199 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPPEvalBatchedClient.cpp : Latency/throughput benchmark of the batched evaluation interface
+//
+// Many client threads send one sequence at a time, either through IEvaluateModelBatched (which coalesces
+// concurrent requests into minibatches), or, with baseline=true, through one IEvaluateModelExtended that
+// is shared under a lock. Usage (all arguments optional):
+//
+//   cppevalbatchedclient modelPath=<model> numClients=16 requestsPerClient=200 sequenceLength=10
+//                        numWorkers=2 maxBatchSize=32 maxBatchLatencyMs=2 numCPUThreads=1 baseline=false
+//
+// Without modelPath a feed-forward network with random parameters is evaluated.
+//
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "Eval.h"
+
+using namespace std;
+using namespace Microsoft::MSR::CNTK;
+
+static const char* s_defaultNetwork =
+    "deviceId = -1 \n"
+    "precision = \"float\" \n"
+    "traceLevel = 0 \n"
+    "run=NDLNetworkBuilder \n"
+    "NDLNetworkBuilder=[ \n"
+    "features = Input(512) \n"
+    "W1 = Parameter(1024, 512, init = \"uniform\", initValueScale = 1) \n"
+    "b1 = Parameter(1024, 1, init = \"fixedValue\", value = 0.0) \n"
+    "h1 = RectifiedLinear(Plus(Times(W1, features), b1)) \n"
+    "W2 = Parameter(1024, 1024, init = \"uniform\", initValueScale = 1) \n"
+    "b2 = Parameter(1024, 1, init = \"fixedValue\", value = 0.0) \n"
+    "h2 = RectifiedLinear(Plus(Times(W2, h1), b2)) \n"
+    "W3 = Parameter(10, 1024, init = \"uniform\", initValueScale = 1) \n"
+    "out = Softmax(Times(W3, h2), tag=\"output\") \n"
+    "FeatureNodes = (features) \n"
+    "] \n";
+
+// Random sequence with 'length' samples for each input. Sparse inputs get one-hot samples.
+Values<float> CreateRequest(const VariableSchema& inputSchema, size_t length, mt19937& rng)
+{
+    uniform_real_distribution<float> values(-1.0f, 1.0f);
+    Values<float> inputs(inputSchema.size());
+    for (size_t i = 0; i < inputSchema.size(); i++)
+    {
+        size_t dim = inputSchema[i].m_numElements;
+        auto& buffer = inputs[i];
+        if (inputSchema[i].m_storageType == VariableLayout::Sparse)
+        {
+            buffer.m_colIndices.push_back(0);
+            for (size_t t = 0; t < length; t++)
+            {
+                buffer.m_indices.push_back((int)(rng() % dim));
+                buffer.m_buffer.push_back(1);
+                buffer.m_colIndices.push_back((int)buffer.m_buffer.size());
+            }
+        }
+        else
+        {
+            buffer.m_buffer.resize(dim * length);
+            for (auto& v : buffer.m_buffer)
+                v = values(rng);
+        }
+    }
+    return inputs;
+}
+
+double Percentile(vector<double>& sorted, double p)
+{
+    return sorted.empty() ? 0 : sorted[min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+}
+
+int main(int argc, char* argv[])
+{
+    map<string, string> args = {
+        { "modelPath", "" }, { "numClients", "16" }, { "requestsPerClient", "200" }, { "sequenceLength", "10" },
+        { "numWorkers", "2" }, { "maxBatchSize", "32" }, { "maxBatchLatencyMs", "2" }, { "numCPUThreads", "1" }, { "baseline", "false" }
+    };
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t pos = arg.find('=');
+        if (pos == string::npos || args.find(arg.substr(0, pos)) == args.end())
+        {
+            fprintf(stderr, "Unknown argument '%s'.\n", arg.c_str());
+            return 1;
+        }
+        args[arg.substr(0, pos)] = arg.substr(pos + 1);
+    }
+
+    const size_t numClients = stoul(args["numClients"]);
+    const size_t requestsPerClient = stoul(args["requestsPerClient"]);
+    const size_t sequenceLength = stoul(args["sequenceLength"]);
+    const bool baseline = args["baseline"] == "true";
+    const string networkDescription = args["modelPath"].empty() ? s_defaultNetwork : "modelPath=\"" + args["modelPath"] + "\"";
+
+    int ret;
+    try
+    {
+        IEvaluateModelBatched<float>* batchedEval = nullptr;
+        IEvaluateModelExtended<float>* extendedEval = nullptr;
+        VariableSchema inputSchema, outputSchema;
+        if (baseline)
+        {
+            GetEvalExtendedF(&extendedEval);
+            extendedEval->Init("numCPUThreads=" + args["numCPUThreads"]);
+            extendedEval->CreateNetwork(networkDescription);
+            extendedEval->StartForwardEvaluation({ extendedEval->GetOutputSchema()[0].m_name });
+            inputSchema = extendedEval->GetInputSchema();
+            outputSchema = extendedEval->GetOutputSchema();
+        }
+        else
+        {
+            GetEvalBatchedF(&batchedEval);
+            batchedEval->Init("numCPUThreads=" + args["numCPUThreads"] + " numWorkers=" + args["numWorkers"] +
+                              " maxBatchSize=" + args["maxBatchSize"] + " maxBatchLatencyMs=" + args["maxBatchLatencyMs"]);
+            batchedEval->CreateNetwork(networkDescription);
+            batchedEval->StartForwardEvaluation({ batchedEval->GetOutputSchema()[0].m_name });
+            inputSchema = batchedEval->GetInputSchema();
+            outputSchema = batchedEval->GetOutputSchema();
+        }
+
+        mutex evalMutex;
+        vector<vector<double>> latencies(numClients);
+        auto start = chrono::steady_clock::now();
+        vector<thread> clients;
+        for (size_t c = 0; c < numClients; c++)
+        {
+            clients.push_back(thread([&, c]()
+            {
+                mt19937 rng((unsigned int)c);
+                for (size_t r = 0; r < requestsPerClient; r++)
+                {
+                    auto inputs = CreateRequest(inputSchema, sequenceLength, rng);
+                    auto requestStart = chrono::steady_clock::now();
+                    if (baseline)
+                    {
+                        Values<float> outputs = outputSchema.CreateBuffers<float>(vector<size_t>(outputSchema.size(), sequenceLength));
+                        lock_guard<mutex> lock(evalMutex);
+                        extendedEval->ForwardPass(inputs, outputs);
+                    }
+                    else
+                    {
+                        batchedEval->ForwardPassAsync(move(inputs)).get();
+                    }
+                    latencies[c].push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - requestStart).count());
+                }
+            }));
+        }
+        for (auto& client : clients)
+            client.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        vector<double> allLatencies;
+        for (auto& l : latencies)
+            allLatencies.insert(allLatencies.end(), l.begin(), l.end());
+        sort(allLatencies.begin(), allLatencies.end());
+
+        printf("%s: %" PRIu64 " clients, %" PRIu64 " requests of %" PRIu64 " samples\n", baseline ? "Locked IEvaluateModelExtended" : "IEvaluateModelBatched",
+               (uint64_t)numClients, (uint64_t)allLatencies.size(), (uint64_t)sequenceLength);
+        printf("Throughput: %.1f requests/s\n", allLatencies.size() / seconds);
+        printf("Latency: p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+               Percentile(allLatencies, 0.5), Percentile(allLatencies, 0.9), Percentile(allLatencies, 0.99), allLatencies.empty() ? 0 : allLatencies.back());
+
+        if (baseline)
+            extendedEval->Destroy();
+        else
+            batchedEval->Destroy();
+
+        // This pattern is used by End2EndTests to check whether the program runs to complete.
+        printf("Evaluation complete.\n");
+        ret = 0;
+    }
+    catch (const std::exception& err)
+    {
+        fprintf(stderr, "Evaluation failed. EXCEPTION occurred: %s\n", err.what());
+        ret = 1;
+    }
+    catch (...)
+    {
+        fprintf(stderr, "Evaluation failed. Unknown ERROR occurred.\n");
+        ret = 1;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    return ret;
+}
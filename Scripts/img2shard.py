@@ -0,0 +1,176 @@
+#!/usr/bin/env python
+
+# This script packs the images listed in an ImageDeserializer map file into a
+# single image shard that can be read with the ImageShardDeserializer.
+#
+# The map file contains one image per line, in the form:
+#   [<sequence key> <tab>] <image path> <tab> <numerical label (0-based class id)>
+#
+# As in the ImageDeserializer, a leading '...' in the image path is replaced
+# with the directory of the map file, and a path of the form
+# <zip file>@/<item> refers to an item in a zip container. Images are copied
+# as they are, without decoding.
+#
+# The shard layout (all integers little endian) is:
+#   header:  uint64 magic ('cntk_ims'), uint32 version, uint32 reserved
+#   records: [uint32 class id, encoded image bytes]*
+#   table:   [uint64 record offset, uint32 record size, uint32 key length, key bytes]*
+#   footer:  uint64 number of records, uint64 table offset, uint64 magic
+#
+
+import sys
+import argparse
+import struct
+import os
+import zipfile
+
+MAGIC_NUMBER = 0x636e746b5f696d73
+SHARD_VERSION = 1
+
+
+class ImageSource(object):
+    def __init__(self, map_directory):
+        self.map_directory = map_directory
+        self.containers = {}
+
+    def read(self, path):
+        if path.startswith('...'):
+            path = self.map_directory + path[3:]
+
+        at = path.find('@')
+        if at < 0:
+            with open(path, 'rb') as f:
+                return f.read()
+
+        container_path = path[:at]
+        # skip @ symbol and path separator (/ or \)
+        item_path = path[at + 2:].replace('\\', '/')
+        container = self.containers.get(container_path)
+        if container is None:
+            container = zipfile.ZipFile(container_path)
+            self.containers[container_path] = container
+        return container.read(item_path)
+
+    def close(self):
+        for container in self.containers.values():
+            container.close()
+
+
+def parse_map_line(line, line_index):
+    columns = line.rstrip('\r\n').split('\t')
+    if len(columns) >= 3:
+        key, path, label = columns[:3]
+    elif len(columns) == 2:
+        key = str(line_index)
+        path, label = columns
+    else:
+        raise ValueError("Invalid map file format, must contain 2 or 3 "
+                         "tab-delimited columns, line %d" % line_index)
+    if not path or not label:
+        raise ValueError("Empty image path or label, line %d" % line_index)
+    return key, path, int(label)
+
+
+def write_shard(map_lines, output, source):
+    output.write(struct.pack('<QII', MAGIC_NUMBER, SHARD_VERSION, 0))
+
+    table = []
+    offset = output.tell()
+    for line_index, line in enumerate(map_lines):
+        if not line.strip():
+            continue
+        key, path, label = parse_map_line(line, line_index)
+        image = source.read(path)
+        if not image:
+            raise ValueError("Image '%s' is empty, line %d" % (path, line_index))
+        output.write(struct.pack('<I', label))
+        output.write(image)
+        size = 4 + len(image)
+        table.append((offset, size, key.encode('utf-8')))
+        offset += size
+
+    table_offset = offset
+    for record_offset, size, key in table:
+        output.write(struct.pack('<QII', record_offset, size, len(key)))
+        output.write(key)
+
+    output.write(struct.pack('<QQQ', len(table), table_offset, MAGIC_NUMBER))
+    return len(table)
+
+
+def process(map_name, output_name):
+    source = ImageSource(os.path.dirname(os.path.abspath(map_name)))
+    try:
+        with open(map_name, 'r') as map_file, open(output_name, 'wb') as output:
+            return write_shard(map_file, output, source)
+    finally:
+        source.close()
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Packs the images of an ImageDeserializer map file into an image shard.")
+    parser.add_argument('--map', help='ImageDeserializer map file listing the images and their labels.', required=True)
+    parser.add_argument('--output', help='Name of the output image shard.', required=True)
+
+    args = parser.parse_args()
+
+    count = process(args.map, args.output)
+    print("Wrote %d images to %s" % (count, args.output))
+
+#####################################################################################################
+# Tests
+#####################################################################################################
+
+import io
+try:
+    import pytest
+except ImportError:
+    pass
+
+
+class InMemorySource(object):
+    def __init__(self, images):
+        self.images = images
+
+    def read(self, path):
+        return self.images[path]
+
+
+def read_table(shard):
+    count, table_offset, magic = struct.unpack('<QQQ', shard[-24:])
+    assert magic == MAGIC_NUMBER
+    entries = []
+    position = table_offset
+    for _ in range(count):
+        offset, size, key_length = struct.unpack('<QII', shard[position:position + 16])
+        position += 16
+        key = shard[position:position + key_length].decode('utf-8')
+        position += key_length
+        label, = struct.unpack('<I', shard[offset:offset + 4])
+        entries.append((key, label, shard[offset + 4:offset + size]))
+    assert position == len(shard) - 24
+    return entries
+
+
+def test_keysAndLabelsAreStored():
+    source = InMemorySource({'a.jpg': b'\xff\xd8abc', 'b.png': b'\x89PNGdefg'})
+    output = io.BytesIO()
+    count = write_shard(['x\ta.jpg\t3\n', 'y\tb.png\t0\n'], output, source)
+    shard = output.getvalue()
+
+    assert count == 2
+    assert struct.unpack('<QII', shard[:16]) == (MAGIC_NUMBER, SHARD_VERSION, 0)
+    assert read_table(shard) == [('x', 3, b'\xff\xd8abc'), ('y', 0, b'\x89PNGdefg')]
+
+
+def test_lineNumberIsKeyWithoutSequenceKeys():
+    source = InMemorySource({'a.jpg': b'1', 'b.jpg': b'22'})
+    output = io.BytesIO()
+    write_shard(['a.jpg\t1\n', 'b.jpg\t2\n'], output, source)
+
+    assert read_table(output.getvalue()) == [('0', 1, b'1'), ('1', 2, b'22')]
+
+
+def test_invalidLine():
+    with pytest.raises(ValueError):
+        write_shard(['a.jpg\n'], io.BytesIO(), InMemorySource({}))
@@ -512,6 +512,9 @@ int wmainWithBS(int argc, wchar_t* argv[]) // called from wmain which is a wrapp
 
     Globals::SetShareNodeValueMatrices(config(L"shareNodeValueMatrices", true));
     Globals::SetGradientAccumulationOptimization(config(L"optimizeGradientAccumulation", true));
+    Globals::SetElementwiseChainFusion(config(L"fuseElementwiseChains", false));
+    Globals::SetMatrixPoolArena(config(L"matrixPoolArena", false));
+    Globals::SetRecurrentGemmBatching(config(L"batchRecurrentGemms", false));
 
     TracingGPUMemoryAllocator::SetTraceLevel(config(L"traceGPUMemoryAllocations", 0));
 
@@ -660,6 +663,9 @@ int wmainOldCNTKConfig(int argc, wchar_t* argv[])
 
     Globals::SetShareNodeValueMatrices(config(L"shareNodeValueMatrices", true));
     Globals::SetGradientAccumulationOptimization(config(L"optimizeGradientAccumulation", true));
+    Globals::SetElementwiseChainFusion(config(L"fuseElementwiseChains", false));
+    Globals::SetMatrixPoolArena(config(L"matrixPoolArena", false));
+    Globals::SetRecurrentGemmBatching(config(L"batchRecurrentGemms", false));
 
     TracingGPUMemoryAllocator::SetTraceLevel(config(L"traceGPUMemoryAllocations", 0));
 
@@ -3019,6 +3019,13 @@ namespace CNTK
         /// ONNX support limited subset of CNTK.
         ///
         ONNX,
+
+        ///
+        /// CNTK version 2 format that stores the values of Parameters and Constants as aligned raw data
+        /// after the protobuf graph. On load the file is memory-mapped and the values are used in place on the CPU
+        /// instead of being parsed and copied. Files in this format are loaded with ModelFormat::CNTKv2 as well.
+        ///
+        CNTKv2MemoryMappable,
     };
 
 
@@ -3085,6 +3092,7 @@ namespace CNTK
 
         friend Variable GetCorrespondingOutputVariableFromClone(const Variable&, const FunctionPtr&, const FunctionPtr&);
         friend bool Internal::IsNativeUserFunctionRegistered(const std::wstring& uniqueOpName);
+        friend size_t Internal::SetWeightStorageFormat(const FunctionPtr& model, const std::wstring& format);
 
     public:
 
@@ -4698,6 +4706,10 @@ namespace CNTK
         ///
         CNTK_API static const std::wstring MinibatchSizeKey;
         ///
+        /// A key that is associated with the fused update option.
+        ///
+        CNTK_API static const std::wstring FusedUpdateKey;
+        ///
         /// A special value that can be used for the minibatchSize to indicate that the reference minibatch size is not specified.
         ///
         CNTK_API static const size_t IgnoredMinibatchSize;
@@ -4794,6 +4806,14 @@ namespace CNTK
         CNTK_API void SetMinibatchSize(std::size_t minibatchSize) { GetOptions().Add(MinibatchSizeKey, minibatchSize); }
         CNTK_API std::size_t GetMinibatchSize() const { return GetOptions().GetOrElse(MinibatchSizeKey, IgnoredMinibatchSize); }
 
+        ///Requests the learner to update all its parameters in a single parallel sweep, which applies the mean gradient scaling, gradient clipping,
+        ///regularization and the actual update rule element by element, instead of running several full-matrix operations for each parameter.
+        ///This pays off for models with many small parameters. When enabled, the smoothed gradients of the learner are kept in a single
+        ///contiguous buffer. The fused update is available for the SGD, momentum SGD, Nesterov, AdaGrad, FSAdaGrad, Adam and RMSProp learners
+        ///with dense parameters and gradients on the CPU and without noise injection; otherwise the learner falls back to the regular update.
+        CNTK_API void SetFusedUpdate(bool fusedUpdate) { GetOptions().Add(FusedUpdateKey, fusedUpdate); }
+        CNTK_API bool UseFusedUpdate() const { return GetOptions().GetOrElse(FusedUpdateKey, false); }
+
         CNTK_API void SetLearningRateSchedule(const LearningRateSchedule& learningRateSchedule) { m_learningRateSchedule = learningRateSchedule; }
         CNTK_API const LearningRateSchedule& GetLearningRateSchedule() const { return m_learningRateSchedule; }
 
@@ -5197,6 +5217,18 @@ namespace CNTK
         ///
         CNTK_API void SaveCheckpoint(const std::wstring& filePath, Dictionary externalState = Dictionary());
 
+        ///
+        /// Same as SaveCheckpoint, but the files are written on a background thread while training continues.
+        /// The model and trainer state are copied to host memory before the call returns. At most 'maxPendingCheckpoints'
+        /// (as given in the first call) checkpoints can be in flight; further calls block until one of them is written.
+        ///
+        CNTK_API void SaveCheckpointAsync(const std::wstring& filePath, Dictionary externalState = Dictionary(), size_t maxPendingCheckpoints = 1);
+
+        ///
+        /// Blocks until all checkpoints saved with SaveCheckpointAsync are written. Rethrows the error of a failed write.
+        ///
+        CNTK_API void WaitForPendingCheckpoints();
+
         ///
         /// Restore the model and trainer state from a previously saved model and checkpoint from the specified file location
         ///
@@ -5267,8 +5299,9 @@ namespace CNTK
         bool TrainLocalMinibatch(const std::unordered_map<Variable, ValuePtr>& arguments, std::unordered_map<Variable, ValuePtr>& outputsToFetch, bool sweepEnd, const DeviceDescriptor& computeDevice);
         bool TrainDistributedMinibatch(const std::unordered_map<Variable, ValuePtr>& arguments, std::unordered_map<Variable, ValuePtr>& outputsToFetch, bool sweepEnd, const DeviceDescriptor& computeDevice);
 
+        void SaveCheckpointImpl(const std::wstring& filePath, const Dictionary& externalState, bool inBackground);
         void Save(const std::wstring& modelFilePath, const std::vector<DictionaryValue>& learnerState,
-            const Dictionary& externalState, const Dictionary& distributedState = {});
+            const Dictionary& externalState, const Dictionary& distributedState, bool inBackground);
 
         void UpdateTrainingProgress(size_t numSamples, const ValuePtr& loss, const ValuePtr& evalCriterion, const DeviceDescriptor& computeDevice);
         void AddProgressWriters(const std::vector<ProgressWriterPtr>& progressWriters);
@@ -5292,6 +5325,9 @@ namespace CNTK
         AccumulatorPtr m_aggregatedTrainingEvalCriterionValue;
 
         size_t m_prevDistributedTotalNumSamples;
+
+        // Writes checkpoints saved with SaveCheckpointAsync.
+        std::shared_ptr<Microsoft::MSR::CNTK::AsyncFileWriter> m_checkpointWriter;
     };
 
     ///
@@ -5602,6 +5638,11 @@ namespace CNTK
     ///
     CNTK_API  Deserializer Base64ImageDeserializer(const std::wstring& fileName, const std::wstring& labelStreamName, size_t numLabels, const std::wstring& imageStreamName, const std::vector<ImageTransform>& transforms = {});
 
+    ///
+    /// Create an ImageShardDeserializer with the specified options
+    ///
+    CNTK_API  Deserializer ImageShardDeserializer(const std::wstring& fileName, const std::wstring& labelStreamName, size_t numLabels, const std::wstring& imageStreamName, const std::vector<ImageTransform>& transforms = {});
+
     ///
     /// Create a CTFDeserializer with the specified options
     ///
@@ -5787,6 +5828,13 @@ namespace CNTK
     ///
     CNTK_API DistributedCommunicatorPtr MPICommunicator(size_t packThresholdSizeInBytes = Internal::DefaultPackThresholdSizeInBytes());
 
+    ///
+    /// Built-in MPI-based communicator that exchanges only the 'density' fraction of the entries of each dense value that are largest
+    /// in magnitude (top-k sparsification). The entries not sent are kept in a residue that is added to the value in the next aggregation.
+    /// Can be used with CreateDataParallelDistributedLearner.
+    ///
+    CNTK_API DistributedCommunicatorPtr SparsifiedMPICommunicator(double density, size_t packThresholdSizeInBytes = Internal::DefaultPackThresholdSizeInBytes());
+
     ///
     /// Distributed communicator that allows quantized aggregations.
     ///
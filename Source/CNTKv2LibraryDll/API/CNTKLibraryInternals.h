@@ -60,6 +60,8 @@ namespace Microsoft { namespace MSR { namespace CNTK {
     typedef std::shared_ptr<ComputationNodeBase> ComputationNodeBasePtr;
 
     struct GpuData;
+
+    class AsyncFileWriter;
 }}}
 
 // TODO: The following should be reconciled with the equivalent code in the CNTK implementation
@@ -262,6 +264,14 @@ namespace CNTK
         // This is meant for debugging purposes only and is very likely to be deprecated in the future.
         CNTK_API void SaveAsLegacyModel(const FunctionPtr& rootFunction, const std::wstring& modelFile);
 
+        ///
+        /// Keeps a 16-bit copy ('format' is L"float16" or L"bfloat16") of the weights of all Times functions in 'model'
+        /// whose left operand is a Parameter or Constant, and multiplies with it when evaluating on the CPU without
+        /// retaining backward state. L"float" switches back to the full precision weights. The setting is saved with the model.
+        /// Returns the number of Times functions that were changed.
+        ///
+        CNTK_API size_t SetWeightStorageFormat(const FunctionPtr& model, const std::wstring& format);
+
         CNTK_API size_t NewUniqueId();
 
         CNTK_API size_t GenerateRandomSeed(bool perWorkerLocalValue = false);
@@ -296,6 +306,10 @@ namespace CNTK
         CNTK_API void UseSparseGradientAggregationInDataParallelSGD(bool enable);
         CNTK_API bool ShouldUseSparseGradientAggregationInDataParallelSGD();
 
+        // Sums dense data on the host within groups of workers on the same host through shared memory, and only across hosts with MPI
+        CNTK_API void UseHierarchicalAllReduce(bool enable);
+        CNTK_API bool ShouldUseHierarchicalAllReduce();
+
         CNTK_API unsigned long GetRandomSeed();
         CNTK_API void SetFixedRandomSeed(unsigned long value);
         CNTK_API bool IsRandomSeedFixed();
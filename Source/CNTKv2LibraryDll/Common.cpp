@@ -584,6 +584,18 @@ namespace CNTK
             return s_useSparseGradientAggregationInDataParallelSGD;
         }
 
+        std::atomic<bool> s_useHierarchicalAllReduce(false);
+
+        void UseHierarchicalAllReduce(bool enable)
+        {
+            s_useHierarchicalAllReduce = enable;
+        }
+
+        bool ShouldUseHierarchicalAllReduce()
+        {
+            return s_useHierarchicalAllReduce;
+        }
+
         static std::atomic<bool> s_threadsAreSet(false);
         bool MaxNumCPUThreadsSet()
         {
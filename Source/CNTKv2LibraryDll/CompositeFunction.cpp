@@ -1934,6 +1934,7 @@ namespace CNTK
         ApplyAttributeUpdates();
 
         // Bump the timestamp of the parameter nodes whose values have changed
+        std::unordered_set<ComputationNodeBasePtr> updatedParameters;
         for (auto& timeStampRecord : m_lastRecordedTimeStamps)
         {
             auto variable = timeStampRecord.first;
@@ -1942,10 +1943,18 @@ namespace CNTK
             if (newTimeStamp > prevTimeStamp)
             {
                 timeStampRecord.second = newTimeStamp;
-                m_variableToNodeMap.at(variable)->BumpEvalTimeStamp();
+                auto& node = m_variableToNodeMap.at(variable);
+                node->BumpEvalTimeStamp();
+                updatedParameters.insert(node);
             }
         }
 
+        bool isTraining = !outputsToRetainBackwardStateFor.empty();
+        if (dataType == DataType::Float)
+            ApplyWeightStorage<float>(isTraining, updatedParameters);
+        else
+            ApplyWeightStorage<double>(isTraining, updatedParameters);
+
         std::vector<ComputationNodeBasePtr> outputsToEvaluate;
         for (auto outputVariable : requestedOutputVariables)
             outputsToEvaluate.push_back(m_variableToNodeMap.at(outputVariable));
@@ -2090,4 +2099,45 @@ namespace CNTK
             node->SetEvalTimeStampOutdatedWrtAll();
         }
     }
+
+    template <typename ElementType>
+    void CompositeFunction::ApplyWeightStorage(bool isTraining, const std::unordered_set<ComputationNodeBasePtr>& updatedParameters)
+    {
+        for (auto& varNodePair : m_variableToNodeMap)
+        {
+            auto& var = varNodePair.first;
+            if (!var.IsOutput())
+                continue;
+
+            auto primitiveFunction = dynamic_cast<PrimitiveFunction*>(var.Owner().get());
+            if (primitiveFunction == nullptr || primitiveFunction->OpType() != PrimitiveOpType::Times ||
+                !primitiveFunction->Attributes().Contains(PrimitiveFunction::AttributeNameWeightStorage))
+                continue;
+
+            auto& node = varNodePair.second;
+            auto timesNode = dynamic_cast<TimesNode<ElementType>*>(node.get());
+            if (timesNode == nullptr)
+                continue;
+
+            // The 16-bit weights are only used for inference on the CPU; the gradients are always computed
+            // with the full precision weights, which remain the master copy.
+            auto format = primitiveFunction->Attributes()[PrimitiveFunction::AttributeNameWeightStorage].Value<std::wstring>();
+            auto weights = node->GetInputs()[0];
+            bool useHalfWeights = !isTraining && format != L"float" && node->GetDeviceId() == CPUDEVICE &&
+                                  dynamic_cast<LearnableParameter<ElementType>*>(weights.get()) != nullptr;
+
+            auto multiplier = std::dynamic_pointer_cast<HalfPrecisionMultiplier<ElementType>>(timesNode->GetMultiplier());
+            if (!useHalfWeights)
+            {
+                if (multiplier)
+                    timesNode->SetMultiplier(nullptr);
+                continue;
+            }
+
+            // A new multiplier converts the weights again when it is first used, e.g. after they were updated.
+            auto halfFormat = HalfGemm::ParseFormat(format);
+            if (!multiplier || multiplier->Format() != halfFormat || updatedParameters.find(weights) != updatedParameters.end())
+                timesNode->SetMultiplier(std::make_shared<HalfPrecisionMultiplier<ElementType>>(halfFormat));
+        }
+    }
 }
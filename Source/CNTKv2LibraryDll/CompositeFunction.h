@@ -255,6 +255,10 @@ namespace CNTK
         // Copy all new values for 'dirty' attributes from functions into corresponding network nodes.
         void ApplyAttributeUpdates();
 
+        // Attach (or detach) the 16-bit weight multipliers of Times nodes according to their weight storage attribute.
+        template <typename ElementType>
+        void ApplyWeightStorage(bool isTraining, const std::unordered_set<Microsoft::MSR::CNTK::ComputationNodeBasePtr>& updatedParameters);
+
         // Generate a dictionary representing the internal (local) state of the function graph.
         Dictionary GetInternalState() const;
 
@@ -693,6 +693,29 @@ namespace CNTK
         }
     }
 
+    // Blocking sum of host data with MPIWrapper::AllReduceHierarchical(), which only supports float and double.
+    static bool AllReduceHierarchical(const MPIWrapperPtr& mpi, float* inputData, float* outputData, size_t numElements)
+    {
+        if (inputData != outputData)
+            memcpy(outputData, inputData, numElements * sizeof(float));
+        mpi->AllReduceHierarchical(outputData, numElements);
+        return true;
+    }
+
+    static bool AllReduceHierarchical(const MPIWrapperPtr& mpi, double* inputData, double* outputData, size_t numElements)
+    {
+        if (inputData != outputData)
+            memcpy(outputData, inputData, numElements * sizeof(double));
+        mpi->AllReduceHierarchical(outputData, numElements);
+        return true;
+    }
+
+    template <typename ElemType>
+    static bool AllReduceHierarchical(const MPIWrapperPtr&, ElemType*, ElemType*, size_t)
+    {
+        return false;
+    }
+
     template <typename ElemType>
     void MPICommunicatorImpl::AllReduceData(ElemType* inputData, ElemType* outputData, size_t numElements, std::vector<MPI_Request>* pAllReduceRequests, bool dataOnCPU, MPI_Op op, bool forceSync)
     {
@@ -703,6 +726,13 @@ namespace CNTK
             return;
         }
 
+        // Without GPUDirect RDMA the data is on the host here
+        if (Internal::ShouldUseHierarchicalAllReduce() && (op == MPI_SUM) && !m_mpi->UseGpuGdr() &&
+            AllReduceHierarchical(m_mpi, inputData, outputData, numElements))
+        {
+            return;
+        }
+
         if (m_mpi->UseGpuGdr() || forceSync)
         {
             if (inputData == outputData)
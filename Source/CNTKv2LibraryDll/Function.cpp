@@ -486,6 +486,12 @@ namespace CNTK
                 ONNXFormat::Save(RootFunction(), filepath);
                 break;
             }
+
+            case ModelFormat::CNTKv2MemoryMappable:
+            {
+                SaveMemoryMappableModel(Serialize(), filepath);
+                break;
+            }
         }
     }
 
@@ -494,7 +500,11 @@ namespace CNTK
         switch (format)
         {
             case ModelFormat::CNTKv2:
+            case ModelFormat::CNTKv2MemoryMappable:
             {
+                if (IsMemoryMappableModel(filepath))
+                    return Function::Deserialize(LoadMemoryMappedModel(filepath), computeDevice);
+
                 auto stream = GetFstream(filepath, true);
                 if (!Internal::IsLegacyModel(*stream))
                 {
@@ -551,6 +561,12 @@ namespace CNTK
 
     void Function::Restore(const std::wstring& filepath)
     {
+        if (IsMemoryMappableModel(filepath))
+        {
+            RestoreFromCheckpoint(LoadMemoryMappedModel(filepath));
+            return;
+        }
+
         auto stream = GetFstream(filepath, true);
         if (!Internal::IsLegacyModel(*stream))
         {
@@ -1049,6 +1065,10 @@ namespace CNTK
 
             primitiveFunctionPtr->SetRandomSeed(seed);
         }
+        else if (name == PrimitiveFunction::AttributeNameWeightStorage)
+        {
+            primitiveFunctionPtr->SetWeightStorage(value.Value<std::wstring>());
+        }
         else
         {
             LogicError("SetAttribute: '%S' is not supported (this attribute cannot be updated).", name.c_str());
@@ -2717,5 +2737,25 @@ namespace CNTK
             auto splicedConv = Splice(opsOutputVector, Axis(inputRank - 1));
             return AsBlock(std::move(splicedConv), { { operandPlaceholder, operand } }, L"Convolution", name);
         }
+
+        size_t SetWeightStorageFormat(const FunctionPtr& model, const std::wstring& format)
+        {
+            size_t numChanged = 0;
+            Function::PreorderTraverseFunctions(model->RootFunction(), [&](const FunctionPtr& function)
+            {
+                auto primitiveFunction = dynamic_cast<PrimitiveFunction*>(function.get());
+                if (primitiveFunction == nullptr || primitiveFunction->OpType() != PrimitiveOpType::Times)
+                    return;
+
+                auto weights = primitiveFunction->Inputs()[0];
+                if (!weights.IsParameter() && !weights.IsConstant())
+                    return;
+
+                function->SetAttribute(PrimitiveFunction::AttributeNameWeightStorage, format);
+                numChanged++;
+            }, /*traverseInsideBlockFunction =*/ true);
+
+            return numChanged;
+        }
     }
 }
@@ -22,6 +22,19 @@
         NOT_IMPLEMENTED;                                                                                      \
     }
 
+#define DISPATCH_TO_TYPED_FUSED_UPDATE_FUNCTION                                                               \
+    switch (tensors.m_dataType)                                                                               \
+    {                                                                                                         \
+    case DataType::Float:                                                                                     \
+        FusedUpdate<float>(tensors, trainingSampleCount);                                                     \
+        break;                                                                                                \
+    case DataType::Double:                                                                                    \
+        FusedUpdate<double>(tensors, trainingSampleCount);                                                    \
+        break;                                                                                                \
+    default:                                                                                                  \
+        NOT_IMPLEMENTED;                                                                                      \
+    }
+
 #define GET_WRITABLE_MATRICES                                                                                 \
     const auto& smoothedGradientMatrix = GetWritableMatrix<ElementType>(smoothedGradientValue);               \
     const auto& gradientMatrix = GetWritableMatrix<ElementType>(gradientValue);                               \
@@ -33,6 +46,7 @@ using namespace std;
 namespace CNTK
 {
     CNTK_API const std::wstring Learner::MinibatchSizeKey = L"MinibatchSize";
+    CNTK_API const std::wstring Learner::FusedUpdateKey = L"FusedUpdate";
     ///
     /// A special value that can be used for the minibatchSize to indicate that the reference minibatch size is not specified.
     ///
@@ -114,6 +128,7 @@ namespace CNTK
             else
                 LogicError("Unsupported DataType %s", DataTypeName(v.second->GetDataType()));
         }
+        ResetLazyUpdateStates();
     }
 
     // Clipping gradients to prevent outliers,
@@ -195,6 +210,136 @@ namespace CNTK
         }
     }
 
+    // Number of elements of a parameter processed by one work item of a fused update.
+    static const size_t s_fusedUpdateBlockSize = 4096;
+
+    template <typename ElementType, typename UpdateFunction>
+    void LearnerBase::ApplyFusedUpdate(const FusedUpdateTensors& tensors, size_t actualMBSize, UpdateFunction update) const
+    {
+        ApplyFusedUpdate<ElementType>(tensors, actualMBSize, /*average*/ false,
+                                      [](const FusedUpdateSegment<ElementType>&, size_t, ElementType) { return ElementType(0); },
+                                      update);
+    }
+
+    // The fused equivalent of PreProcess, the learner update and PostProcess (without noise injection).
+    // The parameters are split into blocks of elements which are distributed over the OpenMP threads.
+    // Reductions over a parameter are first accumulated per block and then summed up in a fixed order,
+    // so that the result does not depend on the number of threads.
+    template <typename ElementType, typename ReduceFunction, typename UpdateFunction>
+    void LearnerBase::ApplyFusedUpdate(const FusedUpdateTensors& tensors, size_t actualMBSize, bool average, ReduceFunction reduce, UpdateFunction update) const
+    {
+        const size_t numParameters = tensors.m_parameters.size();
+        vector<FusedUpdateSegment<ElementType>> segments(numParameters);
+        vector<pair<size_t, size_t>> blocks; // (parameter index, first element)
+        for (size_t p = 0; p < numParameters; ++p)
+        {
+            auto& segment = segments[p];
+            segment.m_parameter = tensors.m_parameters[p]->WritableDataBuffer<ElementType>();
+            segment.m_gradient = tensors.m_gradients[p]->DataBuffer<ElementType>();
+            segment.m_smoothedGradient = tensors.m_smoothedGradients[p]->WritableDataBuffer<ElementType>();
+            segment.m_size = tensors.m_parameters[p]->Shape().TotalSize();
+            segment.m_gradientScale = ElementType(IsCompatibleMode() ? 1.0 / actualMBSize : 1.0);
+            segment.m_reduction = ElementType(1.0);
+            for (size_t begin = 0; begin < segment.m_size; begin += s_fusedUpdateBlockSize)
+                blocks.push_back(make_pair(p, begin));
+        }
+
+        const long numBlocks = (long)blocks.size();
+        vector<double> blockSums(numBlocks);
+        vector<double> parameterSums(numParameters);
+        auto sumBlocksPerParameter = [&]()
+        {
+            fill(parameterSums.begin(), parameterSums.end(), 0.0);
+            for (long b = 0; b < numBlocks; ++b)
+                parameterSums[blocks[b].first] += blockSums[b];
+        };
+
+        // Gradient clipping, see ClipGradient.
+        const double clippingThreshold = m_additionalOptions.gradientClippingThresholdPerSample;
+        const bool clip = clippingThreshold != numeric_limits<double>::infinity();
+        const bool truncate = clip && m_additionalOptions.gradientClippingWithTruncation;
+        const double maxGradientPerMB = IsCompatibleMode() ? clippingThreshold : clippingThreshold * actualMBSize;
+        if (clip && !truncate)
+        {
+#pragma omp parallel for schedule(dynamic)
+            for (long b = 0; b < numBlocks; ++b)
+            {
+                const auto& segment = segments[blocks[b].first];
+                const size_t end = min(blocks[b].second + s_fusedUpdateBlockSize, segment.m_size);
+                double sum = 0;
+                for (size_t i = blocks[b].second; i < end; ++i)
+                    sum += (double)segment.m_gradient[i] * segment.m_gradient[i];
+                blockSums[b] = sum;
+            }
+
+            sumBlocksPerParameter();
+            for (size_t p = 0; p < numParameters; ++p)
+            {
+                const double gradientNorm = segments[p].m_gradientScale * sqrt(parameterSums[p]);
+                if (gradientNorm > maxGradientPerMB)
+                    segments[p].m_gradientScale *= ElementType(maxGradientPerMB / gradientNorm);
+            }
+        }
+
+        // multiply by actualMBSize so that it's invariant to minibatch size since learning rate is per sample
+        const auto l2Weight = ElementType(m_additionalOptions.l2RegularizationWeight * (IsCompatibleMode() ? 1 : actualMBSize));
+        const auto l1Weight = ElementType(LearningRate(actualMBSize) * m_additionalOptions.l1RegularizationWeight * (IsCompatibleMode() ? 1 : actualMBSize));
+        const auto maxGradient = ElementType(maxGradientPerMB);
+        auto preprocessedGradient = [=](const FusedUpdateSegment<ElementType>& segment, size_t i)
+        {
+            ElementType g = segment.m_gradient[i] * segment.m_gradientScale;
+            if (truncate)
+                g = max(-maxGradient, min(g, maxGradient));
+            if (l2Weight > 0)
+                g += l2Weight * segment.m_parameter[i];
+            return g;
+        };
+
+        if (average)
+        {
+#pragma omp parallel for schedule(dynamic)
+            for (long b = 0; b < numBlocks; ++b)
+            {
+                const auto& segment = segments[blocks[b].first];
+                const size_t end = min(blocks[b].second + s_fusedUpdateBlockSize, segment.m_size);
+                double sum = 0;
+                for (size_t i = blocks[b].second; i < end; ++i)
+                    sum += reduce(segment, i, preprocessedGradient(segment, i));
+                blockSums[b] = sum;
+            }
+
+            sumBlocksPerParameter();
+            for (size_t p = 0; p < numParameters; ++p)
+            {
+                if (segments[p].m_size > 0)
+                    segments[p].m_reduction = ElementType(parameterSums[p] / segments[p].m_size);
+            }
+        }
+
+#pragma omp parallel for schedule(dynamic)
+        for (long b = 0; b < numBlocks; ++b)
+        {
+            const auto& segment = segments[blocks[b].first];
+            const size_t end = min(blocks[b].second + s_fusedUpdateBlockSize, segment.m_size);
+            for (size_t i = blocks[b].second; i < end; ++i)
+            {
+                update(segment, i, preprocessedGradient(segment, i));
+
+                // L1 regularizer with proximal gradient descent method, see InplaceSoftThreshold.
+                if (l1Weight > 0)
+                {
+                    ElementType& w = segment.m_parameter[i];
+                    if (w > l1Weight)
+                        w -= l1Weight;
+                    else if (w < -l1Weight)
+                        w += l1Weight;
+                    else
+                        w = 0;
+                }
+            }
+        }
+    }
+
     template <typename ElementType>
     /*static*/ TensorView<ElementType>* LearnerBase::GetWritableTensorView(const NDArrayViewPtr& arrayView)
     {
@@ -267,41 +412,44 @@ namespace CNTK
 
         UpdateOnMinibatch(trainingSampleCount);
 
-        for (const auto& parameter : Parameters())
+        if (!TryFusedUpdate(gradientValues, trainingSampleCount))
         {
-            const auto& smoothedGradientValue = m_smoothedGradientValues.at(parameter);
-            const auto& gradientValue = gradientValues.at(parameter);
-            // TODO: make this a runtime parameter.
+            for (const auto& parameter : Parameters())
+            {
+                const auto& smoothedGradientValue = m_smoothedGradientValues.at(parameter);
+                const auto& gradientValue = gradientValues.at(parameter);
+                // TODO: make this a runtime parameter.
 #if DUMPOUTPUT
-            LOGPRINTF(stderr, "Update_%ls\n", parameter.Uid().c_str());
+                LOGPRINTF(stderr, "Update_%ls\n", parameter.Uid().c_str());
 #endif
 
 #ifdef _DEBUG
-            if (HasNan(smoothedGradientValue, "TrainOneEpoch/UpdateWeights/Learner::Update(): "))
-                LogicError("%ls has NaNs in smoothedGradient.", parameter.Uid().c_str());
+                if (HasNan(smoothedGradientValue, "TrainOneEpoch/UpdateWeights/Learner::Update(): "))
+                    LogicError("%ls has NaNs in smoothedGradient.", parameter.Uid().c_str());
 #endif
 
 #if DUMPOUTPUT
-            const auto learningRate = LearningRate(trainingSampleCount);
-            const auto momentum = MomentumValueForMB(trainingSampleCount);
-            LOGPRINTF(stderr, "learnRatePerSample=%0.8f, momentum=%0.8f, actualMBSize=%ld\n",
-                      learningRate, momentum, trainingSampleCount);
-            LOGPRINTF(stderr, "GradUpdateType()=%s, GradientUpdateNoiseStd()=%0.8f\n",
-                      LearnerType().c_str(), m_additionalOptions.gaussianNoiseInjectionStdDev);
-            Print(gradientValue, "Gradient Update");
-            Print(smoothedGradientValue, "Smoothed Gradient Input");
+                const auto learningRate = LearningRate(trainingSampleCount);
+                const auto momentum = MomentumValueForMB(trainingSampleCount);
+                LOGPRINTF(stderr, "learnRatePerSample=%0.8f, momentum=%0.8f, actualMBSize=%ld\n",
+                          learningRate, momentum, trainingSampleCount);
+                LOGPRINTF(stderr, "GradUpdateType()=%s, GradientUpdateNoiseStd()=%0.8f\n",
+                          LearnerType().c_str(), m_additionalOptions.gaussianNoiseInjectionStdDev);
+                Print(gradientValue, "Gradient Update");
+                Print(smoothedGradientValue, "Smoothed Gradient Input");
 #endif
-            DISPATCH_TO_TYPED_UPDATE_FUNCTION;
+                DISPATCH_TO_TYPED_UPDATE_FUNCTION;
 
 #if DUMPOUTPUT
-            Print(parameter.Value(), "Parameter Update");
+                Print(parameter.Value(), "Parameter Update");
 #endif
 
 #ifdef _DEBUG
-            const auto& parameterValue = parameter.Value();
-            if (HasNan(parameterValue, "TrainOneEpoch/UpdateWeights/Learner::Update(): "))
-                LogicError("%ls has NaNs in parameter values after parameter update.", parameter.Uid().c_str());
+                const auto& parameterValue = parameter.Value();
+                if (HasNan(parameterValue, "TrainOneEpoch/UpdateWeights/Learner::Update(): "))
+                    LogicError("%ls has NaNs in parameter values after parameter update.", parameter.Uid().c_str());
 #endif
+            }
         }
         m_sampleCount += trainingSampleCount;
         m_minibatchCount++;
@@ -326,6 +474,69 @@ namespace CNTK
         paramRef.RecordValueUpdate();
     }
 
+    bool LearnerBase::TryFusedUpdate(unordered_map<Parameter, NDArrayViewPtr>& gradientValues, size_t trainingSampleCount)
+    {
+        if (!UseFusedUpdate() || !HasFusedUpdate() || GetCurrentTrainingParameterValue(m_additionalOptions.gaussianNoiseInjectionStdDev) > 0)
+            return false;
+
+        FusedUpdateTensors tensors;
+        tensors.m_dataType = Parameters().front().GetDataType();
+        for (const auto& parameter : Parameters())
+        {
+            const auto& gradientValue = gradientValues.at(parameter);
+            if (parameter.GetDataType() != tensors.m_dataType ||
+                parameter.Value()->Device().Type() != DeviceKind::CPU ||
+                gradientValue->Device().Type() != DeviceKind::CPU ||
+                gradientValue->IsSparse())
+                return false;
+
+            tensors.m_parameters.push_back(parameter.Value());
+            tensors.m_gradients.push_back(gradientValue);
+        }
+
+        if (!m_smoothedGradientArena)
+            AllocateSmoothedGradientArena(tensors.m_dataType);
+
+        for (const auto& parameter : Parameters())
+            tensors.m_smoothedGradients.push_back(m_smoothedGradientValues.at(parameter));
+
+        FusedUpdate(tensors, trainingSampleCount);
+
+        for (const auto& parameter : Parameters())
+        {
+            auto paramRef = parameter;
+            paramRef.RecordValueUpdate();
+        }
+        return true;
+    }
+
+    void LearnerBase::AllocateSmoothedGradientArena(DataType dataType)
+    {
+        size_t totalSize = 0;
+        for (const auto& parameter : Parameters())
+            totalSize += m_smoothedGradientValues.at(parameter)->Shape().TotalSize();
+
+        const auto& device = DeviceDescriptor::CPUDevice();
+        m_smoothedGradientArena = MakeSharedObject<NDArrayView>(dataType, NDShape({ totalSize }), device);
+        char* buffer = dataType == DataType::Float ?
+            reinterpret_cast<char*>(m_smoothedGradientArena->WritableDataBuffer<float>()) :
+            reinterpret_cast<char*>(m_smoothedGradientArena->WritableDataBuffer<double>());
+
+        // The smoothed gradients are replaced by views into the arena, keeping their shapes,
+        // so that checkpointing and resetting them is not affected.
+        const size_t elementSize = DataTypeSize(dataType);
+        size_t offset = 0;
+        for (const auto& parameter : Parameters())
+        {
+            auto& smoothedGradientValue = m_smoothedGradientValues.at(parameter);
+            const size_t size = smoothedGradientValue->Shape().TotalSize();
+            auto view = MakeSharedObject<NDArrayView>(dataType, smoothedGradientValue->Shape(), buffer + offset * elementSize, size * elementSize, device);
+            view->CopyFrom(*smoothedGradientValue);
+            smoothedGradientValue = view;
+            offset += size;
+        }
+    }
+
     string LearnerBase::LearnerType() const
     {
         return Typename(this);
@@ -335,6 +546,10 @@ namespace CNTK
 
     /*virtual*/ Dictionary LearnerBase::CreateCheckpoint() /*override*/
     {
+        // Before checkpointing we need to sync the state so that our lazy implementation 
+        // for sparse gradients with timestamps is transparent to the user
+        FlushLazyUpdateStates();
+
         Dictionary checkpoint;
 
         checkpoint[versionKey] = CurrentVersion();
@@ -439,6 +654,69 @@ namespace CNTK
         }
         //TODO: additional options are not deserialized. This was not done when AdditionalOption was introduced.
 
+        // After restoring from a checkpoint we need to reset all timestamps and the current time for
+        // parameters that have sparse gradients.
+        ResetLazyUpdateStates();
+    }
+
+    // When the gradients are sparse, some learners update their state in a sparse way and maintain some additional
+    // timestamps. We periodically perform some dense work to prevent a) the timestamps overflowing and b) big
+    // differences between this implementation and an equivalent dense implementation due to numerical issues
+    // with floating point numbers.
+    // TODO: consider exposing this somehow so that it is easy to test by setting it to small value.
+    /* static */ const int LearnerBase::s_lazyUpdateSyncInterval = 1 << 20;
+
+    LearnerBase::LazyUpdateState& LearnerBase::AdvanceLazyUpdateState(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const vector<double>& hyperParameters)
+    {
+        auto search = m_lazyUpdateStates.find(parameter);
+        if (search == m_lazyUpdateStates.end())
+        {
+            // The timestamps are allocated here and initialized to 0, meaning that at time 0 everything was up to date.
+            const auto numCols = GetMatrixShape(parameter)[1];
+            LazyUpdateState state;
+            state.m_lastUpdateTime = MakeSharedObject<NDArrayView>(float(0.0), NDShape({ numCols }), gradientValue->Device());
+            state.m_currentTime = 0;
+            state.m_history.assign(1, 0.0);
+            search = m_lazyUpdateStates.emplace(parameter, state).first;
+        }
+        else if (search->second.m_currentTime >= s_lazyUpdateSyncInterval || search->second.m_hyperParameters != hyperParameters)
+        {
+            SyncLazyUpdateState(parameter, search->second);
+        }
+
+        auto& state = search->second;
+        state.m_hyperParameters = hyperParameters;
+        state.m_currentTime += 1;
+        return state;
+    }
+
+    void LearnerBase::SyncLazyUpdateState(const Parameter& parameter, LazyUpdateState& state)
+    {
+        if (state.m_currentTime == 0)
+            return;
+
+        FlushLazyUpdateState(parameter, state);
+        state.m_currentTime = 0;
+        state.m_history.resize(1);
+
+        auto paramRef = parameter;
+        paramRef.RecordValueUpdate();
+    }
+
+    void LearnerBase::FlushLazyUpdateStates()
+    {
+        for (auto& kv : m_lazyUpdateStates)
+            SyncLazyUpdateState(kv.first, kv.second);
+    }
+
+    void LearnerBase::ResetLazyUpdateStates()
+    {
+        for (auto& kv : m_lazyUpdateStates)
+        {
+            kv.second.m_lastUpdateTime->SetValue(0.0f);
+            kv.second.m_currentTime = 0;
+            kv.second.m_history.resize(1);
+        }
     }
 
     void LearnerBase::ReportTrainingParameterValue(const TrainingParameterSchedule<double>& schedule, const wstring& name) const
@@ -499,6 +777,23 @@ namespace CNTK
         parameterMatrix->SGDUpdate(*gradientMatrix, learningRate);
     }
 
+    /*virtual*/ void LearnerSGD::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) /*override*/
+    {
+        DISPATCH_TO_TYPED_FUSED_UPDATE_FUNCTION;
+    }
+
+    template <typename ElementType>
+    void LearnerSGD::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const
+    {
+        const auto learningRate = ElementType(LearningRate(trainingSampleCount));
+
+        ApplyFusedUpdate<ElementType>(tensors, trainingSampleCount,
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                segment.m_parameter[i] -= learningRate * g;
+            });
+    }
+
     double LearnerMomentumSGD::MomentumValueForMB(const MomentumSchedule& schedule, size_t minibatchSize) const
     {
         //TODO: The unit gain term (1-beta) should stay as it is (currentMomentum) instead of using the following scaled term.
@@ -519,7 +814,7 @@ namespace CNTK
 
     template <typename ElementType>
     void LearnerMomentumSGD::Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, 
-                                    const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const
+                                    const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount)
     {
         GET_WRITABLE_MATRICES;
         /*
@@ -551,8 +846,59 @@ namespace CNTK
         const auto learningRate = ElementType(LearningRate(trainingSampleCount));
         const auto momentum = ElementType(MomentumValueForMB(trainingSampleCount));
         const auto unitGainFactor = UnitGainFactor<ElementType>(trainingSampleCount);
+
+        int* timestamps = nullptr;
+        int currentTimestamp = 0;
+        if (UseLazyUpdate(gradientValue))
+        {
+            // The learning rate is a part of the smoothed gradient, the delayed updates only depend on the momentum.
+            const auto& state = AdvanceLazyUpdateState(parameter, gradientValue, { (double)momentum });
+            timestamps = state.Timestamps();
+            currentTimestamp = state.m_currentTime;
+        }
+
         parameterMatrix->MomentumSGDUpdate(*gradientMatrix, *smoothedGradientMatrix,
-                                           learningRate, momentum, unitGainFactor);
+                                           learningRate, momentum, unitGainFactor, timestamps, currentTimestamp);
+    }
+
+    /*virtual*/ void LearnerMomentumSGD::FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state) /*override*/
+    {
+        if (parameter.GetDataType() == DataType::Float)
+            FlushLazyUpdateState<float>(parameter, state);
+        else
+            FlushLazyUpdateState<double>(parameter, state);
+    }
+
+    template <typename ElementType>
+    void LearnerMomentumSGD::FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state)
+    {
+        const auto& smoothedGradientMatrix = GetWritableMatrix<ElementType>(m_smoothedGradientValues.at(parameter));
+        const auto& parameterMatrix = GetWritableMatrix<ElementType>(parameter.Value());
+        parameterMatrix->MomentumSGDFlushState(*smoothedGradientMatrix, (ElementType)state.m_hyperParameters[0], state.Timestamps(), state.m_currentTime);
+    }
+
+    /*virtual*/ void LearnerMomentumSGD::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) /*override*/
+    {
+        ReportTrainingParameterValue(m_momentumSchedule, L"Momentum");
+
+        DISPATCH_TO_TYPED_FUSED_UPDATE_FUNCTION;
+    }
+
+    template <typename ElementType>
+    void LearnerMomentumSGD::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const
+    {
+        // Same as MomentumSGDUpdate on dense matrices.
+        const auto learningRate = ElementType(LearningRate(trainingSampleCount));
+        const auto momentum = ElementType(MomentumValueForMB(trainingSampleCount));
+        const auto gradientFactor = UnitGainFactor<ElementType>(trainingSampleCount) * learningRate;
+
+        ApplyFusedUpdate<ElementType>(tensors, trainingSampleCount,
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                ElementType& smoothedGradient = segment.m_smoothedGradient[i];
+                smoothedGradient = momentum * smoothedGradient + gradientFactor * g;
+                segment.m_parameter[i] -= smoothedGradient;
+            });
     }
 
     /*virtual*/ void LearnerNesterov::Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, 
@@ -575,6 +921,28 @@ namespace CNTK
                                                               learningRate, momentum, unitGainFactor);
     }
 
+    /*virtual*/ void LearnerNesterov::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) /*override*/
+    {
+        DISPATCH_TO_TYPED_FUSED_UPDATE_FUNCTION;
+    }
+
+    template <typename ElementType>
+    void LearnerNesterov::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const
+    {
+        // Same as NesterovAcceleratedMomentumSGDUpdate on dense matrices.
+        const auto learningRate = ElementType(LearningRate(trainingSampleCount));
+        const auto momentum = ElementType(MomentumValueForMB(trainingSampleCount));
+        const auto gradientFactor = UnitGainFactor<ElementType>(trainingSampleCount) * learningRate;
+
+        ApplyFusedUpdate<ElementType>(tensors, trainingSampleCount,
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                ElementType& smoothedGradient = segment.m_smoothedGradient[i];
+                smoothedGradient = momentum * smoothedGradient + gradientFactor * g;
+                segment.m_parameter[i] -= momentum * smoothedGradient + gradientFactor * g;
+            });
+    }
+
     LearnerAdaGrad::LearnerAdaGrad(const std::vector<Parameter>& parameters,
                                    const LearningRateSchedule& learningRateSchedule,
                                    bool needAveMultiplier,
@@ -616,6 +984,32 @@ namespace CNTK
         Matrix<ElementType>::ScaleAndAdd(ElementType(-learningRate / aveMultiplier), *gradientMatrix, *parameterMatrix);
     }
 
+    /*virtual*/ void LearnerAdaGrad::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) /*override*/
+    {
+        DISPATCH_TO_TYPED_FUSED_UPDATE_FUNCTION;
+    }
+
+    template <typename ElementType>
+    void LearnerAdaGrad::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const
+    {
+        // Same as CPUMatrix::Adagrad followed by the parameter update, the average multiplier
+        // is computed by the reduction sweep from the would-be accumulated squared gradients.
+        const auto learningRate = ElementType(LearningRate(trainingSampleCount));
+        const ElementType floor = ElementType(1e-16);
+
+        ApplyFusedUpdate<ElementType>(tensors, trainingSampleCount, m_needAveMultiplier,
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                return 1 / sqrt(segment.m_smoothedGradient[i] + g * g + floor);
+            },
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                ElementType& accumulator = segment.m_smoothedGradient[i];
+                accumulator += g * g;
+                segment.m_parameter[i] -= learningRate / segment.m_reduction * g / sqrt(accumulator + floor);
+            });
+    }
+
     LearnerAdaDelta::LearnerAdaDelta(
         const std::vector<Parameter>& parameters,
         const LearningRateSchedule& learningRateSchedule,
@@ -638,13 +1032,6 @@ namespace CNTK
         DISPATCH_TO_TYPED_UPDATE_FUNCTION;
     }
 
-    // When the gradients are sparse, we update the corresponding internal buffers of adadelta in a sparse way
-    // and we maintain some additional timestamps. We periodically perform some dense work to prevent 
-    // a) the timestamps overflowing and b) big differences between this implementation and an equivalent dense
-    // implementation due to numerical issues with floating point numbers.
-    // TODO: consider exposing this somehow so that it is easy to test by setting it to small value.
-    /* static */ const int LearnerAdaDelta::s_SyncInterval = 1 << 20;
-
     template <typename ElementType>
     void LearnerAdaDelta::Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue,
         const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount)
@@ -657,86 +1044,32 @@ namespace CNTK
         int currentTimestamp = 0;
         if (gradientValue->IsSparse())
         {
-            // When the gradient is sparse (block sparse column) we maintain a timestamp for every column
-            // The timestamp is allocated here and initialized to 0, meaning that at time 0 everything was
-            // up to date. We also maintain a currentTime variable that is incremented with each update.
+            // When the gradient is sparse (block sparse column) we maintain a timestamp for every column.
             // When we perform the update, for every non-zero column we first use the timestamp and the 
             // current time to apply all updates that a dense implementation would have applied to that column
             // and then update the timestamp for that column with the current time. 
-            const auto numCols = gradientMatrix->GetNumCols();
-            const auto search = m_lastUpdateTime.find(parameter);
-            if (search == m_lastUpdateTime.end())
-            {
-                // create timestamps and current time
-                // NDArrayView only supports Float and Double and the following assert prevents surprises in non-standard platforms
-                static_assert(sizeof(int) <= sizeof(float), "Buffer for timestamps is not big enough on this platform");
-                const auto view = MakeSharedObject<NDArrayView>(float(0.0), NDShape({ numCols }), gradientValue->Device());
-                const auto itBoolPair = m_lastUpdateTime.emplace(make_pair(parameter, view));
-                assert(itBoolPair.second); // insertion took place
-                timestamps = reinterpret_cast<int*>(const_cast<float*>(itBoolPair.first->second->DataBuffer<float>()));
-                m_currentTime[parameter] = 0;
-            }
-            else
-            {
-                // retrieve timestamps and current time
-                timestamps = reinterpret_cast<int*>(const_cast<float*>(search->second->DataBuffer<float>()));
-                currentTimestamp = m_currentTime[parameter];
-            }
-            if (currentTimestamp >= LearnerAdaDelta::s_SyncInterval)
-            {
-                // Once in a while sync the state and reset the timestamps and current time to 0
-                smoothedGradientMatrix->AdaDeltaFlushState(numCols, (ElementType)m_rho, timestamps, currentTimestamp);
-                m_currentTime[parameter] = currentTimestamp = 0;
-            }
-            currentTimestamp += 1;
-            m_currentTime[parameter] = currentTimestamp;
+            const auto& state = AdvanceLazyUpdateState(parameter, gradientValue, {});
+            timestamps = state.Timestamps();
+            currentTimestamp = state.m_currentTime;
         }
 
         smoothedGradientMatrix->AdaDeltaUpdate(*gradientMatrix, *parameterMatrix, (ElementType)learningRate, (ElementType)m_rho, (ElementType)m_epsilon, timestamps, currentTimestamp);
     }
 
-    /*virtual*/ Dictionary LearnerAdaDelta::CreateCheckpoint() /*override*/
+    /*virtual*/ void LearnerAdaDelta::FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state) /*override*/
     {
-        // Before checkpointing we need to sync the state so that our lazy implementation 
-        // for sparse gradients with timestamps is transparent to the user
-        for (const auto& parameter : Parameters())
-        {
-            const auto search = m_lastUpdateTime.find(parameter);
-            if (search == m_lastUpdateTime.end())
-                continue;
-            int* timestamps = reinterpret_cast<int*>(const_cast<float*>(search->second->DataBuffer<float>()));
-            int currentTimestamp = m_currentTime[parameter];
-            const auto& smoothedGradientValue = m_smoothedGradientValues.at(parameter);
-            if (parameter.GetDataType() == CNTK::DataType::Float)
-            {
-                const auto numCols = GetMatrix<float>(parameter.Value())->GetNumCols();
-                const auto& smoothedGradientMatrix = GetWritableMatrix<float>(smoothedGradientValue);
-                smoothedGradientMatrix->AdaDeltaFlushState(numCols, (float)m_rho, timestamps, currentTimestamp);
-            }
-            else
-            {
-                const auto numCols = GetMatrix<double>(parameter.Value())->GetNumCols();
-                const auto& smoothedGradientMatrix = GetWritableMatrix<double>(smoothedGradientValue);
-                smoothedGradientMatrix->AdaDeltaFlushState(numCols, (double)m_rho, timestamps, currentTimestamp);
-            }
-            m_currentTime[parameter] = 0;
-        }
-        return LearnerBase::CreateCheckpoint();
+        if (parameter.GetDataType() == DataType::Float)
+            FlushLazyUpdateState<float>(parameter, state);
+        else
+            FlushLazyUpdateState<double>(parameter, state);
     }
 
-    /*virtual*/ void LearnerAdaDelta::RestoreFromCheckpoint(const Dictionary& checkpoint) /*override*/
+    template <typename ElementType>
+    void LearnerAdaDelta::FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state)
     {
-        LearnerBase::RestoreFromCheckpoint(checkpoint);
-        // After restoring from a checkpoint we need to reset all timestamps and the current time for
-        // parameters that have sparse gradients.
-        for (const auto& parameter : Parameters())
-        {
-            const auto search = m_lastUpdateTime.find(parameter);
-            if (search == m_lastUpdateTime.end())
-                continue;
-            m_currentTime[parameter] = 0;
-            search->second->SetValue(0.0f);
-        }
+        const auto numCols = GetMatrix<ElementType>(parameter.Value())->GetNumCols();
+        const auto& smoothedGradientMatrix = GetWritableMatrix<ElementType>(m_smoothedGradientValues.at(parameter));
+        smoothedGradientMatrix->AdaDeltaFlushState(numCols, (ElementType)m_rho, state.Timestamps(), state.m_currentTime);
     }
 
     /*static*/ const double LearnerFSAdaGrad::s_targetAdagradAvDenom = 1.0;
@@ -801,7 +1134,7 @@ namespace CNTK
 
     template <typename ElementType>
     void LearnerFSAdaGrad::Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, 
-                                  const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const
+                                  const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount)
     {
         GET_WRITABLE_MATRICES;
 
@@ -810,8 +1143,75 @@ namespace CNTK
         const auto varMomentum = VarianceMomentumValueForMB(trainingSampleCount);
         const auto unitGainFactor = UnitGainFactor<ElementType>(trainingSampleCount);
 
+        int* timestamps = nullptr;
+        int currentTimestamp = 0;
+        if (UseLazyUpdate(gradientValue))
+        {
+            const auto& state = AdvanceLazyUpdateState(parameter, gradientValue, { learningRate, momentum, varMomentum });
+            timestamps = state.Timestamps();
+            currentTimestamp = state.m_currentTime;
+        }
+
         smoothedGradientMatrix->FSAdagradUpdate(*gradientMatrix, *parameterMatrix, m_targetAdagradAvDenom_x_sqrtAdagradSqrFrames, learningRate,
-                                                momentum, varMomentum, unitGainFactor);
+                                                momentum, varMomentum, unitGainFactor, timestamps, currentTimestamp);
+    }
+
+    /*virtual*/ void LearnerFSAdaGrad::FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state) /*override*/
+    {
+        if (parameter.GetDataType() == DataType::Float)
+            FlushLazyUpdateState<float>(parameter, state);
+        else
+            FlushLazyUpdateState<double>(parameter, state);
+    }
+
+    template <typename ElementType>
+    void LearnerFSAdaGrad::FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state)
+    {
+        const auto& smoothedGradientMatrix = GetWritableMatrix<ElementType>(m_smoothedGradientValues.at(parameter));
+        const auto& parameterMatrix = GetWritableMatrix<ElementType>(parameter.Value());
+        const auto& hyperParameters = state.m_hyperParameters; // learning rate, momentum, variance momentum
+        smoothedGradientMatrix->FSAdagradFlushState(*parameterMatrix, hyperParameters[0], hyperParameters[1], hyperParameters[2],
+                                                    state.Timestamps(), state.m_currentTime);
+    }
+
+    /*virtual*/ void LearnerFSAdaGrad::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) /*override*/
+    {
+        DISPATCH_TO_TYPED_FUSED_UPDATE_FUNCTION;
+    }
+
+    template <typename ElementType>
+    void LearnerFSAdaGrad::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const
+    {
+        // Same as CPUMatrix::FSAdagrad, the smoothed gradient holds the variance accumulator followed by the momentum accumulator.
+        const auto learningRate = ElementType(LearningRate(trainingSampleCount));
+        const auto momentum = ElementType(MomentumValueForMB(trainingSampleCount));
+        const auto varMomentum = ElementType(VarianceMomentumValueForMB(trainingSampleCount));
+        const auto unitGainFactor = UnitGainFactor<ElementType>(trainingSampleCount);
+        const auto adaMul = ElementType(m_targetAdagradAvDenom_x_sqrtAdagradSqrFrames);
+
+        ApplyFusedUpdate<ElementType>(tensors, trainingSampleCount,
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                ElementType& smoothAda = segment.m_smoothedGradient[i];
+                ElementType& smoothMom = segment.m_smoothedGradient[segment.m_size + i];
+                const ElementType adaSqr = varMomentum * smoothAda + (1 - varMomentum) * g * g;
+                smoothAda = adaSqr;
+                if (adaSqr != 0)
+                {
+                    ElementType w = adaMul / sqrt(adaSqr);
+                    if (w > 10)
+                        w = 10;
+                    g *= w;
+                }
+
+                if (momentum > 0)
+                {
+                    g = momentum * smoothMom + unitGainFactor * g;
+                    smoothMom = g;
+                }
+
+                segment.m_parameter[i] -= learningRate * g;
+            });
     }
 
     LearnerAdam::LearnerAdam(const vector<Parameter>& parameters,
@@ -874,7 +1274,7 @@ namespace CNTK
 
     template <typename ElementType>
     void LearnerAdam::Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue,
-        const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const
+        const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount)
     {
         GET_WRITABLE_MATRICES;
 
@@ -884,8 +1284,81 @@ namespace CNTK
 
         const auto varMomentum = VarianceMomentumValueForMB(trainingSampleCount);
 
+        const double* biasCorrections = nullptr;
+        int* timestamps = nullptr;
+        int currentTimestamp = 0;
+        if (UseLazyUpdate(gradientValue))
+        {
+            // The bias correction changes with every minibatch, the delayed updates need the past values.
+            auto& state = AdvanceLazyUpdateState(parameter, gradientValue, { learningRate, momentum, varMomentum });
+            state.m_history.push_back(BiasCorrection(momentum, varMomentum));
+            biasCorrections = state.m_history.data();
+            timestamps = state.Timestamps();
+            currentTimestamp = state.m_currentTime;
+        }
+
         smoothedGradientMatrix->AdamUpdate(*gradientMatrix, *parameterMatrix, m_smoothedCount, learningRate,
-                                           momentum, varMomentum, (ElementType)m_epsilon, unitGainFactor, m_adamax);
+                                           momentum, varMomentum, (ElementType)m_epsilon, unitGainFactor, m_adamax,
+                                           biasCorrections, timestamps, currentTimestamp);
+    }
+
+    /*virtual*/ void LearnerAdam::FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state) /*override*/
+    {
+        if (parameter.GetDataType() == DataType::Float)
+            FlushLazyUpdateState<float>(parameter, state);
+        else
+            FlushLazyUpdateState<double>(parameter, state);
+    }
+
+    template <typename ElementType>
+    void LearnerAdam::FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state)
+    {
+        const auto& smoothedGradientMatrix = GetWritableMatrix<ElementType>(m_smoothedGradientValues.at(parameter));
+        const auto& parameterMatrix = GetWritableMatrix<ElementType>(parameter.Value());
+        const auto& hyperParameters = state.m_hyperParameters; // learning rate, momentum, variance momentum
+        smoothedGradientMatrix->AdamFlushState(*parameterMatrix, hyperParameters[0], hyperParameters[1], hyperParameters[2],
+                                               m_epsilon, m_adamax, state.m_history.data(), state.Timestamps(), state.m_currentTime);
+    }
+
+    /*virtual*/ void LearnerAdam::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) /*override*/
+    {
+        DISPATCH_TO_TYPED_FUSED_UPDATE_FUNCTION;
+    }
+
+    template <typename ElementType>
+    void LearnerAdam::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const
+    {
+        // Same as AdamUpdate on dense matrices, the smoothed gradient holds the variance accumulator followed by the momentum accumulator.
+        const auto learningRate = ElementType(LearningRate(trainingSampleCount));
+        const double momentum = MomentumValueForMB(trainingSampleCount);
+        const double varMomentum = VarianceMomentumValueForMB(trainingSampleCount);
+        const auto unitGainFactor = UnitGainFactor<ElementType>(trainingSampleCount);
+        const auto epsilon = ElementType(m_epsilon);
+        const bool adamax = m_adamax;
+
+        const auto biasCorrection = ElementType(BiasCorrection(momentum, varMomentum));
+        const auto adaWeight = ElementType(varMomentum);
+        const auto momentumWeight = ElementType(momentum);
+
+        ApplyFusedUpdate<ElementType>(tensors, trainingSampleCount,
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                ElementType& smoothAda = segment.m_smoothedGradient[i];
+                ElementType& smoothMom = segment.m_smoothedGradient[segment.m_size + i];
+                ElementType ada;
+                if (!adamax)
+                {
+                    smoothAda = adaWeight * smoothAda + (1 - adaWeight) * g * g;
+                    ada = sqrt(smoothAda);
+                }
+                else
+                    ada = smoothAda = std::max(adaWeight * smoothAda, std::abs(g));
+
+                const ElementType w = biasCorrection / (ada + epsilon);
+                g = momentumWeight * smoothMom + unitGainFactor * g;
+                smoothMom = g;
+                segment.m_parameter[i] -= g * w * learningRate;
+            });
     }
 
     LearnerRMSProp::LearnerRMSProp(const vector<Parameter>& parameters,
@@ -979,6 +1452,58 @@ namespace CNTK
         Matrix<ElementType>::ScaleAndAdd(ElementType(-learningRate / aveMultiplier), *gradientMatrix, *parameterMatrix);
     }
 
+    /*virtual*/ void LearnerRMSProp::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) /*override*/
+    {
+        DISPATCH_TO_TYPED_FUSED_UPDATE_FUNCTION;
+    }
+
+    template <typename ElementType>
+    void LearnerRMSProp::FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const
+    {
+        // Same as CPUMatrix::RmsProp followed by the parameter update. The smoothed gradient holds
+        // the accumulated variances, the signs of the previous gradient and the current step sizes.
+        const auto learningRate = ElementType(LearningRate(trainingSampleCount));
+        const auto gamma = ElementType(m_gamma);
+        const auto inc = ElementType(m_inc);
+        const auto dec = ElementType(m_dec);
+        const auto max = ElementType(m_max);
+        const auto min = ElementType(m_min);
+        const bool initialized = m_smoothedCount > 1;
+        const ElementType floor = ElementType(1e-6);
+
+        // Returns the new variance and step size of element i.
+        auto nextState = [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+        {
+            const ElementType* avars = segment.m_smoothedGradient;
+            const ElementType* signs = segment.m_smoothedGradient + segment.m_size;
+            const ElementType* steps = segment.m_smoothedGradient + 2 * segment.m_size;
+
+            // Uninitialized state starts with the squared gradient as the variance and the step size of 0.02.
+            const ElementType avar = initialized ? avars[i] : g * g;
+            const ElementType sign = initialized ? signs[i] : ElementType(0);
+            const ElementType step = initialized ? steps[i] : ElementType(0.02);
+
+            const int gradientSign = (ElementType(0) < g) - (g < ElementType(0));
+            return make_pair(gamma * avar + (1 - gamma) * g * g,
+                             sign * gradientSign > 0 ? std::min(step * inc, max) : std::max(step * dec, min));
+        };
+
+        ApplyFusedUpdate<ElementType>(tensors, trainingSampleCount, m_needAveMultiplier,
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                const auto state = nextState(segment, i, g);
+                return state.second / sqrt(state.first + floor);
+            },
+            [=](const FusedUpdateSegment<ElementType>& segment, size_t i, ElementType g)
+            {
+                const auto state = nextState(segment, i, g);
+                segment.m_smoothedGradient[i] = state.first;
+                segment.m_smoothedGradient[segment.m_size + i] = ElementType((ElementType(0) < g) - (g < ElementType(0)));
+                segment.m_smoothedGradient[2 * segment.m_size + i] = state.second;
+                segment.m_parameter[i] -= learningRate / segment.m_reduction * g * state.second / sqrt(state.first + floor);
+            });
+    }
+
     // Explicit template instantiations
     template shared_ptr<Matrix<float>> LearnerBase::GetWritableMatrix<float>(const NDArrayViewPtr& arrayView);
     template shared_ptr<Matrix<double>> LearnerBase::GetWritableMatrix<double>(const NDArrayViewPtr& arrayView);
@@ -44,6 +44,46 @@ namespace CNTK
         // Allows derived class may override this to perform per-minibatch update actions
         virtual void UpdateOnMinibatch(size_t /*trainingSampleCount*/) {}
 
+        // Parameters, gradients and smoothed gradients updated by a fused update.
+        // All of them are dense, located on the CPU and of the same data type.
+        struct FusedUpdateTensors
+        {
+            DataType m_dataType;
+            std::vector<NDArrayViewPtr> m_parameters;
+            std::vector<NDArrayViewPtr> m_gradients;
+            std::vector<NDArrayViewPtr> m_smoothedGradients;
+        };
+
+        // Data of a single parameter as seen by the per-element functions of a fused update.
+        template <typename ElementType>
+        struct FusedUpdateSegment
+        {
+            ElementType* m_parameter;
+            const ElementType* m_gradient;
+            ElementType* m_smoothedGradient;
+            size_t m_size;
+            // Factor applied to the raw gradient (mean gradient and norm clipping).
+            ElementType m_gradientScale;
+            // Average of the learner specific reduction over the parameter (1 if there is none).
+            ElementType m_reduction;
+        };
+
+        // Derived classes that implement FusedUpdate return true.
+        virtual bool HasFusedUpdate() const { return false; }
+
+        // Updates all parameters at once, see Learner::SetFusedUpdate.
+        virtual void FusedUpdate(const FusedUpdateTensors& /*tensors*/, size_t /*trainingSampleCount*/) { NOT_IMPLEMENTED; }
+
+        // Runs the preprocessing, the given update and the postprocessing over all parameters in a single parallel sweep.
+        // update(segment, i, gradient) is called for every element i of every parameter with the preprocessed gradient value.
+        template <typename ElementType, typename UpdateFunction>
+        void ApplyFusedUpdate(const FusedUpdateTensors& tensors, size_t actualMBSize, UpdateFunction update) const;
+
+        // Same as above, preceded by a sweep that averages reduce(segment, i, gradient) over each parameter; the update
+        // gets the average in segment.m_reduction (used for the average multiplier of AdaGrad and RMSProp).
+        template <typename ElementType, typename ReduceFunction, typename UpdateFunction>
+        void ApplyFusedUpdate(const FusedUpdateTensors& tensors, size_t actualMBSize, bool average, ReduceFunction reduce, UpdateFunction update) const;
+
         std::string LearnerType() const;
 
         // Returns current learning rate.
@@ -111,6 +151,43 @@ namespace CNTK
         template <typename ElementType>
         void PostProcess(const Parameter& parameter, const NDArrayViewPtr& gradientValue, size_t actualMBSize) const;
 
+        // If a gradient is sparse (block sparse column), learners that support it skip updating the columns with
+        // zero gradients: each column receives the delayed updates when its gradient is non-zero. For this we keep a
+        // timestamp per column with the last time that column was updated, and the current time. The delayed updates
+        // are computed assuming the learner's hyperparameters did not change since the column was last updated, so
+        // all columns are brought up to date when they do change, and also once every s_lazyUpdateSyncInterval updates
+        // (to prevent the timestamps from overflowing and the state from drifting from the dense implementation
+        // because of floating point round-off) and before checkpointing.
+        struct LazyUpdateState
+        {
+            NDArrayViewPtr m_lastUpdateTime;
+            int m_currentTime;
+            // Hyperparameters the delayed updates are computed with.
+            std::vector<double> m_hyperParameters;
+            // Per-minibatch values needed by the delayed updates, indexed by time (used for the Adam bias correction).
+            std::vector<double> m_history;
+
+            int* Timestamps() const
+            {
+                // NDArrayView only supports Float and Double and the following assert prevents surprises in non-standard platforms
+                static_assert(sizeof(int) <= sizeof(float), "Buffer for timestamps is not big enough on this platform");
+                return reinterpret_cast<int*>(const_cast<float*>(m_lastUpdateTime->DataBuffer<float>()));
+            }
+        };
+
+        static const int s_lazyUpdateSyncInterval;
+
+        // Returns the lazy update state of a parameter with a sparse gradient, with the current time advanced to the
+        // time of this update. The state is flushed first if it is time to sync or if the hyperparameters changed.
+        LazyUpdateState& AdvanceLazyUpdateState(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const std::vector<double>& hyperParameters);
+
+        // Brings the smoothed gradient and the value of the parameter up to date for all columns, as if they were
+        // updated densely, using state.m_hyperParameters. Implemented by the learners that call AdvanceLazyUpdateState.
+        virtual void FlushLazyUpdateState(const Parameter& /*parameter*/, const LazyUpdateState& /*state*/) { NOT_IMPLEMENTED; }
+
+        // Flushes the lazy update states of all parameters.
+        void FlushLazyUpdateStates();
+
         // Returns an NDArrayView with the required shape, with the same data type as parameter value
         // and allocated on the same device.
         static NDArrayViewPtr AllocateNDArrayView(const Parameter& parameter, const NDShape& shape);
@@ -124,6 +201,24 @@ namespace CNTK
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount);
 
+        // Performs the fused update if it is requested and applicable to the given gradients, returns false otherwise.
+        bool TryFusedUpdate(std::unordered_map<Parameter, NDArrayViewPtr>& gradientValues, size_t trainingSampleCount);
+
+        // Moves the smoothed gradients into a single contiguous buffer, done once before the first fused update.
+        void AllocateSmoothedGradientArena(DataType dataType);
+
+        // Backing storage of the smoothed gradients after the first fused update.
+        NDArrayViewPtr m_smoothedGradientArena;
+
+        // Lazy update states of the parameters with sparse gradients.
+        std::unordered_map<Parameter, LazyUpdateState> m_lazyUpdateStates;
+
+        // Flushes the state and resets the current time (and the history).
+        void SyncLazyUpdateState(const Parameter& parameter, LazyUpdateState& state);
+
+        // Resets the timestamps and the current time of all lazy update states, once the smoothed gradients are overwritten.
+        void ResetLazyUpdateStates();
+
         // TODO: make these functions friends of NDViewArray and move to Utils?
         static bool HasNan(const NDArrayViewPtr& value, const char* name);
         static void Print(const NDArrayViewPtr& value, const char* msg);
@@ -151,6 +246,12 @@ namespace CNTK
 
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
+
+        virtual bool HasFusedUpdate() const override { return true; }
+        virtual void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) override;
+
+        template <typename ElementType>
+        void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const;
     };
 
     // SGD optimization with momentum. 
@@ -178,7 +279,24 @@ namespace CNTK
         virtual void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) override;
 
         template <typename ElementType>
-        void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
+        void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount);
+
+        virtual bool HasFusedUpdate() const override { return true; }
+        virtual void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) override;
+
+        template <typename ElementType>
+        void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const;
+
+        virtual void FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state) override;
+
+        template <typename ElementType>
+        void FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state);
+
+        // Returns true if the sparse gradient is updated lazily (see LazyUpdateState), which is implemented for the CPU.
+        static bool UseLazyUpdate(const NDArrayViewPtr& gradientValue)
+        {
+            return gradientValue->IsSparse() && gradientValue->Device().Type() == DeviceKind::CPU;
+        }
 
         // returns current per-minibatch momentum value from the provided schedule.
         double MomentumValueForMB(const MomentumSchedule& schedule, size_t minibatchSize) const;
@@ -224,6 +342,12 @@ namespace CNTK
 
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
+
+        virtual bool HasFusedUpdate() const override { return true; }
+        virtual void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) override;
+
+        template <typename ElementType>
+        void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const;
     };
 
     class LearnerAdaGrad : public LearnerBase
@@ -241,6 +365,12 @@ namespace CNTK
 
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
+
+        virtual bool HasFusedUpdate() const override { return true; }
+        virtual void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) override;
+
+        template <typename ElementType>
+        void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const;
     };
 
     class LearnerAdaDelta : public LearnerBase
@@ -253,26 +383,18 @@ namespace CNTK
             AdditionalLearningOptions additionalOptions);
 
     protected:
-        // If a gradient is sparse, we skip updating columns with zero gradients. This means some 
-        // columns will receive their updates when their gradient is non-zero. The only exception
-        // is that once every s_SyncInterval updates we will make sure all columns are up to date. 
-        static const int s_SyncInterval;
-
         double m_rho;
         double m_epsilon;
-        // If a gradient is sparse, we will maintain a timestamp per column with the last time that column was updated
-        std::unordered_map<Parameter, NDArrayViewPtr> m_lastUpdateTime;
-        // If a gradient is sparse we will use the current time and the timestamp to determine how to apply a bunch of delayed updates for this column.
-        // This allows us to skip updating many columns when the gradients are sparse.
-        std::unordered_map<Parameter, int> m_currentTime;
 
         virtual void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) override;
 
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount);
 
-        virtual Dictionary CreateCheckpoint() override;
-        virtual void RestoreFromCheckpoint(const Dictionary& checkpoint) override;
+        virtual void FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state) override;
+
+        template <typename ElementType>
+        void FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state);
     };
 
     class LearnerFSAdaGrad : public LearnerMomentumSGD
@@ -298,7 +420,18 @@ namespace CNTK
         virtual void UpdateOnMinibatch(size_t trainingSampleCount) override;
 
         template <typename ElementType>
-        void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
+        void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount);
+
+        virtual bool HasFusedUpdate() const override { return true; }
+        virtual void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) override;
+
+        template <typename ElementType>
+        void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const;
+
+        virtual void FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state) override;
+
+        template <typename ElementType>
+        void FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state);
 
     private:
         static const double s_targetAdagradAvDenom;
@@ -339,7 +472,18 @@ namespace CNTK
         virtual void UpdateOnMinibatch(size_t trainingSampleCount) override;
 
         template <typename ElementType>
-        void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
+        void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount);
+
+        virtual bool HasFusedUpdate() const override { return true; }
+        virtual void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) override;
+
+        template <typename ElementType>
+        void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const;
+
+        virtual void FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state) override;
+
+        template <typename ElementType>
+        void FlushLazyUpdateState(const Parameter& parameter, const LazyUpdateState& state);
 
     private:
 
@@ -350,6 +494,14 @@ namespace CNTK
             return MomentumValueForMB(m_varianceMomentumSchedule, minibatchSize);
         }
 
+        // returns the bias correction of the current minibatch, see Matrix::AdamUpdate.
+        double BiasCorrection(double momentum, double varMomentum) const
+        {
+            return m_adamax ?
+                1. / (1 - pow(momentum, m_smoothedCount)) :
+                sqrt(1 - pow(varMomentum, m_smoothedCount)) / (1 - pow(momentum, m_smoothedCount));
+        }
+
         double m_smoothedCount;
         MomentumSchedule m_varianceMomentumSchedule;
         double m_epsilon;
@@ -387,6 +539,12 @@ namespace CNTK
 
         template <typename ElementType>
         void Update(const Parameter& parameter, const NDArrayViewPtr& gradientValue, const NDArrayViewPtr& smoothedGradientValue, size_t trainingSampleCount) const;
+
+        virtual bool HasFusedUpdate() const override { return true; }
+        virtual void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) override;
+
+        template <typename ElementType>
+        void FusedUpdate(const FusedUpdateTensors& tensors, size_t trainingSampleCount) const;
     };
 
 
@@ -423,6 +423,12 @@ namespace CNTK
         return BuildImageDeserializer(L"Base64ImageDeserializer", fileName, labelStreamName, numLabels, imageStreamName, transforms);
     }
 
+    Deserializer ImageShardDeserializer(const std::wstring& fileName, const std::wstring& labelStreamName, size_t numLabels,
+        const std::wstring& imageStreamName, const std::vector<ImageTransform>& transforms)
+    {
+        return BuildImageDeserializer(L"ImageShardDeserializer", fileName, labelStreamName, numLabels, imageStreamName, transforms);
+    }
+
     Deserializer CTFDeserializer(const std::wstring& fileName, const std::vector<StreamConfiguration>& streams)
     {
         Deserializer ctf;
@@ -572,12 +578,14 @@ namespace CNTK
                     { L"CNTKBinaryFormatDeserializer", L"CNTKBinaryReader" },
                     { L"ImageDeserializer",            L"ImageReader" },
                     { L"Base64ImageDeserializer",      L"ImageReader" },
+                    { L"ImageShardDeserializer",       L"ImageReader" },
                     { L"HTKFeatureDeserializer",       L"HTKDeserializers" },
                     { L"HTKMLFDeserializer",           L"HTKDeserializers" },
                 };
 
                 auto deserializerTypeName = deserializerConfig[L"type"].Value<std::wstring>();
-                if (deserializerTypeName == L"ImageDeserializer" || deserializerTypeName == L"Base64ImageDeserializer")
+                if (deserializerTypeName == L"ImageDeserializer" || deserializerTypeName == L"Base64ImageDeserializer" ||
+                    deserializerTypeName == L"ImageShardDeserializer")
                 {
                     defaultMultithreaded = true;
                 }
@@ -117,6 +117,7 @@ namespace CNTK
     /*static*/ const std::wstring PrimitiveFunction::AttributeNameKernelShape = L"kernelShape";
     /*static*/ const std::wstring PrimitiveFunction::AttributeNameBias = L"bias";
     /*static*/ const std::wstring PrimitiveFunction::AttributeNameDepthRadius = L"depthRadius";
+    /*static*/ const std::wstring PrimitiveFunction::AttributeNameWeightStorage = L"weightStorage";
     /*static*/ const std::wstring PrimitiveFunction::AttributeNameCustomAttributes = L"customAttributes";
 
 
@@ -1520,4 +1521,13 @@ namespace CNTK
         m_attributes[AttributeNameRngSeed] = seed;
         m_dirtyAttributes.insert(AttributeNameRngSeed);
     }
+
+    void PrimitiveFunction::SetWeightStorage(const std::wstring& format)
+    {
+        if (OpType() != PrimitiveOpType::Times)
+            LogicError("Cannot set weight storage on '%S' function.", OpName().c_str());
+
+        // L"float" switches back to the full precision weights, anything else has to be a 16-bit format
+        m_attributes[AttributeNameWeightStorage] = (format == L"float") ? format : std::wstring(HalfGemm::ToString(HalfGemm::ParseFormat(format)));
+    }
 }
@@ -288,6 +288,7 @@ namespace CNTK
         static const std::wstring AttributeNameKernelShape;
         static const std::wstring AttributeNameBias;
         static const std::wstring AttributeNameDepthRadius;
+        static const std::wstring AttributeNameWeightStorage;
         static const std::wstring AttributeNameCustomAttributes;
 
     protected:
@@ -775,6 +776,8 @@ namespace CNTK
         void SetDropoutRate(double dropoutRate);
 
         void SetRandomSeed(size_t seed);
+
+        void SetWeightStorage(const std::wstring& format);
     private:
         //aux functions
         void CollectReduceOutputAxesForOutputShape(std::vector<Axis>& staticAxesToReduce,
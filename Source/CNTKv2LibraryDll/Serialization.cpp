@@ -11,11 +11,23 @@
 #include <string>
 #include <vector>
 #include <limits>
+#include <mutex>
 
 #ifdef _MSC_VER
 #include <io.h>
 #endif
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #pragma warning(push)
 #pragma warning(disable : 4800 4267 4610 4512 4100 4510)
 #include "CNTK.pb.h"
@@ -31,6 +43,17 @@ namespace CNTK
     static const uint32 MAGIC_NUMBER = 0x636e746bU;
     static const uint32 BLOCK_SIZE = 8 << 10; // 8Kb;
 
+    // Memory-mappable model files start with their own magic number followed by the bytes size of the metadata
+    // protobuf, the protobuf itself and the data section. The data section holds the raw values of all NDArrayViews,
+    // each one aligned to RAW_DATA_ALIGNMENT bytes, at the offsets recorded in their protos.
+    static const uint32 MEMORY_MAPPABLE_MAGIC_NUMBER = 0x636e746dU;
+    static const size_t RAW_DATA_ALIGNMENT = 64;
+
+    static size_t AlignRawData(size_t offset)
+    {
+        return (offset + RAW_DATA_ALIGNMENT - 1) / RAW_DATA_ALIGNMENT * RAW_DATA_ALIGNMENT;
+    }
+
     static void SetUTF8Locale()
     {
 #ifndef _MSC_VER
@@ -124,6 +147,9 @@ namespace CNTK
         friend class Dictionary;
         friend class DictionaryValue;
 
+        friend void SaveMemoryMappableModel(const Dictionary&, const std::wstring&);
+        friend Dictionary LoadMemoryMappedModel(const std::wstring&);
+
         Serializer(const Dictionary& dict);
         Serializer(const DictionaryValue& dict);
 
@@ -158,6 +184,10 @@ namespace CNTK
 
         bool ReadNDArrayViewData(io::ZeroCopyInputStream& input);
 
+        void WriteMemoryMappable(const std::wstring& filename);
+        bool ReadMemoryMapped(char* data, size_t size, Dictionary& dict);
+        NDArrayView* CreateFromRawData(uint64 offset, DataType dataType, StorageFormat storageFormat, const NDShape& shape);
+
         size_t GetTotalByteSize() 
         {
             return m_byteSize + m_proto->ByteSizeLong();
@@ -285,6 +315,10 @@ namespace CNTK
         Message* m_proto;
         std::vector<std::pair<NDArrayView*, proto::NDArrayView*>> m_arrayViews;
         size_t m_byteSize {0};
+
+        // The data section of a memory-mapped model file being read.
+        char* m_rawData {nullptr};
+        size_t m_rawDataSize {0};
     };
 
 
@@ -430,6 +464,9 @@ namespace CNTK
         std::unique_ptr<NDShape> shape(CreateFromProto(src.shape()));
         auto dataType = FromProtoType(src.data_type());
         auto storageFormat = FromProtoType(src.storage_format());
+        if (src.values_case() == proto::NDArrayView::kRawDataOffset)
+            return CreateFromRawData(src.raw_data_offset(), dataType, storageFormat, *shape);
+
         NDArrayView* dst = new NDArrayView(dataType, storageFormat, *shape, DeviceDescriptor::CPUDevice());
 
         if (dataType == DataType::Float)
@@ -449,6 +486,22 @@ namespace CNTK
         return dst;
     }
 
+    NDArrayView* Serializer::CreateFromRawData(uint64 offset, DataType dataType, StorageFormat storageFormat, const NDShape& shape)
+    {
+        if (m_rawData == nullptr)
+            RuntimeError("NDArrayView values stored outside of the protobuf can only be read from a memory-mappable model file.");
+
+        if (storageFormat != StorageFormat::Dense)
+            RuntimeError("Only dense NDArrayViews can be read from a memory-mappable model file.");
+
+        auto byteSize = shape.TotalSize() * DataTypeSize(dataType);
+        if (offset > m_rawDataSize || byteSize > m_rawDataSize - offset)
+            RuntimeError("The values of an NDArrayView exceed the data section of the memory-mappable model file.");
+
+        // The view does not own the mapped memory, see LoadMemoryMappedModel.
+        return new NDArrayView(dataType, shape, m_rawData + offset, byteSize, DeviceDescriptor::CPUDevice());
+    }
+
     proto::Vector* Serializer::CreateProto(const std::vector<DictionaryValue>& src, Arena* arena)
     {
         proto::Vector* dst = (arena != nullptr) ? 
@@ -651,6 +704,98 @@ namespace CNTK
 #endif
     }
 
+    static const char* RawDataBuffer(const NDArrayView& src)
+    {
+        if (src.GetDataType() == DataType::Float)
+            return reinterpret_cast<const char*>(src.DataBuffer<float>());
+        else if (src.GetDataType() == DataType::Double)
+            return reinterpret_cast<const char*>(src.DataBuffer<double>());
+        LogicError("Unsupported DataType %s", DataTypeName(src.GetDataType()));
+    }
+
+    void Serializer::WriteMemoryMappable(const std::wstring& filename)
+    {
+        // Place the values of each NDArrayView in the data section and record their offsets in the metadata.
+        std::vector<size_t> offsets;
+        offsets.reserve(m_arrayViews.size());
+        size_t dataSectionSize = 0;
+        for (auto& pair : m_arrayViews)
+        {
+            const auto& src = *(pair.first);
+            offsets.push_back(dataSectionSize);
+            pair.second->set_raw_data_offset(dataSectionSize);
+            dataSectionSize = AlignRawData(dataSectionSize + src.Shape().TotalSize() * DataTypeSize(src.GetDataType()));
+        }
+
+        auto protoSize = m_proto->ByteSizeLong();
+        if (protoSize > std::numeric_limits<uint32>::max())
+            RuntimeError("The model metadata (%zu bytes) is too large for a memory-mappable model file.", protoSize);
+
+        auto fd = GetFileDescriptor(filename, false);
+        {
+            io::FileOutputStream stream(fd);
+            io::CodedOutputStream output(&stream);
+            output.WriteLittleEndian32(MEMORY_MAPPABLE_MAGIC_NUMBER);
+            output.WriteLittleEndian32((uint32)protoSize);
+            m_proto->SerializeToCodedStream(&output);
+
+            // The values are stored in the native byte order, so that they can be used in place. This is
+            // little-endian on all supported platforms, same as the values written by WriteNDArrayViewData.
+            static const char padding[RAW_DATA_ALIGNMENT] = {};
+            size_t dataSectionStart = AlignRawData(2 * sizeof(uint32) + protoSize);
+            size_t position = 2 * sizeof(uint32) + protoSize;
+            for (size_t i = 0; i < m_arrayViews.size(); i++)
+            {
+                const auto& src = *(m_arrayViews[i].first);
+                output.WriteRaw(padding, (int)(dataSectionStart + offsets[i] - position));
+                position = dataSectionStart + offsets[i];
+
+                auto buffer = RawDataBuffer(src);
+                auto byteSize = src.Shape().TotalSize() * DataTypeSize(src.GetDataType());
+                for (size_t written = 0; written < byteSize;)
+                {
+                    auto chunkSize = std::min<size_t>(byteSize - written, INT_MAX);
+                    output.WriteRaw(buffer + written, (int)chunkSize);
+                    written += chunkSize;
+                }
+                position += byteSize;
+            }
+
+            if (output.HadError())
+                RuntimeError("Failed to write the memory-mappable model file '%ls'.", filename.c_str());
+        }
+#ifdef _MSC_VER
+        _close(fd);
+#else
+        close(fd);
+#endif
+    }
+
+    bool Serializer::ReadMemoryMapped(char* data, size_t size, Dictionary& dict)
+    {
+        uint32 prefix = 0, protoSize = 0;
+        if (size < 2 * sizeof(uint32))
+            return false;
+
+        io::CodedInputStream::ReadLittleEndian32FromArray(reinterpret_cast<const uint8*>(data), &prefix);
+        io::CodedInputStream::ReadLittleEndian32FromArray(reinterpret_cast<const uint8*>(data) + sizeof(uint32), &protoSize);
+        if (prefix != MEMORY_MAPPABLE_MAGIC_NUMBER || protoSize > size - 2 * sizeof(uint32))
+            return false;
+
+        auto dataSectionStart = std::min(AlignRawData(2 * sizeof(uint32) + protoSize), size);
+        m_rawData = data + dataSectionStart;
+        m_rawDataSize = size - dataSectionStart;
+
+        m_proto = Arena::CreateMessage<proto::Dictionary>(&m_arena);
+        io::CodedInputStream input(reinterpret_cast<const uint8*>(data) + 2 * sizeof(uint32), (int)protoSize);
+        input.SetTotalBytesLimit(INT_MAX, INT_MAX);
+        if (!m_proto->ParseFromCodedStream(&input) || !input.ConsumedEntireMessage())
+            return false;
+
+        Copy(*dynamic_cast<proto::Dictionary*>(m_proto), dict);
+        return true;
+    }
+
     bool ParseMessage(io::ZeroCopyInputStream& input, Message& msg)
     {
         uint32 prefix = 0, limit = INT_MAX;;
@@ -750,6 +895,108 @@ namespace CNTK
         return false;
     }
 
+    // Mappings of memory-mapped model files. They are kept for the lifetime of the process, since the NDArrayViews
+    // wrapping their data do not own it and can be aliased by any number of loaded Functions. The mappings are
+    // private (copy-on-write): pages that are never written to stay backed by the file and cost no private memory,
+    // writes (e.g. training a loaded model) go to private copies of the touched pages and never reach the file.
+    struct MappedModelFile
+    {
+        const char* data;
+        size_t size;
+    };
+
+    static std::mutex s_mappedModelFilesMutex;
+    static std::vector<MappedModelFile> s_mappedModelFiles;
+
+    static char* MapModelFile(const std::wstring& filePath, size_t& size)
+    {
+        char* data = nullptr;
+#ifdef _WIN32
+        auto file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            RuntimeError("Cannot open file '%ls' for memory mapping (error %u).", filePath.c_str(), (unsigned int)GetLastError());
+
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            size = (size_t)fileSize.QuadPart;
+            auto mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+            if (mapping != nullptr)
+            {
+                data = (char*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+                CloseHandle(mapping); // the view keeps the mapping alive
+            }
+        }
+        auto error = GetLastError();
+        CloseHandle(file);
+        if (data == nullptr)
+            RuntimeError("Cannot memory map file '%ls' (error %u).", filePath.c_str(), (unsigned int)error);
+#else
+        auto fd = GetFileDescriptor(filePath, true);
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            size = (size_t)info.st_size;
+            void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+                data = (char*)mapped;
+        }
+        auto error = errno;
+        close(fd); // the mapping stays valid
+        if (data == nullptr)
+            RuntimeError("Cannot memory map file '%ls': %s.", filePath.c_str(), strerror(error));
+#endif
+        return data;
+    }
+
+    void SaveMemoryMappableModel(const Dictionary& model, const std::wstring& filePath)
+    {
+        Serializer(model).WriteMemoryMappable(filePath);
+    }
+
+    bool IsMemoryMappableModel(const std::wstring& filePath)
+    {
+        auto stream = GetFstream(filePath, true);
+        uint8 prefix[sizeof(uint32)];
+        stream->read(reinterpret_cast<char*>(prefix), sizeof(prefix));
+        if (stream->gcount() != sizeof(prefix))
+            return false;
+
+        uint32 magicNumber = 0;
+        io::CodedInputStream::ReadLittleEndian32FromArray(prefix, &magicNumber);
+        return magicNumber == MEMORY_MAPPABLE_MAGIC_NUMBER;
+    }
+
+    Dictionary LoadMemoryMappedModel(const std::wstring& filePath)
+    {
+        size_t size = 0;
+        char* data = MapModelFile(filePath, size);
+        {
+            std::lock_guard<std::mutex> lock(s_mappedModelFilesMutex);
+            s_mappedModelFiles.push_back({ data, size });
+        }
+
+        Dictionary model;
+        if (!Serializer().ReadMemoryMapped(data, size, model))
+            RuntimeError("Failed to parse memory-mappable model file (%ls).", filePath.c_str());
+        return model;
+    }
+
+    bool IsMemoryMappedModelData(const NDArrayView& view)
+    {
+        if (view.GetStorageFormat() != StorageFormat::Dense || view.Device().Type() != DeviceKind::CPU)
+            return false;
+
+        auto buffer = RawDataBuffer(view);
+        std::lock_guard<std::mutex> lock(s_mappedModelFilesMutex);
+        for (const auto& file : s_mappedModelFiles)
+        {
+            if (buffer >= file.data && buffer < file.data + file.size)
+                return true;
+        }
+        return false;
+    }
+
     std::ostream& operator<<(std::ostream& stream, const Dictionary& dictionary)
     {
         return Serializer(dictionary).Write(stream);
@@ -0,0 +1,183 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include "SparsifiedDistributedCommunicator.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <numeric>
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace CNTK
+{
+    DistributedCommunicatorPtr SparsifiedMPICommunicator(double density, size_t packThresholdSizeInBytes)
+    {
+        return std::make_shared<SparsifiedMPICommunicatorImpl>(density, packThresholdSizeInBytes);
+    }
+
+    SparsifiedMPICommunicatorImpl::SparsifiedMPICommunicatorImpl(double density, size_t packThresholdSizeInBytes)
+        : MPICommunicatorImpl(packThresholdSizeInBytes), m_density(density)
+    {
+        if (!(density > 0 && density <= 1))
+            InvalidArgument("SparsifiedMPICommunicator: density (%g) must be in (0, 1].", density);
+    }
+
+    size_t SparsifiedMPICommunicatorImpl::NumSelected(size_t numElements) const
+    {
+        return std::max<size_t>(1, (size_t)std::ceil(m_density * numElements));
+    }
+
+    // The decision only depends on the type and shape of the value, so all workers take the same one.
+    bool SparsifiedMPICommunicatorImpl::ShouldSparsify(const NDArrayViewPtr& value) const
+    {
+        if (value->GetStorageFormat() != StorageFormat::Dense)
+            return false;
+
+        auto dataType = value->GetDataType();
+        if (dataType != DataType::Float && dataType != DataType::Double)
+            return false;
+
+        size_t numElements = value->Shape().TotalSize();
+        if (numElements > INT_MAX)
+            return false;
+
+        size_t elementSize = DataTypeSize(dataType);
+        return NumSelected(numElements) * (sizeof(int) + elementSize) < numElements * elementSize;
+    }
+
+    void SparsifiedMPICommunicatorImpl::AggregateInPlace(
+        const std::vector<NDArrayViewPtr>& values,
+        const std::unordered_set<DistributedWorkerDescriptor>& sendToWorkers)
+    {
+        CheckWorkers(sendToWorkers);
+
+        if (m_mpi->NumNodesInUse() == 1) // No need to aggregate anything.
+            return;
+
+        std::vector<NDArrayViewPtr> denseValues;
+        std::vector<NDArrayViewPtr> sparsifiedFloatValues;
+        std::vector<NDArrayViewPtr> sparsifiedDoubleValues;
+        for (const auto& value : values)
+        {
+            if (!ShouldSparsify(value))
+                denseValues.push_back(value);
+            else if (value->GetDataType() == DataType::Float)
+                sparsifiedFloatValues.push_back(value);
+            else
+                sparsifiedDoubleValues.push_back(value);
+        }
+
+        if (!denseValues.empty())
+            MPICommunicatorImpl::AggregateInPlace(denseValues, sendToWorkers);
+
+        SparseAggregateInPlace<float>(sparsifiedFloatValues, m_residuesFloat);
+        SparseAggregateInPlace<double>(sparsifiedDoubleValues, m_residuesDouble);
+    }
+
+    void SparsifiedMPICommunicatorImpl::Aggregate(
+        const std::vector<NDArrayViewPtr>& inValues,
+        std::vector<NDArrayViewPtr>& outValues,
+        const std::unordered_set<DistributedWorkerDescriptor>& sendToWorkers)
+    {
+        if (outValues.empty())
+        {
+            for (const auto& inValue : inValues)
+                outValues.push_back(inValue->DeepClone());
+        }
+        else if (outValues.size() != inValues.size())
+        {
+            NOT_IMPLEMENTED;
+        }
+        else
+        {
+            for (size_t i = 0; i < inValues.size(); i++)
+                outValues[i]->CopyFrom(*inValues[i]);
+        }
+
+        AggregateInPlace(outValues, sendToWorkers);
+    }
+
+    template <typename ElemType>
+    void SparsifiedMPICommunicatorImpl::SparseAggregateInPlace(const std::vector<NDArrayViewPtr>& values, std::vector<std::vector<ElemType>>& residues)
+    {
+        if (values.empty())
+            return;
+
+        residues.resize(values.size());
+
+        size_t numSelectedTotal = 0;
+        for (const auto& value : values)
+            numSelectedTotal += NumSelected(value->Shape().TotalSize());
+
+        size_t numWorkers = m_mpi->NumNodesInUse();
+        m_sendIndices.resize(numSelectedTotal);
+        m_receivedIndices.resize(numSelectedTotal * numWorkers);
+        m_sendValues.resize(numSelectedTotal * sizeof(ElemType));
+        m_receivedValues.resize(numSelectedTotal * numWorkers * sizeof(ElemType));
+        auto sendValues = reinterpret_cast<ElemType*>(m_sendValues.data());
+        auto receivedValues = reinterpret_cast<ElemType*>(m_receivedValues.data());
+
+        // Values on a GPU are processed in a host copy.
+        std::vector<NDArrayViewPtr> hostValues(values.size());
+        for (size_t i = 0; i < values.size(); i++)
+            hostValues[i] = (values[i]->Device().Type() == DeviceKind::CPU) ? values[i] : values[i]->DeepClone(DeviceDescriptor::CPUDevice());
+
+        // Select the largest entries of value + residue; the rest stays in the residue.
+        std::vector<int> order;
+        size_t offset = 0;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            size_t numElements = values[i]->Shape().TotalSize();
+            size_t numSelected = NumSelected(numElements);
+            auto& residue = residues[i];
+            if (residue.size() != numElements)
+                residue.assign(numElements, 0);
+
+            const ElemType* data = hostValues[i]->DataBuffer<ElemType>();
+            for (size_t j = 0; j < numElements; j++)
+                residue[j] += data[j];
+
+            order.resize(numElements);
+            std::iota(order.begin(), order.end(), 0);
+            std::nth_element(order.begin(), order.begin() + (numSelected - 1), order.end(),
+                             [&residue](int a, int b) { return std::abs(residue[a]) > std::abs(residue[b]); });
+
+            for (size_t j = 0; j < numSelected; j++)
+            {
+                int index = order[j];
+                m_sendIndices[offset + j] = index;
+                sendValues[offset + j] = residue[index];
+                residue[index] = 0;
+            }
+            offset += numSelected;
+        }
+
+        m_mpi->AllGather(m_sendIndices.data(), numSelectedTotal, m_receivedIndices.data(), numSelectedTotal);
+        m_mpi->AllGather(sendValues, numSelectedTotal, receivedValues, numSelectedTotal);
+
+        // Sum the pairs of all workers into the dense result.
+        offset = 0;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            size_t numElements = values[i]->Shape().TotalSize();
+            size_t numSelected = NumSelected(numElements);
+
+            ElemType* data = hostValues[i]->WritableDataBuffer<ElemType>();
+            std::fill(data, data + numElements, (ElemType)0);
+            for (size_t worker = 0; worker < numWorkers; worker++)
+            {
+                size_t begin = worker * numSelectedTotal + offset;
+                for (size_t j = begin; j < begin + numSelected; j++)
+                    data[m_receivedIndices[j]] += receivedValues[j];
+            }
+            offset += numSelected;
+
+            if (hostValues[i] != values[i])
+                values[i]->CopyFrom(*hostValues[i]);
+        }
+    }
+}
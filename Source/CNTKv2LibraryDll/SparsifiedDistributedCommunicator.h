@@ -0,0 +1,57 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include "CNTKLibrary.h"
+#include "DistributedCommunicator.h"
+
+namespace CNTK
+{
+    ///
+    /// MPI communicator that aggregates dense values by exchanging only their top-k entries.
+    ///
+    /// For each sparsified value, the current value plus the residue left over from the previous aggregation is
+    /// accumulated, the k = ceil(density * n) entries largest in magnitude are sent as (index, value) pairs to all workers
+    /// with an all-gather, and the remaining entries become the new residue (error feedback). The received pairs of all
+    /// workers are summed into the dense result. Residues are kept on the host, one per sparsified value, in the order
+    /// in which the values are passed; a residue is reset if the shape of its value changes.
+    ///
+    /// Values that are not dense float or double, or too small for the pairs to be smaller than the dense value,
+    /// are aggregated densely by MPICommunicatorImpl.
+    ///
+    class SparsifiedMPICommunicatorImpl final : public MPICommunicatorImpl
+    {
+    public:
+        SparsifiedMPICommunicatorImpl(double density, size_t packThresholdSizeInBytes);
+
+        virtual void AggregateInPlace(
+            const std::vector<NDArrayViewPtr>& values,
+            const std::unordered_set<DistributedWorkerDescriptor>& sendToWorkers) override;
+
+        virtual void Aggregate(
+            const std::vector<NDArrayViewPtr>& inValues,
+            std::vector<NDArrayViewPtr>& outValues,
+            const std::unordered_set<DistributedWorkerDescriptor>& sendToWorkers) override;
+
+    private:
+        size_t NumSelected(size_t numElements) const;
+        bool ShouldSparsify(const NDArrayViewPtr& value) const;
+
+        template <typename ElemType>
+        void SparseAggregateInPlace(const std::vector<NDArrayViewPtr>& values, std::vector<std::vector<ElemType>>& residues);
+
+        const double m_density;
+
+        std::vector<std::vector<float>> m_residuesFloat;
+        std::vector<std::vector<double>> m_residuesDouble;
+
+        // send and receive buffers, reused across aggregations
+        std::vector<int> m_sendIndices;
+        std::vector<int> m_receivedIndices;
+        std::vector<char> m_sendValues;
+        std::vector<char> m_receivedValues;
+    };
+}
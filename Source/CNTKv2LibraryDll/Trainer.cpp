@@ -10,6 +10,7 @@
 #include "PerformanceProfiler.h"
 #include "CompositeFunction.h"
 #include "Serialization.h"
+#include "AsyncFileWriter.h"
 
 namespace
 {
@@ -360,11 +361,35 @@ namespace CNTK
     }
 
     void Trainer::SaveCheckpoint(const std::wstring& modelFilePath, Dictionary externalState)
+    {
+        SaveCheckpointImpl(modelFilePath, externalState, /*inBackground=*/false);
+    }
+
+    void Trainer::SaveCheckpointAsync(const std::wstring& modelFilePath, Dictionary externalState, size_t maxPendingCheckpoints)
+    {
+        // Created on all workers, so that all of them know to wait for the main one before reading a checkpoint.
+        if (!m_checkpointWriter)
+            m_checkpointWriter = std::make_shared<Microsoft::MSR::CNTK::AsyncFileWriter>(maxPendingCheckpoints);
+
+        SaveCheckpointImpl(modelFilePath, externalState, /*inBackground=*/true);
+    }
+
+    void Trainer::WaitForPendingCheckpoints()
+    {
+        if (!m_checkpointWriter)
+            return;
+
+        m_checkpointWriter->Wait();
+        if (m_distributed)
+            MPICommunicator()->Barrier();
+    }
+
+    void Trainer::SaveCheckpointImpl(const std::wstring& modelFilePath, const Dictionary& externalState, bool inBackground)
     {
         auto learnersState = m_parameterLearners->CreateCheckpoint();
 
         if (!m_distributed)
-            return Save(modelFilePath, learnersState, externalState);
+            return Save(modelFilePath, learnersState, externalState, Dictionary(), inBackground);
 
         auto compositeFunction = dynamic_cast<CompositeFunction*>(m_combinedTrainingFunction.get());
 
@@ -386,14 +411,15 @@ namespace CNTK
         }
 
         if (communicator->CurrentWorker().IsMain())
-            Save(modelFilePath, learnersState, externalState, aggregatedState);
+            Save(modelFilePath, learnersState, externalState, aggregatedState, inBackground);
 
         // all workers need to sync up after saving model to avoid read-after-write hazard
         // i.e. one worker is in the middle of write while another tries to read
+        // (for a checkpoint written in the background, readers call WaitForPendingCheckpoints first)
         communicator->Barrier();
     }
 
-    void Trainer::Save(const std::wstring& modelFilePath, const std::vector<DictionaryValue>& learnerState, const Dictionary& externalState, const Dictionary& distributedState)
+    void Trainer::Save(const std::wstring& modelFilePath, const std::vector<DictionaryValue>& learnerState, const Dictionary& externalState, const Dictionary& distributedState, bool inBackground)
     {
         std::wstring tempModelFile = modelFilePath + L".tmp";
         Dictionary state;
@@ -402,6 +428,26 @@ namespace CNTK
         state[externalStatePropertyName] = externalState;
         state[distributedStatePropertyName] = distributedState;
 
+        if (inBackground)
+        {
+            // Both dictionaries hold copies of the parameter and learner values in host memory,
+            // so they can be serialized while training continues.
+            auto model = std::make_shared<Dictionary>(m_combinedTrainingFunction->Serialize());
+            auto trainerState = std::make_shared<Dictionary>(std::move(state));
+
+            m_checkpointWriter->Write(modelFilePath, [model](const std::wstring& tempFile)
+            {
+                auto stream = GetFstream(tempFile, false);
+                *stream << *model;
+                stream->flush();
+            });
+            m_checkpointWriter->Write(GetTrainerStateCheckpointFilePath(modelFilePath), [trainerState](const std::wstring& tempFile)
+            {
+                trainerState->Save(tempFile);
+            });
+            return;
+        }
+
         m_combinedTrainingFunction->Save(tempModelFile);
         std::wstring trainerStateCheckpointFilePath = GetTrainerStateCheckpointFilePath(modelFilePath);
         std::wstring tempCheckpointFile = trainerStateCheckpointFilePath + L".tmp";
@@ -418,6 +464,9 @@ namespace CNTK
 
     Dictionary Trainer::RestoreFromCheckpoint(const std::wstring& modelFilePath)
     {
+        // The checkpoint may still be written in the background.
+        WaitForPendingCheckpoints();
+
         // Restore the model's parameters
         m_combinedTrainingFunction->Restore(modelFilePath);
 
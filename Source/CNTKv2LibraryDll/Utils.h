@@ -564,6 +564,12 @@ namespace CNTK
     std::shared_ptr<std::fstream> GetFstream(const std::wstring& filePath, bool readOnly);
     int GetFileDescriptor(const std::wstring& filePath, bool readOnly);
 
+    // Memory-mappable model files (ModelFormat::CNTKv2MemoryMappable), see Serialization.cpp.
+    void SaveMemoryMappableModel(const Dictionary& model, const std::wstring& filePath);
+    bool IsMemoryMappableModel(const std::wstring& filePath);
+    Dictionary LoadMemoryMappedModel(const std::wstring& filePath);
+    bool IsMemoryMappedModelData(const NDArrayView& view);
+
     std::string ToString(const std::wstring& wstring);
     std::wstring ToWString(const std::string& string);
 
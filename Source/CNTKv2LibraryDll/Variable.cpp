@@ -525,7 +525,9 @@ namespace CNTK
 
             // TODO: this copying here is redundant, value should be moved from the dictionary to the variable.
             // Also, the correct device should be used upfront when deserializing NDArrayView.
-            Variable var(shape, kind, dataType, value.DeepClone(device, value.IsReadOnly()), needsGradient, dynamicAxis, isSparse, name, uid);
+            // Values of a memory-mapped model file are used in place when they are needed on the CPU.
+            auto valueOnDevice = (device == value.Device() && IsMemoryMappedModelData(value)) ? value.Alias(value.IsReadOnly()) : value.DeepClone(device, value.IsReadOnly());
+            Variable var(shape, kind, dataType, valueOnDevice, needsGradient, dynamicAxis, isSparse, name, uid);
             if (var.IsParameter())
                 return Parameter(var);
             else
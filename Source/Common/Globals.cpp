@@ -15,4 +15,7 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 
     std::atomic<bool> Globals::m_enableShareNodeValueMatrices(true);
     std::atomic<bool> Globals::m_optimizeGradientAccumulation(true);
+    std::atomic<bool> Globals::m_fuseElementwiseChains(false);
+    std::atomic<bool> Globals::m_useMatrixPoolArena(false);
+    std::atomic<bool> Globals::m_batchRecurrentGemms(false);
 }}}
@@ -0,0 +1,157 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "fileutil.h"
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// -----------------------------------------------------------------------
+// AsyncFileWriter -- writes files (e.g. models and checkpoints) on a background thread.
+// Each file is written to '<path>.pending', flushed to disk and then atomically renamed to '<path>',
+// so that readers never see a partially written file. Writes and other queued actions run one at a time
+// in the order they were queued. The caller is responsible for handing over a consistent snapshot of the
+// data to write; at most maxPendingWrites writes can be in flight, which bounds the memory held by snapshots.
+// -----------------------------------------------------------------------
+
+class AsyncFileWriter
+{
+public:
+    explicit AsyncFileWriter(size_t maxPendingWrites = 1)
+        : m_maxPendingWrites(std::max<size_t>(maxPendingWrites, 1)), m_numPending(0), m_stop(false)
+    {
+        m_thread = std::thread([this]() { Run(); });
+    }
+
+    // Finishes all queued writes. Errors are not reported anymore at this point.
+    ~AsyncFileWriter()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_queueChanged.notify_all();
+        m_thread.join();
+    }
+
+    // Queues writing of a file. 'write' is called on the writer thread with the temporary path to write to.
+    // Blocks while maxPendingWrites writes are in flight. Rethrows the error of an earlier failed write.
+    void Write(const std::wstring& path, std::function<void(const std::wstring& tempPath)> write)
+    {
+        Enqueue([path, write]()
+        {
+            std::wstring tempPath = path + L".pending";
+            write(tempPath);
+            SyncToDisk(tempPath);
+            _wunlink(path.c_str());
+            renameOrDie(tempPath, path);
+        });
+    }
+
+    // Queues an action that has to be ordered with the writes, e.g. deleting a file superseded by a write.
+    void Enqueue(std::function<void()> action)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queueChanged.wait(lock, [this]() { return m_numPending < m_maxPendingWrites; });
+        RethrowError();
+        m_queue.push_back(std::move(action));
+        m_numPending++;
+        m_queueChanged.notify_all();
+    }
+
+    // Blocks until a new write can be queued without waiting, i.e. at most maxPendingWrites - 1 writes are in flight.
+    // Used to reuse snapshot buffers that are not referenced by any pending write anymore.
+    void WaitForAvailableSlot()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queueChanged.wait(lock, [this]() { return m_numPending < m_maxPendingWrites; });
+        RethrowError();
+    }
+
+    // Blocks until all queued writes have finished. Rethrows the error of a failed write.
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_queueChanged.wait(lock, [this]() { return m_numPending == 0; });
+        RethrowError();
+    }
+
+    // Flushes the written content of a file from the OS cache to disk.
+    static void SyncToDisk(const std::wstring& path)
+    {
+        FILE* f = fopenOrDie(path, L"r+b"); // flushing requires write access on Windows
+        fsyncOrDie(f);
+        fcloseOrDie(f);
+    }
+
+private:
+    void Run()
+    {
+        for (;;)
+        {
+            std::function<void()> action;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_queueChanged.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty())
+                    return;
+                action = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            std::exception_ptr error;
+            try
+            {
+                action();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            // Release the snapshot held by the action before the slot becomes available.
+            action = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (error && !m_error)
+                    m_error = error;
+                m_numPending--;
+            }
+            m_queueChanged.notify_all();
+        }
+    }
+
+    // Expects m_mutex to be held.
+    void RethrowError()
+    {
+        if (m_error)
+        {
+            auto error = m_error;
+            m_error = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    const size_t m_maxPendingWrites;
+    size_t m_numPending; // queued or running
+    bool m_stop;
+    std::deque<std::function<void()>> m_queue;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::thread m_thread;
+
+    DISABLE_COPY_AND_MOVE(AsyncFileWriter);
+};
+
+}}}
@@ -26,6 +26,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <future>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -362,4 +363,42 @@ void EVAL_API GetEvalExtended(IEvaluateModelExtended<ElemType>** peval);
 extern "C" EVAL_API void GetEvalExtendedF(IEvaluateModelExtended<float>** peval);
 extern "C" EVAL_API void GetEvalExtendedD(IEvaluateModelExtended<double>** peval);
 
+// ------------------------------------------------------------------------
+// Batched interface
+// ------------------------------------------------------------------------
+
+//
+// Thread-safe front-end for serving many concurrent requests of one sequence each.
+// Requests are queued and coalesced into minibatches (one parallel sequence per request), which are
+// evaluated by a number of worker contexts. All workers share one set of model parameters; each has
+// its own activations. In addition to the settings of IEvaluateModelBase::Init(), the config takes
+//   numWorkers         - number of worker contexts (default 1)
+//   maxBatchSize       - maximum number of requests (sequences) in one minibatch (default 32)
+//   maxBatchLatencyMs  - maximum time a request waits for more requests to join its minibatch (default 2)
+//
+template <typename ElemType>
+class IEvaluateModelBatched : public IEvaluateModelBase<ElemType>
+{
+public:
+    //
+    // Same as IEvaluateModelExtended.
+    //
+    virtual VariableSchema GetOutputSchema() const = 0;
+    virtual void StartForwardEvaluation(const std::vector<std::wstring>& outputs) = 0;
+    virtual VariableSchema GetInputSchema() const = 0;
+
+    //
+    // ForwardPassAsync - Queue the evaluation of one sequence, given as one buffer for every input of
+    // GetInputSchema(). Every request starts with a reset RNN state. The future receives one buffer
+    // per output, holding the output sequence that belongs to the request, or the error of the request.
+    // This method can be called concurrently from any number of threads.
+    //
+    virtual std::future<Values<ElemType>> ForwardPassAsync(Values<ElemType>&& inputs) = 0;
+};
+
+template <typename ElemType>
+void EVAL_API GetEvalBatched(IEvaluateModelBatched<ElemType>** peval);
+extern "C" EVAL_API void GetEvalBatchedF(IEvaluateModelBatched<float>** peval);
+extern "C" EVAL_API void GetEvalBatchedD(IEvaluateModelBatched<double>** peval);
+
 } } }
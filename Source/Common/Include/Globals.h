@@ -28,11 +28,26 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         static void SetShareNodeValueMatrices(bool enable) { m_enableShareNodeValueMatrices = enable; }
         static bool ShouldEnableShareNodeValueMatrices() { return m_enableShareNodeValueMatrices; }
 
+        // fuse chains of elementwise nodes into single loops for forward-only (inference) CPU evaluation
+        static void SetElementwiseChainFusion(bool enable) { m_fuseElementwiseChains = enable; }
+        static bool ShouldFuseElementwiseChains() { return m_fuseElementwiseChains; }
+
+        // place node values and gradients of exactly known size in one per-device arena, planned once the minibatch size is known
+        static void SetMatrixPoolArena(bool enable) { m_useMatrixPoolArena = enable; }
+        static bool ShouldUseMatrixPoolArena() { return m_useMatrixPoolArena; }
+
+        // compute the per-time-step GEMMs of a recurrent loop that share their input as one GEMM with stacked weights
+        static void SetRecurrentGemmBatching(bool enable) { m_batchRecurrentGemms = enable; }
+        static bool ShouldBatchRecurrentGemms() { return m_batchRecurrentGemms; }
+
     private:
         static std::atomic<bool> m_forceDeterministicAlgorithms;
         // The global flag to enable matrices values in forward and backward prop
         static std::atomic<bool> m_enableShareNodeValueMatrices;
         static std::atomic<bool> m_forceConstantRandomSeed;
         static std::atomic<bool> m_optimizeGradientAccumulation;
+        static std::atomic<bool> m_fuseElementwiseChains;
+        static std::atomic<bool> m_useMatrixPoolArena;
+        static std::atomic<bool> m_batchRecurrentGemms;
     };
 }}}
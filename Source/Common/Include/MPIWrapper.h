@@ -101,6 +101,7 @@ public:
     virtual int Wait(MPI_Request* request, MPI_Status* status) = 0;
     virtual int Waitany(int count, MPI_Request array_of_requests[], int* index, MPI_Status* status) = 0;
     virtual int Waitall(int count, MPI_Request array_of_requests[], MPI_Status array_of_statuses[]) = 0;
+    virtual int Test(MPI_Request* request, int* flag, MPI_Status* status) = 0;
     virtual int Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, /*MPI_Comm comm,*/ MPI_Request* request) = 0;
     virtual int Recv(void* buf, int count, MPI_Datatype datatype, int source, int tag, /*MPI_Comm comm,*/ MPI_Status* status) = 0;
     virtual int Irecv(void* buf, int count, MPI_Datatype datatype, int source, int tag, /*MPI_Comm comm,*/ MPI_Request* request) = 0;
@@ -142,6 +143,14 @@ public:
     virtual void AllReduceAsync(double* sendData, double* receiveData, size_t numElements, MPI_Request* request, MPI_Op op = MPI_SUM) const = 0;
     virtual void AllReduceAsync(float* sendData, float* receiveData, size_t numElements, MPI_Request* request, MPI_Op op = MPI_SUM) const = 0;
 
+    // Hierarchical all-reduce (sum, in place) of host memory, for jobs with several ranks per host. The ranks of a host
+    // (grouped by CurrentNodeName(), split into groups of at most 'maxRanksPerGroup' ranks if nonzero, e.g. one per socket)
+    // reduce-scatter through shared memory, one leader per group runs a ring all-reduce with the other leaders, and the
+    // result is broadcast back through shared memory. Large buffers are pipelined through these stages in chunks.
+    // Must be called by all ranks in use, with the same 'maxRanksPerGroup'.
+    virtual void AllReduceHierarchical(float* data, size_t numElements, size_t maxRanksPerGroup = 0) const = 0;
+    virtual void AllReduceHierarchical(double* data, size_t numElements, size_t maxRanksPerGroup = 0) const = 0;
+
     virtual void Bcast(size_t* sendData, size_t numElements, size_t srcRank) = 0;
     virtual void Bcast(double* sendData, size_t numElements, size_t srcRank) = 0;
     virtual void Bcast(float* sendData, size_t numElements, size_t srcRank) = 0;
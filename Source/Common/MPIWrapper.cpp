@@ -5,6 +5,7 @@
 #include "Include/Basics.h"
 #include "Include/MPIWrapper.h"
 #include "Include/EnvironmentUtil.h"
+#include <map>
 
 #if HAS_MPI
 #pragma comment(lib, "msmpi.lib")
@@ -61,6 +62,50 @@ private:
 
     void RequestNodes(const char *msg, size_t requestednodes = SIZE_MAX /*default: all*/);
 
+    // Communicators and shared memory of AllReduceHierarchical(), created on first use.
+    // The shared memory of a group holds two sets of per-rank input slots and three result buffers of one chunk each,
+    // such that chunk c can be copied in while chunk c-1 is reduce-scattered, chunk c-2 is all-reduced across
+    // the group leaders and chunk c-3 is copied out.
+    struct HierarchicalGroups
+    {
+        static const size_t ChunkSizeInBytes = 1024 * 1024;
+        static const size_t NumInputSlotSets = 2;
+        static const size_t NumResultBuffers = 3;
+
+        size_t maxRanksPerGroup;
+        MPI_Comm localComm;  // ranks of this group
+        int localRank;
+        int localSize;
+        int maxLocalSize;    // over all groups
+        MPI_Comm leaderComm; // rank 0 of each group; MPI_COMM_NULL on the other ranks
+        int leaderRank;
+        int numLeaders;
+        MPI_Win window;
+        char* sharedMemory;
+        std::vector<char> ringBuffer;
+
+        char* InputSlot(size_t chunk, int rank) const
+        {
+            return sharedMemory + ((chunk % NumInputSlotSets) * localSize + rank) * ChunkSizeInBytes;
+        }
+
+        char* ResultBuffer(size_t chunk) const
+        {
+            return sharedMemory + (NumInputSlotSets * localSize + (chunk % NumResultBuffers)) * ChunkSizeInBytes;
+        }
+    };
+    mutable std::unique_ptr<HierarchicalGroups> m_hierarchicalGroups;
+
+    void CreateHierarchicalGroups(size_t maxRanksPerGroup) const;
+    void FreeHierarchicalGroups() const;
+    void SyncHierarchicalGroup() const;
+
+    template <class ElemType>
+    void AllReduceHierarchicalImpl(ElemType* data, size_t numElements, size_t maxRanksPerGroup) const;
+
+    template <class ElemType>
+    void RingAllReduce(ElemType* data, size_t numElements) const;
+
 public:
 
     size_t NumNodesInUse() const;
@@ -83,6 +128,7 @@ public:
     virtual int Wait(MPI_Request* request, MPI_Status* status);
     virtual int Waitany(int count, MPI_Request array_of_requests[], int* index, MPI_Status* status);
     virtual int Waitall(int count, MPI_Request array_of_requests[], MPI_Status array_of_statuses[]);
+    virtual int Test(MPI_Request* request, int* flag, MPI_Status* status);
     virtual int Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, /*MPI_Comm comm,*/ MPI_Request* request);
     virtual int Recv(void* buf, int count, MPI_Datatype datatype, int source, int tag, /*MPI_Comm comm,*/ MPI_Status* status);
     virtual int Irecv(void* buf, int count, MPI_Datatype datatype, int source, int tag, /*MPI_Comm comm,*/ MPI_Request* request);
@@ -117,6 +163,9 @@ public:
     virtual void AllReduceAsync(double* sendData, double* receiveData, size_t numElements, MPI_Request* request, MPI_Op op = MPI_SUM) const;
     virtual void AllReduceAsync(float* sendData, float* receiveData, size_t numElements, MPI_Request* request, MPI_Op op = MPI_SUM) const;
 
+    virtual void AllReduceHierarchical(float* data, size_t numElements, size_t maxRanksPerGroup = 0) const;
+    virtual void AllReduceHierarchical(double* data, size_t numElements, size_t maxRanksPerGroup = 0) const;
+
     virtual void Bcast(size_t* sendData, size_t numElements, size_t srcRank);
     virtual void Bcast(double* sendData, size_t numElements, size_t srcRank);
     virtual void Bcast(float* sendData, size_t numElements, size_t srcRank);
@@ -180,6 +229,7 @@ public:
     virtual int Wait(MPI_Request* request, MPI_Status* status);
     virtual int Waitany(int count, MPI_Request array_of_requests[], int* index, MPI_Status* status);
     virtual int Waitall(int count, MPI_Request array_of_requests[], MPI_Status array_of_statuses[]);
+    virtual int Test(MPI_Request* request, int* flag, MPI_Status* status);
     virtual int Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, /*MPI_Comm comm,*/ MPI_Request* request);
     virtual int Recv(void* buf, int count, MPI_Datatype datatype, int source, int tag, /*MPI_Comm comm,*/ MPI_Status* status);
     virtual int Irecv(void* buf, int count, MPI_Datatype datatype, int source, int tag, /*MPI_Comm comm,*/ MPI_Request* request);
@@ -214,6 +264,9 @@ public:
     virtual void AllReduceAsync(double* sendData, double* receiveData, size_t numElements, MPI_Request* request, MPI_Op op = MPI_SUM) const;
     virtual void AllReduceAsync(float* sendData, float* receiveData, size_t numElements, MPI_Request* request, MPI_Op op = MPI_SUM) const;
 
+    virtual void AllReduceHierarchical(float* data, size_t numElements, size_t maxRanksPerGroup = 0) const;
+    virtual void AllReduceHierarchical(double* data, size_t numElements, size_t maxRanksPerGroup = 0) const;
+
     virtual void Bcast(size_t* sendData, size_t numElements, size_t srcRank);
     virtual void Bcast(double* sendData, size_t numElements, size_t srcRank);
     virtual void Bcast(float* sendData, size_t numElements, size_t srcRank);
@@ -597,6 +650,7 @@ MPI_Comm MPIWrapperMpi::Communicator() const
 
 int MPIWrapperMpi::Finalize(void)
 {
+    FreeHierarchicalGroups();
     return MPI_Finalize();
 }
 
@@ -626,6 +680,11 @@ int MPIWrapperMpi::Waitall(int count, MPI_Request array_of_requests[], MPI_Statu
     return MPI_Waitall(count, array_of_requests, array_of_statuses);
 }
 
+int MPIWrapperMpi::Test(MPI_Request* request, int* flag, MPI_Status* status)
+{
+    return MPI_Test(request, flag, status);
+}
+
 int MPIWrapperMpi::Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Request* request)
 {
     return MPI_Isend(buf, count, datatype, dest, tag, m_currentComm, request);
@@ -940,6 +999,218 @@ void MPIWrapperMpi::WaitAny(MPI_Request* requests, int numRequests, int* index)
     MPI_Waitany(numRequests, requests, index, MPI_STATUSES_IGNORE) || MpiFail("WaitAny: MPI_Waitany");
 }
 
+// -----------------------------------------------------------------------
+// hierarchical all-reduce
+// -----------------------------------------------------------------------
+
+void MPIWrapperMpi::AllReduceHierarchical(float* data, size_t numElements, size_t maxRanksPerGroup) const
+{
+    AllReduceHierarchicalImpl(data, numElements, maxRanksPerGroup);
+}
+
+void MPIWrapperMpi::AllReduceHierarchical(double* data, size_t numElements, size_t maxRanksPerGroup) const
+{
+    AllReduceHierarchicalImpl(data, numElements, maxRanksPerGroup);
+}
+
+void MPIWrapperMpi::CreateHierarchicalGroups(size_t maxRanksPerGroup) const
+{
+    // Group the ranks by host name. Within a host, ranks are assigned to groups of at most 'maxRanksPerGroup' in rank order.
+    const int nameMax = MPI_MAX_PROCESSOR_NAME + 1;
+    char myName[nameMax] = { 0 };
+    int myNameLen = 0;
+    MPI_Get_processor_name(myName, &myNameLen) || MpiFail("AllReduceHierarchical: MPI_Get_processor_name");
+    myName[myNameLen] = '\0';
+
+    int numRanks = (int)NumNodesInUse();
+    int myRank = (int)CurrentNodeRank();
+    std::vector<char> nameBuffer(numRanks * nameMax);
+    char* allNames = nameBuffer.data();
+    MPI_Allgather(myName, nameMax, MPI_CHAR, allNames, nameMax, MPI_CHAR, m_currentComm) || MpiFail("AllReduceHierarchical: MPI_Allgather");
+
+    // The color of a group is the lowest rank in it.
+    std::vector<int> color(numRanks, 0);
+    std::map<std::string, std::vector<int>> ranksOnHost;
+    for (int i = 0; i < numRanks; i++)
+    {
+        auto& ranks = ranksOnHost[std::string(allNames + i * nameMax)];
+        size_t position = ranks.size();
+        ranks.push_back(i);
+        color[i] = (maxRanksPerGroup == 0) ? ranks[0] : ranks[position / maxRanksPerGroup * maxRanksPerGroup];
+    }
+
+    std::unique_ptr<HierarchicalGroups> groups(new HierarchicalGroups());
+    groups->maxRanksPerGroup = maxRanksPerGroup;
+
+    MPI_Comm_split(m_currentComm, color[myRank], myRank, &groups->localComm) || MpiFail("AllReduceHierarchical: MPI_Comm_split");
+    MPI_Comm_rank(groups->localComm, &groups->localRank);
+    MPI_Comm_size(groups->localComm, &groups->localSize);
+    MPI_Allreduce(&groups->localSize, &groups->maxLocalSize, 1, MPI_INT, MPI_MAX, m_currentComm) || MpiFail("AllReduceHierarchical: MPI_Allreduce");
+
+    MPI_Comm_split(m_currentComm, groups->localRank == 0 ? 0 : MPI_UNDEFINED, myRank, &groups->leaderComm) || MpiFail("AllReduceHierarchical: MPI_Comm_split");
+    groups->leaderRank = 0;
+    groups->numLeaders = 0;
+    if (groups->leaderComm != MPI_COMM_NULL)
+    {
+        MPI_Comm_rank(groups->leaderComm, &groups->leaderRank);
+        MPI_Comm_size(groups->leaderComm, &groups->numLeaders);
+    }
+
+    // The memory is allocated by the first rank of the group and mapped by the others.
+    size_t sharedMemorySize = (HierarchicalGroups::NumInputSlotSets * groups->localSize + HierarchicalGroups::NumResultBuffers) * HierarchicalGroups::ChunkSizeInBytes;
+    void* baseAddress = nullptr;
+    MPI_Win_allocate_shared(groups->localRank == 0 ? (MPI_Aint)sharedMemorySize : 0, 1, MPI_INFO_NULL, groups->localComm, &baseAddress, &groups->window)
+        || MpiFail("AllReduceHierarchical: MPI_Win_allocate_shared");
+
+    MPI_Aint size = 0;
+    int displacementUnit = 0;
+    MPI_Win_shared_query(groups->window, 0, &size, &displacementUnit, &baseAddress) || MpiFail("AllReduceHierarchical: MPI_Win_shared_query");
+    groups->sharedMemory = static_cast<char*>(baseAddress);
+
+    // one passive epoch for the lifetime of the window; ranks synchronize with MPI_Win_sync() and barriers
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, groups->window) || MpiFail("AllReduceHierarchical: MPI_Win_lock_all");
+
+    if (GetMathLibTraceLevel() > 0)
+    {
+        fprintf(stderr, "AllReduceHierarchical: rank %d is rank %d of %d in its group, %s\n", myRank, groups->localRank, groups->localSize,
+                groups->leaderComm != MPI_COMM_NULL ? "leader" : "not a leader");
+        fflush(stderr);
+    }
+
+    m_hierarchicalGroups = std::move(groups);
+}
+
+void MPIWrapperMpi::FreeHierarchicalGroups() const
+{
+    if (!m_hierarchicalGroups)
+        return;
+
+    MPI_Win_unlock_all(m_hierarchicalGroups->window) || MpiFail("AllReduceHierarchical: MPI_Win_unlock_all");
+    MPI_Win_free(&m_hierarchicalGroups->window) || MpiFail("AllReduceHierarchical: MPI_Win_free");
+    if (m_hierarchicalGroups->leaderComm != MPI_COMM_NULL)
+        MPI_Comm_free(&m_hierarchicalGroups->leaderComm) || MpiFail("AllReduceHierarchical: MPI_Comm_free");
+    MPI_Comm_free(&m_hierarchicalGroups->localComm) || MpiFail("AllReduceHierarchical: MPI_Comm_free");
+    m_hierarchicalGroups.reset();
+}
+
+// Makes the writes of all ranks of the group to the shared memory visible to each other
+void MPIWrapperMpi::SyncHierarchicalGroup() const
+{
+    MPI_Win_sync(m_hierarchicalGroups->window) || MpiFail("AllReduceHierarchical: MPI_Win_sync");
+    MPI_Barrier(m_hierarchicalGroups->localComm) || MpiFail("AllReduceHierarchical: MPI_Barrier");
+    MPI_Win_sync(m_hierarchicalGroups->window) || MpiFail("AllReduceHierarchical: MPI_Win_sync");
+}
+
+template <class ElemType>
+void MPIWrapperMpi::AllReduceHierarchicalImpl(ElemType* data, size_t numElements, size_t maxRanksPerGroup) const
+{
+    if (numElements == 0 || NumNodesInUse() == 1)
+        return;
+
+    if (m_hierarchicalGroups && m_hierarchicalGroups->maxRanksPerGroup != maxRanksPerGroup)
+        FreeHierarchicalGroups();
+    if (!m_hierarchicalGroups)
+        CreateHierarchicalGroups(maxRanksPerGroup);
+
+    auto& groups = *m_hierarchicalGroups;
+
+    // Without ranks sharing a host there is nothing to gain over the MPI implementation
+    if (groups.maxLocalSize == 1)
+    {
+        AllReduce(data, numElements);
+        return;
+    }
+
+    const size_t chunkSize = HierarchicalGroups::ChunkSizeInBytes / sizeof(ElemType);
+    const size_t numChunks = (numElements + chunkSize - 1) / chunkSize;
+    auto chunkBegin = [&](size_t chunk) { return chunk * chunkSize; };
+    auto chunkElements = [&](size_t chunk) { return std::min(chunkSize, numElements - chunk * chunkSize); };
+
+    // In step s, chunk s is copied in, chunk s-1 reduce-scattered, chunk s-2 all-reduced by the leaders and chunk s-3 copied out.
+    for (size_t step = 0; step < numChunks + 3; step++)
+    {
+        if (step < numChunks)
+        {
+            size_t chunk = step;
+            memcpy(groups.InputSlot(chunk, groups.localRank), data + chunkBegin(chunk), chunkElements(chunk) * sizeof(ElemType));
+        }
+
+        if (step >= 1 && step - 1 < numChunks)
+        {
+            // each rank sums its slice of the chunk over the inputs of all ranks of the group
+            size_t chunk = step - 1;
+            size_t n = chunkElements(chunk);
+            size_t sliceBegin = n * groups.localRank / groups.localSize;
+            size_t sliceEnd = n * (groups.localRank + 1) / groups.localSize;
+            ElemType* result = reinterpret_cast<ElemType*>(groups.ResultBuffer(chunk));
+            const ElemType* input = reinterpret_cast<const ElemType*>(groups.InputSlot(chunk, 0));
+            for (size_t i = sliceBegin; i < sliceEnd; i++)
+                result[i] = input[i];
+            for (int r = 1; r < groups.localSize; r++)
+            {
+                input = reinterpret_cast<const ElemType*>(groups.InputSlot(chunk, r));
+                for (size_t i = sliceBegin; i < sliceEnd; i++)
+                    result[i] += input[i];
+            }
+        }
+
+        if (step >= 2 && step - 2 < numChunks && groups.leaderComm != MPI_COMM_NULL && groups.numLeaders > 1)
+        {
+            size_t chunk = step - 2;
+            RingAllReduce(reinterpret_cast<ElemType*>(groups.ResultBuffer(chunk)), chunkElements(chunk));
+        }
+
+        if (step >= 3)
+        {
+            size_t chunk = step - 3;
+            memcpy(data + chunkBegin(chunk), groups.ResultBuffer(chunk), chunkElements(chunk) * sizeof(ElemType));
+        }
+
+        if (step + 1 < numChunks + 3)
+            SyncHierarchicalGroup();
+    }
+}
+
+// Bandwidth-optimal ring all-reduce among the group leaders: a reduce-scatter followed by an all-gather,
+// each in numLeaders - 1 steps in which every leader sends one segment to its right and receives one from its left neighbor.
+template <class ElemType>
+void MPIWrapperMpi::RingAllReduce(ElemType* data, size_t numElements) const
+{
+    auto& groups = *m_hierarchicalGroups;
+    int n = groups.numLeaders;
+    int me = groups.leaderRank;
+    int right = (me + 1) % n;
+    int left = (me + n - 1) % n;
+    auto segmentBegin = [&](int segment) { return numElements * segment / n; };
+    auto segmentElements = [&](int segment) { return segmentBegin(segment + 1) - segmentBegin(segment); };
+    auto dataType = GetDataType(data);
+
+    groups.ringBuffer.resize((numElements / n + 1) * sizeof(ElemType));
+    ElemType* received = reinterpret_cast<ElemType*>(groups.ringBuffer.data());
+
+    for (int step = 0; step < n - 1; step++)
+    {
+        int sendSegment = (me - step + n) % n;
+        int recvSegment = (me - step - 1 + 2 * n) % n;
+        MPI_Sendrecv(data + segmentBegin(sendSegment), (int)segmentElements(sendSegment), dataType, right, 0,
+                     received, (int)segmentElements(recvSegment), dataType, left, 0, groups.leaderComm, MPI_STATUS_IGNORE)
+            || MpiFail("AllReduceHierarchical: MPI_Sendrecv");
+
+        ElemType* target = data + segmentBegin(recvSegment);
+        for (size_t i = 0; i < segmentElements(recvSegment); i++)
+            target[i] += received[i];
+    }
+
+    for (int step = 0; step < n - 1; step++)
+    {
+        int sendSegment = (me + 1 - step + n) % n;
+        int recvSegment = (me - step + n) % n;
+        MPI_Sendrecv(data + segmentBegin(sendSegment), (int)segmentElements(sendSegment), dataType, right, 0,
+                     data + segmentBegin(recvSegment), (int)segmentElements(recvSegment), dataType, left, 0, groups.leaderComm, MPI_STATUS_IGNORE)
+            || MpiFail("AllReduceHierarchical: MPI_Sendrecv");
+    }
+}
+
 #endif
 
 
@@ -1009,6 +1280,11 @@ int MPIWrapperEmpty::Waitall(int count, MPI_Request array_of_requests[], MPI_Sta
     return MPI_UNDEFINED;
 }
 
+int MPIWrapperEmpty::Test(MPI_Request* request, int* flag, MPI_Status* status)
+{
+    return MPI_UNDEFINED;
+}
+
 int MPIWrapperEmpty::Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Request* request)
 {
     return MPI_UNDEFINED;
@@ -1114,6 +1390,14 @@ void MPIWrapperEmpty::AllReduce(float* sendData, size_t numElements, MPI_Op op)
 {
 }
 
+void MPIWrapperEmpty::AllReduceHierarchical(float* data, size_t numElements, size_t maxRanksPerGroup) const
+{
+}
+
+void MPIWrapperEmpty::AllReduceHierarchical(double* data, size_t numElements, size_t maxRanksPerGroup) const
+{
+}
+
 void MPIWrapperEmpty::AllReduce(size_t* sendData, size_t* receiveData, size_t numElements, MPI_Op op) const
 {
 }
@@ -47,6 +47,30 @@ vector<MemRequestInfo<double>>& MatrixPool::GetMemRequestInfoVec<double>()
     return m_memRequestInfoDoubleVec;
 }
 
+template <>
+vector<MemRequestInfo<float>>& MatrixPool::GetArenaRequestInfoVec<float>()
+{
+    return m_arenaRequestInfoFloatVec;
+}
+
+template <>
+vector<MemRequestInfo<double>>& MatrixPool::GetArenaRequestInfoVec<double>()
+{
+    return m_arenaRequestInfoDoubleVec;
+}
+
+template <>
+map<DEVICEID_TYPE, shared_ptr<Matrix<float>>>& MatrixPool::GetArenas<float>()
+{
+    return m_floatArenas;
+}
+
+template <>
+map<DEVICEID_TYPE, shared_ptr<Matrix<double>>>& MatrixPool::GetArenas<double>()
+{
+    return m_doubleArenas;
+}
+
 // -----------------------------------------------------------------------
 // construction
 // -----------------------------------------------------------------------
@@ -267,6 +291,40 @@ void ComputationNetwork::ReadPersistableParameters(size_t modelVersion, File& fs
     fstream.GetMarker(FileMarker::fileMarkerEndSection, L"ENodeList");
 }
 
+template <class ElemType>
+static bool TryCopyLearnableParameterValue(const ComputationNodeBasePtr& from, const ComputationNodeBasePtr& to)
+{
+    auto fromParameter = dynamic_pointer_cast<LearnableParameter<ElemType>>(from);
+    if (!fromParameter)
+        return false;
+    auto toParameter = dynamic_pointer_cast<LearnableParameter<ElemType>>(to);
+    if (!toParameter)
+        LogicError("CopyLearnableParameterValuesFrom: Node '%ls' differs in precision.", from->NodeName().c_str());
+    // keeps the device of the target
+    toParameter->Value().AssignValuesOf(fromParameter->Value());
+    return true;
+}
+
+bool ComputationNetwork::CopyLearnableParameterValuesFrom(const ComputationNetwork& other)
+{
+    if (m_nameToNodeMap.size() != other.m_nameToNodeMap.size())
+        return false;
+    for (const auto& iter : other.m_nameToNodeMap)
+    {
+        auto found = m_nameToNodeMap.find(iter.first);
+        if (found == m_nameToNodeMap.end() || found->second->OperationName() != iter.second->OperationName())
+            return false;
+    }
+
+    for (const auto& iter : other.m_nameToNodeMap)
+    {
+        const auto& node = m_nameToNodeMap[iter.first];
+        if (!TryCopyLearnableParameterValue<float>(iter.second, node))
+            TryCopyLearnableParameterValue<double>(iter.second, node);
+    }
+    return true;
+}
+
 // deserialize the model
 // This does not post-process the model (CompileNetwork()). Use Load() instead.
 template <class ElemType> // for ReadPersistableParameters()
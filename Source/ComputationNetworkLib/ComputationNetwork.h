@@ -39,6 +39,18 @@ inline std::wstring ToString(const ComputationNodeBasePtr& node)
     return node->NodeName();
 }
 
+// TimesNodes of a recurrent loop that multiply the same in-loop input with different weights from outside the loop
+// (e.g. the gate projections of the previous output of an LSTM). Per time step, they are computed as a single GEMM
+// with the stacked weights, and their gradients are propagated into the input the same way (see ComputationNetwork::BatchRecurrentGemms()).
+struct RecurrentGemmGroup
+{
+    virtual ~RecurrentGemmGroup() { }
+    virtual void BeginForwardProp() = 0;
+    virtual void ForwardProp(const FrameRange& fr) = 0;
+    virtual void Backprop(const FrameRange& fr) = 0;
+    std::vector<ComputationNodeBasePtr> m_members; // in evaluation order; the first member computes the group
+};
+
 // ===========================================================================
 // ComputationNetwork -- computation graph and operations
 // ===========================================================================
@@ -105,6 +117,9 @@ public:
         auto modelVersion = GetModelVersion(fstream);
         ReadPersistableParameters<ElemType>(modelVersion, fstream, false);
     }
+    // copy the values of all learnable parameters from a network with the same nodes (possibly on another device),
+    // e.g. to refresh a host snapshot of the model that is then saved in the background. Returns false if the nodes differ.
+    bool CopyLearnableParameterValuesFrom(const ComputationNetwork& other);
     // design BUGBUG: binary files do not know whether they are float or double.
     // TODO: modify file format to know this; then eliminate the <ElemType> dependency (and in some future, allow nodes to be different)
     template <class ElemType> void Read(const std::wstring& fileName);
@@ -148,6 +163,12 @@ public:
     // main entry point for backprop
     void Backprop(const ComputationNodeBasePtr rootNode);
 
+    // Same as Backprop(rootNode), but calls 'onNodeBackpropDone' after each top-level node has been backpropagated,
+    // in backprop order (reverse evaluation order). At that point all consumers of the node have been processed,
+    // i.e. the gradient of a LearnableParameter is final and can e.g. be sent to other workers while backprop continues.
+    typedef std::function<void(const ComputationNodeBasePtr&)> BackpropDoneCallback;
+    void Backprop(const ComputationNodeBasePtr rootNode, const BackpropDoneCallback& onNodeBackpropDone);
+
     template <class NODESET> // version that takes multiple nodes
     void TravserseInSortedGlobalEvalOrder(const NODESET& nodes, const std::function<void(const ComputationNodeBasePtr&)>& action)
     {
@@ -181,6 +202,7 @@ public:
     template <class NODESET> // version that takes multiple nodes
     void ForwardProp(const NODESET& nodes)
     {
+        m_matrixPool.PlanArenasForMinibatch();
         TravserseInSortedGlobalEvalOrder(nodes, [](const ComputationNodeBasePtr& node) {
             PARTraversalFlowControlNode::ForwardProp(node, FrameRange(nullptr));
         });
@@ -197,6 +219,8 @@ public:
     template <class NODESET_FROM, class NODESET_TO> // version that takes both initial and final set of nodes
     void ForwardPropFromTo(const NODESET_FROM& nodesFrom, const NODESET_TO& nodesTo)
     {
+        m_matrixPool.PlanArenasForMinibatch();
+
         // Compute the set of nodes to do forward on.
         std::set<ComputationNodeBasePtr> nodesToForward;
         TravserseInSortedGlobalEvalOrder(nodesTo, [&](const ComputationNodeBasePtr& node) {
@@ -253,6 +277,8 @@ private:
     size_t ValidateNodes(list<ComputationNodeBasePtr> nodes, bool isFirstPass, bool isFinalValidationPass);
     bool ValidateNode(ComputationNodeBasePtr node, bool isFinalValidationPass) const;
     void MarkValueNonSharableNodes();
+    void FuseElementwiseChains(const std::vector<ComputationNodeBasePtr>& forwardPropRoots, const std::unordered_map<ComputationNodeBasePtr, std::unordered_set<ComputationNodeBasePtr>>& parentsMap);
+    void BatchRecurrentGemms();
     void ChangeNodeInputs(ComputationNodeBasePtr fromNode, ComputationNodeBasePtr toNode);
 
 private:
@@ -1151,6 +1177,8 @@ protected:
         ComputationNodeBasePtr m_sourceNode; // one of the nodes of the loop   --TODO: What is the special meaning of this node? It seems to always be a delay node.
         int m_loopId;                        // unique loop id, index in m_allSEQNodes array
         int m_steppingDirection;             // +1 if left to right (t=0..T-1), -1 if rightt to left (t=T-1..0)
+        std::vector<std::shared_ptr<RecurrentGemmGroup>> m_gemmGroups; // see ComputationNetwork::BatchRecurrentGemms()
+        std::vector<int> m_gemmGroupOf;                                // [index into m_nestedNodes] index into m_gemmGroups, or -1; empty if there are no groups
 
         SEQTraversalFlowControlNode(int loopId, ComputationNodeBasePtr cur)
             : m_loopId(loopId),
@@ -1210,6 +1238,9 @@ protected:
         // There is currently no other constructor for inner nested PAR-traversed sub-networks, but there will be.
         PARTraversalFlowControlNode(const std::vector<shared_ptr<SEQTraversalFlowControlNode>>& recurrentInfo, const std::list<ComputationNodeBasePtr>& allNodes);
         // Base::m_nestedNodes contains all top-level nodes, in evaluation order
+
+        // called by Backprop() after each nested node; only set for the duration of ComputationNetwork::Backprop(rootNode, onNodeBackpropDone)
+        BackpropDoneCallback m_onNodeBackpropDone;
     };
 
 public:
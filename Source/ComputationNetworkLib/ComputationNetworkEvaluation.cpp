@@ -40,6 +40,9 @@ void ComputationNetwork::ForwardProp(const ComputationNodeBasePtr rootNode)
 {
     VerifyIsCompiled("ForwardProp");
 
+    // now that the minibatch is known, lay out the matrix pool's arenas for it (if used, and if they are too small)
+    m_matrixPool.PlanArenasForMinibatch();
+
     // traverse all nodes in the pre-determined evaluation order
     GetNestedNetwork(rootNode)->ForwardProp(FrameRange(nullptr));
 }
@@ -88,6 +91,25 @@ void ComputationNetwork::Backprop(const ComputationNodeBasePtr rootNode) // trai
     GetNestedNetwork(rootNode)->Backprop(FrameRange(nullptr), true, true);
 }
 
+void ComputationNetwork::Backprop(const ComputationNodeBasePtr rootNode, const BackpropDoneCallback& onNodeBackpropDone)
+{
+    auto network = dynamic_pointer_cast<PARTraversalFlowControlNode>(GetNestedNetwork(rootNode));
+    if (!network)
+        LogicError("Backprop: Expected the nested network of a root node to be a PARTraversalFlowControlNode.");
+
+    network->m_onNodeBackpropDone = onNodeBackpropDone;
+    try
+    {
+        Backprop(rootNode);
+    }
+    catch (...)
+    {
+        network->m_onNodeBackpropDone = nullptr;
+        throw;
+    }
+    network->m_onNodeBackpropDone = nullptr;
+}
+
 void ComputationNetwork::FormNestedNetwork(const ComputationNodeBasePtr& rootNode)
 {
     if (m_nestedNetworks.find(rootNode) != m_nestedNetworks.end())
@@ -142,10 +164,19 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
 }
 /*static*/ void ComputationNetwork::PARTraversalFlowControlNode::ForwardProp(const ComputationNodeBasePtr& node, const FrameRange& fr)
 {
+    if (node->IsFusedIntoConsumer()) // computed by the consumer's fused chain
+    {
+        node->BumpEvalTimeStamp();
+        return;
+    }
+
     if (node->IsOutOfDateWrtInputs())
     {
         node->BeginForwardProp();
-        node->ForwardProp(fr.WithLayout(node->GetMBLayout()));
+        if (node->GetFusedChain())
+            node->ForwardPropFusedChain(fr.WithLayout(node->GetMBLayout()));
+        else
+            node->ForwardProp(fr.WithLayout(node->GetMBLayout()));
         node->EndForwardProp();
 
         node->BumpEvalTimeStamp();
@@ -186,6 +217,9 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
         node->Backprop(fr.WithLayout(node->GetMBLayout()), true /*childrenInThisLoop*/, true /*childrenInOuterLoop*/);
         node->EndBackprop();
 
+        if (m_onNodeBackpropDone)
+            m_onNodeBackpropDone(node);
+
         // Extreme Tracing, part 2/4
         if (node->HasEnvironmentPtr() && node->Environment().ShouldDumpNode() && node->NeedsGradient())
             DumpNode<float>(node, /*dumpGradient=*/true) || DumpNode<double>(node, true);
@@ -249,7 +283,14 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
 
     // tell all that loop is about to commence
     for (auto& node : m_nestedNodes)
-        node->BeginForwardProp();
+    {
+        if (!node->IsFusedIntoConsumer())
+            node->BeginForwardProp();
+    }
+
+    // stack the weights of the batched GEMMs
+    for (auto& group : m_gemmGroups)
+        group->BeginForwardProp();
 }
 
 // evaluation of a SEQTraversalFlowControlNode FlowControlNode
@@ -268,9 +309,20 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     FrameRangeIteration range(GetMBLayout(), m_steppingDirection);
     for (auto t = range.begin(); t != range.end(); t++)
     {
-        for (auto& node : m_nestedNodes)
+        for (size_t i = 0; i < m_nestedNodes.size(); i++)
         {
-            node->ForwardProp(t);
+            auto& node = m_nestedNodes[i];
+            int gemmGroup = m_gemmGroupOf.empty() ? -1 : m_gemmGroupOf[i];
+            if (gemmGroup >= 0)
+            {
+                // the first member of a group computes all members
+                if (m_gemmGroups[gemmGroup]->m_members.front() == node)
+                    m_gemmGroups[gemmGroup]->ForwardProp(t);
+            }
+            else if (node->GetFusedChain())
+                node->ForwardPropFusedChain(t);
+            else if (!node->IsFusedIntoConsumer())
+                node->ForwardProp(t);
             node->BumpEvalTimeStamp();
         }
     }
@@ -289,7 +341,10 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
 {
     // tell all that loop is done  --e.g. PastValueNode will capture its state for BPTT processing
     for (auto& node : m_nestedNodes)
-        node->EndForwardProp();
+    {
+        if (!node->IsFusedIntoConsumer())
+            node->EndForwardProp();
+    }
 }
 
 // called before first iteration step of ComputeGradient()
@@ -307,9 +362,18 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     FrameRangeIteration range(pMBLayout, m_steppingDirection);
     for (auto t = range.rbegin(); t != range.rend(); t++) // note: reverse iteration
     {
-        for (auto nodeIter2 = recurrentNodes.rbegin(); nodeIter2 != recurrentNodes.rend(); ++nodeIter2)
+        for (size_t i = recurrentNodes.size(); i-- > 0;)
         {
-            auto& node2 = *nodeIter2;
+            auto& node2 = recurrentNodes[i];
+            int gemmGroup = m_gemmGroupOf.empty() ? -1 : m_gemmGroupOf[i];
+            if (gemmGroup >= 0)
+            {
+                // The first member of a group is visited last, when the gradients of all members are complete.
+                // The only input inside the loop is the shared one, so that is all that is to do for the group.
+                if (m_gemmGroups[gemmGroup]->m_members.front() == node2)
+                    m_gemmGroups[gemmGroup]->Backprop(t);
+                continue;
+            }
             node2->Backprop(t, true /*childrenInThisLoop*/, false /*childrenInOuterLoop*/);
             // The above flags tell Backprop() to skip back-propagation from inside a node into
             // a node that is outside the loop, which is done later in EndBackprop() in PAR mode.
@@ -914,6 +978,271 @@ void ComputationNetwork::MarkValueNonSharableNodes()
     }
 }
 
+// Fuse trees of elementwise nodes (e.g. the gates of an LSTM cell) into single loops that are computed by the root
+// of the tree (ForwardPropFusedChain()). A node is fused into its consumer if
+//  - both implement GetElementwiseOpCode(), and all their inputs have the same MBLayout and sample size (no broadcasting),
+//  - it is the only consumer, and the node's value is not otherwise needed (i.e. it is sharable),
+//  - both are in the same recurrent loop or both outside of loops, and
+//  - all values are dense and on the CPU.
+// The values of the fused nodes are never materialized, and they do not take part in memory sharing.
+// This is only valid for forward-only evaluation, since backprop would need the intermediate values.
+void ComputationNetwork::FuseElementwiseChains(const std::vector<ComputationNodeBasePtr>& forwardPropRoots,
+                                              const std::unordered_map<ComputationNodeBasePtr, std::unordered_set<ComputationNodeBasePtr>>& parentsMap)
+{
+    // bound the number of instructions, so that the intermediate results of a block stay in the L1 cache
+    const size_t maxFusedNodes = 31;
+
+    // all nodes in global evaluation order, and the loop each belongs to
+    std::vector<ComputationNodeBasePtr> evalOrder;
+    std::unordered_map<ComputationNodeBasePtr, ComputationNodeBasePtr> loopOf;
+    TravserseInSortedGlobalEvalOrder(forwardPropRoots, [&](const ComputationNodeBasePtr& node) {
+        if (node->Is<SEQTraversalFlowControlNode>())
+        {
+            for (auto& loopNode : node->As<SEQTraversalFlowControlNode>()->m_nestedNodes)
+            {
+                evalOrder.push_back(loopNode);
+                loopOf[loopNode] = node;
+            }
+        }
+        else
+            evalOrder.push_back(node);
+    });
+
+    auto isFusable = [](const ComputationNodeBasePtr& node, ElementWiseOperator& op)
+    {
+        if (!node->GetElementwiseOpCode(op) || node->GetDeviceId() != CPUDEVICE || node->IsValueSparse() || node->NeedsDynamicValidation())
+            return false;
+        for (const auto& input : node->GetInputs())
+        {
+            if (input->GetMBLayout() != node->GetMBLayout() || input->GetSampleLayout().GetNumElements() != node->GetSampleLayout().GetNumElements() ||
+                input->GetDeviceId() != CPUDEVICE || input->IsValueSparse())
+                return false;
+        }
+        return true;
+    };
+
+    auto canFuseInto = [&](const ComputationNodeBasePtr& node, const ComputationNodeBasePtr& consumer)
+    {
+        ElementWiseOperator op;
+        const auto& consumerInputs = consumer->GetInputs();
+        auto parents = parentsMap.find(node);
+        return isFusable(node, op) && node->IsValueSharable() && !node->IsFusedIntoConsumer() &&
+               parents != parentsMap.end() && parents->second.size() == 1 && std::count(consumerInputs.begin(), consumerInputs.end(), node) == 1 &&
+               loopOf[node] == loopOf[consumer];
+    };
+
+    size_t numChains = 0, numFusedNodes = 0;
+    for (auto iter = evalOrder.rbegin(); iter != evalOrder.rend(); iter++) // consumers first, so that the trees are maximal
+    {
+        const auto& root = *iter;
+        ElementWiseOperator op;
+        if (root->IsFusedIntoConsumer() || !isFusable(root, op))
+            continue;
+
+        auto chain = make_shared<FusedElementwiseChain>();
+        std::function<int(const ComputationNodeBasePtr&)> emit = [&](const ComputationNodeBasePtr& node)
+        {
+            FusedElementwise::Instruction instruction = {};
+            node->GetElementwiseOpCode(instruction.op);
+            instruction.numArgs = node->GetNumInputs();
+            for (size_t i = 0; i < node->GetNumInputs(); i++)
+            {
+                const auto& input = node->GetInputs()[i];
+                if (chain->fusedNodes.size() < maxFusedNodes && canFuseInto(input, node))
+                {
+                    input->m_isFusedIntoConsumer = true;
+                    chain->fusedNodes.push_back(input);
+                    instruction.args[i] = emit(input);
+                }
+                else
+                {
+                    auto inputIter = std::find(chain->inputs.begin(), chain->inputs.end(), input);
+                    instruction.args[i] = FusedElementwise::InputArg(inputIter - chain->inputs.begin());
+                    if (inputIter == chain->inputs.end())
+                        chain->inputs.push_back(input);
+                }
+            }
+            chain->program.push_back(instruction);
+            return (int) chain->program.size() - 1;
+        };
+        emit(root);
+
+        if (chain->fusedNodes.empty())
+            continue;
+        FusedElementwise::Verify(chain->program, chain->inputs.size());
+        root->m_fusedChain = chain;
+        numChains++;
+        numFusedNodes += chain->fusedNodes.size();
+    }
+
+    if (TraceLevel() > 0)
+        fprintf(stderr, "\nFused %d elementwise nodes into %d chains.\n", (int) numFusedNodes, (int) numChains);
+}
+
+// computes a RecurrentGemmGroup of TimesNodes (see ComputationNetwork::BatchRecurrentGemms())
+template <class ElemType>
+class TimesNodeGemmGroup : public RecurrentGemmGroup
+{
+    typedef shared_ptr<ComputationNode<ElemType>> ComputationNodePtr;
+
+public:
+    TimesNodeGemmGroup(const std::vector<ComputationNodeBasePtr>& members)
+        : m_stackedWeights(members.front()->GetDeviceId()),
+          m_stackedValue(members.front()->GetDeviceId()),
+          m_stackedGradient(members.front()->GetDeviceId())
+    {
+        m_members = members;
+        for (const auto& member : members)
+        {
+            m_nodes.push_back(dynamic_pointer_cast<ComputationNode<ElemType>>(member));
+            m_weights.push_back(dynamic_pointer_cast<ComputationNode<ElemType>>(member->GetInputs()[0]));
+        }
+        m_input = dynamic_pointer_cast<ComputationNode<ElemType>>(members.front()->GetInputs()[1]);
+    }
+
+    virtual void BeginForwardProp() override
+    {
+        size_t numRows = 0;
+        for (auto& weights : m_weights)
+            numRows += weights->ValueAsMatrix().GetNumRows();
+
+        m_stackedWeights.Resize(numRows, m_input->GetSampleLayout().GetNumElements());
+        size_t offset = 0;
+        for (auto& weightsNode : m_weights)
+        {
+            const auto& weights = weightsNode->ValueAsMatrix();
+            m_stackedWeights.AssignToRowSliceValuesOf(weights, offset, weights.GetNumRows());
+            offset += weights.GetNumRows();
+        }
+    }
+
+    // value of all members = stacked weights * input
+    virtual void ForwardProp(const FrameRange& fr) override
+    {
+        Matrix<ElemType>::Multiply(m_stackedWeights, false, m_input->ValueFor(fr), false, m_stackedValue);
+
+        size_t offset = 0;
+        for (auto& node : m_nodes)
+        {
+            auto value = node->ValueFor(fr);
+            value.AssignRowSliceValuesOf(m_stackedValue, offset, value.GetNumRows());
+            offset += value.GetNumRows();
+        }
+    }
+
+    // gradient of the input += stacked weights^T * stacked gradients of all members
+    virtual void Backprop(const FrameRange& fr) override
+    {
+        for (auto& node : m_nodes)
+        {
+            if (node->NeedsGradient())
+                node->LazyZeroGradient(node.get());
+        }
+
+        if (!m_input->NeedsGradient())
+            return;
+
+        m_input->LazyZeroGradient(m_nodes.front().get());
+        auto inputGradient = m_input->GradientFor(fr);
+
+        m_stackedGradient.Resize(m_stackedWeights.GetNumRows(), inputGradient.GetNumCols());
+        size_t offset = 0;
+        for (auto& node : m_nodes)
+        {
+            auto gradient = node->GradientFor(fr);
+            m_stackedGradient.AssignToRowSliceValuesOf(gradient, offset, gradient.GetNumRows());
+            offset += gradient.GetNumRows();
+        }
+
+        Matrix<ElemType>::MultiplyAndAdd(m_stackedWeights, true, m_stackedGradient, false, inputGradient);
+    }
+
+private:
+    std::vector<ComputationNodePtr> m_nodes;   // m_members, down-cast
+    std::vector<ComputationNodePtr> m_weights; // left input of each member
+    ComputationNodePtr m_input;                // shared right input of all members, computed in the same loop
+    Matrix<ElemType> m_stackedWeights;       // left inputs of all members, stacked vertically
+    Matrix<ElemType> m_stackedValue;         // values of all members for one time step
+    Matrix<ElemType> m_stackedGradient;      // gradients of all members for one time step
+};
+
+// returns true if 'node' is a TimesNode that computes W * x for a single column x, with W a dense matrix from outside of any loop
+template <class ElemType>
+static bool IsRecurrentGemmCandidate(const ComputationNodeBasePtr& node)
+{
+    auto timesNode = dynamic_pointer_cast<TimesNode<ElemType>>(node);
+    if (!timesNode || timesNode->GetMultiplier() || timesNode->OutputRank() != 1)
+        return false;
+
+    const auto& weights = node->GetInputs()[0];
+    const auto& input   = node->GetInputs()[1];
+    const auto& weightsLayout = weights->GetSampleLayout();
+    return !weights->HasMBLayout() && !weights->IsPartOfLoop() && !weights->IsValueSparse() && weightsLayout.GetRank() == 2 &&
+           input->GetMBLayout() == node->GetMBLayout() && !input->IsValueSparse() &&
+           input->GetSampleLayout().GetNumElements() == weightsLayout[1] && node->GetSampleLayout().GetNumElements() == weightsLayout[0] &&
+           weights->GetDeviceId() == node->GetDeviceId() && input->GetDeviceId() == node->GetDeviceId();
+}
+
+// Batch the TimesNodes of each recurrent loop that multiply the same input from inside the loop (e.g. the previous output of
+// an LSTM, which is multiplied with the weights of each gate) into RecurrentGemmGroups. Per time step, such a group runs a
+// single GEMM with the vertically stacked weights instead of one small GEMM per node, in forward as well as in backward
+// direction. Products with inputs from outside the loop are not affected, since those are not part of the loop in the first
+// place and run in PAR mode; likewise, the gradients of the weights are computed in PAR mode in EndBackprop().
+void ComputationNetwork::BatchRecurrentGemms()
+{
+    size_t numGroups = 0, numBatchedNodes = 0;
+    for (auto& loop : m_allSEQNodes)
+    {
+        const auto& nestedNodes = loop->m_nestedNodes;
+        std::set<ComputationNodeBasePtr> loopNodes(nestedNodes.begin(), nestedNodes.end());
+
+        // collect the candidates by their shared input, in evaluation order
+        std::vector<ComputationNodeBasePtr> inputs;
+        std::map<ComputationNodeBasePtr, std::vector<size_t>> candidatesOf; // [input] -> indices into nestedNodes
+        for (size_t i = 0; i < nestedNodes.size(); i++)
+        {
+            const auto& node = nestedNodes[i];
+            if (!IsRecurrentGemmCandidate<float>(node) && !IsRecurrentGemmCandidate<double>(node))
+                continue;
+            const auto& input = node->GetInputs()[1];
+            if (loopNodes.find(input) == loopNodes.end() || input->IsFusedIntoConsumer())
+                continue;
+            auto& candidates = candidatesOf[input];
+            if (candidates.empty())
+                inputs.push_back(input);
+            candidates.push_back(i);
+        }
+
+        loop->m_gemmGroups.clear();
+        loop->m_gemmGroupOf.assign(nestedNodes.size(), -1);
+        for (const auto& input : inputs)
+        {
+            const auto& candidates = candidatesOf[input];
+            if (candidates.size() < 2)
+                continue;
+
+            std::vector<ComputationNodeBasePtr> members;
+            for (auto i : candidates)
+            {
+                members.push_back(nestedNodes[i]);
+                loop->m_gemmGroupOf[i] = (int) loop->m_gemmGroups.size();
+            }
+            if (input->Is<ComputationNode<float>>())
+                loop->m_gemmGroups.push_back(make_shared<TimesNodeGemmGroup<float>>(members));
+            else
+                loop->m_gemmGroups.push_back(make_shared<TimesNodeGemmGroup<double>>(members));
+            numBatchedNodes += members.size();
+        }
+
+        if (loop->m_gemmGroups.empty())
+            loop->m_gemmGroupOf.clear();
+        numGroups += loop->m_gemmGroups.size();
+    }
+
+    if (TraceLevel() > 0)
+        fprintf(stderr, "\nBatched %d Times nodes in recurrent loops into %d GEMMs.\n", (int) numBatchedNodes, (int) numGroups);
+}
+
 // From the set of nodes extract all nodes which are used as accumulator nodes.
 set<ComputationNodeBasePtr> ComputationNetwork::ExtractNodesWhichAccumulateResult(set<ComputationNodeBasePtr> candidates)
 {
@@ -1098,6 +1427,14 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
         }
     }
 
+    // forward-only evaluation on the CPU: run chains of elementwise nodes in single loops, without materializing the intermediate values
+    if (!performingBackPropagation && Globals::ShouldFuseElementwiseChains())
+        FuseElementwiseChains(forwardPropRoots, parentsMap);
+
+    // recurrent loops: compute the products of an input from inside the loop with several weight matrices as a single GEMM
+    if (Globals::ShouldBatchRecurrentGemms())
+        BatchRecurrentGemms();
+
     // gradient reuse maps
     std::unordered_map<MatrixPool::AliasNodePtr, std::unordered_set<MatrixPool::AliasNodePtr>> gradientReuseChildrenMap;
     std::unordered_map<MatrixPool::AliasNodePtr, MatrixPool::AliasNodePtr> gradientReuseParentMap;
@@ -1154,7 +1491,14 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
             node->RequestMatricesBeforeForwardProp(m_matrixPool);
             // we only release matrices for the children since the root node's information will be used
             // and should not be shared with others
-            ReleaseMatricesAfterEvalForChildren(node, parentsMap);
+            // The inputs of fused nodes are read when their chain is computed, i.e. together with the root's inputs.
+            if (!node->IsFusedIntoConsumer())
+                ReleaseMatricesAfterEvalForChildren(node, parentsMap);
+            if (node->GetFusedChain())
+            {
+                for (auto& fusedNode : node->GetFusedChain()->fusedNodes)
+                    ReleaseMatricesAfterEvalForChildren(fusedNode, parentsMap);
+            }
         }
     });
 
@@ -1246,12 +1590,22 @@ void ComputationNetwork::AllocateAllMatrices(const std::vector<ComputationNodeBa
         }
     }
 
+    // the sizes of matrices that depend on the input layouts are known before ForwardProp(), so they can be planned per minibatch
+    set<MBLayoutPtr> inputLayouts;
+    for (const auto& node : uniqueForwardPropEvalNodes)
+    {
+        if (node->IsLeaf() && node->HasMBLayout())
+            inputLayouts.insert(node->GetMBLayout());
+    }
+    m_matrixPool.SetInputLayouts(inputLayouts);
+
     m_matrixPool.OptimizedMemoryAllocation(); 
     m_areMatricesAllocated = true;
 
     // TO DO: At the time of AllocateAllMatrices we don't know the minibatch size. In theory one may allocate memory again once we start to receive
     // data from the reader (and the minibatch size is known). For some problems, minibatch size can change constantly, and there needs to be a 
     // tradeoff in deciding how frequent to run optimized memory allocation. For now, we do it only once at the very beginning for speed concerns. 
+    // With Globals::ShouldUseMatrixPoolArena(), node values and gradients are instead planned from ForwardProp(), whenever the minibatch grows.
 
     // TO DO: when some matrices are sparse, the memory size request may be wrong. One may need to call OptimizedMemoryAllocation later again 
     // if the requests of sparse allocation and release are re-processed correctly. Future work. 
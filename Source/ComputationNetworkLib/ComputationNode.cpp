@@ -715,6 +715,27 @@ template <class ElemType>
     Trace();
 }
 
+template <class ElemType>
+/*virtual*/ void ComputationNode<ElemType>::ForwardPropFusedChain(const FrameRange& fr)
+{
+    const auto& chain = *GetFusedChain();
+    auto result = ValueFor(fr);
+    if (result.GetDeviceId() != CPUDEVICE || result.GetMatrixType() != DENSE)
+        LogicError("%ls %ls operation: Fused elementwise chains are only supported for dense matrices on the CPU.", NodeName().c_str(), OperationName().c_str());
+
+    // all inputs have the same layout and sample size as the result, so the same frame range selects matching contiguous columns
+    std::vector<const ElemType*> inputs;
+    inputs.reserve(chain.inputs.size());
+    for (const auto& inputNode : chain.inputs)
+    {
+        auto input = inputNode->As<ComputationNode<ElemType>>()->ValueFor(fr);
+        if (input.GetDeviceId() != CPUDEVICE || input.GetMatrixType() != DENSE || input.GetNumElements() != result.GetNumElements())
+            LogicError("%ls %ls operation: Fused input %ls has an incompatible value matrix.", NodeName().c_str(), OperationName().c_str(), inputNode->NodeDescription().c_str());
+        inputs.push_back(input.Data());
+    }
+    FusedElementwise::Evaluate(chain.program, inputs, result.Data(), result.GetNumElements());
+}
+
 template <class ElemType>
 /*virtual*/ void ComputationNode<ElemType>::BeginBackprop()
 {
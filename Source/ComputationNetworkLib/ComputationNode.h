@@ -13,6 +13,7 @@
 #include "MatrixPool.h"
 #include "ComputationEnvironment.h"
 #include "Globals.h"
+#include "FusedElementwise.h"
 
 #include <unordered_set>
 #include <map>
@@ -172,13 +173,22 @@ enum class ParentGradientOptimization
 
 class ComputationNetwork;
 class ComputationNodeBase;
+
+// a tree of elementwise nodes that is computed in a single loop by its root (see ComputationNetwork::FuseElementwiseChains())
+struct FusedElementwiseChain
+{
+    std::vector<std::shared_ptr<ComputationNodeBase>> fusedNodes; // nodes computed by the root, whose values are never materialized
+    std::vector<std::shared_ptr<ComputationNodeBase>> inputs;     // values read by the loop
+    std::vector<FusedElementwise::Instruction> program;           // the last instruction computes the root
+};
+
 struct ComputationNetworkOwnedNodeState
 {
     friend class ComputationNetwork;
 
     ComputationNetworkOwnedNodeState()
         : m_needsGradient(false), m_needsDynamicValidation(false), m_valueSharable(true), m_parentGradientOptimization(ParentGradientOptimization::None),
-          m_isPartOfLoop{false}
+          m_isFusedIntoConsumer(false), m_isPartOfLoop{false}
     {
     }
 
@@ -206,6 +216,10 @@ struct ComputationNetworkOwnedNodeState
     virtual void MarkValueSharable() { m_valueSharable = true; }
     bool IsValueSharable() const { return m_valueSharable; }
 
+    // elementwise-chain fusion: a fused node is computed by its consumer, which holds the chain
+    bool IsFusedIntoConsumer() const { return m_isFusedIntoConsumer; }
+    const std::shared_ptr<FusedElementwiseChain>& GetFusedChain() const { return m_fusedChain; }
+
     // tracing flags
     // Enable to print the value of the function-value matrix in somewhat readable format.
     // These are public since you are meant to set these flags manually in the debugger or temporarily poke into them from code as needed.
@@ -218,6 +232,9 @@ struct ComputationNetworkOwnedNodeState
 
     virtual ParentGradientOptimization ImplementsGradientOptimization(const ComputationNodeBase* /*input*/) const { return ParentGradientOptimization::None; }
 
+    // nodes whose ForwardProp() is a single unary or binary op over equally shaped inputs return it here, making them candidates for elementwise-chain fusion
+    virtual bool GetElementwiseOpCode(ElementWiseOperator& /*op*/) const { return false; }
+
 protected:                // TODO: should be fully encapsulated here
     bool m_needsGradient; // true if this node or any children need a gradient to be computed (for own consumption or propagation to somewhere in the child tree)
     bool m_needsDynamicValidation;
@@ -228,6 +245,9 @@ protected:                // TODO: should be fully encapsulated here
 
     ParentGradientOptimization m_parentGradientOptimization; // flag indicating whether the parent of this node overwrites the gradient of this node instead of accumulating to it
 
+    bool m_isFusedIntoConsumer;                          // value is computed (and never materialized) by the consumer's fused chain
+    std::shared_ptr<FusedElementwiseChain> m_fusedChain; // if not null, ForwardPropFusedChain() computes this node together with the fused nodes
+
 private:
     bool m_isPartOfLoop; // true if this loop is part of a recurrent loop
 
@@ -811,6 +831,9 @@ public:
     virtual void InvalidateMissingValueColumns(const FrameRange&) = 0;
     virtual void InvalidateMissingGradientColumns(const FrameRange&) = 0;
 
+    // overridden by <ElemType> variant only; replaces ForwardProp() for nodes with a fused chain
+    virtual void ForwardPropFusedChain(const FrameRange&) = 0;
+
     // -----------------------------------------------------------------------
     // memory sharing
     // -----------------------------------------------------------------------
@@ -1759,6 +1782,9 @@ public:
     // TODO: move to -Base (or -Network?)
     void Backprop(const FrameRange& fr, bool childrenInThisLoop, bool childrenInOuterLoop) override;
 
+    // computes this node and the nodes fused into it in a single loop (see ComputationNetwork::FuseElementwiseChains())
+    void ForwardPropFusedChain(const FrameRange& fr) override;
+
     // lazy resetting of gradient
     // This performs the actual zeroing out.
     void LazyZeroGradient(const ComputationNodeBase* gradientInitializedBy);
@@ -1813,8 +1839,10 @@ public:
     virtual void RequestMatricesBeforeForwardProp(MatrixPool& matrixPool) override
     {
         size_t matrixSize = m_sampleLayout.GetNumElements();
-        if (IsValueSharable() && !m_isValueSparse)
-            RequestMatrixFromPool(m_value, matrixPool, matrixSize, HasMBLayout());
+        if (IsFusedIntoConsumer()) // never materialized
+            CreateMatrixIfNull(m_value);
+        else if (IsValueSharable() && !m_isValueSparse)
+            RequestMatrixFromPool(m_value, matrixPool, matrixSize, HasMBLayout(), /*isWorkSpace*/false, /*aliasing*/false, /*isExactSize*/true, m_pMBLayout);
         else
             CreateMatrixIfNull(m_value);
 
@@ -1824,7 +1852,8 @@ public:
             for (size_t i = 1; i < multiOutputNode->m_numOutputs; ++i)
             {
                 if (IsValueSharable() && !multiOutputNode->m_outputsIsValueSparse[i])
-                    RequestMatrixFromPool(multiOutputNode->m_outputsValue[i], matrixPool, multiOutputNode->m_outputsShape[i].GetNumElements(), multiOutputNode->m_outputsMBLayout[i] != nullptr);
+                    RequestMatrixFromPool(multiOutputNode->m_outputsValue[i], matrixPool, multiOutputNode->m_outputsShape[i].GetNumElements(), multiOutputNode->m_outputsMBLayout[i] != nullptr,
+                                          /*isWorkSpace*/false, /*aliasing*/false, /*isExactSize*/true, multiOutputNode->m_outputsMBLayout[i]);
                 else
                     CreateMatrixIfNull(multiOutputNode->m_outputsValue[i]);
             }
@@ -1835,7 +1864,7 @@ public:
     // don't release matrices that need to be used in the gradient computation
     virtual void ReleaseMatricesAfterForwardProp(MatrixPool& matrixPool) override
     {
-        if (!IsOutputNeededDuringBackprop() && !m_isValueSparse && IsValueSharable())
+        if (!IsOutputNeededDuringBackprop() && !m_isValueSparse && IsValueSharable() && !IsFusedIntoConsumer())
             ReleaseMatrixToPool(m_value, matrixPool);
     }
 
@@ -1852,13 +1881,14 @@ public:
     virtual void RequestMatricesBeforeBackprop(MatrixPool& matrixPool) override
     {
         size_t matrixSize = m_sampleLayout.GetNumElements();
-        RequestMatrixFromPool(m_gradient, matrixPool, matrixSize, HasMBLayout(), /*isWorkSpace*/false, ParentGradientReused() || IsGradientReused());
+        RequestMatrixFromPool(m_gradient, matrixPool, matrixSize, HasMBLayout(), /*isWorkSpace*/false, ParentGradientReused() || IsGradientReused(), /*isExactSize*/true, m_pMBLayout);
 
         auto multiOutputNode = dynamic_cast<MultiOutputNode<ElemType>*>(this);
         if (multiOutputNode)
         {
             for (size_t i = 1; i < multiOutputNode->m_numOutputs; ++i)
-                RequestMatrixFromPool(multiOutputNode->m_outputsGradient[i], matrixPool, multiOutputNode->m_outputsShape[i].GetNumElements(), multiOutputNode->m_outputsMBLayout[i] != nullptr);
+                RequestMatrixFromPool(multiOutputNode->m_outputsGradient[i], matrixPool, multiOutputNode->m_outputsShape[i].GetNumElements(), multiOutputNode->m_outputsMBLayout[i] != nullptr,
+                                      /*isWorkSpace*/false, /*aliasing*/false, /*isExactSize*/true, multiOutputNode->m_outputsMBLayout[i]);
         }
     }
 
@@ -1921,14 +1951,16 @@ protected:
     // if the matrix's size will scale with minibatch size, set mbScale = true 
     // if workspace flag is true, the memory request will be treated specially. We assume workspace memory will share their own pointers 
     // this is currently a workaround for workspace memory for convolutions
-    void RequestMatrixFromPool(shared_ptr<Matrix<ElemType>>& matrixPtr, MatrixPool& matrixPool, size_t matrixSize=0, bool mbScale=false, bool isWorkSpace=false, bool aliasing=false)
+    // if isExactSize, the matrix will always be [matrixSize x pMBLayout->GetNumCols()] (or [matrixSize x 1] without layout), as for node values and gradients
+    void RequestMatrixFromPool(shared_ptr<Matrix<ElemType>>& matrixPtr, MatrixPool& matrixPool, size_t matrixSize=0, bool mbScale=false, bool isWorkSpace=false, bool aliasing=false,
+                               bool isExactSize=false, const MBLayoutPtr& pMBLayout=nullptr)
     {
         if (matrixPtr == nullptr)
         {
             if (aliasing)
-                matrixPool.RequestAliasedAllocate<ElemType>(m_deviceId, this, &matrixPtr, matrixSize, mbScale);
+                matrixPool.RequestAliasedAllocate<ElemType>(m_deviceId, this, &matrixPtr, matrixSize, mbScale, isExactSize, pMBLayout);
             else
-                matrixPool.RequestAllocate<ElemType>(m_deviceId, &matrixPtr, matrixSize, mbScale, isWorkSpace);
+                matrixPool.RequestAllocate<ElemType>(m_deviceId, &matrixPtr, matrixSize, mbScale, isWorkSpace, isExactSize, pMBLayout);
         }
     }
 
@@ -2246,6 +2278,7 @@ public:
     virtual void MaskMissingGradientColumnsToZero(const Microsoft::MSR::CNTK::FrameRange&) override { NOT_IMPLEMENTED; }
     virtual void InvalidateMissingValueColumns(const Microsoft::MSR::CNTK::FrameRange&) override { NOT_IMPLEMENTED; }
     virtual void InvalidateMissingGradientColumns(const Microsoft::MSR::CNTK::FrameRange&) override { NOT_IMPLEMENTED; }
+    virtual void ForwardPropFusedChain(const Microsoft::MSR::CNTK::FrameRange&) override { NOT_IMPLEMENTED; }
     virtual void NotifyFunctionValuesMBSizeModified(void) override { NOT_IMPLEMENTED; }
     virtual std::wstring ToString(void) const override { NOT_IMPLEMENTED; }
     // these are meant to be called during computation, so provide dummy implementations
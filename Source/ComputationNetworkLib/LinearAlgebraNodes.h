@@ -87,6 +87,12 @@ public:
 
         return this->InputMatchesOutput(i) ? ParentGradientOptimization::Reuse : ParentGradientOptimization::Overwrite;
     }
+
+    virtual bool GetElementwiseOpCode(ElementWiseOperator& op) const override
+    {
+        op = ElementWiseOperator::opSum;
+        return true;
+    }
 };
 
 template class PlusNode<float>;
@@ -283,6 +289,12 @@ public:
         // only left operand can use gradient overwrite optimization
         return (Input(0).get() == input && this->InputMatchesOutput(0)) ? ParentGradientOptimization::Reuse : ParentGradientOptimization::Overwrite;
     }
+
+    virtual bool GetElementwiseOpCode(ElementWiseOperator& op) const override
+    {
+        op = ElementWiseOperator::opDifference;
+        return true;
+    }
 };
 
 template class MinusNode<float>;
@@ -327,6 +339,12 @@ public:
         return ParentGradientOptimization::Overwrite;
     }
 
+    virtual bool GetElementwiseOpCode(ElementWiseOperator& op) const override
+    {
+        op = ElementWiseOperator::opElementwiseProduct;
+        return true;
+    }
+
     template <typename classType>
     static void ForwardPropImpl(classType& c, const FrameRange& fr, bool allowBroadcast)
     {
@@ -998,6 +1016,11 @@ public:
     size_t OutputRank() const { return m_outputRank; }
     int InferInputRankToMap() const { return m_inferInputRankToMap; }
 
+    // Replaces the multiplier used by the forward product on the CPU, e.g. by a HalfPrecisionMultiplier
+    // that keeps a constant input 0 in 16 bits. Only dense, untransposed products use it.
+    void SetMultiplier(shared_ptr<QuantizedMultiplier<ElemType>> multiplier) { m_pQuantizedMultiplier = multiplier; }
+    shared_ptr<QuantizedMultiplier<ElemType>> GetMultiplier() const { return m_pQuantizedMultiplier; }
+
 protected: 
     shared_ptr<QuantizedMultiplier<ElemType>> m_pQuantizedMultiplier;
 
@@ -9,6 +9,7 @@
 #include <stdexcept>
 #include <vector>
 #include <set>
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -18,6 +19,7 @@
 #include "Basics.h"
 #include "Matrix.h"
 #include "ComputationNode.h"
+#include "Globals.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -32,11 +34,19 @@ struct MemRequestInfo
     int allocStep;                              // at what step counter memory allocation is requested 
     int releaseStep;                            // at what step counter memory release is requested  
     int memoryId;                               // integer indexing the memory buffer ID 
-    MemRequestInfo(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace, int allocStep)
-        :deviceId(deviceId), matrixSize(matrixSize), mbScale(mbScale), isWorkSpace(isWorkSpace), allocStep(allocStep), releaseStep(INT_MAX), memoryId(-1)
+    bool isExactSize;                           // matrixSize is exactly the number of elements per column of pMBLayout (or of the matrix, without layout)
+    MBLayoutPtr pMBLayout;                      // layout that determines the number of columns, if isExactSize
+    size_t arenaOffset;                         // where the matrix was placed in its device's arena (in elements)
+    size_t arenaSize;                           // and how many elements it was given there
+    MemRequestInfo(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace, int allocStep,
+                   bool isExactSize = false, const MBLayoutPtr& pMBLayout = nullptr)
+        :deviceId(deviceId), matrixSize(matrixSize), mbScale(mbScale), isWorkSpace(isWorkSpace), allocStep(allocStep), releaseStep(INT_MAX), memoryId(-1),
+        isExactSize(isExactSize), pMBLayout(pMBLayout), arenaOffset(0), arenaSize(0)
     {
         pMatrixPtrs.push_back(pMatrixPtr);
     }
+    // number of elements the matrix needs for the current minibatch
+    size_t ExactSize() const { return pMBLayout ? matrixSize * pMBLayout->GetNumCols() : matrixSize; }
     void SetReleaseStep(int step) { releaseStep = step; }
     void SetMemoryId(int id) { memoryId = id;  }
 };
@@ -64,6 +74,13 @@ struct MemAllocInfo
 // MatrixPool -- class to support memory sharing
 // Despite the gather general name of this class, it is specifically designed to support the memory sharing of ComputationNodes.
 // Note: see #define SUPRESS_MEMSHARING below as for how to temporarily disable memory sharing altogether, for debugging
+//
+// With Globals::ShouldUseMatrixPoolArena(), requests of exactly known size whose number of columns is given by one of the
+// input layouts (see SetInputLayouts()) do not take part in the buffer sharing below. Instead, once the minibatch size is
+// known (PlanArenasForMinibatch()), they are packed by their lifetimes into a single arena per device: each request
+// gets a fixed offset such that no two requests that are alive at the same time overlap. Their matrices use their part of
+// the arena as an external buffer, within which they can be resized. The arenas are re-planned whenever a minibatch needs
+// more space than planned.
 class MatrixPool
 {
 public:
@@ -78,6 +95,18 @@ protected:
     template <class ElemType>
     vector<MemRequestInfo<ElemType>>& GetMemRequestInfoVec();
 
+    // requests placed in the arenas, and the arena of each device
+    vector<MemRequestInfo<float>> m_arenaRequestInfoFloatVec;
+    vector<MemRequestInfo<double>> m_arenaRequestInfoDoubleVec;
+    map<DEVICEID_TYPE, shared_ptr<Matrix<float>>> m_floatArenas;
+    map<DEVICEID_TYPE, shared_ptr<Matrix<double>>> m_doubleArenas;
+    set<MBLayoutPtr> m_inputLayouts; // layouts that are known before ForwardProp() is called
+
+    template <class ElemType>
+    vector<MemRequestInfo<ElemType>>& GetArenaRequestInfoVec();
+    template <class ElemType>
+    map<DEVICEID_TYPE, shared_ptr<Matrix<ElemType>>>& GetArenas();
+
     // MatrixPool allows a bunch of node to share one matrix
 
     struct AliasInfo
@@ -133,11 +162,14 @@ public:
     // global memory allocation optimziation is run to improve memory efficiency 
     // mbScale is another flag indicating if the size of the memory will scale w.r.t. the minibatch size. Unfortunately, at the time of memory
     // request and pointer assignment, we don't known the minibatch size. Thus our memory sharing algorithm is sub-optimal. 
+    // isExactSize means that matrixSize is exact, and that the matrix will have as many columns as pMBLayout (or one, without a layout).
+    // Only such requests can be placed in an arena.
     template <class ElemType>
-    void RequestAllocate(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace)
+    void RequestAllocate(DEVICEID_TYPE deviceId, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale, bool isWorkSpace,
+                         bool isExactSize = false, const MBLayoutPtr& pMBLayout = nullptr)
     {
         vector<MemRequestInfo<ElemType>>& memInfoVec = GetMemRequestInfoVec<ElemType>(); 
-        MemRequestInfo<ElemType> memInfo(deviceId, pMatrixPtr, matrixSize, mbScale, isWorkSpace, m_stepCounter);
+        MemRequestInfo<ElemType> memInfo(deviceId, pMatrixPtr, matrixSize, mbScale, isWorkSpace, m_stepCounter, isExactSize, pMBLayout);
         memInfoVec.push_back(memInfo); 
         m_deviceIDSet.insert(deviceId); 
         m_stepCounter++; 
@@ -154,6 +186,19 @@ public:
         return; 
     }
 
+    // the layouts of the input nodes, which are set before ForwardProp() is called; must be called before OptimizedMemoryAllocation()
+    void SetInputLayouts(const set<MBLayoutPtr>& layouts)
+    {
+        m_inputLayouts = layouts;
+    }
+
+    // (re-)plan the arenas if the current minibatch does not fit; to be called before ForwardProp(), once the input layouts are set
+    void PlanArenasForMinibatch()
+    {
+        PlanArenasFunc<float>();
+        PlanArenasFunc<double>();
+    }
+
     void SetAliasInfo(
         const unordered_map<AliasNodePtr, unordered_set<AliasNodePtr>>& groupMap,
         const unordered_map<AliasNodePtr, AliasNodePtr>& rootLookupMap)
@@ -203,7 +248,8 @@ public:
     }
 
     template <class ElemType>
-    void RequestAliasedAllocate(DEVICEID_TYPE deviceId, AliasNodePtr node, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale)
+    void RequestAliasedAllocate(DEVICEID_TYPE deviceId, AliasNodePtr node, shared_ptr<Matrix<ElemType>>*pMatrixPtr, size_t matrixSize, bool mbScale,
+                                bool isExactSize = false, const MBLayoutPtr& pMBLayout = nullptr)
     {
         const auto iter = m_aliasLookup.find(node);
         if (iter == m_aliasLookup.end())
@@ -215,13 +261,17 @@ public:
         {
             // first allocation for the group
             aliasInfo.pMatrixPtr = pMatrixPtr;
-            RequestAllocate(deviceId, pMatrixPtr, matrixSize, mbScale, false);
+            RequestAllocate(deviceId, pMatrixPtr, matrixSize, mbScale, false, isExactSize, pMBLayout);
         }
         else
         {
             auto aliasRootMatrixPtr = (shared_ptr<Matrix<ElemType>>*)aliasInfo.pMatrixPtr;
             *pMatrixPtr = *aliasRootMatrixPtr;
-            GetMemInfo<ElemType>(aliasRootMatrixPtr)->pMatrixPtrs.push_back(pMatrixPtr);
+            auto memInfo = GetMemInfo<ElemType>(aliasRootMatrixPtr);
+            memInfo->pMatrixPtrs.push_back(pMatrixPtr);
+            // the group only has an exact size if all its members agree on it
+            if (!isExactSize || memInfo->matrixSize != matrixSize || memInfo->pMBLayout != pMBLayout)
+                memInfo->isExactSize = false;
         }
     }
 
@@ -271,6 +321,29 @@ private:
                 iter++; 
         }
 
+        // move the requests that go into the arenas out of the way; they are placed once the minibatch size is known
+        if (Globals::ShouldUseMatrixPoolArena())
+        {
+            vector<MemRequestInfo<ElemType>>& arenaInfoVec = GetArenaRequestInfoVec<ElemType>();
+            auto isArenaRequest = [this](const MemRequestInfo<ElemType>& memInfo)
+            {
+                return memInfo.isExactSize && !memInfo.isWorkSpace && (!memInfo.pMBLayout || m_inputLayouts.find(memInfo.pMBLayout) != m_inputLayouts.end());
+            };
+            for (auto& memInfo : memInfoVec)
+            {
+                if (!isArenaRequest(memInfo))
+                    continue;
+                // all pointers of the request share one matrix, which gets bound to its part of the arena later
+                auto matrixPtr = make_shared<Matrix<ElemType>>(memInfo.deviceId);
+                for (auto pOutMatrixPtr : memInfo.pMatrixPtrs)
+                    *pOutMatrixPtr = matrixPtr;
+                arenaInfoVec.push_back(memInfo);
+            }
+            memInfoVec.erase(std::remove_if(memInfoVec.begin(), memInfoVec.end(), isArenaRequest), memInfoVec.end());
+            if (memInfoVec.empty())
+                return;
+        }
+
         // sort the memory request from largest size to smallest 
         std::sort(memInfoVec.begin(), memInfoVec.end(), greater_than_mem_req_size<ElemType>());
 
@@ -386,6 +459,103 @@ private:
             }
         }
     }
+
+    template <class ElemType>
+    void PlanArenasFunc()
+    {
+        vector<MemRequestInfo<ElemType>>& arenaInfoVec = GetArenaRequestInfoVec<ElemType>();
+        if (arenaInfoVec.empty())
+            return;
+
+        auto& arenas = GetArenas<ElemType>();
+        bool fits = !arenas.empty();
+        for (const auto& memInfo : arenaInfoVec)
+            fits &= memInfo.ExactSize() <= memInfo.arenaSize;
+        if (fits)
+            return;
+
+        for (auto& devId : m_deviceIDSet)
+        {
+            // place the largest requests first, each at the lowest offset that is not used by any placed request alive at the same time
+            vector<MemRequestInfo<ElemType>*> placed;
+            vector<MemRequestInfo<ElemType>*> requests;
+            for (auto& memInfo : arenaInfoVec)
+            {
+                if (memInfo.deviceId == devId)
+                    requests.push_back(&memInfo);
+            }
+            if (requests.empty())
+                continue;
+            std::stable_sort(requests.begin(), requests.end(), [](const MemRequestInfo<ElemType>* a, const MemRequestInfo<ElemType>* b) { return a->ExactSize() > b->ExactSize(); });
+
+            const size_t alignment = 256 / sizeof(ElemType); // keep every matrix aligned for the GPU
+            size_t arenaSize = 0;
+            size_t totalSize = 0;
+            vector<pair<size_t, size_t>> busy; // [begin, end) of the placed requests that overlap in time with the current one
+            for (auto memInfo : requests)
+            {
+                busy.clear();
+                for (auto other : placed)
+                {
+                    if (memInfo->allocStep <= other->releaseStep && memInfo->releaseStep >= other->allocStep)
+                        busy.push_back(make_pair(other->arenaOffset, other->arenaOffset + other->arenaSize));
+                }
+                std::sort(busy.begin(), busy.end());
+
+                const size_t size = memInfo->ExactSize();
+                size_t offset = 0;
+                for (const auto& range : busy)
+                {
+                    if (offset + size <= range.first)
+                        break;
+                    offset = std::max(offset, (range.second + alignment - 1) / alignment * alignment);
+                }
+                memInfo->arenaOffset = offset;
+                memInfo->arenaSize = size;
+                placed.push_back(memInfo);
+                arenaSize = std::max(arenaSize, offset + size);
+                totalSize += size;
+            }
+
+            // for comparison: the peak of the buffer sharing done by OptimizedMemoryAllocationFunc(), with the actual sizes
+            vector<pair<size_t, vector<pair<int, int>>>> buffers;
+            for (auto memInfo : requests)
+            {
+                auto occ = make_pair(memInfo->allocStep, memInfo->releaseStep);
+                auto iter = buffers.begin();
+                while (iter != buffers.end() && CheckOverlap(occ, iter->second))
+                    iter++;
+                if (iter == buffers.end())
+                    buffers.push_back(make_pair(memInfo->ExactSize(), vector<pair<int, int>>(1, occ)));
+                else
+                    iter->second.push_back(occ);
+            }
+            size_t sharedSize = 0;
+            for (const auto& buffer : buffers)
+                sharedSize += buffer.first;
+
+            // free the old arena before allocating the new one; its matrices are all rebound below
+            auto& arena = arenas[devId];
+            arena = nullptr;
+            arena = make_shared<Matrix<ElemType>>(arenaSize, 1, devId);
+            ElemType* base = arenaSize > 0 ? arena->Data() : nullptr;
+            for (auto memInfo : requests)
+            {
+                auto& matrix = **memInfo->pMatrixPtrs[0];
+                if (matrix.GetMatrixType() == SPARSE) // replaced by the node since the last plan; keeps its own memory
+                    continue;
+                const size_t rows = matrix.GetNumRows();
+                const size_t cols = matrix.GetNumCols();
+                matrix.SetValue(memInfo->arenaSize, 1, devId, base ? base + memInfo->arenaOffset : nullptr, matrixFlagDontOwnBuffer);
+                if (rows * cols <= memInfo->arenaSize)
+                    matrix.Resize(rows, cols);
+            }
+
+            const double MB = 1024.0 * 1024.0 / sizeof(ElemType);
+            fprintf(stderr, "MatrixPool: Planned %d matrices on device %d into an arena of %.1f MB (%.1f MB with shared buffers, %.1f MB without sharing).\n",
+                    (int) requests.size(), (int) devId, arenaSize / MB, sharedSize / MB, totalSize / MB);
+        }
+    }
 };
 
 }}}
@@ -100,6 +100,12 @@ public:
     }
 
     virtual ParentGradientOptimization ImplementsGradientOptimization(const ComputationNodeBase*) const override { return (opType != noGradient) ? ParentGradientOptimization::Overwrite : ParentGradientOptimization::None; }
+
+    virtual bool GetElementwiseOpCode(ElementWiseOperator& op) const override
+    {
+        op = opForward;
+        return true;
+    }
 };
 
 #define UnaryElementWiseWithOpCodeNodeBaseMembers UsingComputationNodeMembersBoilerplate;
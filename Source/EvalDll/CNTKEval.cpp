@@ -37,6 +37,9 @@ void CNTKEvalBase<ElemType>::Init(const std::string& config)
     CPUMatrix<ElemType>::SetNumThreads(nThreads);
 
     Globals::SetShareNodeValueMatrices(m_config(L"shareNodeValueMatrices", true));
+    Globals::SetElementwiseChainFusion(m_config(L"fuseElementwiseChains", false));
+    Globals::SetMatrixPoolArena(m_config(L"matrixPoolArena", false));
+    Globals::SetRecurrentGemmBatching(m_config(L"batchRecurrentGemms", false));
 }
 
 
@@ -233,7 +236,7 @@ template class CNTKEval<float>;
 // ----------------------------------------------------------------------------
 
 template<typename ElemType>
-VariableLayout CNTKEvalExtended<ElemType>::ToVariableLayout(const ComputationNodeBasePtr n) 
+VariableLayout CNTKEvalBase<ElemType>::ToVariableLayout(const ComputationNodeBasePtr n) 
 {
     auto matrix = dynamic_pointer_cast<Matrix<ElemType>>(n->ValuePtr());
     return VariableLayout
@@ -277,7 +280,7 @@ VariableSchema CNTKEvalExtended<ElemType>::GetOutputSchema() const
     auto& nodes = m_started ? m_outputNodes : this->m_net->OutputNodes();
     for (const auto& n : nodes)
     {
-        schema.push_back(ToVariableLayout(n));
+        schema.push_back(this->ToVariableLayout(n));
     }
     return schema;
 }
@@ -295,7 +298,7 @@ VariableSchema CNTKEvalExtended<ElemType>::GetInputSchema() const
 
     for (const auto& n : nodes)
     {
-        inputLayouts.push_back(ToVariableLayout(n));
+        inputLayouts.push_back(this->ToVariableLayout(n));
     }
     return inputLayouts;
 }
@@ -455,4 +458,379 @@ extern "C" EVAL_API void GetEvalExtendedD(IEvaluateModelExtended<double>** peval
 
 template class CNTKEvalExtended<double>;
 template class CNTKEvalExtended<float>;
+
+// ----------------------------------------------------------------------------
+// Batched interface
+// ----------------------------------------------------------------------------
+
+template <typename ElemType>
+void CNTKEvalBatched<ElemType>::Init(const std::string& config)
+{
+    CNTKEvalBase<ElemType>::Init(config);
+    size_t numWorkers = this->m_config("numWorkers", "1");
+    size_t maxBatchSize = this->m_config("maxBatchSize", "32");
+    double maxBatchLatencyMs = this->m_config("maxBatchLatencyMs", "2");
+    m_numWorkers = max<size_t>(numWorkers, 1);
+    m_maxBatchSize = max<size_t>(maxBatchSize, 1);
+    m_maxBatchLatency = std::chrono::microseconds((long long)(1000 * maxBatchLatencyMs));
+}
+
+// Creates one network per worker. The parameters of every network are replaced by those of the first one
+// right after it was created, so that only one copy of the model is kept.
+template <typename ElemType>
+void CNTKEvalBatched<ElemType>::CreateNetwork(const std::string& networkDescription)
+{
+    if (!m_workers.empty())
+        LogicError("CreateNetwork() can only be called once.");
+
+    for (size_t i = 0; i < m_numWorkers; i++)
+    {
+        CNTKEvalBase<ElemType>::CreateNetwork(networkDescription);
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker()));
+        m_workers.back()->m_net = this->m_net;
+        if (i == 0)
+            continue;
+
+        const auto& sharedNet = m_workers.front()->m_net;
+        for (const auto& node : this->m_net->GetAllNodes())
+        {
+            if (node->OperationName() != OperationNameOf(LearnableParameter))
+                continue;
+
+            auto sharedNode = sharedNet->NodeNameExists(node->NodeName()) ? sharedNet->GetNodeFromName(node->NodeName()) : nullptr;
+            if (!sharedNode || sharedNode->OperationName() != node->OperationName() || sharedNode->GetSampleLayout() != node->GetSampleLayout())
+                LogicError("CreateNetwork: Parameter '%ls' differs between the networks of the workers.", node->NodeName().c_str());
+            dynamic_pointer_cast<ComputationNode<ElemType>>(node)->ValuePtrRef() = dynamic_pointer_cast<ComputationNode<ElemType>>(sharedNode)->ValuePtrRef();
+        }
+    }
+    this->m_net = m_workers.front()->m_net;
+}
+
+template <typename ElemType>
+void CNTKEvalBatched<ElemType>::StartForwardEvaluation(const std::vector<wstring>& outputNodeNames)
+{
+    if (m_started)
+        LogicError("StartForwardEvaluation() can only be called once.");
+    if (m_workers.empty())
+        LogicError("StartForwardEvaluation() called before CreateNetwork().");
+
+    for (auto& worker : m_workers)
+    {
+        auto& net = worker->m_net;
+        worker->m_scopedNetworkOperationMode = make_shared<ScopedNetworkOperationMode>(net, NetworkOperationMode::inferring);
+        worker->m_outputNodes = net->OutputNodesByName(outputNodeNames);
+        worker->m_inputNodes = net->InputNodesForOutputs(outputNodeNames);
+        net->AllocateAllMatrices({}, worker->m_outputNodes, nullptr);
+        net->StartEvaluateMinibatchLoop(worker->m_outputNodes);
+
+        for (const auto& node : worker->m_outputNodes)
+        {
+            if (dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr())->GetMatrixType() != MatrixType::DENSE)
+                RuntimeError("Sparse outputs are not supported by this API.");
+        }
+    }
+
+    m_started = true;
+    for (auto& worker : m_workers)
+    {
+        Worker* w = worker.get();
+        w->m_thread = std::thread([this, w]() { RunWorker(*w); });
+    }
+}
+
+template <typename ElemType>
+VariableSchema CNTKEvalBatched<ElemType>::GetOutputSchema() const
+{
+    VariableSchema schema;
+    auto& nodes = m_started ? m_workers.front()->m_outputNodes : this->m_net->OutputNodes();
+    for (const auto& n : nodes)
+        schema.push_back(this->ToVariableLayout(n));
+    return schema;
+}
+
+template <typename ElemType>
+VariableSchema CNTKEvalBatched<ElemType>::GetInputSchema() const
+{
+    VariableSchema schema;
+    auto nodes = m_started ? m_workers.front()->m_inputNodes : this->m_net->InputNodesForOutputs({});
+    for (const auto& n : nodes)
+        schema.push_back(this->ToVariableLayout(n));
+    return schema;
+}
+
+template <typename ElemType>
+std::future<Values<ElemType>> CNTKEvalBatched<ElemType>::ForwardPassAsync(Values<ElemType>&& inputs)
+{
+    if (!m_started)
+        RuntimeError("ForwardPassAsync() called before StartForwardEvaluation()");
+
+    Request request;
+    request.m_inputs = std::move(inputs);
+    request.m_arrivalTime = std::chrono::steady_clock::now();
+    auto result = request.m_result.get_future();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_stop)
+            RuntimeError("ForwardPassAsync() called after Destroy()");
+        m_queue.push_back(std::move(request));
+    }
+    m_queueChanged.notify_all();
+    return result;
+}
+
+template <typename ElemType>
+bool CNTKEvalBatched<ElemType>::GetNextBatch(std::vector<Request>& batch)
+{
+    batch.clear();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_queueChanged.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty())
+            return false;
+
+        // Wait for more requests until the batch is full or the oldest request has waited long enough.
+        auto deadline = m_queue.front().m_arrivalTime + m_maxBatchLatency;
+        if (m_stop || m_queue.size() >= m_maxBatchSize || std::chrono::steady_clock::now() >= deadline)
+            break;
+        m_queueChanged.wait_until(lock, deadline);
+    }
+
+    size_t batchSize = min(m_queue.size(), m_maxBatchSize);
+    for (size_t i = 0; i < batchSize; i++)
+    {
+        batch.push_back(std::move(m_queue.front()));
+        m_queue.pop_front();
+    }
+
+    // let other workers pick up the remaining requests
+    if (!m_queue.empty())
+        m_queueChanged.notify_all();
+    return true;
+}
+
+template <typename ElemType>
+void CNTKEvalBatched<ElemType>::RunWorker(Worker& worker)
+{
+    std::vector<Request> batch;
+    while (GetNextBatch(batch))
+    {
+        try
+        {
+            ForwardPassBatch(worker, batch);
+        }
+        catch (...)
+        {
+            for (auto& request : batch)
+                request.m_result.set_exception(std::current_exception());
+        }
+    }
+}
+
+// Evaluates the requests as one minibatch, with request 's' as parallel sequence 's', padded with gaps to the
+// length of the longest request, and returns each request the outputs of its sequence.
+// Requests with invalid inputs fail on their own and are dropped from the minibatch.
+template <typename ElemType>
+void CNTKEvalBatched<ElemType>::ForwardPassBatch(Worker& worker, std::vector<Request>& batch)
+{
+    const auto& inputNodes = worker.m_inputNodes;
+
+    // validate the requests and determine the number of samples of each input
+    std::vector<std::vector<size_t>> lengths; // [request][input]
+    for (size_t r = 0; r < batch.size();)
+    {
+        try
+        {
+            const auto& inputs = batch[r].m_inputs;
+            if (inputs.size() != inputNodes.size())
+                RuntimeError("Expected %d inputs, but got %d.", (int)inputNodes.size(), (int)inputs.size());
+
+            std::vector<size_t> requestLengths;
+            for (size_t i = 0; i < inputNodes.size(); i++)
+            {
+                const auto& buffer = inputs[i];
+                auto type = dynamic_pointer_cast<Matrix<ElemType>>(inputNodes[i]->ValuePtr())->GetMatrixType();
+                size_t numRows = inputNodes[i]->GetSampleLayout().GetNumElements();
+                size_t numCols;
+                if (type == MatrixType::DENSE)
+                {
+                    if (buffer.m_buffer.empty() || buffer.m_buffer.size() % numRows != 0)
+                        RuntimeError("Input %ls: Expected input data to be a non-zero multiple of %" PRIu64 ", but it is %" PRIu64 ".",
+                                     inputNodes[i]->GetName().c_str(), numRows, buffer.m_buffer.size());
+                    numCols = buffer.m_buffer.size() / numRows;
+                }
+                else
+                {
+                    if (buffer.m_colIndices.size() < 2 || buffer.m_colIndices.front() != 0 ||
+                        buffer.m_colIndices.back() != buffer.m_indices.size() || buffer.m_indices.size() != buffer.m_buffer.size())
+                        RuntimeError("Input %ls: Invalid sparse input, expected at least one element and consistent column indices, indices and values.",
+                                     inputNodes[i]->GetName().c_str());
+                    numCols = buffer.m_colIndices.size() - 1;
+                }
+                requestLengths.push_back(numCols);
+            }
+            lengths.push_back(std::move(requestLengths));
+            r++;
+        }
+        catch (...)
+        {
+            batch[r].m_result.set_exception(std::current_exception());
+            batch.erase(batch.begin() + r);
+        }
+    }
+    if (batch.empty())
+        return;
+
+    const size_t numSequences = batch.size();
+    for (size_t i = 0; i < inputNodes.size(); i++)
+    {
+        auto& inputNode = inputNodes[i];
+        auto matrix = dynamic_pointer_cast<Matrix<ElemType>>(inputNode->ValuePtr());
+        size_t numRows = inputNode->GetSampleLayout().GetNumElements();
+
+        size_t numTimeSteps = 0;
+        for (size_t s = 0; s < numSequences; s++)
+            numTimeSteps = max(numTimeSteps, lengths[s][i]);
+
+        auto pMBLayout = inputNode->GetMBLayout();
+        pMBLayout->Init(numSequences, numTimeSteps);
+        for (size_t s = 0; s < numSequences; s++)
+        {
+            pMBLayout->AddSequence(s, s, 0, lengths[s][i]);
+            if (lengths[s][i] < numTimeSteps)
+                pMBLayout->AddGap(s, lengths[s][i], numTimeSteps);
+        }
+
+        // column of time step t of sequence s is t * numSequences + s
+        const size_t numCols = numSequences * numTimeSteps;
+        if (matrix->GetMatrixType() == MatrixType::DENSE)
+        {
+            std::vector<ElemType> data(numRows * numCols, 0);
+            for (size_t s = 0; s < numSequences; s++)
+            {
+                const ElemType* source = batch[s].m_inputs[i].m_buffer.data();
+                for (size_t t = 0; t < lengths[s][i]; t++)
+                    memcpy(&data[(t * numSequences + s) * numRows], source + t * numRows, numRows * sizeof(ElemType));
+            }
+            matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), data.data(), matrixFlagNormal);
+        }
+        else
+        {
+            std::vector<int> colIndices(numCols + 1, 0);
+            for (size_t t = 0; t < numTimeSteps; t++)
+                for (size_t s = 0; s < numSequences; s++)
+                {
+                    size_t j = t * numSequences + s;
+                    const auto& sourceCols = batch[s].m_inputs[i].m_colIndices;
+                    colIndices[j + 1] = colIndices[j] + (t < lengths[s][i] ? sourceCols[t + 1] - sourceCols[t] : 0);
+                }
+
+            std::vector<int> indices(colIndices.back());
+            std::vector<ElemType> values(colIndices.back());
+            for (size_t s = 0; s < numSequences; s++)
+            {
+                const auto& source = batch[s].m_inputs[i];
+                for (size_t t = 0; t < lengths[s][i]; t++)
+                {
+                    size_t j = t * numSequences + s;
+                    size_t numValues = source.m_colIndices[t + 1] - source.m_colIndices[t];
+                    std::copy_n(source.m_indices.begin() + source.m_colIndices[t], numValues, indices.begin() + colIndices[j]);
+                    std::copy_n(source.m_buffer.begin() + source.m_colIndices[t], numValues, values.begin() + colIndices[j]);
+                }
+            }
+            matrix->SetMatrixFromCSCFormat(colIndices.data(), indices.data(), values.data(), values.size(), numRows, numCols);
+        }
+    }
+
+    ComputationNetwork::BumpEvalTimeStamp(inputNodes);
+    worker.m_net->ForwardProp(worker.m_outputNodes);
+
+    // scatter the outputs back to the requests, using the sequence ids to find the columns of each request
+    std::vector<Values<ElemType>> results(numSequences, Values<ElemType>(worker.m_outputNodes.size()));
+    std::vector<ElemType> output;
+    for (size_t o = 0; o < worker.m_outputNodes.size(); o++)
+    {
+        auto& node = worker.m_outputNodes[o];
+        auto outputMatrix = dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr());
+        size_t numRows = node->GetSampleLayout().GetNumElements();
+        output.resize(outputMatrix->GetNumElements());
+        ElemType* data = output.data();
+        size_t size = output.size();
+        outputMatrix->CopyToArray(data, size);
+
+        auto pMBLayout = node->GetMBLayout();
+        if (!pMBLayout)
+        {
+            // not dependent on the inputs: every request gets the same value
+            for (auto& result : results)
+                result[o].m_buffer = output;
+            continue;
+        }
+
+        const size_t numParallelSequences = pMBLayout->GetNumParallelSequences();
+        const size_t numTimeSteps = pMBLayout->GetNumTimeSteps();
+        for (const auto& seq : pMBLayout->GetAllSequences())
+        {
+            if (seq.seqId == GAP_SEQUENCE_ID)
+                continue;
+            if (seq.seqId >= numSequences)
+                LogicError("Output %ls: Unexpected sequence id %" PRIu64 ".", node->GetName().c_str(), (uint64_t)seq.seqId);
+
+            auto& buffer = results[seq.seqId][o].m_buffer;
+            for (size_t t = (size_t)max<ptrdiff_t>(seq.tBegin, 0); t < min(seq.tEnd, numTimeSteps); t++)
+            {
+                const ElemType* column = output.data() + (t * numParallelSequences + seq.s) * numRows;
+                buffer.insert(buffer.end(), column, column + numRows);
+            }
+        }
+    }
+
+    for (size_t s = 0; s < numSequences; s++)
+        batch[s].m_result.set_value(std::move(results[s]));
+}
+
+template <typename ElemType>
+void CNTKEvalBatched<ElemType>::StopWorkers()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_queueChanged.notify_all();
+    for (auto& worker : m_workers)
+    {
+        if (worker->m_thread.joinable())
+            worker->m_thread.join();
+    }
+}
+
+// Serves all queued requests before destroying the networks.
+template <typename ElemType>
+void CNTKEvalBatched<ElemType>::Destroy()
+{
+    StopWorkers();
+    for (auto& worker : m_workers)
+        worker->m_scopedNetworkOperationMode.reset();
+    m_workers.clear();
+    CNTKEvalBase<ElemType>::Destroy();
+    delete this;
+}
+
+template <typename ElemType>
+void EVAL_API GetEvalBatched(IEvaluateModelBatched<ElemType>** peval)
+{
+    *peval = new CNTKEvalBatched<ElemType>();
+}
+
+extern "C" EVAL_API void GetEvalBatchedF(IEvaluateModelBatched<float>** peval)
+{
+    GetEvalBatched(peval);
+}
+extern "C" EVAL_API void GetEvalBatchedD(IEvaluateModelBatched<double>** peval)
+{
+    GetEvalBatched(peval);
+}
+
+template class CNTKEvalBatched<double>;
+template class CNTKEvalBatched<float>;
 } } }
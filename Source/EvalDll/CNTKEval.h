@@ -13,6 +13,11 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "Eval.h"
 #include "EvalReader.h"
@@ -32,6 +37,8 @@ protected:
 
     // constructor
     CNTKEvalBase() : m_net(nullptr) { }
+
+    static VariableLayout ToVariableLayout(const ComputationNodeBasePtr n);
 public:
 
     // CreateNetwork - create a network based on the network description
@@ -120,7 +127,6 @@ public:
     }
 
 private:
-    static VariableLayout ToVariableLayout(const ComputationNodeBasePtr n);
     std::vector<ComputationNodeBasePtr> m_outputNodes;
     std::shared_ptr<ScopedNetworkOperationMode> m_scopedNetworkOperationMode;
     std::vector<ComputationNodeBasePtr> m_inputNodes;
@@ -132,4 +138,67 @@ private:
                       std::vector < ValueBuffer<ElemType, ValueContainer> >& outputs, bool resetRNN);
 
 };
+
+// ------------------------------------------------------------------------
+// Batched interface
+// ------------------------------------------------------------------------
+template <typename ElemType>
+class CNTKEvalBatched : public CNTKEvalBase<ElemType>, public IEvaluateModelBatched<ElemType>
+{
+public:
+    CNTKEvalBatched() : CNTKEvalBase<ElemType>(),
+        m_numWorkers(1), m_maxBatchSize(32), m_maxBatchLatency(std::chrono::milliseconds(2)), m_started(false), m_stop(false) {}
+
+    virtual VariableSchema GetOutputSchema() const override;
+
+    virtual void StartForwardEvaluation(const std::vector<wstring>& outputs) override;
+
+    virtual VariableSchema GetInputSchema() const override;
+
+    virtual std::future<Values<ElemType>> ForwardPassAsync(Values<ElemType>&& inputs) override;
+
+    virtual void Destroy() override;
+
+    virtual void CreateNetwork(const std::string& networkDescription) override;
+
+    virtual void Init(const std::string& config) override;
+
+private:
+    struct Request
+    {
+        Values<ElemType> m_inputs;
+        std::promise<Values<ElemType>> m_result;
+        std::chrono::steady_clock::time_point m_arrivalTime;
+    };
+
+    // A network that shares its parameters with all other workers, with its own activations (MatrixPool).
+    struct Worker
+    {
+        ComputationNetworkPtr m_net;
+        std::vector<ComputationNodeBasePtr> m_inputNodes;
+        std::vector<ComputationNodeBasePtr> m_outputNodes;
+        std::shared_ptr<ScopedNetworkOperationMode> m_scopedNetworkOperationMode;
+        std::thread m_thread;
+    };
+
+    void RunWorker(Worker& worker);
+
+    // Waits for the next minibatch of requests; returns false once stopped and all requests are served.
+    bool GetNextBatch(std::vector<Request>& batch);
+
+    void ForwardPassBatch(Worker& worker, std::vector<Request>& batch);
+
+    void StopWorkers();
+
+    size_t m_numWorkers;
+    size_t m_maxBatchSize;
+    std::chrono::steady_clock::duration m_maxBatchLatency;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    bool m_started;
+
+    std::deque<Request> m_queue;
+    bool m_stop;
+    std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+};
 } } }
@@ -28,6 +28,8 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 
 double logadd(double x, double y);
 
+template <class ElemType> class CPURNNExecutor;
+
 // To comply with BLAS libraries matrices are stored in ColMajor. However, by default C/C++/C# use RowMajor
 // conversion is need when passing data between CPUMatrix and C++ matrices
 template <class ElemType>
@@ -111,6 +113,23 @@ public:
     void AdaDelta(CPUMatrix<ElemType>& gradients, CPUMatrix<ElemType>& functionValues, ElemType learningRate, ElemType rho, ElemType epsilon);
     void AdaDeltaFlushTimestamps(size_t cols, ElemType rho, int* timestamps, int currentTimestamp);
 
+    // Lazy updates of block sparse gradients (see CPUSparseMatrix::MomentumSGD, FSAdagrad and Adam): 'this' is the
+    // smoothed gradient. The flush brings every column up to date with currentTimestamp and resets its timestamp.
+    void MomentumSGDFlushTimestamps(CPUMatrix<ElemType>& functionValues, ElemType momentum, int* timestamps, int currentTimestamp);
+    void FSAdagradFlushTimestamps(CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight,
+                                  int* timestamps, int currentTimestamp);
+    void AdamFlushTimestamps(CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight,
+                             ElemType epsilon, bool adamax, const double* biasCorrections, int* timestamps, int currentTimestamp);
+
+    // Apply to one column the updates that the dense implementation makes during 'skipped' minibatches
+    // in which the gradient of the column is zero.
+    static void MomentumSGDCatchUp(ElemType* smoothMom, ElemType* val, size_t rows, ElemType momentum, int skipped);
+    static void FSAdagradCatchUp(ElemType* smoothAda, ElemType* smoothMom, ElemType* val, size_t rows,
+                                 ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight, int skipped);
+    static void AdamCatchUp(ElemType* smoothAda, ElemType* smoothMom, ElemType* val, size_t rows,
+                            ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight, ElemType epsilon, bool adamax,
+                            const double* biasCorrections, int skipped);
+
     void Reshape(const size_t numRows, const size_t numCols);
 
 
@@ -419,6 +438,11 @@ public:
     void BatchNormalizationBackward(const CPUMatrix<ElemType>& in, CPUMatrix<ElemType>& grad, const CPUMatrix<ElemType>& scale, double blendFactor, const CPUMatrix<ElemType>& saveMean, const CPUMatrix<ElemType>& saveInvStdDev,
                                     CPUMatrix<ElemType>& scaleGrad, CPUMatrix<ElemType>& biasGrad) const;
 
+    // RNN support functions
+    void RNNForward(const CPUMatrix<ElemType>& inputX, const CPUMatrix<ElemType>& paramW, size_t xDim, size_t yDim, const vector<size_t>& numSequencesForFrame, const struct RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace);
+    void RNNBackwardData(const CPUMatrix<ElemType>& outputDY, const CPUMatrix<ElemType>& paramW, CPUMatrix<ElemType>& outputDX, const struct RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace);
+    void RNNBackwardWeights(const CPUMatrix<ElemType>& inputX, const CPUMatrix<ElemType>& outputY, CPUMatrix<ElemType>& dw, const struct RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace);
+
 public:
     // This functions do not depend on <ElemType>, i.e. you can call them on any <ElemType>
     static int SetNumThreads(int numThreads);
@@ -568,6 +592,12 @@ protected:
 private:
     void Clear();
 
+// Have to disable the warning to avoid issues with __declspec(dllexport) on Windows (C4251).
+#pragma warning(push)
+#pragma warning(disable : 4251)
+    mutable std::shared_ptr<CPURNNExecutor<ElemType>> m_rnnExecutor; // for OptimizedRNNStack
+#pragma warning(pop)
+
     void ScatterValues(ElemType* indices, ElemType* value, ElemType* data, ElemType alpha, size_t num_indices, size_t rows, size_t cols, size_t indices_step = 1);
 };
 
@@ -9,8 +9,11 @@
 
 #include "Basics.h"
 #include "File.h"
+#include "Globals.h"
 
 #include "CPUMatrix.h"
+#include "CPUTensorSIMD.h"
+#include "CPURNN.h"
 #include "TensorOps.h"
 #include <assert.h>
 #include <stdexcept>
@@ -874,8 +877,9 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     // if it's externally managed, then populate the structure
     if (matrixFlags & matrixFlagDontOwnBuffer)
     {
-        // free previous array allocation if any before overwriting
-        delete[] Buffer();
+        // free previous array allocation if any before overwriting (unless it was external as well)
+        if (OwnBuffer())
+            delete[] Buffer();
 
         m_numRows = numRows;
         m_numCols = numCols;
@@ -1508,6 +1512,150 @@ void CPUMatrix<ElemType>::AdaDeltaFlushTimestamps(size_t cols, ElemType rho, int
     }
 }
 
+// Sum of momentum^i for i = 1..skipped, i.e. how many times the momentum accumulator (as it was before the
+// skipped minibatches) is subtracted from the model while it decays.
+static double MomentumDecaySum(double momentum, int skipped)
+{
+    if (momentum == 1)
+        return skipped;
+    return momentum * (1 - std::pow(momentum, skipped)) / (1 - momentum);
+}
+
+template <class ElemType>
+/*static*/ void CPUMatrix<ElemType>::MomentumSGDCatchUp(ElemType* smoothMom, ElemType* val, size_t rows, ElemType momentum, int skipped)
+{
+    // With a zero gradient: sg_t = momentum * sg_{t-1}, w_t = w_{t-1} - sg_t
+    if (skipped <= 0)
+        return;
+    const auto decay = (ElemType)std::pow((double)momentum, skipped);
+    const auto decaySum = (ElemType)MomentumDecaySum(momentum, skipped);
+    for (size_t row = 0; row < rows; ++row)
+    {
+        val[row] -= decaySum * smoothMom[row];
+        smoothMom[row] *= decay;
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUMatrix<ElemType>::FSAdagradCatchUp(ElemType* smoothAda, ElemType* smoothMom, ElemType* val, size_t rows,
+                                                      ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight, int skipped)
+{
+    // With a zero gradient the AdaGrad normalization has no effect, the accumulators decay and
+    // the model keeps moving by the momentum accumulator.
+    if (skipped <= 0)
+        return;
+    const auto adaDecay = (ElemType)std::pow((double)adaWeight, skipped);
+    const auto momDecay = (ElemType)std::pow((double)momentum, skipped);
+    const auto momDecaySum = (ElemType)(learnRatePerSample * MomentumDecaySum(momentum, skipped));
+    for (size_t row = 0; row < rows; ++row)
+    {
+        smoothAda[row] *= adaDecay;
+        if (momentum > 0.0f)
+        {
+            val[row] -= momDecaySum * smoothMom[row];
+            smoothMom[row] *= momDecay;
+        }
+    }
+}
+
+template <class ElemType>
+/*static*/ void CPUMatrix<ElemType>::AdamCatchUp(ElemType* smoothAda, ElemType* smoothMom, ElemType* val, size_t rows,
+                                                 ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight, ElemType epsilon, bool adamax,
+                                                 const double* biasCorrections, int skipped)
+{
+    // With a zero gradient both accumulators decay geometrically, but the step size depends on the
+    // bias correction of each minibatch and on epsilon, so the model update has no closed form.
+    // We sum it up minibatch by minibatch, stopping once the momentum has decayed so much relative to
+    // the normalization that the remaining steps are below the precision of ElemType.
+    if (skipped <= 0)
+        return;
+    const double eps = std::numeric_limits<ElemType>::epsilon();
+    int steps = 0;
+    for (double momPow = momentum, adaPow = adaWeight; steps < skipped; ++steps, momPow *= momentum, adaPow *= adaWeight)
+    {
+        if (momPow < eps * (adamax ? adaPow : sqrt(adaPow)))
+            break;
+    }
+
+    const auto adaDecay = (ElemType)std::pow((double)adaWeight, skipped);
+    const auto momDecay = (ElemType)std::pow((double)momentum, skipped);
+    for (size_t row = 0; row < rows; ++row)
+    {
+        const double mom = smoothMom[row];
+        const double ada = smoothAda[row];
+        if (mom != 0)
+        {
+            double delta = 0;
+            double momPow = 1, adaPow = 1;
+            for (int i = 0; i < steps; ++i)
+            {
+                momPow *= momentum;
+                adaPow *= adaWeight;
+                const double norm = adamax ? adaPow * ada : sqrt(adaPow * ada);
+                delta += biasCorrections[i] * momPow * mom / (norm + epsilon);
+            }
+            val[row] -= (ElemType)(delta * learnRatePerSample);
+        }
+        smoothAda[row] = (ElemType)(ada * adaDecay);
+        smoothMom[row] = (ElemType)(mom * momDecay);
+    }
+}
+
+template <class ElemType>
+void CPUMatrix<ElemType>::MomentumSGDFlushTimestamps(CPUMatrix<ElemType>& functionValues, ElemType momentum, int* timestamps, int currentTimestamp)
+{
+    auto rows = functionValues.GetNumRows();
+    auto cols = functionValues.GetNumCols();
+    auto smoothMom = Data();
+    auto val = functionValues.Data();
+#pragma omp parallel for
+    for (long col = 0; col < (long)cols; ++col)
+    {
+        auto offset = rows * col;
+        MomentumSGDCatchUp(smoothMom + offset, val + offset, rows, momentum, currentTimestamp - timestamps[col]);
+        timestamps[col] = 0;
+    }
+}
+
+template <class ElemType>
+void CPUMatrix<ElemType>::FSAdagradFlushTimestamps(CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight,
+                                                   int* timestamps, int currentTimestamp)
+{
+    auto rows = functionValues.GetNumRows();
+    auto cols = functionValues.GetNumCols();
+    auto smoothAda = Data();
+    auto smoothMom = Data() + rows * cols;
+    auto val = functionValues.Data();
+#pragma omp parallel for
+    for (long col = 0; col < (long)cols; ++col)
+    {
+        auto offset = rows * col;
+        FSAdagradCatchUp(smoothAda + offset, smoothMom + offset, val + offset, rows,
+                         learnRatePerSample, momentum, adaWeight, currentTimestamp - timestamps[col]);
+        timestamps[col] = 0;
+    }
+}
+
+template <class ElemType>
+void CPUMatrix<ElemType>::AdamFlushTimestamps(CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight,
+                                              ElemType epsilon, bool adamax, const double* biasCorrections, int* timestamps, int currentTimestamp)
+{
+    // biasCorrections[t] is the bias correction that was used for the minibatch with timestamp t.
+    auto rows = functionValues.GetNumRows();
+    auto cols = functionValues.GetNumCols();
+    auto smoothAda = Data();
+    auto smoothMom = Data() + rows * cols;
+    auto val = functionValues.Data();
+#pragma omp parallel for
+    for (long col = 0; col < (long)cols; ++col)
+    {
+        auto offset = rows * col;
+        AdamCatchUp(smoothAda + offset, smoothMom + offset, val + offset, rows, learnRatePerSample, momentum, adaWeight, epsilon, adamax,
+                    biasCorrections + timestamps[col] + 1, currentTimestamp - timestamps[col]);
+        timestamps[col] = 0;
+    }
+}
+
 template <class ElemType>
 void CPUMatrix<ElemType>::Reshape(const size_t numRows, const size_t numCols)
 {
@@ -1537,11 +1685,16 @@ void CPUMatrix<ElemType>::Resize(const size_t numRows, const size_t numCols, boo
     if (GetNumRows() == numRows && GetNumCols() == numCols)
         return;
 
-    VerifyResizable(__func__);
-
     size_t numElements = numRows * numCols;
-    if (numElements > GetSizeAllocated() ||                 // grow allocation
-        (!growOnly && (numElements != GetSizeAllocated()))) // shrink allocation (not if 'growOnly')
+
+    // an externally owned buffer (e.g. a slot in a MatrixPool arena) may be reshaped within its size, but never reallocated
+    bool fitsExternalBuffer = HasExternalBuffer() && m_sob.unique() && numElements <= GetSizeAllocated();
+    if (!fitsExternalBuffer)
+        VerifyResizable(__func__);
+
+    if (!fitsExternalBuffer &&
+        (numElements > GetSizeAllocated() ||                  // grow allocation
+         (!growOnly && (numElements != GetSizeAllocated())))) // shrink allocation (not if 'growOnly')
     {
         // reallocate buffer
         ElemType* pArray = nullptr;
@@ -5022,6 +5175,34 @@ void CPUMatrix<ElemType>::BatchNormalizationBackward(const CPUMatrix<ElemType>&
     RuntimeError("Batch normalization training on CPU is not yet implemented.");
 }
 
+#pragma region RNN Functions
+
+template <class ElemType>
+void CPUMatrix<ElemType>::RNNForward(const CPUMatrix<ElemType>& inputX, const CPUMatrix<ElemType>& paramW, size_t xDim, size_t yDim, const vector<size_t>& numSequencesForFrame, const RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace)
+{
+    if (!m_rnnExecutor)
+        m_rnnExecutor = std::make_shared<CPURNNExecutor<ElemType>>(xDim, yDim, rnnAttributes);
+    m_rnnExecutor->ForwardCore(paramW, inputX, *this, numSequencesForFrame, rnnAttributes, reserve, workspace);
+}
+
+template <class ElemType>
+void CPUMatrix<ElemType>::RNNBackwardData(const CPUMatrix<ElemType>& outputDY, const CPUMatrix<ElemType>& paramW, CPUMatrix<ElemType>& outputDX, const RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace)
+{
+    if (!m_rnnExecutor)
+        LogicError("RNNBackwardData called, but RNNWrapper object is not yet initialized");
+    m_rnnExecutor->BackwardDataCore(*this, outputDY, paramW, outputDX, rnnAttributes, reserve, workspace);
+}
+
+template <class ElemType>
+void CPUMatrix<ElemType>::RNNBackwardWeights(const CPUMatrix<ElemType>& inputX, const CPUMatrix<ElemType>& outputY, CPUMatrix<ElemType>& dw, const RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace)
+{
+    if (!m_rnnExecutor)
+        LogicError("RNNBackwardWeights called, but RNNWrapper object is not yet initialized");
+    m_rnnExecutor->BackwardWeightsCore(inputX, outputY, dw, rnnAttributes, reserve, workspace);
+}
+
+#pragma endregion RNN Functions
+
 
 #pragma region Static BLAS Functions
 
@@ -7049,20 +7230,16 @@ struct TensorOpIteration<ElemType, OPFN, ReductionOp, 3, true /*vectorizable*/,
         size_t K = regularOpDims[0];
         // special-case beta and alpha to allow the compiler to short-circuit it
         if (beta != 0)
-#pragma omp parallel for
-            for (int k = 0; k < (int) K; k++)
+            for (size_t k = 0; k < K; k++)
                 TensorOpIteration<ElemType, OPFN, ReductionOp, 3, true /*vectorizable*/, -1 /*no reduction*/, -1 /*scalar*/>::Loop(beta, array<ElemType*, 3>{pa + k, pb + k, pc + k}, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
         else if (alpha != 1)
-#pragma omp parallel for
-            for (int k = 0; k < (int) K; k++)
+            for (size_t k = 0; k < K; k++)
                 TensorOpIteration<ElemType, OPFN, ReductionOp, 3, true /*vectorizable*/, -1 /*no reduction*/, -1 /*scalar*/>::Loop(0, array<ElemType*, 3>{pa + k, pb + k, pc + k}, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
         else
-#pragma omp parallel for
-            for (int k = 0; k < (int) K; k++)
+            for (size_t k = 0; k < K; k++)
                 TensorOpIteration<ElemType, OPFN, ReductionOp, 3, true /*vectorizable*/, -1 /*no reduction*/, -1 /*scalar*/>::Loop(0, array<ElemType*, 3>{pa + k, pb + k, pc + k}, 1, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
         // TODO: According to Amit, the VS compiler is not able to vectorize into lambdas. Solution: change the lambda to take an N, or to implement the loop inside (with 1 element by default).
-        // TODO: The signedness of k (required for omp) causes an extra sign-extend.
-        // TODO: OMP adds LOTS of overhead. Do we need a guard, a min size when to use it?
+        // Note: no OMP here. Threads are forked once per tensor op at the outermost level, see TensorOpWithFnAndReduction().
     }
 };
 // and unary
@@ -7078,16 +7255,13 @@ struct TensorOpIteration<ElemType, OPFN, ReductionOp, 2, true /*vectorizable*/,
         size_t K = regularOpDims[0];
         // special-case beta and alpha to allow the compiler to short-circuit it
         if (beta != 0)
-#pragma omp parallel for
-            for (int k = 0; k < (int) K; k++)
+            for (size_t k = 0; k < K; k++)
                 TensorOpIteration<ElemType, OPFN, ReductionOp, 2, true /*vectorizable*/, -1 /*no reduction*/, -1 /*scalar*/>::Loop(beta, array<ElemType*, 2>{pa + k, pb + k}, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
         else if (alpha != 1)
-#pragma omp parallel for
-            for (int k = 0; k < (int) K; k++)
+            for (size_t k = 0; k < K; k++)
                 TensorOpIteration<ElemType, OPFN, ReductionOp, 2, true /*vectorizable*/, -1 /*no reduction*/, -1 /*scalar*/>::Loop(0, array<ElemType*, 2>{pa + k, pb + k}, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
         else
-#pragma omp parallel for
-            for (int k = 0; k < (int) K; k++)
+            for (size_t k = 0; k < K; k++)
                 TensorOpIteration<ElemType, OPFN, ReductionOp, 2, true /*vectorizable*/, -1 /*no reduction*/, -1 /*scalar*/>::Loop(0, array<ElemType*, 2>{pa + k, pb + k}, 1, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
     }
 };
@@ -7154,6 +7328,76 @@ struct TensorArgOpIteration<ElemType, N, -1>
     }
 };
 
+// -----------------------------------------------------------------------
+// cache-blocked reduction over a single non-contiguous dimension
+// -----------------------------------------------------------------------
+
+// Number of result elements that are reduced together in TensorOpWithTiledReduction().
+// The double-precision aggregators of one tile (4 KB) plus the current input row stay in L1.
+static const size_t TensorOpReductionTileSize = 512;
+
+// Reduce a single reducing dimension for a single contiguous regular dimension, e.g. the bias gradient [M x T] -> [M].
+// The straightforward loop reduces one result element at a time and walks the input with stride M, touching a new
+// cache line for every element. Instead we sweep a tile of result elements across the reducing dimension, so the
+// input is read row by row. Each result element is aggregated in exactly the same order as in TensorOpReduction,
+// so results are bit-identical to the straightforward loop.
+template <class ElemType, typename OPFN, typename ReductionOp, size_t N>
+static void TensorOpWithTiledReduction(ElemType beta, const array<ElemType*, N>& pointers, ElemType alpha, const OPFN& opfn, const ReductionOp& reductionOp,
+                                       const SmallVector<size_t>& regularOpDims, const array<SmallVector<ptrdiff_t>, N>& regularStrides,
+                                       const SmallVector<size_t>& reducingOpDims, const array<SmallVector<ptrdiff_t>, N>& reducingStrides)
+{
+    double aggregates[TensorOpReductionTileSize];
+    const size_t numResults = regularOpDims[0];
+    const size_t numReduced = reducingOpDims[0];
+    for (size_t first = 0; first < numResults; first += TensorOpReductionTileSize)
+    {
+        const size_t tileSize = min(TensorOpReductionTileSize, numResults - first);
+        array<ElemType*, N> rowPointers;
+        for (size_t i = 0; i < N; i++)
+            rowPointers[i] = pointers[i] + (ptrdiff_t) first * regularStrides[i][0];
+        for (size_t r = 0; r < numReduced; r++)
+        {
+            array<ElemType*, N> elementPointers = rowPointers;
+            for (size_t j = 0; j < tileSize; j++)
+            {
+                ElemType val = opfn(elementPointers);
+                aggregates[j] = r == 0 ? val : reductionOp(aggregates[j], val);
+                for (size_t i = 0; i < N - 1; i++) // last pointer (result) is unused here
+                    elementPointers[i] += regularStrides[i][0];
+            }
+            for (size_t i = 0; i < N - 1; i++)
+                rowPointers[i] += reducingStrides[i][0];
+        }
+        // scale, combine with previous value in target matrix, then write it out
+        ElemType* pout = rowPointers.back();
+        for (size_t j = 0; j < tileSize; j++)
+        {
+            ElemType val = (ElemType) aggregates[j];
+            val *= alpha;
+            if (beta != 0)
+                val += beta * *pout;
+            *pout = val;
+            pout += regularStrides[N - 1][0];
+        }
+    }
+}
+
+// determine whether TensorOpWithTiledReduction() is applicable and beneficial
+// That is the case if all inputs are contiguous (or broadcast) along the single regular dimension.
+template <size_t N>
+static bool ShouldUseTiledReduction(const SmallVector<size_t>& regularOpDims, const array<SmallVector<ptrdiff_t>, N>& regularStrides,
+                                    const SmallVector<size_t>& reducingOpDims)
+{
+    if (regularOpDims.size() != 1 || reducingOpDims.size() != 1 || regularOpDims[0] < 2 || reducingOpDims[0] < 2)
+        return false;
+    for (size_t i = 0; i < N - 1; i++)
+    {
+        if (regularStrides[i][0] != 0 && regularStrides[i][0] != 1)
+            return false;
+    }
+    return true;
+}
+
 // -----------------------------------------------------------------------
 // map runtime parameters N to template parameters
 // -----------------------------------------------------------------------
@@ -7170,6 +7414,8 @@ static void TensorOpWithRegularLoop(ElemType beta, const array<ElemType*, N>& po
     case 2:
         return TensorOpIteration<ElemType, OPFN, ReductionOp, N, false /*vectorizable*/, 1, k>::Loop(beta, pointers, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
     case 1:
+        if (k == 0 && ShouldUseTiledReduction<N>(regularOpDims, regularStrides, reducingOpDims))
+            return TensorOpWithTiledReduction(beta, pointers, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
         return TensorOpIteration<ElemType, OPFN, ReductionOp, N, false /*vectorizable*/, 0, k>::Loop(beta, pointers, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
     case 0:
     {
@@ -7187,16 +7433,13 @@ static void TensorOpWithRegularLoop(ElemType beta, const array<ElemType*, N>& po
     }
 }
 
-// tensor operation, generalized in number of arguments, operation already provided as a lambda
-// This function now expands into different k.
+// tensor operation, single-threaded, after offsets have been applied
+// This function expands into different k.
 template <class ElemType, typename OPFN, typename ReductionOp, size_t N>
-static void TensorOpWithFnAndReduction(ElemType beta, array<ElemType*, N> pointers, ElemType alpha, const OPFN& opfn, const ReductionOp& reductionOp,
-    const array<size_t, N>& offsets,
-    const SmallVector<size_t>& regularOpDims, const array<SmallVector<ptrdiff_t>, N>& regularStrides,
-    const SmallVector<size_t>& reducingOpDims, const array<SmallVector<ptrdiff_t>, N>& reducingStrides)
+static void TensorOpWithRegularDims(ElemType beta, const array<ElemType*, N>& pointers, ElemType alpha, const OPFN& opfn, const ReductionOp& reductionOp,
+                                    const SmallVector<size_t>& regularOpDims, const array<SmallVector<ptrdiff_t>, N>& regularStrides,
+                                    const SmallVector<size_t>& reducingOpDims, const array<SmallVector<ptrdiff_t>, N>& reducingStrides)
 {
-    for (size_t i = 0; i < N; i++) // N = a small constant, this will be unrolled
-        pointers[i] += offsets[i];
     size_t dims = regularOpDims.size();
     switch (dims)
     {
@@ -7218,6 +7461,211 @@ static void TensorOpWithFnAndReduction(ElemType beta, array<ElemType*, N> pointe
     }
 }
 
+// -----------------------------------------------------------------------
+// multi-threaded execution
+// -----------------------------------------------------------------------
+
+// Minimum number of element operations (result elements times reduced elements) per thread.
+// Below that, the fork/join cost of an OMP parallel region exceeds the gain.
+static const size_t TensorOpMinElementsPerThread = 16384;
+
+// number of threads to use for a tensor op with the given number of element operations
+static size_t TensorOpNumThreads(size_t numElementOps)
+{
+#ifdef _OPENMP
+    if (omp_in_parallel()) // nested: the caller already parallelized
+        return 1;
+    return max((size_t) 1, min((size_t) omp_get_max_threads(), numElementOps / TensorOpMinElementsPerThread));
+#else
+    return 1;
+#endif
+}
+
+// Partition one regular dimension across threads. We pick the outermost dimension that has at least one slice per thread,
+// so that each thread works on large contiguous blocks (and its share of the output stays in its own L2).
+// Every result element is computed by exactly one thread, in the same way as in the single-threaded loop, so this is bit-exact.
+template <class ElemType, typename OPFN, typename ReductionOp, size_t N>
+static void ParallelTensorOpOverRegularDim(size_t numThreads, ElemType beta, const array<ElemType*, N>& pointers, ElemType alpha, const OPFN& opfn, const ReductionOp& reductionOp,
+                                           const SmallVector<size_t>& regularOpDims, const array<SmallVector<ptrdiff_t>, N>& regularStrides,
+                                           const SmallVector<size_t>& reducingOpDims, const array<SmallVector<ptrdiff_t>, N>& reducingStrides)
+{
+    size_t splitDim = regularOpDims.size() - 1;
+    for (size_t d = regularOpDims.size(); d-- > 0;)
+    {
+        if (regularOpDims[d] >= numThreads)
+        {
+            splitDim = d;
+            break;
+        }
+        if (regularOpDims[d] > regularOpDims[splitDim])
+            splitDim = d;
+    }
+    const size_t extent = regularOpDims[splitDim];
+    numThreads = min(numThreads, extent);
+
+#pragma omp parallel for num_threads((int) numThreads) schedule(static, 1)
+    for (int t = 0; t < (int) numThreads; t++)
+    {
+        const size_t begin = extent * t / numThreads;
+        const size_t end = extent * (t + 1) / numThreads;
+        SmallVector<size_t> threadOpDims(regularOpDims);
+        threadOpDims[splitDim] = end - begin;
+        array<ElemType*, N> threadPointers;
+        for (size_t i = 0; i < N; i++)
+            threadPointers[i] = pointers[i] + (ptrdiff_t) begin * regularStrides[i][splitDim];
+        TensorOpWithRegularDims(beta, threadPointers, alpha, opfn, reductionOp, threadOpDims, regularStrides, reducingOpDims, reducingStrides);
+    }
+}
+
+// Reduce to a single result element (e.g. a loss or a full ReduceSum) by partitioning the outermost reducing dimension
+// across threads. Each thread computes a partial aggregate, which are combined in thread order.
+// This changes the order of aggregation, and thus the result in the last bits. It is therefore not used in deterministic mode.
+template <class ElemType, typename OPFN, typename ReductionOp, size_t N>
+static void ParallelTensorOpOverReducingDim(size_t numThreads, ElemType beta, const array<ElemType*, N>& pointers, ElemType alpha, const OPFN& opfn, const ReductionOp& reductionOp,
+                                            const SmallVector<size_t>& reducingOpDims, const array<SmallVector<ptrdiff_t>, N>& reducingStrides)
+{
+    const size_t splitDim = reducingOpDims.size() - 1;
+    const size_t extent = reducingOpDims[splitDim];
+    numThreads = min(numThreads, extent);
+
+    vector<ElemType> partials(numThreads);
+#pragma omp parallel for num_threads((int) numThreads) schedule(static, 1)
+    for (int t = 0; t < (int) numThreads; t++)
+    {
+        const size_t begin = extent * t / numThreads;
+        const size_t end = extent * (t + 1) / numThreads;
+        SmallVector<size_t> threadOpDims(reducingOpDims);
+        threadOpDims[splitDim] = end - begin;
+        array<ElemType*, N> threadPointers;
+        for (size_t i = 0; i < N - 1; i++) // last pointer (result) is unused in reduction
+            threadPointers[i] = pointers[i] + (ptrdiff_t) begin * reducingStrides[i][splitDim];
+        if (splitDim == 1)
+            partials[t] = TensorOpReduction<ElemType, OPFN, ReductionOp, N, 1>::Loop(threadPointers, opfn, reductionOp, threadOpDims, reducingStrides);
+        else
+            partials[t] = TensorOpReduction<ElemType, OPFN, ReductionOp, N, 0>::Loop(threadPointers, opfn, reductionOp, threadOpDims, reducingStrides);
+    }
+
+    double aggregate = partials[0];
+    for (size_t t = 1; t < numThreads; t++)
+        aggregate = reductionOp(aggregate, partials[t]);
+    // scale, combine with previous value in target matrix, then write it out
+    ElemType val = (ElemType) aggregate;
+    val *= alpha;
+    auto* pout = pointers.back();
+    if (beta != 0)
+        val += beta * *pout;
+    *pout = val;
+}
+
+// -----------------------------------------------------------------------
+// SIMD kernels (CPUTensorSIMD.h) for elementwise ops
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+static inline void InvokeSIMDKernel(SIMD::UnaryKernel<ElemType> kernel, size_t n, const array<ElemType*, 2>& pointers, ElemType alpha, ElemType beta)
+{
+    kernel(n, pointers[0], pointers[1], alpha, beta);
+}
+
+template <class ElemType>
+static inline void InvokeSIMDKernel(SIMD::BinaryKernel<ElemType> kernel, size_t n, const array<ElemType*, 3>& pointers, ElemType alpha, ElemType beta)
+{
+    kernel(n, pointers[0], pointers[1], pointers[2], alpha, beta);
+}
+
+template <class ElemType>
+static inline void InvokeSIMDKernel(SIMD::TernaryKernel<ElemType> kernel, size_t n, const array<ElemType*, 4>& pointers, ElemType alpha, ElemType beta)
+{
+    kernel(n, pointers[0], pointers[1], pointers[2], pointers[3], alpha, beta);
+}
+
+// Minimum length of the contiguous innermost dimension for the SIMD kernels. Shorter rows stay with the scalar loops.
+static const size_t TensorOpMinSIMDRowLength = 16;
+
+// Perform an elementwise op (no reduction) through a SIMD kernel, if there is one for the op and all operands
+// are contiguous in the innermost dimension. The remaining dimensions are flattened into rows, which are
+// distributed over threads (long rows are cut into chunks if there are fewer rows than threads).
+// Returns false if the op cannot be done this way.
+template <class ElemType, size_t N, typename KERNEL>
+static bool TensorOpWithSIMDKernel(KERNEL kernel, ElemType beta, array<ElemType*, N> pointers, ElemType alpha,
+                                   const array<size_t, N>& offsets,
+                                   const SmallVector<size_t>& regularOpDims, const array<SmallVector<ptrdiff_t>, N>& regularStrides,
+                                   const SmallVector<size_t>& reducingOpDims)
+{
+    if (!kernel || reducingOpDims.size() > 0 || regularOpDims.size() == 0 || regularOpDims[0] < TensorOpMinSIMDRowLength)
+        return false;
+    for (size_t i = 0; i < N; i++)
+    {
+        if (regularStrides[i][0] != 1)
+            return false;
+    }
+
+    for (size_t i = 0; i < N; i++)
+        pointers[i] += offsets[i];
+    const size_t rowLength = regularOpDims[0];
+    size_t numRows = 1;
+    for (size_t d = 1; d < regularOpDims.size(); d++)
+        numRows *= regularOpDims[d];
+
+    const size_t numThreads = TensorOpNumThreads(rowLength * numRows);
+    size_t chunksPerRow = numRows >= numThreads ? 1 : (numThreads + numRows - 1) / numRows;
+    const size_t chunkLength = ((rowLength + chunksPerRow - 1) / chunksPerRow + 63) / 64 * 64; // keep chunks aligned to cache lines relative to the row start
+    chunksPerRow = (rowLength + chunkLength - 1) / chunkLength;
+    const size_t numTasks = numRows * chunksPerRow;
+
+#pragma omp parallel for num_threads((int) numThreads) if (numThreads > 1)
+    for (int task = 0; task < (int) numTasks; task++)
+    {
+        size_t row = task / chunksPerRow;
+        const size_t begin = (task % chunksPerRow) * chunkLength;
+        const size_t n = min(chunkLength, rowLength - begin);
+        array<ElemType*, N> rowPointers = pointers;
+        for (size_t d = 1; d < regularOpDims.size(); d++)
+        {
+            const size_t coordinate = row % regularOpDims[d];
+            row /= regularOpDims[d];
+            for (size_t i = 0; i < N; i++)
+                rowPointers[i] += (ptrdiff_t) coordinate * regularStrides[i][d];
+        }
+        for (size_t i = 0; i < N; i++)
+            rowPointers[i] += begin;
+        InvokeSIMDKernel(kernel, n, rowPointers, alpha, beta);
+    }
+    return true;
+}
+
+// tensor operation, generalized in number of arguments, operation already provided as a lambda
+// This function decides on multi-threading, and then expands into different k.
+template <class ElemType, typename OPFN, typename ReductionOp, size_t N>
+static void TensorOpWithFnAndReduction(ElemType beta, array<ElemType*, N> pointers, ElemType alpha, const OPFN& opfn, const ReductionOp& reductionOp,
+    const array<size_t, N>& offsets,
+    const SmallVector<size_t>& regularOpDims, const array<SmallVector<ptrdiff_t>, N>& regularStrides,
+    const SmallVector<size_t>& reducingOpDims, const array<SmallVector<ptrdiff_t>, N>& reducingStrides)
+{
+    for (size_t i = 0; i < N; i++) // N = a small constant, this will be unrolled
+        pointers[i] += offsets[i];
+
+    // validate here, since errors cannot be thrown out of a parallel region
+    if (regularOpDims.size() > 5)
+        LogicError("TensorOp: %d non-flattened input dimensions are not supported.", (int) regularOpDims.size());
+    if (reducingOpDims.size() > 2)
+        LogicError("TensorOp: %d non-flattened reduction dimensions are not supported.", (int) reducingOpDims.size());
+
+    size_t numResults = 1;
+    for (size_t d = 0; d < regularOpDims.size(); d++)
+        numResults *= regularOpDims[d];
+    size_t numReduced = 1;
+    for (size_t d = 0; d < reducingOpDims.size(); d++)
+        numReduced *= reducingOpDims[d];
+
+    size_t numThreads = TensorOpNumThreads(numResults * numReduced);
+    if (numThreads > 1 && numResults > 1)
+        return ParallelTensorOpOverRegularDim(numThreads, beta, pointers, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
+    if (numThreads > 1 && numResults == 1 && !Globals::ShouldForceDeterministicAlgorithms())
+        return ParallelTensorOpOverReducingDim(numThreads, beta, pointers, alpha, opfn, reductionOp, reducingOpDims, reducingStrides);
+    return TensorOpWithRegularDims(beta, pointers, alpha, opfn, reductionOp, regularOpDims, regularStrides, reducingOpDims, reducingStrides);
+}
+
 // tensor operation, generalized in number of arguments, operation already provided as a lambda
 // This function now expands into different reductionOps
 template <class ElemType, typename OPFN, size_t N>
@@ -7281,6 +7729,11 @@ void CPUMatrix<ElemType>::TensorOp(ElemType beta, const CPUMatrix<ElemType>& a,
                               reductionOp, offsets, regularOpDims, regularStrides, reducingOpDims, reducingStrides)
 
     array<ElemType*, 2> pointers = {a.Data(), Data()};
+
+    // contiguous elementwise ops go to the SIMD kernels, if there is one for 'op'
+    if (TensorOpWithSIMDKernel(SIMD::GetUnaryKernel<ElemType>(op), beta, pointers, alpha, offsets, regularOpDims, regularStrides, reducingOpDims))
+        return;
+
     switch (op)
     {
         ForAllUnaryOps(CaseUnaryTensorOp);
@@ -7309,6 +7762,11 @@ void CPUMatrix<ElemType>::TensorOp(ElemType beta, const CPUMatrix<ElemType>& a,
                               reductionOp, offsets, regularOpDims, regularStrides, reducingOpDims, reducingStrides)
 
     array<ElemType*, 3> pointers = {a.Data(), b.Data(), Data()};
+
+    // contiguous elementwise ops go to the SIMD kernels, if there is one for 'op'
+    if (TensorOpWithSIMDKernel(SIMD::GetBinaryKernel<ElemType>(op), beta, pointers, alpha, offsets, regularOpDims, regularStrides, reducingOpDims))
+        return;
+
     switch (op)
     {
         ForAllBinaryOps(CaseBinaryTensorOp);
@@ -7337,6 +7795,11 @@ void CPUMatrix<ElemType>::TensorOp(ElemType beta, const CPUMatrix<ElemType>& a,
                               reductionOp, offsets, regularOpDims, regularStrides, reducingOpDims, reducingStrides)
 
     array<ElemType*, 4> pointers = {a.Data(), b.Data(), c.Data(), Data()};
+
+    // contiguous elementwise ops go to the SIMD kernels, if there is one for 'op'
+    if (TensorOpWithSIMDKernel(SIMD::GetTernaryKernel<ElemType>(op), beta, pointers, alpha, offsets, regularOpDims, regularStrides, reducingOpDims))
+        return;
+
     switch (op)
     {
         ForAllTernaryOps(CaseTernaryTensorOp);
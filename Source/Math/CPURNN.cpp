@@ -0,0 +1,520 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPURNN.cpp -- CPU implementation of the OptimizedRNNStack engine (see CPURNN.h)
+//
+
+#include "stdafx.h"
+#include "CPURNN.h"
+#include "TensorOps.h"
+#include <string.h>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// gate kernels over fewer elements than this are not worth forking threads for
+static const size_t MinElementsForThreads = 32768;
+
+// c = alpha * op(a) * op(b) + beta * c, for dense column-major buffers
+template <class ElemType>
+static void Gemm(ElemType alpha, const ElemType* a, size_t aRows, size_t aCols, bool transposeA, const ElemType* b, size_t bRows, size_t bCols, bool transposeB,
+                 ElemType beta, ElemType* c, size_t cRows, size_t cCols)
+{
+    if (cRows == 0 || cCols == 0)
+        return;
+    CPUMatrix<ElemType> aView(aRows, aCols, const_cast<ElemType*>(a), matrixFlagDontOwnBuffer);
+    CPUMatrix<ElemType> bView(bRows, bCols, const_cast<ElemType*>(b), matrixFlagDontOwnBuffer);
+    CPUMatrix<ElemType> cView(cRows, cCols, c, matrixFlagDontOwnBuffer);
+    CPUMatrix<ElemType>::MultiplyAndWeightedAdd(alpha, aView, transposeA, bView, transposeB, beta, cView);
+}
+
+// -----------------------------------------------------------------------
+// fused gate kernels for one column (one sequence at one time step)
+// 'hasPrev' is false for the first frame of a sequence, where the previous hidden and cell state are zero
+// and the recurrent projection 'rec' is not computed.
+// -----------------------------------------------------------------------
+
+// gates (i, f, c~, o): input projection in, activations out
+template <class ElemType>
+static inline void LSTMForwardColumn(size_t H, ElemType* gates, const ElemType* rec, const ElemType* bW, const ElemType* bR, bool hasPrev,
+                                     const ElemType* cPrev, ElemType* c, ElemType* h)
+{
+    for (size_t j = 0; j < H; j++)
+    {
+        const ElemType i  = StableSigmoid(gates[j]         + bW[j]         + bR[j]         + (hasPrev ? rec[j]         : 0));
+        const ElemType f  = StableSigmoid(gates[H + j]     + bW[H + j]     + bR[H + j]     + (hasPrev ? rec[H + j]     : 0));
+        const ElemType cc = tanh_(        gates[2 * H + j] + bW[2 * H + j] + bR[2 * H + j] + (hasPrev ? rec[2 * H + j] : 0));
+        const ElemType o  = StableSigmoid(gates[3 * H + j] + bW[3 * H + j] + bR[3 * H + j] + (hasPrev ? rec[3 * H + j] : 0));
+        const ElemType cv = i * cc + (hasPrev ? f * cPrev[j] : 0);
+        gates[j]         = i;
+        gates[H + j]     = f;
+        gates[2 * H + j] = cc;
+        gates[3 * H + j] = o;
+        c[j] = cv;
+        h[j] = o * tanh_(cv);
+    }
+}
+
+// gates (r, z, h~): input projection in, activations out; 'rh' receives R_h^T * hPrev + bR_h, which is needed for the gradient of r
+template <class ElemType>
+static inline void GRUForwardColumn(size_t H, ElemType* gates, const ElemType* rec, const ElemType* bW, const ElemType* bR, bool hasPrev,
+                                    const ElemType* hPrev, ElemType* rh, ElemType* h)
+{
+    for (size_t j = 0; j < H; j++)
+    {
+        const ElemType r   = StableSigmoid(gates[j]     + bW[j]     + bR[j]     + (hasPrev ? rec[j]     : 0));
+        const ElemType z   = StableSigmoid(gates[H + j] + bW[H + j] + bR[H + j] + (hasPrev ? rec[H + j] : 0));
+        const ElemType rhv = (hasPrev ? rec[2 * H + j] : 0) + bR[2 * H + j];
+        const ElemType hh  = tanh_(gates[2 * H + j] + bW[2 * H + j] + r * rhv);
+        gates[j]         = r;
+        gates[H + j]     = z;
+        gates[2 * H + j] = hh;
+        rh[j] = rhv;
+        h[j] = (1 - z) * hh + (hasPrev ? z * hPrev[j] : 0);
+    }
+}
+
+// h: input projection in, hidden state out
+template <class ElemType>
+static inline void RNNForwardColumn(size_t H, bool isReLU, const ElemType* rec, const ElemType* bW, const ElemType* bR, bool hasPrev, ElemType* h)
+{
+    for (size_t j = 0; j < H; j++)
+    {
+        const ElemType v = h[j] + bW[j] + bR[j] + (hasPrev ? rec[j] : 0);
+        h[j] = isReLU ? (v > 0 ? v : 0) : tanh_(v);
+    }
+}
+
+// The gradient of the hidden state is dy plus, if 'hasRec', the recurrent gradient dhRec from the successor.
+// dcRec: recurrent gradient of the cell state (if 'hasRec'); dcPrev receives the gradient of the previous cell state (if 'hasPrev')
+template <class ElemType>
+static inline void LSTMBackwardColumn(size_t H, const ElemType* gates, const ElemType* c, const ElemType* dy, bool hasRec, const ElemType* dhRec, const ElemType* dcRec,
+                                      bool hasPrev, const ElemType* cPrev, ElemType* dGates, ElemType* dcPrev)
+{
+    for (size_t j = 0; j < H; j++)
+    {
+        const ElemType i = gates[j], f = gates[H + j], cc = gates[2 * H + j], o = gates[3 * H + j];
+        const ElemType dh = dy[j] + (hasRec ? dhRec[j] : 0);
+        const ElemType tc = tanh_(c[j]);
+        const ElemType dc = dh * o * (1 - tc * tc) + (hasRec ? dcRec[j] : 0);
+        dGates[j]         = dc * cc * i * (1 - i);
+        dGates[H + j]     = hasPrev ? dc * cPrev[j] * f * (1 - f) : 0;
+        dGates[2 * H + j] = dc * i * (1 - cc * cc);
+        dGates[3 * H + j] = dh * tc * o * (1 - o);
+        if (hasPrev)
+            dcPrev[j] = dc * f;
+    }
+}
+
+// dGatesR differs from dGates in the h~ gate, whose recurrent projection is gated by r;
+// dhPrev receives the direct part z * dh of the gradient of the previous hidden state (if 'hasPrev')
+template <class ElemType>
+static inline void GRUBackwardColumn(size_t H, const ElemType* gates, const ElemType* rh, const ElemType* dy, bool hasRec, const ElemType* dhRec,
+                                     bool hasPrev, const ElemType* hPrev, ElemType* dGates, ElemType* dGatesR, ElemType* dhPrev)
+{
+    for (size_t j = 0; j < H; j++)
+    {
+        const ElemType r = gates[j], z = gates[H + j], hh = gates[2 * H + j];
+        const ElemType dh = dy[j] + (hasRec ? dhRec[j] : 0);
+        const ElemType hp = hasPrev ? hPrev[j] : 0;
+        const ElemType dz = dh * (hp - hh) * z * (1 - z);
+        const ElemType dhh = dh * (1 - z) * (1 - hh * hh);
+        const ElemType dr = dhh * rh[j] * r * (1 - r);
+        dGates[j]          = dr;
+        dGates[H + j]      = dz;
+        dGates[2 * H + j]  = dhh;
+        dGatesR[j]         = dr;
+        dGatesR[H + j]     = dz;
+        dGatesR[2 * H + j] = dhh * r;
+        if (hasPrev)
+            dhPrev[j] = dh * z;
+    }
+}
+
+template <class ElemType>
+static inline void RNNBackwardColumn(size_t H, bool isReLU, const ElemType* h, const ElemType* dy, bool hasRec, const ElemType* dhRec, ElemType* dGates)
+{
+    for (size_t j = 0; j < H; j++)
+    {
+        const ElemType dh = dy[j] + (hasRec ? dhRec[j] : 0);
+        dGates[j] = isReLU ? (h[j] > 0 ? dh : 0) : dh * (1 - h[j] * h[j]);
+    }
+}
+
+// -----------------------------------------------------------------------
+// CPURNNExecutor
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+CPURNNExecutor<ElemType>::CPURNNExecutor(size_t xDim, size_t yDim, const RnnAttributes& rnnAttributes)
+    : m_rnnAttributes(rnnAttributes),
+      m_xDim(xDim), m_yDim(yDim),
+      m_numColumns(0), m_maxNumSequences(0),
+      m_BackwardDataCalledYet(false)
+{
+    if      (rnnAttributes.m_recurrentOp == wstring(L"lstm"))    m_cellType = CellType::LSTM, m_numGates = 4;
+    else if (rnnAttributes.m_recurrentOp == wstring(L"gru"))     m_cellType = CellType::GRU,  m_numGates = 3;
+    else if (rnnAttributes.m_recurrentOp == wstring(L"rnnReLU")) m_cellType = CellType::ReLU, m_numGates = 1;
+    else if (rnnAttributes.m_recurrentOp == wstring(L"rnnTanh")) m_cellType = CellType::Tanh, m_numGates = 1;
+    else InvalidArgument("Unknown cell type '%ls'. Supported values are 'lstm', 'gru', 'rnnReLU', 'rnnTanh'.", rnnAttributes.m_recurrentOp.c_str());
+    m_numDirections = rnnAttributes.m_bidirectional ? 2 : 1;
+}
+
+// Reserve layout: for each pseudo-layer, hidden [H x N], then cell (LSTM) or rh (GRU) [H x N], then gates (LSTM, GRU) [G*H x N];
+// followed by the outputs [D*H x N] of all layers but the last one, which are the inputs of the next layers.
+// Backward workspace layout: for each pseudo-layer, dGates [G*H x N] and (GRU only) dGatesR [G*H x N]; then two [D*H x N]
+// buffers for the gradients of the layer outputs, and two each [H x maxNumSequences] for the recurrent gradients of h and c.
+template <class ElemType>
+typename CPURNNExecutor<ElemType>::PseudoLayer CPURNNExecutor<ElemType>::GetPseudoLayer(size_t layer, size_t dir, ElemType* reserve, ElemType* workspace) const
+{
+    const size_t H = m_rnnAttributes.m_hiddenSize, G = m_numGates, D = m_numDirections, N = m_numColumns;
+    const bool hasGates = m_cellType == CellType::LSTM || m_cellType == CellType::GRU;
+    const size_t pseudoLayerIndex = layer * D + dir;
+
+    PseudoLayer pl;
+    pl.inputDim = layer == 0 ? m_xDim : D * H;
+
+    // parameters: the matrices W, R of all pseudo-layers, then the biases bW, bR of all pseudo-layers
+    auto matricesSize = [&](size_t l) { return D * ((l == 0 ? m_xDim : D * H) + H) * G * H; }; // of all directions of layer l
+    size_t allMatricesSize = 0;
+    for (size_t l = 0; l < m_rnnAttributes.m_numLayers; l++)
+    {
+        if (l == layer)
+            pl.wOffset = allMatricesSize + dir * (pl.inputDim + H) * G * H;
+        allMatricesSize += matricesSize(l);
+    }
+    pl.rOffset = pl.wOffset + pl.inputDim * G * H;
+    pl.bWOffset = allMatricesSize + pseudoLayerIndex * 2 * G * H;
+    pl.bROffset = pl.bWOffset + G * H;
+
+    ElemType* p = reserve + pseudoLayerIndex * PseudoLayerReserveSize();
+    pl.hidden = p;
+    pl.cell = m_cellType == CellType::LSTM ? p + H * N : nullptr;
+    pl.rh   = m_cellType == CellType::GRU  ? p + H * N : nullptr;
+    pl.gates = hasGates ? p + 2 * H * N : pl.hidden;
+
+    // the gradients only exist in the backward workspace
+    pl.dGates = pl.dGatesR = nullptr;
+    if (workspace)
+    {
+        const size_t dGatesSize = G * H * N * (m_cellType == CellType::GRU ? 2 : 1);
+        pl.dGates = workspace + pseudoLayerIndex * dGatesSize;
+        pl.dGatesR = m_cellType == CellType::GRU ? pl.dGates + G * H * N : pl.dGates;
+    }
+    return pl;
+}
+
+template <class ElemType>
+size_t CPURNNExecutor<ElemType>::PseudoLayerReserveSize() const
+{
+    const bool hasGates = m_cellType == CellType::LSTM || m_cellType == CellType::GRU;
+    return m_rnnAttributes.m_hiddenSize * m_numColumns * (hasGates ? 2 + m_numGates : 1);
+}
+
+template <class ElemType>
+ElemType* CPURNNExecutor<ElemType>::LayerOutput(size_t layer, ElemType* reserve) const
+{
+    const size_t numPseudoLayers = m_rnnAttributes.m_numLayers * m_numDirections;
+    return reserve + numPseudoLayers * PseudoLayerReserveSize() + layer * m_yDim * m_numColumns;
+}
+
+template <class ElemType>
+size_t CPURNNExecutor<ElemType>::ReserveSize() const
+{
+    const size_t L = m_rnnAttributes.m_numLayers;
+    return L * m_numDirections * PseudoLayerReserveSize() + (L - 1) * m_yDim * m_numColumns;
+}
+
+template <class ElemType>
+size_t CPURNNExecutor<ElemType>::ForwardWorkspaceSize() const
+{
+    // the recurrent projection of one time step
+    return m_numGates * m_rnnAttributes.m_hiddenSize * m_maxNumSequences;
+}
+
+template <class ElemType>
+size_t CPURNNExecutor<ElemType>::BackwardWorkspaceSize() const
+{
+    const size_t H = m_rnnAttributes.m_hiddenSize, G = m_numGates, D = m_numDirections, N = m_numColumns;
+    const size_t dGatesSize = G * H * N * (m_cellType == CellType::GRU ? 2 : 1);
+    return m_rnnAttributes.m_numLayers * D * dGatesSize + 2 * D * H * N + 4 * H * m_maxNumSequences;
+}
+
+template <class ElemType>
+void CPURNNExecutor<ElemType>::GetPredecessor(size_t dir, size_t t, size_t& prevCol, size_t& numPrev) const
+{
+    const size_t T = m_numSequencesForFrame.size();
+    prevCol = 0;
+    numPrev = 0;
+    if (dir == 0 && t > 0)
+    {
+        prevCol = m_frameOffsets[t - 1];
+        numPrev = m_numSequencesForFrame[t];
+    }
+    else if (dir == 1 && t + 1 < T)
+    {
+        prevCol = m_frameOffsets[t + 1];
+        numPrev = m_numSequencesForFrame[t + 1];
+    }
+}
+
+template <class ElemType>
+void CPURNNExecutor<ElemType>::ForwardCore(const CPUMatrix<ElemType>& weightsW, const CPUMatrix<ElemType>& inputX, CPUMatrix<ElemType>& outputY,
+                                           const vector<size_t>& numSequencesForFrame, const RnnAttributes& rnnAttributes,
+                                           CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace)
+{
+    if (!(m_rnnAttributes == rnnAttributes))
+        LogicError("RNN Layout has changed during processing");
+
+    const size_t H = m_rnnAttributes.m_hiddenSize, D = m_numDirections, L = m_rnnAttributes.m_numLayers;
+    if (m_yDim != D * H)
+        InvalidArgument("CPURNNExecutor::ForwardCore: Output leading dimension must be twice hidden size for bidirectional networks");
+
+    // column offsets of the time steps
+    m_numSequencesForFrame = numSequencesForFrame;
+    m_frameOffsets.resize(numSequencesForFrame.size());
+    m_numColumns = 0;
+    m_maxNumSequences = 0;
+    for (size_t t = 0; t < numSequencesForFrame.size(); t++)
+    {
+        if (t > 0 && numSequencesForFrame[t] > numSequencesForFrame[t - 1])
+            InvalidArgument("CPURNNExecutor::ForwardCore: The number of sequences must not increase over time.");
+        m_frameOffsets[t] = m_numColumns;
+        m_numColumns += numSequencesForFrame[t];
+        m_maxNumSequences = max(m_maxNumSequences, numSequencesForFrame[t]);
+    }
+
+    if (inputX.GetNumRows() != m_xDim || inputX.GetNumCols() != m_numColumns)
+        InvalidArgument("CPURNNExecutor::ForwardCore: Input must be %d x %d, but is %d x %d.", (int) m_xDim, (int) m_numColumns, (int) inputX.GetNumRows(), (int) inputX.GetNumCols());
+    if (outputY.GetNumRows() != m_yDim || outputY.GetNumCols() != m_numColumns)
+        InvalidArgument("CPURNNExecutor::ForwardCore: Output must be %d x %d, but is %d x %d.", (int) m_yDim, (int) m_numColumns, (int) outputY.GetNumRows(), (int) outputY.GetNumCols());
+    const auto numParameters = m_rnnAttributes.GetNumParameters(m_xDim);
+    if (numParameters.first * numParameters.second != weightsW.GetNumElements())
+        InvalidArgument("RNN needs %ld parameters, but %ld were allocated", (long) (numParameters.first * numParameters.second), (long) weightsW.GetNumElements());
+
+    reserve.Resize(ReserveSize(), 1);
+    workspace.Resize(ForwardWorkspaceSize(), 1);
+
+    for (size_t layer = 0; layer < L; layer++)
+    {
+        const ElemType* x = layer == 0 ? inputX.Data() : LayerOutput(layer - 1, reserve.Data());
+        ElemType* y = layer == L - 1 ? outputY.Data() : LayerOutput(layer, reserve.Data());
+        for (size_t dir = 0; dir < D; dir++)
+        {
+            const PseudoLayer pl = GetPseudoLayer(layer, dir, reserve.Data(), nullptr);
+            ForwardPseudoLayer(pl, dir, weightsW.Data(), x, workspace.Data());
+
+            // interleave the directions into the layer output
+            for (size_t col = 0; col < m_numColumns; col++)
+                memcpy(y + col * m_yDim + dir * H, pl.hidden + col * H, H * sizeof(ElemType));
+        }
+    }
+    m_BackwardDataCalledYet = false;
+}
+
+template <class ElemType>
+void CPURNNExecutor<ElemType>::ForwardPseudoLayer(const PseudoLayer& pl, size_t dir, const ElemType* weights, const ElemType* x, ElemType* recurrent)
+{
+    const size_t H = m_rnnAttributes.m_hiddenSize, GH = m_numGates * H, T = m_numSequencesForFrame.size();
+
+    // input projection of all time steps at once
+    Gemm<ElemType>(1, weights + pl.wOffset, pl.inputDim, GH, true, x, pl.inputDim, m_numColumns, false, 0, pl.gates, GH, m_numColumns);
+
+    for (size_t i = 0; i < T; i++)
+    {
+        const size_t t = dir == 0 ? i : T - 1 - i;
+        size_t prevCol, numPrev;
+        GetPredecessor(dir, t, prevCol, numPrev);
+        Gemm<ElemType>(1, weights + pl.rOffset, H, GH, true, pl.hidden + prevCol * H, H, numPrev, false, 0, recurrent, GH, numPrev);
+        ForwardStep(pl, weights, m_frameOffsets[t], m_numSequencesForFrame[t], prevCol, numPrev, recurrent);
+    }
+}
+
+template <class ElemType>
+void CPURNNExecutor<ElemType>::ForwardStep(const PseudoLayer& pl, const ElemType* weights, size_t col, size_t n, size_t prevCol, size_t numPrev, const ElemType* recurrent)
+{
+    const size_t H = m_rnnAttributes.m_hiddenSize, GH = m_numGates * H;
+    const ElemType* bW = weights + pl.bWOffset;
+    const ElemType* bR = weights + pl.bROffset;
+    const CellType cellType = m_cellType;
+#pragma omp parallel for if (n * GH >= MinElementsForThreads)
+    for (long s = 0; s < (long) n; s++)
+    {
+        const bool hasPrev = (size_t) s < numPrev;
+        const ElemType* rec = recurrent + s * GH;
+        ElemType* h = pl.hidden + (col + s) * H;
+        switch (cellType)
+        {
+        case CellType::LSTM:
+            LSTMForwardColumn(H, pl.gates + (col + s) * GH, rec, bW, bR, hasPrev, pl.cell + (prevCol + s) * H, pl.cell + (col + s) * H, h);
+            break;
+        case CellType::GRU:
+            GRUForwardColumn(H, pl.gates + (col + s) * GH, rec, bW, bR, hasPrev, pl.hidden + (prevCol + s) * H, pl.rh + (col + s) * H, h);
+            break;
+        default:
+            RNNForwardColumn(H, cellType == CellType::ReLU, rec, bW, bR, hasPrev, h);
+            break;
+        }
+    }
+}
+
+template <class ElemType>
+void CPURNNExecutor<ElemType>::BackwardDataCore(const CPUMatrix<ElemType>& outputY, const CPUMatrix<ElemType>& outputDY, const CPUMatrix<ElemType>& weightsW, CPUMatrix<ElemType>& dx,
+                                                const RnnAttributes& rnnAttributes,
+                                                CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace)
+{
+    if (!(m_rnnAttributes == rnnAttributes))
+        LogicError("RNN Layout has changed during processing");
+
+    if (!m_BackwardDataCalledYet)
+    {
+        const size_t H = m_rnnAttributes.m_hiddenSize, G = m_numGates, D = m_numDirections, L = m_rnnAttributes.m_numLayers, N = m_numColumns;
+        if (outputY.GetNumRows() != m_yDim || outputY.GetNumCols() != N || outputDY.GetNumRows() != m_yDim || outputDY.GetNumCols() != N)
+            InvalidArgument("CPURNNExecutor::BackwardDataCore: Output and its gradient must be %d x %d.", (int) m_yDim, (int) N);
+        if (dx.GetNumRows() != m_xDim || dx.GetNumCols() != N)
+            InvalidArgument("CPURNNExecutor::BackwardDataCore: Input gradient must be %d x %d, but is %d x %d.", (int) m_xDim, (int) N, (int) dx.GetNumRows(), (int) dx.GetNumCols());
+        if (reserve.GetNumElements() != ReserveSize())
+            LogicError("CPURNNExecutor::BackwardDataCore: The reserve buffer has changed since the forward pass.");
+
+        workspace.Resize(BackwardWorkspaceSize(), 1);
+        ElemType* layerGrads = workspace.Data() + L * D * G * H * N * (m_cellType == CellType::GRU ? 2 : 1);
+        ElemType* layerGrad[2] = { layerGrads, layerGrads + D * H * N };
+        ElemType* recGrads = layerGrads + 2 * D * H * N;
+        ElemType* dhRec[2] = { recGrads, recGrads + H * m_maxNumSequences };
+        ElemType* dcRec[2] = { recGrads + 2 * H * m_maxNumSequences, recGrads + 3 * H * m_maxNumSequences };
+
+        for (size_t layer = L; layer-- > 0;)
+        {
+            const ElemType* dy = layer == L - 1 ? outputDY.Data() : layerGrad[layer % 2];
+            ElemType* dxLayer = layer == 0 ? dx.Data() : layerGrad[(layer - 1) % 2];
+            for (size_t dir = 0; dir < D; dir++)
+            {
+                const PseudoLayer pl = GetPseudoLayer(layer, dir, reserve.Data(), workspace.Data());
+                BackwardDataPseudoLayer(pl, dir, weightsW.Data(), dy, dhRec, dcRec);
+
+                // input gradient of all time steps at once; the directions add up
+                Gemm<ElemType>(1, weightsW.Data() + pl.wOffset, pl.inputDim, G * H, false, pl.dGates, G * H, N, false, dir == 0 ? 0 : 1, dxLayer, pl.inputDim, N);
+            }
+        }
+    }
+    m_BackwardDataCalledYet = true;
+}
+
+template <class ElemType>
+void CPURNNExecutor<ElemType>::BackwardDataPseudoLayer(const PseudoLayer& pl, size_t dir, const ElemType* weights, const ElemType* dy, ElemType* dhRec[2], ElemType* dcRec[2])
+{
+    const size_t H = m_rnnAttributes.m_hiddenSize, GH = m_numGates * H, T = m_numSequencesForFrame.size();
+
+    // the time steps in the reverse order of the forward pass; dhRec/dcRec[cur] hold the gradient that flows back
+    // into the current time step from its successor, for the first 'numRec' sequences
+    size_t numRec = 0;
+    int cur = 0;
+    for (size_t i = 0; i < T; i++)
+    {
+        const size_t t = dir == 0 ? T - 1 - i : i;
+        const size_t col = m_frameOffsets[t];
+        size_t prevCol, numPrev;
+        GetPredecessor(dir, t, prevCol, numPrev);
+        BackwardDataStep(pl, col, m_numSequencesForFrame[t], prevCol, numPrev, dy, dir * H, dhRec[cur], dcRec[cur], numRec, dhRec[1 - cur], dcRec[1 - cur]);
+
+        // recurrent gradient for the predecessor; GRU adds to the direct part set by BackwardDataStep()
+        Gemm<ElemType>(1, weights + pl.rOffset, H, GH, false, pl.dGatesR + col * GH, GH, numPrev, false, m_cellType == CellType::GRU ? 1 : 0, dhRec[1 - cur], H, numPrev);
+        cur = 1 - cur;
+        numRec = numPrev;
+    }
+}
+
+template <class ElemType>
+void CPURNNExecutor<ElemType>::BackwardDataStep(const PseudoLayer& pl, size_t col, size_t n, size_t prevCol, size_t numPrev, const ElemType* dy, size_t dyOffset,
+                                                const ElemType* dhRec, const ElemType* dcRec, size_t numRec, ElemType* dhPrev, ElemType* dcPrev)
+{
+    const size_t H = m_rnnAttributes.m_hiddenSize, GH = m_numGates * H;
+    const CellType cellType = m_cellType;
+    const size_t yDim = m_yDim;
+#pragma omp parallel for if (n * GH >= MinElementsForThreads)
+    for (long s = 0; s < (long) n; s++)
+    {
+        const ElemType* dyCol = dy + (col + s) * yDim + dyOffset;
+        const bool hasRec = (size_t) s < numRec;
+        const bool hasPrev = (size_t) s < numPrev;
+        ElemType* dGates = pl.dGates + (col + s) * GH;
+        switch (cellType)
+        {
+        case CellType::LSTM:
+            LSTMBackwardColumn(H, pl.gates + (col + s) * GH, pl.cell + (col + s) * H, dyCol, hasRec, dhRec + s * H, dcRec + s * H,
+                               hasPrev, pl.cell + (prevCol + s) * H, dGates, dcPrev + s * H);
+            break;
+        case CellType::GRU:
+            GRUBackwardColumn(H, pl.gates + (col + s) * GH, pl.rh + (col + s) * H, dyCol, hasRec, dhRec + s * H,
+                              hasPrev, pl.hidden + (prevCol + s) * H, dGates, pl.dGatesR + (col + s) * GH, dhPrev + s * H);
+            break;
+        default:
+            RNNBackwardColumn(H, cellType == CellType::ReLU, pl.hidden + (col + s) * H, dyCol, hasRec, dhRec + s * H, dGates);
+            break;
+        }
+    }
+}
+
+template <class ElemType>
+void CPURNNExecutor<ElemType>::BackwardWeightsCore(const CPUMatrix<ElemType>& inputX, const CPUMatrix<ElemType>& outputY, CPUMatrix<ElemType>& dw,
+                                                   const RnnAttributes& rnnAttributes,
+                                                   CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace)
+{
+    if (!(m_rnnAttributes == rnnAttributes))
+        LogicError("RNN Layout has changed during processing");
+    if (!m_BackwardDataCalledYet)
+        LogicError("CPURNNExecutor::BackwardWeightsCore: RNNBackwardData must be called first.");
+
+    const size_t H = m_rnnAttributes.m_hiddenSize, G = m_numGates, D = m_numDirections, L = m_rnnAttributes.m_numLayers, N = m_numColumns;
+    const auto numParameters = m_rnnAttributes.GetNumParameters(m_xDim);
+    if (numParameters.first * numParameters.second != dw.GetNumElements())
+        InvalidArgument("RNN needs %ld parameters, but %ld were allocated", (long) (numParameters.first * numParameters.second), (long) dw.GetNumElements());
+    if (inputX.GetNumRows() != m_xDim || inputX.GetNumCols() != N || outputY.GetNumRows() != m_yDim || outputY.GetNumCols() != N)
+        InvalidArgument("CPURNNExecutor::BackwardWeightsCore: Input and output must match the forward pass.");
+    if (workspace.GetNumElements() != BackwardWorkspaceSize())
+        LogicError("CPURNNExecutor::BackwardWeightsCore: The workspace has changed since RNNBackwardData.");
+
+    // the previous hidden states of all columns, zero for the first frame of a sequence; the gradient buffers are free by now
+    ElemType* hPrev = workspace.Data() + L * D * G * H * N * (m_cellType == CellType::GRU ? 2 : 1);
+
+    ElemType* dW = dw.Data();
+    for (size_t layer = 0; layer < L; layer++)
+    {
+        const ElemType* x = layer == 0 ? inputX.Data() : LayerOutput(layer - 1, reserve.Data());
+        for (size_t dir = 0; dir < D; dir++)
+        {
+            const PseudoLayer pl = GetPseudoLayer(layer, dir, reserve.Data(), workspace.Data());
+
+            // weight gradients of all time steps at once; like cuDNN, they are added to dw
+            Gemm<ElemType>(1, x, pl.inputDim, N, false, pl.dGates, G * H, N, true, 1, dW + pl.wOffset, pl.inputDim, G * H);
+
+            for (size_t t = 0; t < m_numSequencesForFrame.size(); t++)
+            {
+                size_t prevCol, numPrev;
+                GetPredecessor(dir, t, prevCol, numPrev);
+                ElemType* dst = hPrev + m_frameOffsets[t] * H;
+                memcpy(dst, pl.hidden + prevCol * H, numPrev * H * sizeof(ElemType));
+                memset(dst + numPrev * H, 0, (m_numSequencesForFrame[t] - numPrev) * H * sizeof(ElemType));
+            }
+            Gemm<ElemType>(1, hPrev, H, N, false, pl.dGatesR, G * H, N, true, 1, dW + pl.rOffset, H, G * H);
+
+            ElemType* dbW = dW + pl.bWOffset;
+            ElemType* dbR = dW + pl.bROffset;
+            for (size_t col = 0; col < N; col++)
+            {
+                const ElemType* dGates = pl.dGates + col * G * H;
+                const ElemType* dGatesR = pl.dGatesR + col * G * H;
+                for (size_t k = 0; k < G * H; k++)
+                {
+                    dbW[k] += dGates[k];
+                    dbR[k] += dGatesR[k];
+                }
+            }
+        }
+    }
+}
+
+template class CPURNNExecutor<float>;
+template class CPURNNExecutor<double>;
+
+}}}
@@ -0,0 +1,96 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPURNN.h -- CPU implementation of the OptimizedRNNStack engine, the counterpart of CuDnnRNN.h
+//
+// The parameter vector uses the cuDNN layout, so that models trained with cuDNN run unchanged on the CPU.
+// With G gates (LSTM: 4, ordered i, f, c~, o; GRU: 3, ordered r, z, h~; ReLU/Tanh: 1) and H = hiddenSize,
+// it holds, for each pseudo-layer (layer, then direction):
+//  - W: the input weights, column-major [inputDim x G*H], i.e. for each gate and hidden unit the inputDim weights
+//  - R: the recurrent weights, column-major [H x G*H]
+// followed by, again for each pseudo-layer:
+//  - bW, bR: two bias vectors of G*H elements each
+// The data is packed as for cuDNN: the columns are grouped by time step, and time step t holds the first
+// numSequencesForFrame[t] sequences (which must be non-increasing). A bidirectional layer outputs
+// [forward hidden state; backward hidden state].
+//
+// The input projections W^T * x of a pseudo-layer are computed for all time steps with a single GEMM.
+// The time steps then only need the recurrent GEMM R^T * h, followed by a fused kernel for all gates.
+//
+
+#pragma once
+
+#include "CPUMatrix.h"
+#include "RNNCommon.h"
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// CPURNNExecutor holds the configuration and the state between the forward and backward passes of an RNN
+// on the CPU. Like CuDnnRNNExecutor, it is attached to the output CPUMatrix, and must be called in the order
+// ForwardCore(), BackwardDataCore(), BackwardWeightsCore(). The reserve buffer (activations) must not be touched
+// between the three calls, and the workspace must not be touched between the two backward calls.
+template <class ElemType>
+class CPURNNExecutor
+{
+public:
+    CPURNNExecutor(size_t xDim, size_t yDim, const RnnAttributes& rnnAttributes);
+
+    void ForwardCore(const CPUMatrix<ElemType>& weightsW, const CPUMatrix<ElemType>& inputX, CPUMatrix<ElemType>& outputY, const vector<size_t>& numSequencesForFrame, const RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace);
+    void BackwardDataCore(const CPUMatrix<ElemType>& outputY, const CPUMatrix<ElemType>& outputDY, const CPUMatrix<ElemType>& weightsW, CPUMatrix<ElemType>& dx, const RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace);
+    void BackwardWeightsCore(const CPUMatrix<ElemType>& inputX, const CPUMatrix<ElemType>& outputY, CPUMatrix<ElemType>& dw, const RnnAttributes& rnnAttributes, CPUMatrix<ElemType>& reserve, CPUMatrix<ElemType>& workspace);
+
+private:
+    enum class CellType
+    {
+        LSTM,
+        GRU,
+        ReLU,
+        Tanh
+    };
+
+    // offsets of the parameters of a pseudo-layer (layer, direction), and pointers to its parts of the reserve and the workspace
+    struct PseudoLayer
+    {
+        size_t inputDim;
+        size_t wOffset;     // W [inputDim x G*H] in the parameters
+        size_t rOffset;     // R [H x G*H]
+        size_t bWOffset;    // bW [G*H]
+        size_t bROffset;    // bR [G*H]
+        ElemType* hidden;   // [H x N] hidden state
+        ElemType* cell;     // [H x N] cell state (LSTM only)
+        ElemType* rh;       // [H x N] R_h^T * h + bR_h (GRU only)
+        ElemType* gates;    // [G*H x N] input projection, then gate activations (for ReLU/Tanh, the same as 'hidden')
+        ElemType* dGates;   // [G*H x N] (workspace) gradient of the gate pre-activations w.r.t. the input projection
+        ElemType* dGatesR;  // [G*H x N] (workspace) same w.r.t. the recurrent projection (the same as 'dGates' except for GRU)
+    };
+
+    PseudoLayer GetPseudoLayer(size_t layer, size_t dir, ElemType* reserve, ElemType* workspace) const;
+    ElemType* LayerOutput(size_t layer, ElemType* reserve) const; // [D*H x N] output of all but the last layer
+    size_t PseudoLayerReserveSize() const;
+    size_t ReserveSize() const;
+    size_t ForwardWorkspaceSize() const;
+    size_t BackwardWorkspaceSize() const;
+
+    void ForwardPseudoLayer(const PseudoLayer& pl, size_t dir, const ElemType* weights, const ElemType* x, ElemType* recurrent);
+    void ForwardStep(const PseudoLayer& pl, const ElemType* weights, size_t col, size_t n, size_t prevCol, size_t numPrev, const ElemType* recurrent);
+    void BackwardDataPseudoLayer(const PseudoLayer& pl, size_t dir, const ElemType* weights, const ElemType* dy, ElemType* dhRec[2], ElemType* dcRec[2]);
+    void BackwardDataStep(const PseudoLayer& pl, size_t col, size_t n, size_t prevCol, size_t numPrev, const ElemType* dy, size_t dyOffset, const ElemType* dhRec, const ElemType* dcRec, size_t numRec, ElemType* dhPrev, ElemType* dcPrev);
+
+    // first column of the predecessor of time step t in direction 'dir', and the number of its sequences that continue at t
+    void GetPredecessor(size_t dir, size_t t, size_t& prevCol, size_t& numPrev) const;
+
+    RnnAttributes m_rnnAttributes;
+    CellType m_cellType;
+    size_t m_xDim, m_yDim;
+    size_t m_numGates;      // G
+    size_t m_numDirections; // D
+    size_t m_numColumns;    // N: total number of frames of all sequences
+    size_t m_maxNumSequences;
+    vector<size_t> m_numSequencesForFrame;
+    vector<size_t> m_frameOffsets; // first column of each time step
+    bool m_BackwardDataCalledYet;
+};
+
+}}}
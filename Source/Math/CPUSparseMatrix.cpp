@@ -1468,6 +1468,155 @@ void CPUSparseMatrix<ElemType>::AdaDelta(CPUMatrix<ElemType>& c, CPUMatrix<ElemT
     }
 }
 
+// The lazy learners below only touch the columns present in the gradient. Like AdaDelta they keep a timestamp
+// per column with the last minibatch in which the column was updated, and before the update of a column they
+// first apply what the dense implementation would have done to it in the minibatches it was absent from
+// (see CPUMatrix::MomentumSGDCatchUp and friends). This requires the learning rate and the momentums to be
+// the same in all of these minibatches, it is up to the caller to flush the state when they change.
+template <class ElemType>
+static void VerifyLazyUpdateArguments(const CPUSparseMatrix<ElemType>& gradients, CPUMatrix<ElemType>& c, size_t numColsNeeded)
+{
+    if (c.IsEmpty() || (c.GetNumCols() < numColsNeeded))
+    {
+        c.RequireSize(gradients.GetNumRows(), numColsNeeded);
+        c.SetValue(0.0);
+    }
+
+    if (c.GetNumRows() != gradients.GetNumRows() || c.GetNumCols() != numColsNeeded)
+        LogicError("The matrix gradients does not have expected dimensions.");
+
+    if (gradients.GetFormat() != MatrixFormat::matrixFormatSparseBlockCol)
+        LogicError("Unsupported sparse format.");
+}
+
+// Same as the dense Matrix::MomentumSGDUpdate:
+// 1) sg_t = momentum * sg_{t-1} + learnRatePerSample * unitGainFactor * g_{t-1}
+// 2) w_t = w_{t-1} - sg_t
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::MomentumSGD(CPUMatrix<ElemType>& c, CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum,
+                                            ElemType unitGainFactor, int* timestamps, int currentTimestamp)
+{
+    VerifyLazyUpdateArguments(*this, c, GetNumCols());
+
+    ElemType* grad = Data();
+    ElemType* smoothMom = c.Data();
+    ElemType* val = functionValues.Data();
+    auto rows = GetNumRows();
+    const ElemType gradientFactor = unitGainFactor * learnRatePerSample;
+
+#pragma omp parallel for
+    for (auto blockid = 0; blockid < (int)GetBlockSize(); ++blockid)
+    {
+        auto col = GetBlockIds()[blockid] - GetBlockIdShift();
+        auto columnOffset = col * rows;
+        auto blockOffset = blockid * rows;
+        CPUMatrix<ElemType>::MomentumSGDCatchUp(smoothMom + columnOffset, val + columnOffset, rows, momentum, currentTimestamp - 1 - timestamps[col]);
+        timestamps[col] = currentTimestamp;
+        for (auto row = 0; row < rows; ++row)
+        {
+            size_t denseIndex = columnOffset + row;
+            ElemType sg = momentum * smoothMom[denseIndex] + gradientFactor * grad[blockOffset + row];
+            smoothMom[denseIndex] = sg;
+            val[denseIndex] -= sg;
+        }
+    }
+}
+
+// Same as the dense CPUMatrix::FSAdagrad.
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::FSAdagrad(CPUMatrix<ElemType>& c, CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum,
+                                          ElemType adaWeight, ElemType adaMul, ElemType unitGainFactor, int* timestamps, int currentTimestamp)
+{
+    VerifyLazyUpdateArguments(*this, c, 2 * GetNumCols());
+
+    size_t n = functionValues.GetNumElements();
+    ElemType* grad = Data();
+    ElemType* smoothAda = c.Data();
+    ElemType* smoothMom = c.Data() + n;
+    ElemType* val = functionValues.Data();
+    auto rows = GetNumRows();
+
+#pragma omp parallel for
+    for (auto blockid = 0; blockid < (int)GetBlockSize(); ++blockid)
+    {
+        auto col = GetBlockIds()[blockid] - GetBlockIdShift();
+        auto columnOffset = col * rows;
+        auto blockOffset = blockid * rows;
+        CPUMatrix<ElemType>::FSAdagradCatchUp(smoothAda + columnOffset, smoothMom + columnOffset, val + columnOffset, rows,
+                                              learnRatePerSample, momentum, adaWeight, currentTimestamp - 1 - timestamps[col]);
+        timestamps[col] = currentTimestamp;
+        for (auto row = 0; row < rows; ++row)
+        {
+            size_t denseIndex = columnOffset + row;
+            ElemType g = grad[blockOffset + row];
+            ElemType adaSqr = adaWeight * smoothAda[denseIndex] + (1.0f - adaWeight) * g * g;
+            smoothAda[denseIndex] = adaSqr;
+            if (adaSqr != 0.0f)
+            {
+                ElemType w = adaMul * ((ElemType) 1.0 / sqrt(adaSqr));
+                if (w > 10.0f)
+                    w = 10.0f;
+                g *= w;
+            }
+
+            if (momentum > 0.0f)
+            {
+                g = momentum * smoothMom[denseIndex] + unitGainFactor * g;
+                smoothMom[denseIndex] = g;
+            }
+
+            val[denseIndex] -= g * learnRatePerSample;
+        }
+    }
+}
+
+// Same as the dense CPUMatrix::Adam. biasCorrections[t] holds the bias correction (adaMul) of the minibatch with timestamp t.
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::Adam(CPUMatrix<ElemType>& c, CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum,
+                                     ElemType adaWeight, ElemType adaMul, ElemType epsilon, ElemType unitGainFactor, bool adamax,
+                                     const double* biasCorrections, int* timestamps, int currentTimestamp)
+{
+    VerifyLazyUpdateArguments(*this, c, 2 * GetNumCols());
+
+    size_t n = functionValues.GetNumElements();
+    ElemType* grad = Data();
+    ElemType* smoothAda = c.Data();
+    ElemType* smoothMom = c.Data() + n;
+    ElemType* val = functionValues.Data();
+    auto rows = GetNumRows();
+
+#pragma omp parallel for
+    for (auto blockid = 0; blockid < (int)GetBlockSize(); ++blockid)
+    {
+        auto col = GetBlockIds()[blockid] - GetBlockIdShift();
+        auto columnOffset = col * rows;
+        auto blockOffset = blockid * rows;
+        CPUMatrix<ElemType>::AdamCatchUp(smoothAda + columnOffset, smoothMom + columnOffset, val + columnOffset, rows,
+                                         learnRatePerSample, momentum, adaWeight, epsilon, adamax,
+                                         biasCorrections + timestamps[col] + 1, currentTimestamp - 1 - timestamps[col]);
+        timestamps[col] = currentTimestamp;
+        for (auto row = 0; row < rows; ++row)
+        {
+            size_t denseIndex = columnOffset + row;
+            ElemType g = grad[blockOffset + row];
+            ElemType ada;
+            if (!adamax)
+            {
+                ElemType adaSqr = adaWeight * smoothAda[denseIndex] + (1.0f - adaWeight) * g * g;
+                smoothAda[denseIndex] = adaSqr;
+                ada = sqrt(adaSqr);
+            }
+            else
+                ada = smoothAda[denseIndex] = std::max(adaWeight * smoothAda[denseIndex], std::abs(g));
+
+            ElemType w = adaMul * (ElemType)(1.0 / (ada + epsilon));
+            g = momentum * smoothMom[denseIndex] + unitGainFactor * g;
+            smoothMom[denseIndex] = g;
+            val[denseIndex] -= g * w * learnRatePerSample;
+        }
+    }
+}
+
 template <class ElemType>
 CPUSparseMatrix<ElemType>& CPUSparseMatrix<ElemType>::InplaceTruncateTop(const ElemType threshold)
 {
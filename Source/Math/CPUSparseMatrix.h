@@ -234,6 +234,14 @@ public:
     ElemType Adagrad(CPUMatrix<ElemType>& c, const bool needAveMultiplier);
     void AdaDelta(CPUMatrix<ElemType>& c, CPUMatrix<ElemType>& functionValues, ElemType learningRate, ElemType rho, ElemType epsilon, int* timestamps, int currentTimestamp);
 
+    // Lazy counterparts of the dense CPUMatrix learners for block sparse column gradients, see the AdaDelta above.
+    void MomentumSGD(CPUMatrix<ElemType>& c, CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType unitGainFactor,
+                     int* timestamps, int currentTimestamp);
+    void FSAdagrad(CPUMatrix<ElemType>& c, CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight,
+                   ElemType adaMul, ElemType unitGainFactor, int* timestamps, int currentTimestamp);
+    void Adam(CPUMatrix<ElemType>& c, CPUMatrix<ElemType>& functionValues, ElemType learnRatePerSample, ElemType momentum, ElemType adaWeight,
+              ElemType adaMul, ElemType epsilon, ElemType unitGainFactor, bool adamax, const double* biasCorrections, int* timestamps, int currentTimestamp);
+
 public:
     CPUSparseMatrix<ElemType>& InplaceTruncateTop(const ElemType threshold);
     CPUSparseMatrix<ElemType>& InplaceTruncateBottom(const ElemType threshold);
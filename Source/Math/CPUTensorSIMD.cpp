@@ -0,0 +1,186 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPUTensorSIMD.cpp -- instruction-set detection and kernel dispatch for the SIMD tensor-op kernels
+//
+
+#include "stdafx.h"
+#include "CPUTensorSIMD.h"
+#include <atomic>
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace SIMD {
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+static void CpuId(int leaf, int subleaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+    for (int i = 0; i < 4; i++)
+        regs[i] = (unsigned int) r[i];
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// extended control register 0: which register states the OS saves on context switches
+static unsigned long long XGetBV()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long) edx << 32) | eax;
+#endif
+}
+
+static InstructionSet DetectInstructionSet()
+{
+    unsigned int regs[4]; // eax, ebx, ecx, edx
+    CpuId(0, 0, regs);
+    const unsigned int maxLeaf = regs[0];
+    if (maxLeaf < 1)
+        return InstructionSet::None;
+
+    CpuId(1, 0, regs);
+    const bool hasSSE41   = (regs[2] & (1u << 19)) != 0;
+    const bool hasFMA     = (regs[2] & (1u << 12)) != 0;
+    const bool hasOSXSave = (regs[2] & (1u << 27)) != 0;
+    const bool hasAVX     = (regs[2] & (1u << 28)) != 0;
+    const bool hasF16C    = (regs[2] & (1u << 29)) != 0; // present on all CPUs with AVX2, checked for the HalfGemm kernels
+    if (!hasSSE41)
+        return InstructionSet::None;
+    if (!hasAVX || !hasOSXSave || maxLeaf < 7)
+        return InstructionSet::SSE4;
+
+    // the OS must save the YMM (and for AVX-512 also the opmask and ZMM) registers
+    const unsigned long long xcr0 = XGetBV();
+    const bool osSavesYMM = (xcr0 & 0x06) == 0x06;
+    const bool osSavesZMM = (xcr0 & 0xe6) == 0xe6;
+
+    CpuId(7, 0, regs);
+    const bool hasAVX2    = (regs[1] & (1u << 5)) != 0;
+    const bool hasAVX512F = (regs[1] & (1u << 16)) != 0;
+    if (hasAVX512F && hasAVX2 && hasFMA && hasF16C && osSavesZMM)
+        return InstructionSet::AVX512;
+    if (hasAVX2 && hasFMA && hasF16C && osSavesYMM)
+        return InstructionSet::AVX2;
+    return InstructionSet::SSE4;
+}
+
+#else
+
+static InstructionSet DetectInstructionSet()
+{
+    return InstructionSet::None;
+}
+
+#endif
+
+InstructionSet GetSupportedInstructionSet()
+{
+    static const InstructionSet supported = DetectInstructionSet();
+    return supported;
+}
+
+static std::atomic<int> s_maxInstructionSet((int) InstructionSet::AVX512);
+
+InstructionSet GetInstructionSet()
+{
+    int supported = (int) GetSupportedInstructionSet();
+    int maxAllowed = s_maxInstructionSet;
+    return (InstructionSet) (supported < maxAllowed ? supported : maxAllowed);
+}
+
+void SetMaxInstructionSet(InstructionSet instructionSet)
+{
+    s_maxInstructionSet = (int) instructionSet;
+}
+
+const char* ToString(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+    case InstructionSet::None:   return "none";
+    case InstructionSet::SSE4:   return "SSE4.1";
+    case InstructionSet::AVX2:   return "AVX2";
+    case InstructionSet::AVX512: return "AVX-512";
+    default:                     return "unknown";
+    }
+}
+
+// kernel tables for all instruction sets up to the supported one
+// Each table is filled with the kernels of its own instruction set on top of those of the narrower ones,
+// so that an op missing from a wider instruction set falls back to the widest that has it.
+template <class ElemType>
+struct KernelTables
+{
+    KernelTable<ElemType> tables[(int) InstructionSet::AVX512 + 1];
+};
+
+struct AllKernelTables
+{
+    KernelTables<float> floatTables;
+    KernelTables<double> doubleTables;
+
+    AllKernelTables()
+    {
+        memset(this, 0, sizeof(*this)); // InstructionSet::None stays all nullptr
+        typedef void (*RegisterFn)(KernelTable<float>&, KernelTable<double>&);
+        static const RegisterFn registerFns[] = { nullptr, &RegisterKernelsSSE4, &RegisterKernelsAVX2, &RegisterKernelsAVX512 };
+        for (int isa = (int) InstructionSet::SSE4; isa <= (int) GetSupportedInstructionSet(); isa++)
+        {
+            floatTables.tables[isa] = floatTables.tables[isa - 1];
+            doubleTables.tables[isa] = doubleTables.tables[isa - 1];
+            registerFns[isa](floatTables.tables[isa], doubleTables.tables[isa]);
+        }
+    }
+
+    const KernelTable<float>& Get(float*) const { return floatTables.tables[(int) GetInstructionSet()]; }
+    const KernelTable<double>& Get(double*) const { return doubleTables.tables[(int) GetInstructionSet()]; }
+};
+
+static const AllKernelTables& GetAllKernelTables()
+{
+    static const AllKernelTables tables;
+    return tables;
+}
+
+template <class ElemType>
+UnaryKernel<ElemType> GetUnaryKernel(ElementWiseOperator op)
+{
+    return GetAllKernelTables().Get((ElemType*) nullptr).unary[op];
+}
+
+template <class ElemType>
+BinaryKernel<ElemType> GetBinaryKernel(ElementWiseOperator op)
+{
+    return GetAllKernelTables().Get((ElemType*) nullptr).binary[op];
+}
+
+template <class ElemType>
+TernaryKernel<ElemType> GetTernaryKernel(ElementWiseOperator op)
+{
+    return GetAllKernelTables().Get((ElemType*) nullptr).ternary[op];
+}
+
+template UnaryKernel<float>    GetUnaryKernel<float>(ElementWiseOperator op);
+template UnaryKernel<double>   GetUnaryKernel<double>(ElementWiseOperator op);
+template BinaryKernel<float>   GetBinaryKernel<float>(ElementWiseOperator op);
+template BinaryKernel<double>  GetBinaryKernel<double>(ElementWiseOperator op);
+template TernaryKernel<float>  GetTernaryKernel<float>(ElementWiseOperator op);
+template TernaryKernel<double> GetTernaryKernel<double>(ElementWiseOperator op);
+
+}}}}
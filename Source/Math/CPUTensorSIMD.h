@@ -0,0 +1,71 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPUTensorSIMD.h -- runtime-dispatched SIMD kernels for elementwise CPU tensor ops
+//
+// The kernels are compiled once per instruction set (CPUTensorSIMDSSE4.cpp, CPUTensorSIMDAVX2.cpp, CPUTensorSIMDAVX512.cpp)
+// from the same source (CPUTensorSIMDKernels.h). The best instruction set supported by CPU and OS is selected at runtime.
+// The kernels use polynomial approximations of exp(), log() and tanh(), so results differ from the scalar
+// path in TensorOps.h in the last bits.
+//
+
+#pragma once
+
+#include "CommonMatrix.h" // for ElementWiseOperator and MATH_API
+#include <cstddef>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace SIMD {
+
+enum class InstructionSet : int
+{
+    None = 0, // scalar code in TensorOps.h
+    SSE4 = 1,
+    AVX2 = 2, // AVX2 + FMA + F16C
+    AVX512 = 3, // AVX-512F
+};
+
+// best instruction set supported by this CPU and OS
+MATH_API InstructionSet GetSupportedInstructionSet();
+
+// instruction set currently used for tensor ops, i.e. the supported one, but at most what was set by SetMaxInstructionSet()
+MATH_API InstructionSet GetInstructionSet();
+
+// limit the instruction set used by the tensor ops, e.g. to compare against the scalar path (InstructionSet::None)
+MATH_API void SetMaxInstructionSet(InstructionSet instructionSet);
+
+MATH_API const char* ToString(InstructionSet instructionSet);
+
+// kernel signatures, operating on n contiguous elements: out[i] = beta * out[i] + alpha * op(a[i], ...)
+// If beta == 0, 'out' is not read.
+template <class ElemType> using UnaryKernel   = void (*)(size_t n, const ElemType* a, ElemType* out, ElemType alpha, ElemType beta);
+template <class ElemType> using BinaryKernel  = void (*)(size_t n, const ElemType* a, const ElemType* b, ElemType* out, ElemType alpha, ElemType beta);
+template <class ElemType> using TernaryKernel = void (*)(size_t n, const ElemType* a, const ElemType* b, const ElemType* c, ElemType* out, ElemType alpha, ElemType beta);
+
+// get the kernel for 'op' for the current instruction set, or nullptr if there is none
+template <class ElemType> UnaryKernel<ElemType>   GetUnaryKernel(ElementWiseOperator op);
+template <class ElemType> BinaryKernel<ElemType>  GetBinaryKernel(ElementWiseOperator op);
+template <class ElemType> TernaryKernel<ElemType> GetTernaryKernel(ElementWiseOperator op);
+
+// -----------------------------------------------------------------------
+// implementation details: kernel registration by the per-instruction-set compilation units
+// -----------------------------------------------------------------------
+
+// number of entries in the kernel tables, i.e. one past the last ElementWiseOperator
+static const size_t NumElementWiseOperators = (size_t) ElementWiseOperator::opElementwiseProductWithPowBaseDerivative + 1;
+
+template <class ElemType>
+struct KernelTable
+{
+    UnaryKernel<ElemType>   unary[NumElementWiseOperators];
+    BinaryKernel<ElemType>  binary[NumElementWiseOperators];
+    TernaryKernel<ElemType> ternary[NumElementWiseOperators];
+};
+
+// These fill in the kernels available for one instruction set (entries for missing kernels are left untouched).
+// They must only be called if the instruction set is supported.
+void RegisterKernelsSSE4  (KernelTable<float>& floatKernels, KernelTable<double>& doubleKernels);
+void RegisterKernelsAVX2  (KernelTable<float>& floatKernels, KernelTable<double>& doubleKernels);
+void RegisterKernelsAVX512(KernelTable<float>& floatKernels, KernelTable<double>& doubleKernels);
+
+}}}}
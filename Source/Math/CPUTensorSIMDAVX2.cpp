@@ -0,0 +1,34 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPUTensorSIMDAVX2.cpp -- elementwise tensor-op kernels for AVX2 and FMA
+//
+// This file is compiled with -mavx2 -mfma (see Makefile) and must not include anything that instantiates
+// shared inline code, see CPUTensorSIMDKernels.h. It is only called after checking CPU support.
+//
+
+#include "CPUTensorSIMD.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#define CNTK_SIMD_ISA AVX2
+#define CNTK_SIMD_ISA_ID 2
+#include "CPUTensorSIMDKernels.h"
+
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace SIMD {
+
+void RegisterKernelsAVX2(KernelTable<float>& floatKernels, KernelTable<double>& doubleKernels)
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    AVX2::RegisterKernels<AVX2::VecFloat>(floatKernels);
+    AVX2::RegisterKernels<AVX2::VecDouble>(doubleKernels);
+#else
+    (void) floatKernels; // not x64: no kernels
+    (void) doubleKernels;
+#endif
+}
+
+}}}}
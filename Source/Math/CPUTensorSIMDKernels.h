@@ -0,0 +1,586 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPUTensorSIMDKernels.h -- SIMD elementwise kernels, written once against a vector abstraction
+//
+// This file is included by exactly one compilation unit per instruction set, which defines CNTK_SIMD_ISA to one
+// of SSE4, AVX2, AVX512 (and CNTK_SIMD_ISA_ID to 1, 2, 3) and is compiled with the matching compiler flags.
+// Everything is placed into a namespace named after the instruction set, so that no inline function compiled
+// for a wider instruction set can be picked by the linker for use elsewhere. For the same reason, do not use
+// std templates here.
+//
+
+#pragma once
+
+#if !defined(CNTK_SIMD_ISA) || !defined(CNTK_SIMD_ISA_ID)
+#error CNTK_SIMD_ISA and CNTK_SIMD_ISA_ID must be defined before including CPUTensorSIMDKernels.h
+#endif
+
+#include "CPUTensorSIMD.h"
+#include <immintrin.h>
+#include <math.h>
+#include <stdint.h>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace SIMD { namespace CNTK_SIMD_ISA {
+
+// -----------------------------------------------------------------------
+// vector abstraction
+//
+// VecFloat and VecDouble wrap the intrinsics of one instruction set. Each provides
+//  - T, V: scalar and vector type; M: comparison mask type; width: number of elements in V
+//  - load/store (unaligned), set1
+//  - arithmetic, min/max (same NaN semantics as (a < b ? a : b) etc.), comparisons, Select(m, a, b) = m ? a : b
+//  - Round() to nearest integer, Pow2(n) = 2^n for integral-valued n, GetMantissa() and GetBiasedExponent() (frexp-like)
+// -----------------------------------------------------------------------
+
+#if CNTK_SIMD_ISA_ID == 1 // SSE4
+
+struct VecFloat
+{
+    typedef float T; typedef __m128 V; typedef __m128 M;
+    static const size_t width = 4;
+    static inline V Load(const T* p)          { return _mm_loadu_ps(p); }
+    static inline void Store(T* p, V a)       { _mm_storeu_ps(p, a); }
+    static inline V Set1(T a)                 { return _mm_set1_ps(a); }
+    static inline V Add(V a, V b)             { return _mm_add_ps(a, b); }
+    static inline V Sub(V a, V b)             { return _mm_sub_ps(a, b); }
+    static inline V Mul(V a, V b)             { return _mm_mul_ps(a, b); }
+    static inline V Div(V a, V b)             { return _mm_div_ps(a, b); }
+    static inline V MulAdd(V a, V b, V c)     { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static inline V Min(V a, V b)             { return _mm_min_ps(a, b); }
+    static inline V Max(V a, V b)             { return _mm_max_ps(a, b); }
+    static inline V Sqrt(V a)                 { return _mm_sqrt_ps(a); }
+    static inline V Abs(V a)                  { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static inline V Negate(V a)               { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+    static inline V CopySign(V a, V s)        { return _mm_or_ps(Abs(a), _mm_and_ps(_mm_set1_ps(-0.0f), s)); }
+    static inline M Less(V a, V b)            { return _mm_cmplt_ps(a, b); }
+    static inline M LessEqual(V a, V b)       { return _mm_cmple_ps(a, b); }
+    static inline M Greater(V a, V b)         { return _mm_cmpgt_ps(a, b); }
+    static inline M GreaterEqual(V a, V b)    { return _mm_cmpge_ps(a, b); }
+    static inline M Equal(V a, V b)           { return _mm_cmpeq_ps(a, b); }
+    static inline M NotEqual(V a, V b)        { return _mm_cmpneq_ps(a, b); }
+    static inline V Select(M m, V a, V b)     { return _mm_blendv_ps(b, a, m); }
+    static inline V Round(V a)                { return _mm_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static inline V Pow2(V n)                 { return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23)); }
+    // split a > 0 into mantissa in [1, 2) and biased exponent
+    static inline V GetMantissa(V a)          { return _mm_or_ps(_mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff))), _mm_set1_ps(1.0f)); }
+    static inline V GetBiasedExponent(V a)    { return _mm_cvtepi32_ps(_mm_srli_epi32(_mm_castps_si128(a), 23)); }
+};
+
+struct VecDouble
+{
+    typedef double T; typedef __m128d V; typedef __m128d M;
+    static const size_t width = 2;
+    static inline V Load(const T* p)          { return _mm_loadu_pd(p); }
+    static inline void Store(T* p, V a)       { _mm_storeu_pd(p, a); }
+    static inline V Set1(T a)                 { return _mm_set1_pd(a); }
+    static inline V Add(V a, V b)             { return _mm_add_pd(a, b); }
+    static inline V Sub(V a, V b)             { return _mm_sub_pd(a, b); }
+    static inline V Mul(V a, V b)             { return _mm_mul_pd(a, b); }
+    static inline V Div(V a, V b)             { return _mm_div_pd(a, b); }
+    static inline V MulAdd(V a, V b, V c)     { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    static inline V Min(V a, V b)             { return _mm_min_pd(a, b); }
+    static inline V Max(V a, V b)             { return _mm_max_pd(a, b); }
+    static inline V Sqrt(V a)                 { return _mm_sqrt_pd(a); }
+    static inline V Abs(V a)                  { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    static inline V Negate(V a)               { return _mm_xor_pd(_mm_set1_pd(-0.0), a); }
+    static inline V CopySign(V a, V s)        { return _mm_or_pd(Abs(a), _mm_and_pd(_mm_set1_pd(-0.0), s)); }
+    static inline M Less(V a, V b)            { return _mm_cmplt_pd(a, b); }
+    static inline M LessEqual(V a, V b)       { return _mm_cmple_pd(a, b); }
+    static inline M Greater(V a, V b)         { return _mm_cmpgt_pd(a, b); }
+    static inline M GreaterEqual(V a, V b)    { return _mm_cmpge_pd(a, b); }
+    static inline M Equal(V a, V b)           { return _mm_cmpeq_pd(a, b); }
+    static inline M NotEqual(V a, V b)        { return _mm_cmpneq_pd(a, b); }
+    static inline V Select(M m, V a, V b)     { return _mm_blendv_pd(b, a, m); }
+    static inline V Round(V a)                { return _mm_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static inline V Pow2(V n)                 { return _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(_mm_cvtepi32_epi64(_mm_cvtpd_epi32(n)), _mm_set1_epi64x(1023)), 52)); }
+    static inline V GetMantissa(V a)          { return _mm_or_pd(_mm_and_pd(a, _mm_castsi128_pd(_mm_set1_epi64x(0x000fffffffffffffLL))), _mm_set1_pd(1.0)); }
+    // no int64 -> double conversion before AVX-512DQ: place the exponent into the mantissa of 2^52 and subtract 2^52
+    static inline V GetBiasedExponent(V a)    { return _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(_mm_castpd_si128(a), 52), _mm_castpd_si128(_mm_set1_pd(4503599627370496.0)))), _mm_set1_pd(4503599627370496.0)); }
+};
+
+#elif CNTK_SIMD_ISA_ID == 2 // AVX2 + FMA
+
+struct VecFloat
+{
+    typedef float T; typedef __m256 V; typedef __m256 M;
+    static const size_t width = 8;
+    static inline V Load(const T* p)          { return _mm256_loadu_ps(p); }
+    static inline void Store(T* p, V a)       { _mm256_storeu_ps(p, a); }
+    static inline V Set1(T a)                 { return _mm256_set1_ps(a); }
+    static inline V Add(V a, V b)             { return _mm256_add_ps(a, b); }
+    static inline V Sub(V a, V b)             { return _mm256_sub_ps(a, b); }
+    static inline V Mul(V a, V b)             { return _mm256_mul_ps(a, b); }
+    static inline V Div(V a, V b)             { return _mm256_div_ps(a, b); }
+    static inline V MulAdd(V a, V b, V c)     { return _mm256_fmadd_ps(a, b, c); }
+    static inline V Min(V a, V b)             { return _mm256_min_ps(a, b); }
+    static inline V Max(V a, V b)             { return _mm256_max_ps(a, b); }
+    static inline V Sqrt(V a)                 { return _mm256_sqrt_ps(a); }
+    static inline V Abs(V a)                  { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static inline V Negate(V a)               { return _mm256_xor_ps(_mm256_set1_ps(-0.0f), a); }
+    static inline V CopySign(V a, V s)        { return _mm256_or_ps(Abs(a), _mm256_and_ps(_mm256_set1_ps(-0.0f), s)); }
+    static inline M Less(V a, V b)            { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static inline M LessEqual(V a, V b)       { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static inline M Greater(V a, V b)         { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static inline M GreaterEqual(V a, V b)    { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static inline M Equal(V a, V b)           { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static inline M NotEqual(V a, V b)        { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+    static inline V Select(M m, V a, V b)     { return _mm256_blendv_ps(b, a, m); }
+    static inline V Round(V a)                { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static inline V Pow2(V n)                 { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23)); }
+    static inline V GetMantissa(V a)          { return _mm256_or_ps(_mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff))), _mm256_set1_ps(1.0f)); }
+    static inline V GetBiasedExponent(V a)    { return _mm256_cvtepi32_ps(_mm256_srli_epi32(_mm256_castps_si256(a), 23)); }
+};
+
+struct VecDouble
+{
+    typedef double T; typedef __m256d V; typedef __m256d M;
+    static const size_t width = 4;
+    static inline V Load(const T* p)          { return _mm256_loadu_pd(p); }
+    static inline void Store(T* p, V a)       { _mm256_storeu_pd(p, a); }
+    static inline V Set1(T a)                 { return _mm256_set1_pd(a); }
+    static inline V Add(V a, V b)             { return _mm256_add_pd(a, b); }
+    static inline V Sub(V a, V b)             { return _mm256_sub_pd(a, b); }
+    static inline V Mul(V a, V b)             { return _mm256_mul_pd(a, b); }
+    static inline V Div(V a, V b)             { return _mm256_div_pd(a, b); }
+    static inline V MulAdd(V a, V b, V c)     { return _mm256_fmadd_pd(a, b, c); }
+    static inline V Min(V a, V b)             { return _mm256_min_pd(a, b); }
+    static inline V Max(V a, V b)             { return _mm256_max_pd(a, b); }
+    static inline V Sqrt(V a)                 { return _mm256_sqrt_pd(a); }
+    static inline V Abs(V a)                  { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    static inline V Negate(V a)               { return _mm256_xor_pd(_mm256_set1_pd(-0.0), a); }
+    static inline V CopySign(V a, V s)        { return _mm256_or_pd(Abs(a), _mm256_and_pd(_mm256_set1_pd(-0.0), s)); }
+    static inline M Less(V a, V b)            { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static inline M LessEqual(V a, V b)       { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static inline M Greater(V a, V b)         { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static inline M GreaterEqual(V a, V b)    { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static inline M Equal(V a, V b)           { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static inline M NotEqual(V a, V b)        { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+    static inline V Select(M m, V a, V b)     { return _mm256_blendv_pd(b, a, m); }
+    static inline V Round(V a)                { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static inline V Pow2(V n)                 { return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n)), _mm256_set1_epi64x(1023)), 52)); }
+    static inline V GetMantissa(V a)          { return _mm256_or_pd(_mm256_and_pd(a, _mm256_castsi256_pd(_mm256_set1_epi64x(0x000fffffffffffffLL))), _mm256_set1_pd(1.0)); }
+    static inline V GetBiasedExponent(V a)    { return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(_mm256_castpd_si256(a), 52), _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)))), _mm256_set1_pd(4503599627370496.0)); }
+};
+
+#elif CNTK_SIMD_ISA_ID == 3 // AVX-512F (no DQ: bitwise float ops go through the integer domain)
+
+struct VecFloat
+{
+    typedef float T; typedef __m512 V; typedef __mmask16 M;
+    static const size_t width = 16;
+    static inline V Load(const T* p)          { return _mm512_loadu_ps(p); }
+    static inline void Store(T* p, V a)       { _mm512_storeu_ps(p, a); }
+    static inline V Set1(T a)                 { return _mm512_set1_ps(a); }
+    static inline V Add(V a, V b)             { return _mm512_add_ps(a, b); }
+    static inline V Sub(V a, V b)             { return _mm512_sub_ps(a, b); }
+    static inline V Mul(V a, V b)             { return _mm512_mul_ps(a, b); }
+    static inline V Div(V a, V b)             { return _mm512_div_ps(a, b); }
+    static inline V MulAdd(V a, V b, V c)     { return _mm512_fmadd_ps(a, b, c); }
+    static inline V Min(V a, V b)             { return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), b, a); }
+    static inline V Max(V a, V b)             { return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), b, a); }
+    static inline V Sqrt(V a)                 { return _mm512_sqrt_ps(a); }
+    static inline V Abs(V a)                  { return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a), _mm512_set1_epi32(0x7fffffff))); }
+    static inline V Negate(V a)               { return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a), _mm512_set1_epi32((int) 0x80000000))); }
+    static inline V CopySign(V a, V s)        { return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_castps_si512(Abs(a)), _mm512_and_epi32(_mm512_castps_si512(s), _mm512_set1_epi32((int) 0x80000000)))); }
+    static inline M Less(V a, V b)            { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static inline M LessEqual(V a, V b)       { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static inline M Greater(V a, V b)         { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static inline M GreaterEqual(V a, V b)    { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+    static inline M Equal(V a, V b)           { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    static inline M NotEqual(V a, V b)        { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+    static inline V Select(M m, V a, V b)     { return _mm512_mask_blend_ps(m, b, a); }
+    static inline V Round(V a)                { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static inline V Pow2(V n)                 { return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23)); }
+    static inline V GetMantissa(V a)          { return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_and_epi32(_mm512_castps_si512(a), _mm512_set1_epi32(0x007fffff)), _mm512_set1_epi32(0x3f800000))); }
+    static inline V GetBiasedExponent(V a)    { return _mm512_cvtepi32_ps(_mm512_srli_epi32(_mm512_castps_si512(a), 23)); }
+};
+
+struct VecDouble
+{
+    typedef double T; typedef __m512d V; typedef __mmask8 M;
+    static const size_t width = 8;
+    static inline V Load(const T* p)          { return _mm512_loadu_pd(p); }
+    static inline void Store(T* p, V a)       { _mm512_storeu_pd(p, a); }
+    static inline V Set1(T a)                 { return _mm512_set1_pd(a); }
+    static inline V Add(V a, V b)             { return _mm512_add_pd(a, b); }
+    static inline V Sub(V a, V b)             { return _mm512_sub_pd(a, b); }
+    static inline V Mul(V a, V b)             { return _mm512_mul_pd(a, b); }
+    static inline V Div(V a, V b)             { return _mm512_div_pd(a, b); }
+    static inline V MulAdd(V a, V b, V c)     { return _mm512_fmadd_pd(a, b, c); }
+    static inline V Min(V a, V b)             { return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ), b, a); }
+    static inline V Max(V a, V b)             { return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), b, a); }
+    static inline V Sqrt(V a)                 { return _mm512_sqrt_pd(a); }
+    static inline V Abs(V a)                  { return _mm512_castsi512_pd(_mm512_and_epi64(_mm512_castpd_si512(a), _mm512_set1_epi64(0x7fffffffffffffffLL))); }
+    static inline V Negate(V a)               { return _mm512_castsi512_pd(_mm512_xor_epi64(_mm512_castpd_si512(a), _mm512_set1_epi64((long long) 0x8000000000000000ULL))); }
+    static inline V CopySign(V a, V s)        { return _mm512_castsi512_pd(_mm512_or_epi64(_mm512_castpd_si512(Abs(a)), _mm512_and_epi64(_mm512_castpd_si512(s), _mm512_set1_epi64((long long) 0x8000000000000000ULL)))); }
+    static inline M Less(V a, V b)            { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static inline M LessEqual(V a, V b)       { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    static inline M Greater(V a, V b)         { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+    static inline M GreaterEqual(V a, V b)    { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+    static inline M Equal(V a, V b)           { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+    static inline M NotEqual(V a, V b)        { return _mm512_cmp_pd_mask(a, b, _CMP_NEQ_UQ); }
+    static inline V Select(M m, V a, V b)     { return _mm512_mask_blend_pd(m, b, a); }
+    static inline V Round(V a)                { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    static inline V Pow2(V n)                 { return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(_mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(n)), _mm512_set1_epi64(1023)), 52)); }
+    static inline V GetMantissa(V a)          { return _mm512_castsi512_pd(_mm512_or_epi64(_mm512_and_epi64(_mm512_castpd_si512(a), _mm512_set1_epi64(0x000fffffffffffffLL)), _mm512_set1_epi64(0x3ff0000000000000LL))); }
+    static inline V GetBiasedExponent(V a)    { return _mm512_cvtepi32_pd(_mm512_cvtepi64_epi32(_mm512_srli_epi64(_mm512_castpd_si512(a), 52))); }
+};
+
+#else
+#error Unknown CNTK_SIMD_ISA_ID
+#endif
+
+// -----------------------------------------------------------------------
+// constants of the math function approximations, per precision
+// -----------------------------------------------------------------------
+
+template <class T> struct MathConstants;
+
+template <>
+struct MathConstants<float>
+{
+    // exp: exp(x) = 2^n * exp(r), r = x - n * ln(2) in [-ln(2)/2, ln(2)/2], with ln(2) split into a high part that is exact in float and a low part
+    static float ExpMax()    { return 88.72283f; }   // log(FLT_MAX)
+    static float ExpMin()    { return -87.33654f; }  // log(FLT_MIN)
+    static float Ln2Hi()     { return 0.693359375f; }
+    static float Ln2Lo()     { return -2.12194440e-4f; }
+    static const int ExpOrder = 7;                   // Taylor series up to r^7, rel. error < 1e-8
+    // log: log(x) = e * ln(2) + log(m), log(m) = 2 atanh(s), s = (m - 1) / (m + 1), m in [sqrt(0.5), sqrt(2))
+    static const int LogOrder = 4;                   // odd powers of s up to s^9
+    // tanh: Cephes polynomial for |x| < 0.625, tanh(x) = x + x^3 P(x^2)
+    static float TanhP(int i) { static const float p[] = { -5.70498872745e-3f, 2.06390887954e-2f, -5.37397155531e-2f, 1.33314422036e-1f, -3.33332819422e-1f }; return p[i]; }
+    static const int TanhOrderP = 5;
+    static const int TanhOrderQ = 0;
+    static float TanhQ(int) { return 1; }
+};
+
+template <>
+struct MathConstants<double>
+{
+    static double ExpMax()    { return 709.782712893384; } // log(DBL_MAX)
+    static double ExpMin()    { return -708.396418532264; } // log(DBL_MIN)
+    static double Ln2Hi()     { return 6.93145751953125e-1; }
+    static double Ln2Lo()     { return 1.42860682030941723212e-6; }
+    static const int ExpOrder = 13;                         // rel. error < 1e-17
+    static const int LogOrder = 9;                          // odd powers of s up to s^19
+    // tanh: Cephes rational function for |x| < 0.625, tanh(x) = x + x^3 P(x^2) / Q(x^2)
+    static double TanhP(int i) { static const double p[] = { -9.64399179425052238628e-1, -9.92877231001918586564e1, -1.61468768441708447952e3 }; return p[i]; }
+    static const int TanhOrderP = 3;
+    static double TanhQ(int i) { static const double q[] = { 1.0, 1.12811678491632931402e2, 2.23548839060100448583e3, 4.84406305325125486048e3 }; return q[i]; }
+    static const int TanhOrderQ = 4;
+};
+
+// -----------------------------------------------------------------------
+// vectorized math functions
+// -----------------------------------------------------------------------
+
+template <class VT>
+static inline typename VT::V Exp(typename VT::V x)
+{
+    typedef typename VT::T T;
+    typedef typename VT::V V;
+    typedef MathConstants<T> C;
+    // clamp first (NaNs pass through since min/max return the second operand for NaN); out-of-range values are fixed up at the end
+    V xc = VT::Max(VT::Set1(C::ExpMin()), VT::Min(VT::Set1(C::ExpMax()), x));
+    V n = VT::Round(VT::Mul(xc, VT::Set1((T) 1.44269504088896341)));
+    V r = VT::Sub(VT::Sub(xc, VT::Mul(n, VT::Set1(C::Ln2Hi()))), VT::Mul(n, VT::Set1(C::Ln2Lo())));
+    // Taylor series in Horner form
+    T coefficient = 1;
+    for (int k = 2; k <= C::ExpOrder; k++)
+        coefficient /= k;
+    V p = VT::Set1(coefficient);
+    for (int k = C::ExpOrder - 1; k >= 0; k--)
+    {
+        coefficient *= k + 1;
+        p = VT::MulAdd(p, r, VT::Set1(coefficient));
+    }
+    // 2^n = 2 * 2^(n-1), to keep the biased exponent of n = max. exponent + 1 representable
+    V result = VT::Mul(VT::Mul(p, VT::Pow2(VT::Sub(n, VT::Set1((T) 1)))), VT::Set1((T) 2));
+    result = VT::Select(VT::Greater(x, VT::Set1(C::ExpMax())), VT::Set1((T) INFINITY), result);
+    result = VT::Select(VT::Less(x, VT::Set1(C::ExpMin())), VT::Set1((T) 0), result);
+    return result;
+}
+
+// natural log for x > 0 (normalized numbers only; callers clip tiny values, see ClippedLog())
+template <class VT>
+static inline typename VT::V Log(typename VT::V x)
+{
+    typedef typename VT::T T;
+    typedef typename VT::V V;
+    typedef MathConstants<T> C;
+    V m = VT::GetMantissa(x);
+    V e = VT::GetBiasedExponent(x);
+    // move m from [1, 2) into [sqrt(0.5), sqrt(2))
+    auto isLarge = VT::Greater(m, VT::Set1((T) 1.41421356237309504880));
+    m = VT::Select(isLarge, VT::Mul(m, VT::Set1((T) 0.5)), m);
+    e = VT::Select(isLarge, VT::Add(e, VT::Set1((T) 1)), e);
+    e = VT::Sub(e, VT::Set1((T) (sizeof(T) == sizeof(float) ? 127 : 1023)));
+    // log(m) = 2 (s + s^3/3 + s^5/5 + ...)
+    V s = VT::Div(VT::Sub(m, VT::Set1((T) 1)), VT::Add(m, VT::Set1((T) 1)));
+    V s2 = VT::Mul(s, s);
+    V p = VT::Set1((T) 1 / (2 * C::LogOrder + 1));
+    for (int k = C::LogOrder - 1; k >= 0; k--)
+        p = VT::MulAdd(p, s2, VT::Set1((T) 1 / (2 * k + 1)));
+    V logm = VT::Mul(VT::Add(s, s), p);
+    // e * ln(2), with ln(2) split into two parts for precision
+    return VT::Add(VT::MulAdd(e, VT::Set1((T) 1.90821492927058770002e-10), logm), VT::Mul(e, VT::Set1((T) 6.93147180369123816490e-01)));
+}
+
+template <class VT>
+static inline typename VT::V Tanh(typename VT::V x)
+{
+    typedef typename VT::T T;
+    typedef typename VT::V V;
+    typedef MathConstants<T> C;
+    // large |x|: 1 - 2 / (exp(2|x|) + 1); exp() overflow to inf yields 1
+    V ax = VT::Abs(x);
+    V large = VT::Sub(VT::Set1((T) 1), VT::Div(VT::Set1((T) 2), VT::Add(Exp<VT>(VT::Add(ax, ax)), VT::Set1((T) 1))));
+    large = VT::CopySign(large, x);
+    // small |x|: x + x^3 P(x^2) / Q(x^2), to avoid the cancellation above
+    V z = VT::Mul(x, x);
+    V p = VT::Set1(C::TanhP(0));
+    for (int k = 1; k < C::TanhOrderP; k++)
+        p = VT::MulAdd(p, z, VT::Set1(C::TanhP(k)));
+    if (C::TanhOrderQ > 0)
+    {
+        V q = VT::Set1(C::TanhQ(0));
+        for (int k = 1; k < C::TanhOrderQ; k++)
+            q = VT::MulAdd(q, z, VT::Set1(C::TanhQ(k)));
+        p = VT::Div(p, q);
+    }
+    V small = VT::MulAdd(VT::Mul(x, z), p, x);
+    return VT::Select(VT::Less(ax, VT::Set1((T) 0.625)), small, large);
+}
+
+template <class VT>
+static inline typename VT::V Sigmoid(typename VT::V x)
+{
+    // same formula as Sigmoid() in TensorOps.h
+    typedef typename VT::T T;
+    return VT::Div(VT::Set1((T) 1), VT::Add(Exp<VT>(VT::Negate(x)), VT::Set1((T) 1)));
+}
+
+template <class VT>
+static inline typename VT::V StableSigmoid(typename VT::V x)
+{
+    typedef typename VT::T T;
+    typedef typename VT::V V;
+    V q = Exp<VT>(VT::Negate(VT::Abs(x)));
+    V numer = VT::Select(VT::Greater(x, VT::Set1((T) 0)), VT::Set1((T) 1), q);
+    return VT::Div(numer, VT::Add(q, VT::Set1((T) 1)));
+}
+
+template <class VT>
+static inline typename VT::V ClippedLog(typename VT::V x)
+{
+    typedef typename VT::T T;
+    return VT::Select(VT::Less(x, VT::Set1((T) EPS_IN_LOG)), VT::Set1((T) LOG_OF_EPS_IN_LOG), Log<VT>(x));
+}
+
+// -----------------------------------------------------------------------
+// elementwise operations
+//
+// Each mirrors the Op* function of the same name in TensorOps.h.
+// -----------------------------------------------------------------------
+
+#pragma push_macro("DefUnarySIMDOp")
+#define DefUnarySIMDOp(op, expr)                  \
+    struct SIMDOp##op                             \
+    {                                             \
+        template <class VT>                       \
+        static inline typename VT::V Apply(typename VT::V a) \
+        {                                         \
+            return expr;                          \
+        }                                         \
+    }
+
+DefUnarySIMDOp(Copy, a);
+DefUnarySIMDOp(Negate, VT::Negate(a));
+DefUnarySIMDOp(Abs, VT::Abs(a));
+DefUnarySIMDOp(Reciprocal, VT::Select(VT::Equal(a, VT::Set1(0)), VT::Set1(0), VT::Div(VT::Set1(1), a)));
+DefUnarySIMDOp(Sigmoid, Sigmoid<VT>(a));
+DefUnarySIMDOp(Tanh, Tanh<VT>(a));
+DefUnarySIMDOp(Sqr, VT::Mul(a, a));
+DefUnarySIMDOp(Sqrt, VT::Sqrt(VT::Select(VT::Greater(a, VT::Set1(0)), a, VT::Set1(0))));
+DefUnarySIMDOp(Exp, Exp<VT>(a));
+DefUnarySIMDOp(Log, ClippedLog<VT>(a));
+DefUnarySIMDOp(LinearRectifier, VT::Select(VT::Greater(a, VT::Set1(0)), a, VT::Set1(0)));
+DefUnarySIMDOp(ExponentialLinearUnit, VT::Select(VT::GreaterEqual(a, VT::Set1(0)), a, VT::Sub(Exp<VT>(a), VT::Set1(1))));
+DefUnarySIMDOp(StableSigmoid, StableSigmoid<VT>(a));
+#pragma pop_macro("DefUnarySIMDOp")
+
+#pragma push_macro("DefBinarySIMDOp")
+#define DefBinarySIMDOp(op, expr)                 \
+    struct SIMDOp##op                             \
+    {                                             \
+        template <class VT>                       \
+        static inline typename VT::V Apply(typename VT::V a, typename VT::V b) \
+        {                                         \
+            return expr;                          \
+        }                                         \
+    }
+
+DefBinarySIMDOp(Sum, VT::Add(a, b));
+DefBinarySIMDOp(Difference, VT::Sub(a, b));
+DefBinarySIMDOp(ElementwiseProduct, VT::Mul(a, b));
+DefBinarySIMDOp(Max, VT::Select(VT::Greater(a, b), a, b));
+DefBinarySIMDOp(Min, VT::Select(VT::Less(a, b), a, b));
+DefBinarySIMDOp(MaskNegative, VT::Select(VT::GreaterEqual(b, VT::Set1(0)), a, VT::Set1(0)));
+DefBinarySIMDOp(ElementwiseProductWithSigmoidDerivativeFromOutput, VT::Mul(a, VT::Mul(b, VT::Sub(VT::Set1(1), b))));
+DefBinarySIMDOp(ElementwiseProductWithTanhDerivativeFromOutput, VT::Mul(a, VT::Sub(VT::Set1(1), VT::Mul(b, b))));
+DefBinarySIMDOp(ElementwiseProductWithLinearRectifierDerivativeFromOutput, VT::Select(VT::Greater(b, VT::Set1(0)), a, VT::Set1(0)));
+DefBinarySIMDOp(ElementwiseProductWithLogDerivativeFromOutput, VT::Mul(a, Exp<VT>(VT::Negate(b))));
+DefBinarySIMDOp(ElementwiseProductWithExponentialLinearUnitDerivativeFromOutput, VT::Select(VT::GreaterEqual(b, VT::Set1(0)), a, VT::Mul(a, VT::Add(b, VT::Set1(1)))));
+DefBinarySIMDOp(SqrOfDifference, VT::Mul(VT::Sub(a, b), VT::Sub(a, b)));
+#pragma pop_macro("DefBinarySIMDOp")
+
+#pragma push_macro("DefTernarySIMDOp")
+#define DefTernarySIMDOp(op, expr)                \
+    struct SIMDOp##op                             \
+    {                                             \
+        template <class VT>                       \
+        static inline typename VT::V Apply(typename VT::V a, typename VT::V b, typename VT::V c) \
+        {                                         \
+            return expr;                          \
+        }                                         \
+    }
+
+DefTernarySIMDOp(Cond, VT::Select(VT::NotEqual(a, VT::Set1(0)), b, c));
+DefTernarySIMDOp(CopyIfEqual, VT::Select(VT::Equal(a, b), c, VT::Set1(0)));
+DefTernarySIMDOp(Clip, VT::Select(VT::Less(c, a), a, VT::Select(VT::Greater(c, b), b, c)));
+DefTernarySIMDOp(ElementwiseProductWithLogSumDerivative, VT::Mul(a, StableSigmoid<VT>(VT::Sub(c, b))));
+DefTernarySIMDOp(ElementwiseProductWithExpOfDiff, VT::Mul(a, Exp<VT>(VT::Sub(b, c))));
+#pragma pop_macro("DefTernarySIMDOp")
+
+// -----------------------------------------------------------------------
+// kernels: out[i] = beta * out[i] + alpha * op(a[i], ...)
+// The remainder that does not fill a vector is processed through a zero-padded stack buffer.
+// -----------------------------------------------------------------------
+
+template <class VT>
+static inline void StoreScaled(typename VT::T* out, typename VT::V val, typename VT::T alpha, typename VT::T beta)
+{
+    if (alpha != 1)
+        val = VT::Mul(val, VT::Set1(alpha));
+    if (beta != 0)
+        val = VT::MulAdd(VT::Load(out), VT::Set1(beta), val);
+    VT::Store(out, val);
+}
+
+template <class T>
+static inline void CopyPartial(T* dst, const T* src, size_t n)
+{
+    for (size_t j = 0; j < n; j++)
+        dst[j] = src[j];
+}
+
+template <class VT, class OP>
+static void UnaryKernelFn(size_t n, const typename VT::T* a, typename VT::T* out, typename VT::T alpha, typename VT::T beta)
+{
+    typedef typename VT::T T;
+    const size_t w = VT::width;
+    size_t i = 0;
+    for (; i + w <= n; i += w)
+        StoreScaled<VT>(out + i, OP::template Apply<VT>(VT::Load(a + i)), alpha, beta);
+    if (i < n)
+    {
+        T ra[VT::width] = { 0 }, rout[VT::width] = { 0 };
+        CopyPartial(ra, a + i, n - i);
+        if (beta != 0)
+            CopyPartial(rout, out + i, n - i);
+        StoreScaled<VT>(rout, OP::template Apply<VT>(VT::Load(ra)), alpha, beta);
+        CopyPartial(out + i, rout, n - i);
+    }
+}
+
+template <class VT, class OP>
+static void BinaryKernelFn(size_t n, const typename VT::T* a, const typename VT::T* b, typename VT::T* out, typename VT::T alpha, typename VT::T beta)
+{
+    typedef typename VT::T T;
+    const size_t w = VT::width;
+    size_t i = 0;
+    for (; i + w <= n; i += w)
+        StoreScaled<VT>(out + i, OP::template Apply<VT>(VT::Load(a + i), VT::Load(b + i)), alpha, beta);
+    if (i < n)
+    {
+        T ra[VT::width] = { 0 }, rb[VT::width] = { 0 }, rout[VT::width] = { 0 };
+        CopyPartial(ra, a + i, n - i);
+        CopyPartial(rb, b + i, n - i);
+        if (beta != 0)
+            CopyPartial(rout, out + i, n - i);
+        StoreScaled<VT>(rout, OP::template Apply<VT>(VT::Load(ra), VT::Load(rb)), alpha, beta);
+        CopyPartial(out + i, rout, n - i);
+    }
+}
+
+template <class VT, class OP>
+static void TernaryKernelFn(size_t n, const typename VT::T* a, const typename VT::T* b, const typename VT::T* c, typename VT::T* out, typename VT::T alpha, typename VT::T beta)
+{
+    typedef typename VT::T T;
+    const size_t w = VT::width;
+    size_t i = 0;
+    for (; i + w <= n; i += w)
+        StoreScaled<VT>(out + i, OP::template Apply<VT>(VT::Load(a + i), VT::Load(b + i), VT::Load(c + i)), alpha, beta);
+    if (i < n)
+    {
+        T ra[VT::width] = { 0 }, rb[VT::width] = { 0 }, rc[VT::width] = { 0 }, rout[VT::width] = { 0 };
+        CopyPartial(ra, a + i, n - i);
+        CopyPartial(rb, b + i, n - i);
+        CopyPartial(rc, c + i, n - i);
+        if (beta != 0)
+            CopyPartial(rout, out + i, n - i);
+        StoreScaled<VT>(rout, OP::template Apply<VT>(VT::Load(ra), VT::Load(rb), VT::Load(rc)), alpha, beta);
+        CopyPartial(out + i, rout, n - i);
+    }
+}
+
+// -----------------------------------------------------------------------
+// registration
+// -----------------------------------------------------------------------
+
+template <class VT>
+static void RegisterKernels(KernelTable<typename VT::T>& kernels)
+{
+#define RegisterUnarySIMDOp(name)   kernels.unary[ElementWiseOperator::op##name]   = &UnaryKernelFn<VT, SIMDOp##name>
+#define RegisterBinarySIMDOp(name)  kernels.binary[ElementWiseOperator::op##name]  = &BinaryKernelFn<VT, SIMDOp##name>
+#define RegisterTernarySIMDOp(name) kernels.ternary[ElementWiseOperator::op##name] = &TernaryKernelFn<VT, SIMDOp##name>
+    RegisterUnarySIMDOp(Copy);
+    RegisterUnarySIMDOp(Negate);
+    RegisterUnarySIMDOp(Abs);
+    RegisterUnarySIMDOp(Reciprocal);
+    RegisterUnarySIMDOp(Sigmoid);
+    RegisterUnarySIMDOp(Tanh);
+    RegisterUnarySIMDOp(Sqr);
+    RegisterUnarySIMDOp(Sqrt);
+    RegisterUnarySIMDOp(Exp);
+    RegisterUnarySIMDOp(Log);
+    RegisterUnarySIMDOp(LinearRectifier);
+    RegisterUnarySIMDOp(ExponentialLinearUnit);
+    RegisterUnarySIMDOp(StableSigmoid);
+
+    RegisterBinarySIMDOp(Sum);
+    RegisterBinarySIMDOp(Difference);
+    RegisterBinarySIMDOp(ElementwiseProduct);
+    RegisterBinarySIMDOp(Max);
+    RegisterBinarySIMDOp(Min);
+    RegisterBinarySIMDOp(MaskNegative);
+    RegisterBinarySIMDOp(ElementwiseProductWithSigmoidDerivativeFromOutput);
+    RegisterBinarySIMDOp(ElementwiseProductWithTanhDerivativeFromOutput);
+    RegisterBinarySIMDOp(ElementwiseProductWithLinearRectifierDerivativeFromOutput);
+    RegisterBinarySIMDOp(ElementwiseProductWithLogDerivativeFromOutput);
+    RegisterBinarySIMDOp(ElementwiseProductWithExponentialLinearUnitDerivativeFromOutput);
+    RegisterBinarySIMDOp(SqrOfDifference);
+
+    RegisterTernarySIMDOp(Cond);
+    RegisterTernarySIMDOp(CopyIfEqual);
+    RegisterTernarySIMDOp(Clip);
+    RegisterTernarySIMDOp(ElementwiseProductWithLogSumDerivative);
+    RegisterTernarySIMDOp(ElementwiseProductWithExpOfDiff);
+#undef RegisterUnarySIMDOp
+#undef RegisterBinarySIMDOp
+#undef RegisterTernarySIMDOp
+}
+
+}}}}}
@@ -0,0 +1,34 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CPUTensorSIMDSSE4.cpp -- elementwise tensor-op kernels for SSE4.1
+//
+// This file is compiled with -msse4.1 (the default SSE_FLAGS in the Makefile) and must not include anything that instantiates
+// shared inline code, see CPUTensorSIMDKernels.h. It is only called after checking CPU support.
+//
+
+#include "CPUTensorSIMD.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+#define CNTK_SIMD_ISA SSE4
+#define CNTK_SIMD_ISA_ID 1
+#include "CPUTensorSIMDKernels.h"
+
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace SIMD {
+
+void RegisterKernelsSSE4(KernelTable<float>& floatKernels, KernelTable<double>& doubleKernels)
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    SSE4::RegisterKernels<SSE4::VecFloat>(floatKernels);
+    SSE4::RegisterKernels<SSE4::VecDouble>(doubleKernels);
+#else
+    (void) floatKernels; // not x64: no kernels
+    (void) doubleKernels;
+#endif
+}
+
+}}}}
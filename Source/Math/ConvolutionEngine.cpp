@@ -6,6 +6,7 @@
 #include "stdafx.h"
 #include "ConvolutionEngine.h"
 #include "CuDnnFactories.h"
+#include "DirectConvolution.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -854,6 +855,194 @@ public:
     }
 };
 
+//------------------------------------------------------------------
+// Direct convolution engine implementation.
+// This engine computes the forward pass of 2D convolutions with full sharing
+// without unrolling the input (see DirectConvolution.h):
+// * 3x3 kernels with stride 1: Winograd F(4x4,3x3), or F(2x2,3x3) for outputs smaller than 4x4.
+// * 1x1 kernels: a GEMM per sample directly on the input.
+// * kernels of depth 1 (depthwise): direct convolution of each input channel.
+// The algorithm is picked from the geometry when the engine is created.
+// Backpropagation uses the GEMM engine if the kernel has full depth and sharing,
+// and the reference engine otherwise. Uses reference engine for pooling operations.
+//------------------------------------------------------------------
+template <class ElemType>
+class DirectConvolutionEngine : public GemmConvolutionEngine<ElemType>
+{
+public:
+    using Base = GemmConvolutionEngine<ElemType>;
+    using typename Base::Mat;
+
+    enum class Algorithm
+    {
+        WinogradF2x2,
+        WinogradF4x4,
+        Pointwise,
+        Depthwise
+    };
+
+public:
+    DirectConvolutionEngine(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId, ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind, bool poolIncludePad)
+        : Base(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind, poolIncludePad)
+    {
+        m_isSupported = TryGetAlgorithm(geometry, m_algorithm, m_shape, m_sharedKernels);
+        m_useGemmForBackprop = geometry->KernelShape()[geometry->KernelShape().GetRank() - 1] == geometry->InputShape()[geometry->InputShape().GetRank() - 1] &&
+                               Base::IsSupported(deviceId, geometry);
+    }
+
+    const char* AlgorithmName() const
+    {
+        switch (m_algorithm)
+        {
+        case Algorithm::WinogradF2x2: return "Winograd F(2x2,3x3)";
+        case Algorithm::WinogradF4x4: return "Winograd F(4x4,3x3)";
+        case Algorithm::Pointwise:    return "pointwise";
+        default:                      return "depthwise";
+        }
+    }
+
+protected:
+    using Base::m_geometry;
+    using Base::m_maxTempMemSizeInSamples;
+
+    void EnsureCompatible() override
+    {
+        Base::EnsureCompatible();
+        if (!m_isSupported)
+            LogicError("Direct convolution engine does not support this convolution configuration. Geometry: %s", ((string)*m_geometry).c_str());
+    }
+
+    void ForwardCore(const Mat& in, const Mat& kernel, Mat& out, Mat& workspace) override
+    {
+        size_t batchSize = in.GetNumCols();
+        size_t subBatchSize = m_maxTempMemSizeInSamples == 0 ? batchSize : min(batchSize, m_maxTempMemSizeInSamples);
+        size_t inSize = m_geometry->InputShape().GetNumElements();
+        size_t outSize = m_geometry->OutputShape().GetNumElements();
+
+        size_t workspaceSize = 0;
+        if (m_algorithm == Algorithm::WinogradF2x2 || m_algorithm == Algorithm::WinogradF4x4)
+            workspaceSize = DirectConvolution::WinogradWorkspaceSize(m_shape, TileSize(), subBatchSize);
+        else if (m_algorithm == Algorithm::Pointwise)
+            workspaceSize = DirectConvolution::PointwiseWorkspaceSize(m_shape);
+        if (workspaceSize > 0)
+            workspace.Resize(workspaceSize, 1);
+
+        for (size_t start = 0; start < batchSize; start += subBatchSize)
+        {
+            size_t curBatchSize = min(subBatchSize, batchSize - start);
+            const ElemType* inData = in.Data() + start * inSize;
+            ElemType* outData = out.Data() + start * outSize;
+            switch (m_algorithm)
+            {
+            case Algorithm::WinogradF2x2:
+            case Algorithm::WinogradF4x4:
+                DirectConvolution::WinogradForward(m_shape, TileSize(), inData, kernel.Data(), outData, curBatchSize, workspace.Data());
+                break;
+            case Algorithm::Pointwise:
+                DirectConvolution::PointwiseForward(m_shape, inData, kernel.Data(), outData, curBatchSize, workspaceSize > 0 ? workspace.Data() : nullptr);
+                break;
+            case Algorithm::Depthwise:
+                DirectConvolution::DepthwiseForward(m_shape, m_sharedKernels, inData, kernel.Data(), outData, curBatchSize);
+                break;
+            }
+        }
+    }
+
+    void BackwardDataCore(const Mat& srcGrad, const Mat& kernel, Mat& grad, bool accumulateGradient, Mat& workspace) override
+    {
+        if (m_useGemmForBackprop)
+            Base::BackwardDataCore(srcGrad, kernel, grad, accumulateGradient, workspace);
+        else
+            ReferenceConvolutionEngine<ElemType>::BackwardDataCore(srcGrad, kernel, grad, accumulateGradient, workspace);
+    }
+
+    void BackwardKernelCore(const Mat& srcGrad, const Mat& in, Mat& kernelGrad, bool accumulateGradient, bool allowReuse, Mat& workspace) override
+    {
+        if (m_useGemmForBackprop)
+            Base::BackwardKernelCore(srcGrad, in, kernelGrad, accumulateGradient, allowReuse, workspace);
+        else
+            ReferenceConvolutionEngine<ElemType>::BackwardKernelCore(srcGrad, in, kernelGrad, accumulateGradient, allowReuse, workspace);
+    }
+
+    size_t TileSize() const
+    {
+        return m_algorithm == Algorithm::WinogradF2x2 ? 2 : 4;
+    }
+
+    // Picks the algorithm for 2D convolutions [W x H x C] with kernels [X x Y x C] (full depth) or [X x Y x 1] (depthwise).
+    static bool TryGetAlgorithm(ConvolveGeometryPtr geometry, Algorithm& algorithm, DirectConvolution::Shape& shape, bool& sharedKernels)
+    {
+        const auto& inT = geometry->InputShape();
+        const auto& kernT = geometry->KernelShape();
+        const auto& outT = geometry->OutputShape();
+        if (inT.GetRank() != 3 || kernT.GetRank() != 3 || outT.GetRank() != 3)
+            return false;
+        for (size_t i = 0; i < 3; i++)
+        {
+            if (geometry->GetDilation(i) != 1)
+                return false;
+        }
+        if (!geometry->GetSharing(0) || !geometry->GetSharing(1) || geometry->GetMapCount(0) != 1 || geometry->GetMapCount(1) != 1)
+            return false;
+
+        shape.inW = inT[0];
+        shape.inH = inT[1];
+        shape.inC = inT[2];
+        shape.outW = outT[0];
+        shape.outH = outT[1];
+        shape.outC = outT[2];
+        shape.kW = kernT[0];
+        shape.kH = kernT[1];
+        shape.strideW = geometry->GetStride(0);
+        shape.strideH = geometry->GetStride(1);
+        shape.padW = geometry->GetLowerPad(0);
+        shape.padH = geometry->GetLowerPad(1);
+        sharedKernels = true;
+
+        size_t mapCount = geometry->GetMapCount(2);
+        if (kernT[2] == inT[2])
+        {
+            if (outT[2] != mapCount)
+                return false;
+            if (shape.kW == 3 && shape.kH == 3 && shape.strideW == 1 && shape.strideH == 1)
+            {
+                // F(4x4,3x3) is faster even if the tiles overhang the output a bit, e.g. for 7x7
+                algorithm = shape.outW >= 4 && shape.outH >= 4 ? Algorithm::WinogradF4x4 : Algorithm::WinogradF2x2;
+                return true;
+            }
+            if (shape.kW == 1 && shape.kH == 1)
+            {
+                algorithm = Algorithm::Pointwise;
+                return true;
+            }
+            return false;
+        }
+        if (kernT[2] == 1 && geometry->GetStride(2) == 1 && geometry->GetLowerPad(2) == 0 && outT[2] == inT[2] * mapCount)
+        {
+            sharedKernels = geometry->GetSharing(2);
+            algorithm = Algorithm::Depthwise;
+            return true;
+        }
+        return false;
+    }
+
+public:
+    static bool IsSupported(DEVICEID_TYPE deviceId, ConvolveGeometryPtr geometry)
+    {
+        Algorithm algorithm;
+        DirectConvolution::Shape shape;
+        bool sharedKernels;
+        return deviceId < 0 && TryGetAlgorithm(geometry, algorithm, shape, sharedKernels);
+    }
+
+private:
+    bool m_isSupported;
+    bool m_useGemmForBackprop;
+    Algorithm m_algorithm;
+    DirectConvolution::Shape m_shape;
+    bool m_sharedKernels;
+};
+
 template <class ElemType>
 std::unique_ptr<ConvolutionEngine<ElemType>> ConvolutionEngine<ElemType>::Create(ConvolveGeometryPtr geometry, DEVICEID_TYPE deviceId,
                                                                                  ImageLayoutKind imageLayout, size_t maxTempMemSizeInSamples, PoolKind poolKind,
@@ -892,6 +1081,16 @@ std::unique_ptr<ConvolutionEngine<ElemType>> ConvolutionEngine<ElemType>::Create
                                                                forceDeterministicAlgorithms, poolIncludePad, inputHasFreeDimension);
     }
 
+    if (isEnabled(ConvolutionEngineKind::Direct) && poolKind == PoolKind::None &&
+        DirectConvolutionEngine<ElemType>::IsSupported(deviceId, geometry))
+    {
+        auto engine = std::make_unique<DirectConvolutionEngine<ElemType>>(geometry, deviceId, imageLayout, maxTempMemSizeInSamples, poolKind, poolIncludePad);
+        if (GetMathLibTraceLevel() > 0)
+            fprintf(stderr, "%lsusing direct convolution engine (%s) for geometry: %s.\n", logPrefix.c_str(), engine->AlgorithmName(), engStr.c_str());
+
+        return std::move(engine);
+    }
+
     if (isEnabled(ConvolutionEngineKind::Gemm) && GemmConvolutionEngine<ElemType>::IsSupported(deviceId, geometry))
     {
         if (GetMathLibTraceLevel() > 0)
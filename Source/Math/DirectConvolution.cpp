@@ -0,0 +1,323 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// DirectConvolution.cpp -- Winograd, pointwise and depthwise convolution kernels (see DirectConvolution.h)
+//
+
+#include "stdafx.h"
+#include "DirectConvolution.h"
+#include "CPUMatrix.h"
+#include <algorithm>
+#include <string.h>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace DirectConvolution {
+
+// c = op(a) * op(b), for dense column-major buffers
+template <class ElemType>
+static void Gemm(const ElemType* a, size_t aRows, size_t aCols, const ElemType* b, size_t bRows, size_t bCols, ElemType* c)
+{
+    if (aRows == 0 || bCols == 0)
+        return;
+    CPUMatrix<ElemType> aView(aRows, aCols, const_cast<ElemType*>(a), matrixFlagDontOwnBuffer);
+    CPUMatrix<ElemType> bView(bRows, bCols, const_cast<ElemType*>(b), matrixFlagDontOwnBuffer);
+    CPUMatrix<ElemType> cView(aRows, bCols, c, matrixFlagDontOwnBuffer);
+    CPUMatrix<ElemType>::MultiplyAndWeightedAdd(1, aView, false, bView, false, 0, cView);
+}
+
+// -----------------------------------------------------------------------
+// Winograd F(m x m, 3 x 3)
+// The 2D transforms X^T x X are done as 1D transforms of the columns, then of the rows. The 1D transforms
+// are B^T d (input), G g (kernel) and A^T y (output), with the matrices of Lavin & Gray.
+// -----------------------------------------------------------------------
+
+template <class ElemType, size_t TileSize>
+struct Winograd;
+
+template <class ElemType>
+struct Winograd<ElemType, 2>
+{
+    static const size_t Alpha = 4;
+
+    static void TransformInput(const ElemType* d, size_t ds, ElemType* o, size_t os)
+    {
+        const ElemType d0 = d[0], d1 = d[ds], d2 = d[2 * ds], d3 = d[3 * ds];
+        o[0]      = d0 - d2;
+        o[os]     = d1 + d2;
+        o[2 * os] = d2 - d1;
+        o[3 * os] = d1 - d3;
+    }
+
+    static void TransformKernel(const ElemType* g, size_t gs, ElemType* o, size_t os)
+    {
+        const ElemType g0 = g[0], g1 = g[gs], g2 = g[2 * gs];
+        o[0]      = g0;
+        o[os]     = (g0 + g1 + g2) / 2;
+        o[2 * os] = (g0 - g1 + g2) / 2;
+        o[3 * os] = g2;
+    }
+
+    static void TransformOutput(const ElemType* m, size_t ms, ElemType* o, size_t os)
+    {
+        const ElemType m0 = m[0], m1 = m[ms], m2 = m[2 * ms], m3 = m[3 * ms];
+        o[0]  = m0 + m1 + m2;
+        o[os] = m1 - m2 - m3;
+    }
+};
+
+template <class ElemType>
+struct Winograd<ElemType, 4>
+{
+    static const size_t Alpha = 6;
+
+    static void TransformInput(const ElemType* d, size_t ds, ElemType* o, size_t os)
+    {
+        const ElemType d0 = d[0], d1 = d[ds], d2 = d[2 * ds], d3 = d[3 * ds], d4 = d[4 * ds], d5 = d[5 * ds];
+        o[0]      = 4 * d0 - 5 * d2 + d4;
+        o[os]     = -4 * (d1 + d2) + d3 + d4;
+        o[2 * os] = 4 * (d1 - d2) - d3 + d4;
+        o[3 * os] = 2 * (d3 - d1) - d2 + d4;
+        o[4 * os] = 2 * (d1 - d3) - d2 + d4;
+        o[5 * os] = 4 * d1 - 5 * d3 + d5;
+    }
+
+    static void TransformKernel(const ElemType* g, size_t gs, ElemType* o, size_t os)
+    {
+        const ElemType g0 = g[0], g1 = g[gs], g2 = g[2 * gs];
+        o[0]      = g0 / 4;
+        o[os]     = -(g0 + g1 + g2) / 6;
+        o[2 * os] = -(g0 - g1 + g2) / 6;
+        o[3 * os] = g0 / 24 + g1 / 12 + g2 / 6;
+        o[4 * os] = g0 / 24 - g1 / 12 + g2 / 6;
+        o[5 * os] = g2;
+    }
+
+    static void TransformOutput(const ElemType* m, size_t ms, ElemType* o, size_t os)
+    {
+        const ElemType m0 = m[0], m1 = m[ms], m2 = m[2 * ms], m3 = m[3 * ms], m4 = m[4 * ms], m5 = m[5 * ms];
+        o[0]      = m0 + (m1 + m2) + (m3 + m4);
+        o[os]     = (m1 - m2) + 2 * (m3 - m4);
+        o[2 * os] = (m1 + m2) + 4 * (m3 + m4);
+        o[3 * os] = (m1 - m2) + 8 * (m3 - m4) + m5;
+    }
+};
+
+template <class ElemType, size_t TileSize>
+static void WinogradForwardT(const Shape& shape, const ElemType* in, const ElemType* kernel, ElemType* out, size_t batchSize, ElemType* workspace)
+{
+    typedef Winograd<ElemType, TileSize> W;
+    const size_t alpha = W::Alpha, numPoints = alpha * alpha;
+    const size_t C = shape.inC, K = shape.outC;
+    const size_t inPlane = shape.inW * shape.inH, outPlane = shape.outW * shape.outH;
+    const size_t tilesW = (shape.outW + TileSize - 1) / TileSize, tilesH = (shape.outH + TileSize - 1) / TileSize;
+    const size_t tilesPerSample = tilesW * tilesH, P = tilesPerSample * batchSize;
+
+    // For each of the alpha x alpha points of a tile: U [C x K] (kernels), V [P x C] (input tiles), M [P x K] = V * U.
+    ElemType* U = workspace;
+    ElemType* V = U + numPoints * C * K;
+    ElemType* M = V + numPoints * C * P;
+
+#pragma omp parallel for
+    for (int64_t kc = 0; kc < (int64_t) (K * C); kc++)
+    {
+        const size_t k = kc / C, c = kc % C;
+        const ElemType* g = kernel + (k * C + c) * 9; // [3 x 3], x fastest
+        ElemType tmp[alpha * 3], u[alpha * alpha];
+        for (size_t x = 0; x < 3; x++)
+            W::TransformKernel(g + x, 3, tmp + x, 3);
+        for (size_t r = 0; r < alpha; r++)
+            W::TransformKernel(tmp + r * 3, 1, u + r * alpha, 1);
+        for (size_t point = 0; point < numPoints; point++)
+            U[point * C * K + k * C + c] = u[point];
+    }
+
+#pragma omp parallel for
+    for (int64_t cp = 0; cp < (int64_t) (C * P); cp++)
+    {
+        const size_t c = cp / P, p = cp % P;
+        const size_t n = p / tilesPerSample, tx = p % tilesPerSample % tilesW, ty = p % tilesPerSample / tilesW;
+        const ElemType* plane = in + n * inPlane * C + c * inPlane;
+        const int x0 = (int) (tx * TileSize) - shape.padW, y0 = (int) (ty * TileSize) - shape.padH;
+        ElemType d[alpha * alpha], tmp[alpha * alpha], v[alpha * alpha];
+        if (x0 >= 0 && y0 >= 0 && x0 + alpha <= shape.inW && y0 + alpha <= shape.inH)
+        {
+            for (size_t y = 0; y < alpha; y++)
+                memcpy(d + y * alpha, plane + (y0 + y) * shape.inW + x0, alpha * sizeof(ElemType));
+        }
+        else // tile overlaps the padding
+        {
+            for (size_t y = 0; y < alpha; y++)
+            {
+                const int iy = y0 + (int) y;
+                for (size_t x = 0; x < alpha; x++)
+                {
+                    const int ix = x0 + (int) x;
+                    d[y * alpha + x] = iy >= 0 && iy < (int) shape.inH && ix >= 0 && ix < (int) shape.inW ? plane[iy * shape.inW + ix] : 0;
+                }
+            }
+        }
+        for (size_t x = 0; x < alpha; x++)
+            W::TransformInput(d + x, alpha, tmp + x, alpha);
+        for (size_t r = 0; r < alpha; r++)
+            W::TransformInput(tmp + r * alpha, 1, v + r * alpha, 1);
+        for (size_t point = 0; point < numPoints; point++)
+            V[point * C * P + c * P + p] = v[point];
+    }
+
+    // one GEMM per point; BLAS does the threading
+    for (size_t point = 0; point < numPoints; point++)
+        Gemm(V + point * C * P, P, C, U + point * C * K, C, K, M + point * K * P);
+
+#pragma omp parallel for
+    for (int64_t kp = 0; kp < (int64_t) (K * P); kp++)
+    {
+        const size_t k = kp / P, p = kp % P;
+        const size_t n = p / tilesPerSample, tx = p % tilesPerSample % tilesW, ty = p % tilesPerSample / tilesW;
+        ElemType m[alpha * alpha], tmp[TileSize * alpha], y[TileSize * TileSize];
+        for (size_t point = 0; point < numPoints; point++)
+            m[point] = M[point * K * P + k * P + p];
+        for (size_t x = 0; x < alpha; x++)
+            W::TransformOutput(m + x, alpha, tmp + x, alpha);
+        for (size_t r = 0; r < TileSize; r++)
+            W::TransformOutput(tmp + r * alpha, 1, y + r * TileSize, 1);
+
+        ElemType* plane = out + n * outPlane * K + k * outPlane;
+        const size_t numRows = min(TileSize, shape.outH - ty * TileSize), numCols = min(TileSize, shape.outW - tx * TileSize);
+        for (size_t r = 0; r < numRows; r++)
+            for (size_t s = 0; s < numCols; s++)
+                plane[(ty * TileSize + r) * shape.outW + tx * TileSize + s] = y[r * TileSize + s];
+    }
+}
+
+static size_t AlphaFor(size_t tileSize)
+{
+    if (tileSize != 2 && tileSize != 4)
+        InvalidArgument("Winograd convolution: Unsupported tile size %d, must be 2 or 4.", (int) tileSize);
+    return tileSize + 2;
+}
+
+size_t WinogradWorkspaceSize(const Shape& shape, size_t tileSize, size_t batchSize)
+{
+    const size_t alpha = AlphaFor(tileSize);
+    const size_t P = (shape.outW + tileSize - 1) / tileSize * ((shape.outH + tileSize - 1) / tileSize) * batchSize;
+    return alpha * alpha * (shape.inC * shape.outC + shape.inC * P + shape.outC * P);
+}
+
+template <class ElemType>
+void WinogradForward(const Shape& shape, size_t tileSize, const ElemType* in, const ElemType* kernel, ElemType* out, size_t batchSize, ElemType* workspace)
+{
+    AlphaFor(tileSize);
+    if (shape.kW != 3 || shape.kH != 3 || shape.strideW != 1 || shape.strideH != 1)
+        InvalidArgument("Winograd convolution: Only 3x3 kernels with stride 1 are supported.");
+    if (tileSize == 2)
+        WinogradForwardT<ElemType, 2>(shape, in, kernel, out, batchSize, workspace);
+    else
+        WinogradForwardT<ElemType, 4>(shape, in, kernel, out, batchSize, workspace);
+}
+
+// -----------------------------------------------------------------------
+// pointwise (1x1) convolution
+// -----------------------------------------------------------------------
+
+static bool IsStridedOrPadded(const Shape& shape)
+{
+    return shape.strideW != 1 || shape.strideH != 1 || shape.padW != 0 || shape.padH != 0 || shape.outW != shape.inW || shape.outH != shape.inH;
+}
+
+size_t PointwiseWorkspaceSize(const Shape& shape)
+{
+    return IsStridedOrPadded(shape) ? shape.outW * shape.outH * shape.inC : 0;
+}
+
+template <class ElemType>
+void PointwiseForward(const Shape& shape, const ElemType* in, const ElemType* kernel, ElemType* out, size_t batchSize, ElemType* workspace)
+{
+    if (shape.kW != 1 || shape.kH != 1)
+        InvalidArgument("Pointwise convolution: Only 1x1 kernels are supported.");
+    const size_t inPlane = shape.inW * shape.inH, outPlane = shape.outW * shape.outH;
+    const bool gather = IsStridedOrPadded(shape);
+    for (size_t n = 0; n < batchSize; n++)
+    {
+        // [outW*outH x C] * [C x K] -> [outW*outH x K]
+        const ElemType* sample = in + n * inPlane * shape.inC;
+        if (gather)
+        {
+#pragma omp parallel for
+            for (int64_t cy = 0; cy < (int64_t) (shape.inC * shape.outH); cy++)
+            {
+                const size_t c = cy / shape.outH, oy = cy % shape.outH;
+                const int iy = (int) (oy * shape.strideH) - shape.padH;
+                ElemType* dst = workspace + c * outPlane + oy * shape.outW;
+                for (size_t ox = 0; ox < shape.outW; ox++)
+                {
+                    const int ix = (int) (ox * shape.strideW) - shape.padW;
+                    dst[ox] = iy >= 0 && iy < (int) shape.inH && ix >= 0 && ix < (int) shape.inW ? sample[c * inPlane + iy * shape.inW + ix] : 0;
+                }
+            }
+            sample = workspace;
+        }
+        Gemm(sample, outPlane, shape.inC, kernel, shape.inC, shape.outC, out + n * outPlane * shape.outC);
+    }
+}
+
+// -----------------------------------------------------------------------
+// depthwise convolution
+// -----------------------------------------------------------------------
+
+template <class ElemType>
+void DepthwiseForward(const Shape& shape, bool sharedKernels, const ElemType* in, const ElemType* kernel, ElemType* out, size_t batchSize)
+{
+    if (shape.outC % shape.inC != 0)
+        InvalidArgument("Depthwise convolution: The number of output channels (%d) must be a multiple of the number of input channels (%d).", (int) shape.outC, (int) shape.inC);
+    const size_t inPlane = shape.inW * shape.inH, outPlane = shape.outW * shape.outH;
+    const int inW = (int) shape.inW, inH = (int) shape.inH, strideW = (int) shape.strideW;
+
+#pragma omp parallel for
+    for (int64_t plane = 0; plane < (int64_t) (batchSize * shape.outC); plane++)
+    {
+        const size_t n = plane / shape.outC, o = plane % shape.outC;
+        const size_t c = o % shape.inC, k = o / shape.inC;
+        const ElemType* w = kernel + (sharedKernels ? k : o) * shape.kW * shape.kH;
+        const ElemType* src = in + n * inPlane * shape.inC + c * inPlane;
+        ElemType* dst = out + n * outPlane * shape.outC + o * outPlane;
+        memset(dst, 0, outPlane * sizeof(ElemType));
+        for (size_t oy = 0; oy < shape.outH; oy++)
+        {
+            ElemType* dstRow = dst + oy * shape.outW;
+            for (size_t j = 0; j < shape.kH; j++)
+            {
+                const int iy = (int) (oy * shape.strideH + j) - shape.padH;
+                if (iy < 0 || iy >= inH)
+                    continue;
+                const ElemType* srcRow = src + iy * inW;
+                for (size_t i = 0; i < shape.kW; i++)
+                {
+                    // output columns [begin, end) read input column ox * strideW + offset inside of the row
+                    const int offset = (int) i - shape.padW;
+                    const int begin = offset >= 0 ? 0 : (-offset + strideW - 1) / strideW;
+                    const int end = offset >= inW ? 0 : min((int) shape.outW, (inW - 1 - offset) / strideW + 1);
+                    const ElemType weight = w[j * shape.kW + i];
+                    if (strideW == 1)
+                    {
+                        for (int ox = begin; ox < end; ox++)
+                            dstRow[ox] += weight * srcRow[ox + offset];
+                    }
+                    else
+                    {
+                        for (int ox = begin; ox < end; ox++)
+                            dstRow[ox] += weight * srcRow[ox * strideW + offset];
+                    }
+                }
+            }
+        }
+    }
+}
+
+template MATH_API void WinogradForward<float>(const Shape& shape, size_t tileSize, const float* in, const float* kernel, float* out, size_t batchSize, float* workspace);
+template MATH_API void WinogradForward<double>(const Shape& shape, size_t tileSize, const double* in, const double* kernel, double* out, size_t batchSize, double* workspace);
+template MATH_API void PointwiseForward<float>(const Shape& shape, const float* in, const float* kernel, float* out, size_t batchSize, float* workspace);
+template MATH_API void PointwiseForward<double>(const Shape& shape, const double* in, const double* kernel, double* out, size_t batchSize, double* workspace);
+template MATH_API void DepthwiseForward<float>(const Shape& shape, bool sharedKernels, const float* in, const float* kernel, float* out, size_t batchSize);
+template MATH_API void DepthwiseForward<double>(const Shape& shape, bool sharedKernels, const double* in, const double* kernel, double* out, size_t batchSize);
+
+}}}}
@@ -0,0 +1,53 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// DirectConvolution.h -- 2D convolution kernels without im2col, used by DirectConvolutionEngine
+//
+// All tensors use the CHW (cuDNN) layout in CNTK column-major notation: a sample of the input is [W x H x C],
+// a sample of the output [W' x H' x C'], and the samples follow each other. Output pixel (x', y') reads the
+// input pixels (x' * strideW - padW + i, y' * strideH - padH + j) for the kernel offsets (i, j); pixels outside
+// of the input are zero.
+//  - Winograd: 3x3 kernels with stride 1 and full depth, with F(2x2,3x3) or F(4x4,3x3) tiles (Lavin & Gray,
+//    Fast Algorithms for Convolutional Neural Networks). The kernels and input tiles are transformed, multiplied
+//    with (tileSize + 2)^2 GEMMs over all tiles, and transformed back. F(4x4,3x3) needs 4x fewer multiplications
+//    than a direct 3x3 convolution, F(2x2,3x3) 2.25x, at a slightly lower numerical accuracy.
+//  - Pointwise: 1x1 kernels with full depth, i.e. a GEMM per sample directly on the input, which is only
+//    gathered first if the convolution is strided or padded.
+//  - Depthwise: kernels of depth 1 applied to each input channel separately, row by row.
+//
+
+#pragma once
+
+#include "CommonMatrix.h" // for MATH_API
+#include <cstddef>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace DirectConvolution {
+
+struct Shape
+{
+    size_t inW, inH, inC;    // input sample [inW x inH x inC]
+    size_t outW, outH, outC; // output sample [outW x outH x outC]
+    size_t kW, kH;           // kernel width and height
+    size_t strideW, strideH;
+    int padW, padH;          // lower padding
+};
+
+// Winograd convolution, tileSize 2 (F(2x2,3x3)) or 4 (F(4x4,3x3)).
+// 'kernel' holds outC kernels of [3 x 3 x inC] each. 'workspace' must hold WinogradWorkspaceSize() elements.
+MATH_API size_t WinogradWorkspaceSize(const Shape& shape, size_t tileSize, size_t batchSize);
+template <class ElemType>
+MATH_API void WinogradForward(const Shape& shape, size_t tileSize, const ElemType* in, const ElemType* kernel, ElemType* out, size_t batchSize, ElemType* workspace);
+
+// 1x1 convolution. 'kernel' holds outC kernels of [inC] each. 'workspace' must hold PointwiseWorkspaceSize() elements
+// (none if the convolution is neither strided nor padded).
+MATH_API size_t PointwiseWorkspaceSize(const Shape& shape);
+template <class ElemType>
+MATH_API void PointwiseForward(const Shape& shape, const ElemType* in, const ElemType* kernel, ElemType* out, size_t batchSize, ElemType* workspace);
+
+// Depthwise convolution: output channel c + inC * k is input channel c convolved with kernel k (if 'sharedKernels',
+// with outC / inC kernels of [kW x kH]) or with kernel c + inC * k (otherwise, with outC kernels).
+template <class ElemType>
+MATH_API void DepthwiseForward(const Shape& shape, bool sharedKernels, const ElemType* in, const ElemType* kernel, ElemType* out, size_t batchSize);
+
+}}}}
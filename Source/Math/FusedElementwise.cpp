@@ -0,0 +1,163 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// FusedElementwise.cpp -- blocked evaluation of elementwise programs, using the SIMD kernels of CPUTensorSIMD.h where available
+//
+
+#include "stdafx.h"
+#include "Basics.h"
+#include "FusedElementwise.h"
+#include "CPUTensorSIMD.h"
+#include "TensorOps.h"
+#include <algorithm>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace FusedElementwise {
+
+// Number of elements processed per instruction at a time. The intermediate results of one block
+// (program size x BlockSize elements) are meant to stay in the L1 cache.
+static const size_t BlockSize = 256;
+
+// programs over fewer elements than this are not worth forking threads for
+static const size_t MinElementsForThreads = 16384;
+
+static bool IsUnaryOp(ElementWiseOperator op)
+{
+#define CaseUnaryOp(oper)              \
+    case ElementWiseOperator::op##oper: \
+        return true
+    switch (op)
+    {
+        ForAllUnaryOps(CaseUnaryOp);
+    default:
+        return false;
+    }
+#undef CaseUnaryOp
+}
+
+static bool IsBinaryOp(ElementWiseOperator op)
+{
+#define CaseBinaryOp(oper)             \
+    case ElementWiseOperator::op##oper: \
+        return true
+    switch (op)
+    {
+        ForAllBinaryOps(CaseBinaryOp);
+    default:
+        return false;
+    }
+#undef CaseBinaryOp
+}
+
+void Verify(const std::vector<Instruction>& program, size_t numInputs)
+{
+    if (program.empty())
+        InvalidArgument("FusedElementwise: Empty program.");
+    for (size_t i = 0; i < program.size(); i++)
+    {
+        const auto& instruction = program[i];
+        if (instruction.numArgs == 1 ? !IsUnaryOp(instruction.op) : instruction.numArgs == 2 ? !IsBinaryOp(instruction.op) : true)
+            InvalidArgument("FusedElementwise: Instruction %d: Op code %d does not take %d arguments.", (int) i, (int) instruction.op, (int) instruction.numArgs);
+        for (size_t k = 0; k < instruction.numArgs; k++)
+        {
+            const int arg = instruction.args[k];
+            if (arg >= (int) i || (arg < 0 && -1 - arg >= (int) numInputs))
+                InvalidArgument("FusedElementwise: Instruction %d: Argument %d refers to %s %d, which is out of range.",
+                                (int) i, (int) k, arg < 0 ? "input" : "instruction", arg < 0 ? -1 - arg : arg);
+        }
+    }
+}
+
+// scalar fallback for ops without a SIMD kernel (or if SIMD is disabled)
+template <class ElemType>
+static void ApplyUnaryOp(ElementWiseOperator op, size_t n, const ElemType* a, ElemType* out)
+{
+#define CaseUnaryOp(oper)                  \
+    case ElementWiseOperator::op##oper:     \
+        for (size_t i = 0; i < n; i++)     \
+            out[i] = Op##oper(a[i]);       \
+        break
+    switch (op)
+    {
+        ForAllUnaryOps(CaseUnaryOp);
+    default:
+        LogicError("FusedElementwise: Unknown unary op code %d.", (int) op);
+    }
+#undef CaseUnaryOp
+}
+
+template <class ElemType>
+static void ApplyBinaryOp(ElementWiseOperator op, size_t n, const ElemType* a, const ElemType* b, ElemType* out)
+{
+#define CaseBinaryOp(oper)                 \
+    case ElementWiseOperator::op##oper:     \
+        for (size_t i = 0; i < n; i++)     \
+            out[i] = Op##oper(a[i], b[i]); \
+        break
+    switch (op)
+    {
+        ForAllBinaryOps(CaseBinaryOp);
+    default:
+        LogicError("FusedElementwise: Unknown binary op code %d.", (int) op);
+    }
+#undef CaseBinaryOp
+}
+
+template <class ElemType>
+void Evaluate(const std::vector<Instruction>& program, const std::vector<const ElemType*>& inputs, ElemType* output, size_t numElements)
+{
+    Verify(program, inputs.size());
+
+    // look up the kernels once
+    std::vector<SIMD::UnaryKernel<ElemType>> unaryKernels(program.size());
+    std::vector<SIMD::BinaryKernel<ElemType>> binaryKernels(program.size());
+    for (size_t i = 0; i < program.size(); i++)
+    {
+        if (program[i].numArgs == 1)
+            unaryKernels[i] = SIMD::GetUnaryKernel<ElemType>(program[i].op);
+        else
+            binaryKernels[i] = SIMD::GetBinaryKernel<ElemType>(program[i].op);
+    }
+
+    const size_t numInstructions = program.size();
+    const int numBlocks = (int) ((numElements + BlockSize - 1) / BlockSize);
+#pragma omp parallel if (numElements >= MinElementsForThreads)
+    {
+        // results of all but the last instruction for one block
+        std::vector<ElemType> scratch((numInstructions - 1) * BlockSize);
+#pragma omp for
+        for (int block = 0; block < numBlocks; block++)
+        {
+            const size_t begin = block * BlockSize;
+            const size_t n = std::min(BlockSize, numElements - begin);
+            auto argPtr = [&](int arg) -> const ElemType*
+            {
+                return arg < 0 ? inputs[-1 - arg] + begin : &scratch[arg * BlockSize];
+            };
+            for (size_t i = 0; i < numInstructions; i++)
+            {
+                const auto& instruction = program[i];
+                ElemType* out = i + 1 < numInstructions ? &scratch[i * BlockSize] : output + begin;
+                if (instruction.numArgs == 1)
+                {
+                    if (unaryKernels[i])
+                        unaryKernels[i](n, argPtr(instruction.args[0]), out, 1, 0);
+                    else
+                        ApplyUnaryOp(instruction.op, n, argPtr(instruction.args[0]), out);
+                }
+                else
+                {
+                    if (binaryKernels[i])
+                        binaryKernels[i](n, argPtr(instruction.args[0]), argPtr(instruction.args[1]), out, 1, 0);
+                    else
+                        ApplyBinaryOp(instruction.op, n, argPtr(instruction.args[0]), argPtr(instruction.args[1]), out);
+                }
+            }
+        }
+    }
+}
+
+template MATH_API void Evaluate<float>(const std::vector<Instruction>& program, const std::vector<const float*>& inputs, float* output, size_t numElements);
+template MATH_API void Evaluate<double>(const std::vector<Instruction>& program, const std::vector<const double*>& inputs, double* output, size_t numElements);
+
+}}}}
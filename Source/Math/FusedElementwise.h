@@ -0,0 +1,42 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// FusedElementwise.h -- evaluation of an expression of elementwise ops in a single pass over memory
+//
+// A program is a list of unary or binary ElementWiseOperator instructions over contiguous, equally sized inputs,
+// e.g. the gates of an LSTM cell. Evaluate() processes the elements in blocks that fit into the L1 cache: each
+// instruction is applied to a block before moving on to the next block, so that each input is read once, and
+// only the result of the last instruction is written to memory. Used for fused elementwise chains in
+// ComputationNetwork (see ComputationNetwork::FuseElementwiseChains()); CPU only.
+//
+
+#pragma once
+
+#include "CommonMatrix.h" // for ElementWiseOperator and MATH_API
+#include <cstddef>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace FusedElementwise {
+
+struct Instruction
+{
+    ElementWiseOperator op;
+    size_t numArgs; // 1 (ForAllUnaryOps) or 2 (ForAllBinaryOps)
+    int args[2];    // >= 0: result of an earlier instruction; < 0: input (-1 - args[i])
+};
+
+// argument reference to input 'index', for Instruction::args
+inline int InputArg(size_t index)
+{
+    return -1 - (int) index;
+}
+
+// Throws if the program is not well-formed (unknown or unsupported op, argument out of range or not computed yet).
+MATH_API void Verify(const std::vector<Instruction>& program, size_t numInputs);
+
+// output[0..numElements) = the result of the last instruction of 'program' applied to inputs[k][0..numElements)
+template <class ElemType>
+MATH_API void Evaluate(const std::vector<Instruction>& program, const std::vector<const ElemType*>& inputs, ElemType* output, size_t numElements);
+
+}}}}
@@ -1219,7 +1219,7 @@ void GPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, i
     if (matrixFlags & matrixFlagDontOwnBuffer)
     {
         // free the existing array if it used to be an owned array
-        if ( Buffer() != NULL)
+        if (Buffer() != NULL && OwnBuffer())
         {
             TracingGPUMemoryAllocator::Free<ElemType>(GetComputeDeviceId(), Buffer());
         }
@@ -1708,11 +1708,16 @@ void GPUMatrix<ElemType>::Resize(const size_t numRows, const size_t numCols, boo
     if (GetNumRows() == numRows && GetNumCols() == numCols)
         return;
 
-    VerifyResizable(__FUNCTION__);
-
     size_t numElements = numRows * numCols;
-    if (numElements > GetSizeAllocated() ||                     // grow allocation
-        (!growOnly && numElements != GetSizeAllocated()))   // shrink allocation if not growOnly
+
+    // an externally owned buffer (e.g. a slot in a MatrixPool arena) may be reshaped within its size, but never reallocated
+    bool fitsExternalBuffer = HasExternalBuffer() && m_sob.unique() && numElements <= GetSizeAllocated();
+    if (!fitsExternalBuffer)
+        VerifyResizable(__FUNCTION__);
+
+    if (!fitsExternalBuffer &&
+        (numElements > GetSizeAllocated() ||                    // grow allocation
+         (!growOnly && numElements != GetSizeAllocated())))     // shrink allocation if not growOnly
     {
         // If the buffer exists, free it before allocate
         if (Buffer())
@@ -0,0 +1,236 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// HalfGemm.cpp -- conversions, packing, blocking and threading of the 16-bit weight matrix product; scalar kernel
+//
+
+#include "stdafx.h"
+#include "HalfGemm.h"
+#include "CPUTensorSIMD.h"
+#include <algorithm>
+#include <string.h>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace HalfGemm {
+
+// Blocking of Multiply(): a task computes one panel of rows for a block of columns. The k dimension is
+// processed in blocks so that the A panel block (PanelRows x DepthBlockSize values) stays in L1 while
+// the kernel sweeps over the columns.
+static const int DepthBlockSize = 256;
+static const int ColumnBlockSize = 64;
+
+// products smaller than this (in multiply-adds) are not worth forking threads for
+static const double MinOpsForThreads = 1e6;
+
+Format ParseFormat(const std::wstring& name)
+{
+    if (name == L"float16")
+        return Format::Float16;
+    if (name == L"bfloat16")
+        return Format::BFloat16;
+    InvalidArgument("Unknown 16-bit storage format '%ls', expected 'float16' or 'bfloat16'.", name.c_str());
+}
+
+const wchar_t* ToString(Format format)
+{
+    return format == Format::Float16 ? L"float16" : L"bfloat16";
+}
+
+// -----------------------------------------------------------------------
+// conversions
+// -----------------------------------------------------------------------
+
+static inline unsigned int FloatBits(float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline float BitsToFloat(unsigned int bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+unsigned short FloatToHalf(float value)
+{
+    const unsigned int bits = FloatBits(value);
+    const unsigned int sign = (bits >> 16) & 0x8000;
+    const unsigned int absBits = bits & 0x7fffffff;
+
+    if (absBits >= 0x7f800000) // Inf and NaN; NaNs stay (quiet) NaNs
+        return (unsigned short) (sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 | ((absBits >> 13) & 0x3ff) : 0));
+    if (absBits >= 0x477ff000) // rounds to 65520 or more, beyond the largest half (65504)
+        return (unsigned short) (sign | 0x7c00);
+
+    if (absBits < 0x38800000) // below 2^-14, the smallest normal half
+    {
+        if (absBits < 0x33000000) // below or at half of the smallest subnormal (2^-24), rounds to zero
+            return (unsigned short) sign;
+
+        // subnormal: the result is the value in units of 2^-24
+        const unsigned int exponent = absBits >> 23;
+        const unsigned int mantissa = (absBits & 0x7fffff) | 0x800000;
+        const unsigned int shift = 126 - exponent;
+        unsigned int result = mantissa >> shift;
+        const unsigned int remainder = mantissa & ((1u << shift) - 1);
+        const unsigned int halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (result & 1)))
+            result++;
+        return (unsigned short) (sign | result);
+    }
+
+    // normal: rebias the exponent from 127 to 15 and round the mantissa from 23 to 10 bits;
+    // a carry out of the mantissa correctly increments the exponent
+    unsigned int result = absBits - 0x38000000;
+    result = (result + 0xfff + ((result >> 13) & 1)) >> 13;
+    return (unsigned short) (sign | result);
+}
+
+float HalfToFloat(unsigned short value)
+{
+    const unsigned int sign = (unsigned int) (value & 0x8000) << 16;
+    unsigned int exponent = (value >> 10) & 0x1f;
+    unsigned int mantissa = value & 0x3ff;
+
+    if (exponent == 0x1f) // Inf and NaN
+        return BitsToFloat(sign | 0x7f800000 | (mantissa << 13));
+    if (exponent != 0)
+        return BitsToFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    if (mantissa == 0)
+        return BitsToFloat(sign);
+
+    // subnormal: normalize
+    exponent = 113;
+    while (!(mantissa & 0x400))
+    {
+        mantissa <<= 1;
+        exponent--;
+    }
+    return BitsToFloat(sign | (exponent << 23) | ((mantissa & 0x3ff) << 13));
+}
+
+unsigned short FloatToBFloat16(float value)
+{
+    unsigned int bits = FloatBits(value);
+    if ((bits & 0x7fffffff) > 0x7f800000) // NaN: truncate, but keep it a (quiet) NaN
+        return (unsigned short) ((bits >> 16) | 0x40);
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return (unsigned short) (bits >> 16);
+}
+
+float BFloat16ToFloat(unsigned short value)
+{
+    return BitsToFloat((unsigned int) value << 16);
+}
+
+// -----------------------------------------------------------------------
+// packing
+// -----------------------------------------------------------------------
+
+size_t PackedASize(int m, int k)
+{
+    return (size_t) ((m + PanelRows - 1) / PanelRows * PanelRows) * k;
+}
+
+void PackA(int m, int k, const float* A, Format format, unsigned short* packedA)
+{
+    const int numPanels = (m + PanelRows - 1) / PanelRows;
+    const auto convert = (format == Format::Float16) ? &FloatToHalf : &FloatToBFloat16;
+#pragma omp parallel for if ((double) m * k >= MinOpsForThreads)
+    for (int p = 0; p < numPanels; p++)
+    {
+        for (int l = 0; l < k; l++)
+        {
+            unsigned short* dst = packedA + ((size_t) p * k + l) * PanelRows;
+            for (int r = 0; r < PanelRows; r++)
+            {
+                const int i = p * PanelRows + r;
+                dst[r] = (i < m) ? convert(A[i + (size_t) l * m]) : 0;
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// kernels
+// -----------------------------------------------------------------------
+
+// reference kernel, used if SIMD is disabled (SIMD::SetMaxInstructionSet()) or AVX2 is not available:
+// widens the panel block once and then runs a plain float loop
+template <Format format>
+static void KernelScalar(int k, const unsigned short* panel, const float* B, int ldb, int numCols, float* C, int ldc, bool accumulate)
+{
+    float a[DepthBlockSize * PanelRows];
+    for (int i = 0; i < k * PanelRows; i++)
+        a[i] = (format == Format::Float16) ? HalfToFloat(panel[i]) : BFloat16ToFloat(panel[i]);
+
+    for (int j = 0; j < numCols; j++)
+    {
+        float c[PanelRows];
+        for (int r = 0; r < PanelRows; r++)
+            c[r] = accumulate ? C[r + (size_t) j * ldc] : 0;
+        for (int l = 0; l < k; l++)
+        {
+            const float b = B[l + (size_t) j * ldb];
+            for (int r = 0; r < PanelRows; r++)
+                c[r] += a[l * PanelRows + r] * b;
+        }
+        for (int r = 0; r < PanelRows; r++)
+            C[r + (size_t) j * ldc] = c[r];
+    }
+}
+
+static Kernel GetKernel(Format format)
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    if (SIMD::GetInstructionSet() >= SIMD::InstructionSet::AVX2)
+        return (format == Format::Float16) ? &KernelFloat16AVX2 : &KernelBFloat16AVX2;
+#endif
+    return (format == Format::Float16) ? &KernelScalar<Format::Float16> : &KernelScalar<Format::BFloat16>;
+}
+
+// -----------------------------------------------------------------------
+// product
+// -----------------------------------------------------------------------
+
+void Multiply(int m, int n, int k, const unsigned short* packedA, Format format, const float* B, float* C)
+{
+    if (k == 0)
+    {
+        memset(C, 0, sizeof(float) * m * n);
+        return;
+    }
+
+    const Kernel kernel = GetKernel(format);
+    const int numPanels = (m + PanelRows - 1) / PanelRows;
+    const int numColumnBlocks = (n + ColumnBlockSize - 1) / ColumnBlockSize;
+    const int numTasks = numPanels * numColumnBlocks;
+
+#pragma omp parallel for schedule(dynamic) if (numTasks > 1 && (double) m * n * k >= MinOpsForThreads)
+    for (int task = 0; task < numTasks; task++)
+    {
+        // consecutive tasks share the same block of B
+        const int panelIndex = task % numPanels;
+        const int j0 = task / numPanels * ColumnBlockSize;
+        const int numCols = std::min(ColumnBlockSize, n - j0);
+        const unsigned short* panel = packedA + (size_t) panelIndex * k * PanelRows;
+
+        // The panel is computed into a tile of whole panel rows, since the last panel of C may be partial.
+        float tile[PanelRows * ColumnBlockSize];
+        for (int k0 = 0; k0 < k; k0 += DepthBlockSize)
+        {
+            const int depth = std::min(DepthBlockSize, k - k0);
+            kernel(depth, panel + (size_t) k0 * PanelRows, B + (size_t) j0 * k + k0, k, numCols, tile, PanelRows, k0 > 0);
+        }
+
+        const int i0 = panelIndex * PanelRows;
+        const int numRows = std::min(PanelRows, m - i0);
+        for (int j = 0; j < numCols; j++)
+            memcpy(C + (size_t) (j0 + j) * m + i0, tile + (size_t) j * PanelRows, sizeof(float) * numRows);
+    }
+}
+
+}}}}
@@ -0,0 +1,60 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// HalfGemm.h -- float matrix product with A stored in 16 bits (IEEE half or bfloat16), used by HalfPrecisionMultiplier
+//
+// A (typically the weights) is converted once and packed into panels of PanelRows rows, with the PanelRows values
+// of one k-element adjacent. The kernels widen each panel column to float in registers right before the multiply-adds,
+// so A is read from memory at half the bandwidth of a float GEMM, while all arithmetic is done in float.
+// The SIMD kernel (AVX2 + FMA + F16C) is selected at runtime, see CPUTensorSIMD.h.
+//
+
+#pragma once
+
+#include "CommonMatrix.h" // for MATH_API
+#include <cstddef>
+#include <string>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace HalfGemm {
+
+enum class Format : int
+{
+    Float16 = 0,  // IEEE 754 binary16: 5 exponent bits, 10 mantissa bits
+    BFloat16 = 1, // upper half of an IEEE 754 binary32: 8 exponent bits, 7 mantissa bits
+};
+
+// parses "float16" or "bfloat16"
+MATH_API Format ParseFormat(const std::wstring& name);
+MATH_API const wchar_t* ToString(Format format);
+
+// scalar conversions; float to 16 bits rounds to nearest even
+MATH_API unsigned short FloatToHalf(float value);
+MATH_API float HalfToFloat(unsigned short value);
+MATH_API unsigned short FloatToBFloat16(float value);
+MATH_API float BFloat16ToFloat(unsigned short value);
+
+// number of rows of A in one packed panel
+static const int PanelRows = 16;
+
+// number of 16-bit values needed for packed A[m,k]
+MATH_API size_t PackedASize(int m, int k);
+
+// convert column-major A[m,k] to 'format' and pack it into 'packedA' (PackedASize(m, k) elements); rows are zero-padded
+MATH_API void PackA(int m, int k, const float* A, Format format, unsigned short* packedA);
+
+// C[m,n] = A[m,k] * B[k,n] with A packed by PackA() and B and C column-major (leading dimensions k and m)
+MATH_API void Multiply(int m, int n, int k, const unsigned short* packedA, Format format, const float* B, float* C);
+
+// -----------------------------------------------------------------------
+// implementation details: micro kernels
+// -----------------------------------------------------------------------
+
+// Computes (or, if 'accumulate', adds to) one panel of C[PanelRows, numCols] += panel * B[k, numCols],
+// with 'panel' pointing to the packed A panel at the first k-element of this block, and B to its first k-element.
+typedef void (*Kernel)(int k, const unsigned short* panel, const float* B, int ldb, int numCols, float* C, int ldc, bool accumulate);
+
+void KernelFloat16AVX2(int k, const unsigned short* panel, const float* B, int ldb, int numCols, float* C, int ldc, bool accumulate);
+void KernelBFloat16AVX2(int k, const unsigned short* panel, const float* B, int ldb, int numCols, float* C, int ldc, bool accumulate);
+
+}}}}
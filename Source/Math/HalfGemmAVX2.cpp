@@ -0,0 +1,140 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// HalfGemmAVX2.cpp -- AVX2 + FMA + F16C kernels of the 16-bit weight matrix product (HalfGemm.h)
+//
+// This file is compiled with -mavx2 -mfma -mf16c (see Makefile) and must not instantiate any shared inline code
+// (e.g. std templates), since the linker might pick the AVX2 version for other callers.
+// It is only called after checking CPU support.
+//
+
+#include "HalfGemm.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace HalfGemm {
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+namespace AVX2 {
+
+// Load the 16 panel rows of one k-element and widen them to float: vcvtph2ps for IEEE half,
+// a shift into the upper half of each 32-bit lane for bfloat16.
+template <Format format>
+static inline void LoadPanelColumn(const unsigned short* a, __m256& a0, __m256& a1)
+{
+    const __m128i h0 = _mm_loadu_si128((const __m128i*) a);
+    const __m128i h1 = _mm_loadu_si128((const __m128i*) (a + 8));
+    if (format == Format::Float16)
+    {
+        a0 = _mm256_cvtph_ps(h0);
+        a1 = _mm256_cvtph_ps(h1);
+    }
+    else
+    {
+        a0 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h0), 16));
+        a1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h1), 16));
+    }
+}
+
+static inline __m256 LoadAccumulator(const float* C, bool accumulate)
+{
+    return accumulate ? _mm256_loadu_ps(C) : _mm256_setzero_ps();
+}
+
+// Multiply the 16 panel rows (a0, a1) with B[l,j] and add to the accumulators of column j.
+static inline void MultiplyAdd(__m256& acc0, __m256& acc1, __m256 a0, __m256 a1, const float* b)
+{
+    const __m256 bb = _mm256_broadcast_ss(b);
+    acc0 = _mm256_fmadd_ps(a0, bb, acc0);
+    acc1 = _mm256_fmadd_ps(a1, bb, acc1);
+}
+
+// 4 columns; the accumulators are spelled out to keep them in registers
+template <Format format>
+static void KernelColumns4(int k, const unsigned short* panel, const float* B, int ldb, float* C, int ldc, bool accumulate)
+{
+    const float* B0 = B;
+    const float* B1 = B + ldb;
+    const float* B2 = B + 2 * (size_t) ldb;
+    const float* B3 = B + 3 * (size_t) ldb;
+    __m256 c00 = LoadAccumulator(C, accumulate),                    c01 = LoadAccumulator(C + 8, accumulate);
+    __m256 c10 = LoadAccumulator(C + ldc, accumulate),              c11 = LoadAccumulator(C + ldc + 8, accumulate);
+    __m256 c20 = LoadAccumulator(C + 2 * (size_t) ldc, accumulate), c21 = LoadAccumulator(C + 2 * (size_t) ldc + 8, accumulate);
+    __m256 c30 = LoadAccumulator(C + 3 * (size_t) ldc, accumulate), c31 = LoadAccumulator(C + 3 * (size_t) ldc + 8, accumulate);
+
+    for (int l = 0; l < k; l++)
+    {
+        __m256 a0, a1;
+        LoadPanelColumn<format>(panel + (size_t) l * PanelRows, a0, a1);
+        MultiplyAdd(c00, c01, a0, a1, B0 + l);
+        MultiplyAdd(c10, c11, a0, a1, B1 + l);
+        MultiplyAdd(c20, c21, a0, a1, B2 + l);
+        MultiplyAdd(c30, c31, a0, a1, B3 + l);
+    }
+
+    _mm256_storeu_ps(C, c00);
+    _mm256_storeu_ps(C + 8, c01);
+    _mm256_storeu_ps(C + ldc, c10);
+    _mm256_storeu_ps(C + ldc + 8, c11);
+    _mm256_storeu_ps(C + 2 * (size_t) ldc, c20);
+    _mm256_storeu_ps(C + 2 * (size_t) ldc + 8, c21);
+    _mm256_storeu_ps(C + 3 * (size_t) ldc, c30);
+    _mm256_storeu_ps(C + 3 * (size_t) ldc + 8, c31);
+}
+
+template <Format format>
+static void KernelColumns1(int k, const unsigned short* panel, const float* B, float* C, bool accumulate)
+{
+    __m256 c0 = LoadAccumulator(C, accumulate), c1 = LoadAccumulator(C + 8, accumulate);
+    for (int l = 0; l < k; l++)
+    {
+        __m256 a0, a1;
+        LoadPanelColumn<format>(panel + (size_t) l * PanelRows, a0, a1);
+        MultiplyAdd(c0, c1, a0, a1, B + l);
+    }
+    _mm256_storeu_ps(C, c0);
+    _mm256_storeu_ps(C + 8, c1);
+}
+
+template <Format format>
+static void Kernel(int k, const unsigned short* panel, const float* B, int ldb, int numCols, float* C, int ldc, bool accumulate)
+{
+    int j = 0;
+    for (; j + 4 <= numCols; j += 4)
+        KernelColumns4<format>(k, panel, B + (size_t) j * ldb, ldb, C + (size_t) j * ldc, ldc, accumulate);
+    for (; j < numCols; j++)
+        KernelColumns1<format>(k, panel, B + (size_t) j * ldb, C + (size_t) j * ldc, accumulate);
+    _mm256_zeroupper();
+}
+
+} // namespace AVX2
+
+void KernelFloat16AVX2(int k, const unsigned short* panel, const float* B, int ldb, int numCols, float* C, int ldc, bool accumulate)
+{
+    AVX2::Kernel<Format::Float16>(k, panel, B, ldb, numCols, C, ldc, accumulate);
+}
+
+void KernelBFloat16AVX2(int k, const unsigned short* panel, const float* B, int ldb, int numCols, float* C, int ldc, bool accumulate)
+{
+    AVX2::Kernel<Format::BFloat16>(k, panel, B, ldb, numCols, C, ldc, accumulate);
+}
+
+#else
+
+void KernelFloat16AVX2(int, const unsigned short*, const float*, int, int, float*, int, bool)
+{
+    LogicError("HalfGemm::KernelFloat16AVX2: not available on this platform.");
+}
+
+void KernelBFloat16AVX2(int, const unsigned short*, const float*, int, int, float*, int, bool)
+{
+    LogicError("HalfGemm::KernelBFloat16AVX2: not available on this platform.");
+}
+
+#endif
+
+}}}}
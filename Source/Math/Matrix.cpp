@@ -1656,7 +1656,9 @@ void Matrix<ElemType>::MomentumSGDUpdate(Matrix<ElemType>& gradients,
                                          Matrix<ElemType>& smoothedGradients,
                                          ElemType learnRatePerSample,
                                          ElemType momentum,
-                                         ElemType unitGainFactor)
+                                         ElemType unitGainFactor,
+                                         int* timestamps,
+                                         int currentTimestamp)
 {
     DecideAndMoveToRightDevice(smoothedGradients, gradients, *this);
 
@@ -1682,11 +1684,20 @@ void Matrix<ElemType>::MomentumSGDUpdate(Matrix<ElemType>& gradients,
             // 1) sg_t = momentum * sg_{t-1} + (1.0 - momentum) * g_{t-1}
             // 2) g'_{t-1} = sg_t
             // 3) w_t = w_{t-1} - learnRatePerSample * g'_{t-1}
-            if (momentum != 0)
+            // With timestamps the lazy update is used instead, which gives the same result as the dense implementation.
+            if (timestamps != nullptr)
             {
-                gradients.m_CPUSparseMatrix->NormalGrad(*smoothedGradients.m_CPUMatrix, momentum, unitGainFactor);
+                gradients.m_CPUSparseMatrix->MomentumSGD(*smoothedGradients.m_CPUMatrix, *m_CPUMatrix, learnRatePerSample, momentum, unitGainFactor,
+                                                         timestamps, currentTimestamp);
+            }
+            else
+            {
+                if (momentum != 0)
+                {
+                    gradients.m_CPUSparseMatrix->NormalGrad(*smoothedGradients.m_CPUMatrix, momentum, unitGainFactor);
+                }
+                ScaleAndAdd(-learnRatePerSample, gradients, *this);
             }
-            ScaleAndAdd(-learnRatePerSample, gradients, *this);
         },
         { 
             if (momentum != 0)
@@ -1697,6 +1708,19 @@ void Matrix<ElemType>::MomentumSGDUpdate(Matrix<ElemType>& gradients,
         });
 }
 
+// Brings the state of the lazy MomentumSGDUpdate up to date for all columns, see AdaDeltaFlushState.
+template <class ElemType>
+void Matrix<ElemType>::MomentumSGDFlushState(Matrix<ElemType>& smoothedGradients, ElemType momentum, int* timestamps, int currentTimestamp)
+{
+    DecideAndMoveToRightDevice(smoothedGradients, *this);
+
+    DISPATCH_MATRIX_ON_FLAG(this, this,
+    { smoothedGradients.m_CPUMatrix->MomentumSGDFlushTimestamps(*m_CPUMatrix, momentum, timestamps, currentTimestamp); SetDataLocation(CPU); },
+    { NOT_IMPLEMENTED; },
+    { NOT_IMPLEMENTED; },
+    { NOT_IMPLEMENTED; });
+}
+
 // Nesterov accelerated SGD update.
 // Modifies "this" parameter matrix, on which this method is invoked.
 template <class ElemType>
@@ -1772,7 +1796,8 @@ ElemType Matrix<ElemType>::Adagrad(Matrix<ElemType>& gradients, const bool needA
 //  - the model itself
 template <class ElemType>
 void Matrix<ElemType>::FSAdagradUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const double targetAdagradAvDenom_x_sqrtAdagradSqrFrames,
-                                       const double learnRatePerSample, const double meanMomentum, const double varMomentum, ElemType unitGainFactor)
+                                       const double learnRatePerSample, const double meanMomentum, const double varMomentum, ElemType unitGainFactor,
+                                       int* timestamps, int currentTimestamp)
 {
     DISPATCH_MATRIX_ON_FLAG(&gradients, &gradients,
         { 
@@ -1787,7 +1812,16 @@ void Matrix<ElemType>::FSAdagradUpdate(Matrix<ElemType>& gradients, Matrix<ElemT
                                    (ElemType)targetAdagradAvDenom_x_sqrtAdagradSqrFrames, unitGainFactor);
             SetDataLocation(GPU); 
         },
-        { NOT_IMPLEMENTED; },
+        {
+            // only the lazy update is implemented for sparse gradients on the CPU
+            if (timestamps == nullptr)
+                NOT_IMPLEMENTED;
+            gradients.m_CPUSparseMatrix->FSAdagrad(*m_CPUMatrix, *functionValues.m_CPUMatrix,
+                                                   (ElemType)learnRatePerSample, (ElemType)meanMomentum, (ElemType)varMomentum,
+                                                   (ElemType)targetAdagradAvDenom_x_sqrtAdagradSqrFrames, unitGainFactor,
+                                                   timestamps, currentTimestamp);
+            SetDataLocation(CPU);
+        },
         {
             gradients.m_GPUSparseMatrix->FSAdagrad(*m_GPUMatrix, *functionValues.m_GPUMatrix, 
                                                    (ElemType)learnRatePerSample, (ElemType)meanMomentum, (ElemType)varMomentum,
@@ -1798,13 +1832,31 @@ void Matrix<ElemType>::FSAdagradUpdate(Matrix<ElemType>& gradients, Matrix<ElemT
     // Note: Since both 'this' and gradients are changed, we must call SetDataLocation() on 'this' as well.
 }
 
+template <class ElemType>
+void Matrix<ElemType>::FSAdagradFlushState(Matrix<ElemType>& functionValues, const double learnRatePerSample, const double meanMomentum, const double varMomentum,
+                                           int* timestamps, int currentTimestamp)
+{
+    DecideAndMoveToRightDevice(*this, functionValues);
+
+    DISPATCH_MATRIX_ON_FLAG(this, this,
+    {
+        m_CPUMatrix->FSAdagradFlushTimestamps(*functionValues.m_CPUMatrix, (ElemType)learnRatePerSample, (ElemType)meanMomentum, (ElemType)varMomentum,
+                                              timestamps, currentTimestamp);
+        SetDataLocation(CPU);
+    },
+    { NOT_IMPLEMENTED; },
+    { NOT_IMPLEMENTED; },
+    { NOT_IMPLEMENTED; });
+}
+
 ///
 // Implement the original adam algorithm according to the paper
 // Ref: ADAM: A METHOD FOR STOCHASTIC OPTIMIZATION, https://arxiv.org/pdf/1412.6980.pdf
 ///
 template <class ElemType>
 void Matrix<ElemType>::AdamUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const double smoothedCount,
-    const double learnRatePerSample, const double meanMomentum, const double varMomentum, const double epsilon, ElemType unitGainFactor, bool adamax)
+    const double learnRatePerSample, const double meanMomentum, const double varMomentum, const double epsilon, ElemType unitGainFactor, bool adamax,
+    const double* biasCorrections, int* timestamps, int currentTimestamp)
 {
     // Bias correction
     let biasCorrection = adamax? (ElemType)(1. / (1- pow(meanMomentum, smoothedCount))) : (ElemType)(sqrt(1- pow(varMomentum, smoothedCount))/(1- pow(meanMomentum, smoothedCount)));
@@ -1822,7 +1874,15 @@ void Matrix<ElemType>::AdamUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>&
         biasCorrection, (ElemType)epsilon, unitGainFactor, adamax);
         SetDataLocation(GPU);
     },
-    { NOT_IMPLEMENTED; },
+    {
+        // only the lazy update is implemented for sparse gradients on the CPU, biasCorrections holds the bias corrections of the past minibatches
+        if (timestamps == nullptr)
+            NOT_IMPLEMENTED;
+        gradients.m_CPUSparseMatrix->Adam(*m_CPUMatrix, *functionValues.m_CPUMatrix,
+        (ElemType)learnRatePerSample, (ElemType)meanMomentum, (ElemType)varMomentum,
+        biasCorrection, (ElemType)epsilon, unitGainFactor, adamax, biasCorrections, timestamps, currentTimestamp);
+        SetDataLocation(CPU);
+    },
     { gradients.m_GPUSparseMatrix->Adam(*m_GPUMatrix, *functionValues.m_GPUMatrix, 
         (ElemType)learnRatePerSample, (ElemType)meanMomentum, 
         (ElemType)varMomentum, biasCorrection, (ElemType)epsilon, unitGainFactor, adamax);
@@ -1831,6 +1891,23 @@ void Matrix<ElemType>::AdamUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>&
     // Note: Since both 'this' and gradients are changed, we must call SetDataLocation() on 'this' as well.
 }
 
+template <class ElemType>
+void Matrix<ElemType>::AdamFlushState(Matrix<ElemType>& functionValues, const double learnRatePerSample, const double meanMomentum, const double varMomentum,
+                                      const double epsilon, bool adamax, const double* biasCorrections, int* timestamps, int currentTimestamp)
+{
+    DecideAndMoveToRightDevice(*this, functionValues);
+
+    DISPATCH_MATRIX_ON_FLAG(this, this,
+    {
+        m_CPUMatrix->AdamFlushTimestamps(*functionValues.m_CPUMatrix, (ElemType)learnRatePerSample, (ElemType)meanMomentum, (ElemType)varMomentum,
+                                         (ElemType)epsilon, adamax, biasCorrections, timestamps, currentTimestamp);
+        SetDataLocation(CPU);
+    },
+    { NOT_IMPLEMENTED; },
+    { NOT_IMPLEMENTED; },
+    { NOT_IMPLEMENTED; });
+}
+
 template <class ElemType>
 ElemType Matrix<ElemType>::RmsProp(Matrix<ElemType>& gradients,
                                    ElemType RMS_GAMMA,
@@ -4926,7 +5003,7 @@ void Matrix<ElemType>::RNNForward(const Matrix<ElemType> &inputX, const Matrix<E
 
     DISPATCH_MATRIX_ON_FLAG(this,
                             this,
-                            NOT_IMPLEMENTED,
+                            m_CPUMatrix->RNNForward(*(inputX.m_CPUMatrix), *(paramW.m_CPUMatrix), xDim, yDim, numSequencesForFrame, rnnAttributes, *(reserve.m_CPUMatrix), *(workspace.m_CPUMatrix)),
                             m_GPUMatrix->RNNForward(*(inputX.m_GPUMatrix), *(paramW.m_GPUMatrix), xDim, yDim, numSequencesForFrame, rnnAttributes, *(reserve.m_GPUMatrix), *(workspace.m_GPUMatrix)),
                             NOT_IMPLEMENTED,
                             NOT_IMPLEMENTED);
@@ -4941,7 +5018,7 @@ void Matrix<ElemType>::RNNBackwardData(const Matrix<ElemType>& outputDY, const M
     workspace._transferToDevice(GetDeviceId());
     DISPATCH_MATRIX_ON_FLAG(this,
                             this,
-                            NOT_IMPLEMENTED,
+                            m_CPUMatrix->RNNBackwardData(*(outputDY.m_CPUMatrix), *(paramW.m_CPUMatrix), *(outputDX.m_CPUMatrix), rnnAttributes, *(reserve.m_CPUMatrix), *(workspace.m_CPUMatrix)),
                             m_GPUMatrix->RNNBackwardData(*(outputDY.m_GPUMatrix), *(paramW.m_GPUMatrix), *(outputDX.m_GPUMatrix), rnnAttributes, *(reserve.m_GPUMatrix), *(workspace.m_GPUMatrix)),
                             NOT_IMPLEMENTED,
                             NOT_IMPLEMENTED);
@@ -4956,7 +5033,7 @@ void Matrix<ElemType>::RNNBackwardWeights(const Matrix<ElemType>& inputX, const
     workspace._transferToDevice(GetDeviceId());
     DISPATCH_MATRIX_ON_FLAG(this,
                             this,
-                            NOT_IMPLEMENTED,
+                            m_CPUMatrix->RNNBackwardWeights(*(inputX.m_CPUMatrix), *(outputY.m_CPUMatrix), *(dw.m_CPUMatrix), rnnAttributes, *(reserve.m_CPUMatrix), *(workspace.m_CPUMatrix)),
                             m_GPUMatrix->RNNBackwardWeights(*(inputX.m_GPUMatrix), *(outputY.m_GPUMatrix), *(dw.m_GPUMatrix), rnnAttributes, *(reserve.m_GPUMatrix), *(workspace.m_GPUMatrix)),
                             NOT_IMPLEMENTED,
                             NOT_IMPLEMENTED);
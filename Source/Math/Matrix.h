@@ -205,15 +205,23 @@ public:
     void AssignDiagonalValuesTo(Matrix<ElemType>& diag) const;
 
     void SGDUpdate(Matrix<ElemType>& gradients, ElemType learnRatePerSample);
-    void MomentumSGDUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& smoothedGradients, ElemType learnRatePerSample, ElemType momentum, ElemType unitGainFactor);
+    void MomentumSGDUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& smoothedGradients, ElemType learnRatePerSample, ElemType momentum, ElemType unitGainFactor,
+                           int* timestamps = nullptr, int currentTimestamp = 0);
+    void MomentumSGDFlushState(Matrix<ElemType>& smoothedGradients, ElemType momentum, int* timestamps, int currentTimestamp);
     void NesterovAcceleratedMomentumSGDUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& smoothedGradients, ElemType learnRatePerSample, ElemType momentum, ElemType unitGainFactor);
 
     ElemType Adagrad(Matrix<ElemType>& gradients, const bool needAveMultiplier);
     void FSAdagradUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const double targetAdagradAvDenom_x_sqrtAdagradSqrFrames,
-                         const double learnRatePerSample, const double meanMomentum, const double varMomentum, ElemType unitGainFactor);
+                         const double learnRatePerSample, const double meanMomentum, const double varMomentum, ElemType unitGainFactor,
+                         int* timestamps = nullptr, int currentTimestamp = 0);
+    void FSAdagradFlushState(Matrix<ElemType>& functionValues, const double learnRatePerSample, const double meanMomentum, const double varMomentum,
+                             int* timestamps, int currentTimestamp);
 
     void AdamUpdate(Matrix<ElemType>& gradients, Matrix<ElemType>& functionValues, const double smoothedCount,
-        const double learnRatePerSample, const double meanMomentum, const double varMomentum, const double epsilon, ElemType unitGainFactor, bool adamax = false);
+        const double learnRatePerSample, const double meanMomentum, const double varMomentum, const double epsilon, ElemType unitGainFactor, bool adamax = false,
+        const double* biasCorrections = nullptr, int* timestamps = nullptr, int currentTimestamp = 0);
+    void AdamFlushState(Matrix<ElemType>& functionValues, const double learnRatePerSample, const double meanMomentum, const double varMomentum,
+                        const double epsilon, bool adamax, const double* biasCorrections, int* timestamps, int currentTimestamp);
 
     ElemType RmsProp(Matrix<ElemType>& gradients, ElemType RMS_GAMMA, ElemType RMS_WGT_INC, ElemType RMS_WGT_MAX, ElemType RMS_WGT_DEC, ElemType RMS_WGT_MIN, const bool needAveMultiplier, const bool initialized);
 
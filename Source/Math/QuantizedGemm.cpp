@@ -0,0 +1,205 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// QuantizedGemm.cpp -- packing, blocking and threading of the int16 matrix product; scalar and SSE2 kernels
+//
+
+#include "stdafx.h"
+#include "QuantizedGemm.h"
+#include "CPUTensorSIMD.h"
+#include <algorithm>
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace QuantizedGemm {
+
+// Blocking of Multiply(): a task computes one panel of rows for a block of columns. The k dimension is
+// processed in blocks so that the A panel block (PanelRows x DepthBlockSize shorts) stays in L1 while
+// the kernel sweeps over the columns.
+static const int DepthBlockSize = 256; // must be even, so that blocks start at pair boundaries
+static const int ColumnBlockSize = 64;
+
+// products smaller than this (in multiply-adds) are not worth forking threads for
+static const double MinOpsForThreads = 1e6;
+
+size_t PackedASize(int m, int k)
+{
+    return (size_t) ResultLeadingDim(m) * ((k + 1) / 2) * 2;
+}
+
+void PackA(int m, int k, const short* A, short* packedA)
+{
+    const int numPanels = (m + PanelRows - 1) / PanelRows;
+    const int kPairs = (k + 1) / 2;
+#pragma omp parallel for if ((double) m * k >= MinOpsForThreads)
+    for (int p = 0; p < numPanels; p++)
+    {
+        for (int kk = 0; kk < kPairs; kk++)
+        {
+            short* dst = packedA + ((size_t) p * kPairs + kk) * 2 * PanelRows;
+            for (int e = 0; e < 2; e++)
+            {
+                const int l = 2 * kk + e;
+                for (int r = 0; r < PanelRows; r++)
+                {
+                    const int i = p * PanelRows + r;
+                    dst[2 * r + e] = (i < m && l < k) ? A[i + (size_t) l * m] : 0;
+                }
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// kernels
+// -----------------------------------------------------------------------
+
+// reference kernel, used if SIMD is disabled (SIMD::SetMaxInstructionSet(InstructionSet::None)) or not available
+static void KernelScalar(int k, const short* panel, const short* B, int ldb, int numCols, int* C, int ldc, bool accumulate)
+{
+    for (int j = 0; j < numCols; j++)
+    {
+        for (int r = 0; r < PanelRows; r++)
+        {
+            int sum = accumulate ? C[r + (size_t) j * ldc] : 0;
+            for (int l = 0; l < k; l++)
+                sum += panel[(l / 2) * 2 * PanelRows + 2 * r + l % 2] * B[l + (size_t) j * ldb];
+            C[r + (size_t) j * ldc] = sum;
+        }
+    }
+}
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+// pair (B[l,j], B[l+1,j]) for l = 2p; for odd k, the last element is paired with zero (the packed A is zero-padded as well)
+static inline int LoadPair(const short* B, int p, int k)
+{
+    int pair;
+    if (2 * p + 1 < k)
+        memcpy(&pair, B + 2 * p, sizeof(pair));
+    else
+        pair = (unsigned short) B[2 * p];
+    return pair;
+}
+
+// 16 int32 or 16 pairs of int16, one per panel row; a struct rather than an array, so that it is kept in registers
+struct Vec16SSE2
+{
+    __m128i r0, r1, r2, r3;
+};
+
+static inline Vec16SSE2 LoadSSE2(const void* p)
+{
+    const __m128i* q = (const __m128i*) p;
+    return { _mm_loadu_si128(q), _mm_loadu_si128(q + 1), _mm_loadu_si128(q + 2), _mm_loadu_si128(q + 3) };
+}
+
+static inline void StoreSSE2(void* p, const Vec16SSE2& v)
+{
+    __m128i* q = (__m128i*) p;
+    _mm_storeu_si128(q, v.r0);
+    _mm_storeu_si128(q + 1, v.r1);
+    _mm_storeu_si128(q + 2, v.r2);
+    _mm_storeu_si128(q + 3, v.r3);
+}
+
+static inline Vec16SSE2 LoadAccumulatorsSSE2(const int* C, bool accumulate)
+{
+    const __m128i zero = _mm_setzero_si128();
+    return accumulate ? LoadSSE2(C) : Vec16SSE2{ zero, zero, zero, zero };
+}
+
+// Multiply the pairs (A[r,l], A[r,l+1]) of the 16 panel rows with the pair (B[l,j], B[l+1,j]) (pmaddwd)
+// and add to the accumulators of column j.
+static inline void MultiplyAddSSE2(Vec16SSE2& acc, const Vec16SSE2& a, int pair)
+{
+    const __m128i b = _mm_set1_epi32(pair);
+    acc.r0 = _mm_add_epi32(acc.r0, _mm_madd_epi16(a.r0, b));
+    acc.r1 = _mm_add_epi32(acc.r1, _mm_madd_epi16(a.r1, b));
+    acc.r2 = _mm_add_epi32(acc.r2, _mm_madd_epi16(a.r2, b));
+    acc.r3 = _mm_add_epi32(acc.r3, _mm_madd_epi16(a.r3, b));
+}
+
+// two columns: 8 accumulator registers, 4 for the panel
+static void KernelColumns2SSE2(int k, const short* panel, const short* B, int ldb, int* C, int ldc, bool accumulate)
+{
+    Vec16SSE2 c0 = LoadAccumulatorsSSE2(C, accumulate);
+    Vec16SSE2 c1 = LoadAccumulatorsSSE2(C + ldc, accumulate);
+    const int kPairs = (k + 1) / 2;
+    for (int p = 0; p < kPairs; p++)
+    {
+        const Vec16SSE2 a = LoadSSE2(panel + (size_t) p * 2 * PanelRows);
+        MultiplyAddSSE2(c0, a, LoadPair(B, p, k));
+        MultiplyAddSSE2(c1, a, LoadPair(B + ldb, p, k));
+    }
+    StoreSSE2(C, c0);
+    StoreSSE2(C + ldc, c1);
+}
+
+static void KernelColumns1SSE2(int k, const short* panel, const short* B, int* C, bool accumulate)
+{
+    Vec16SSE2 c0 = LoadAccumulatorsSSE2(C, accumulate);
+    const int kPairs = (k + 1) / 2;
+    for (int p = 0; p < kPairs; p++)
+        MultiplyAddSSE2(c0, LoadSSE2(panel + (size_t) p * 2 * PanelRows), LoadPair(B, p, k));
+    StoreSSE2(C, c0);
+}
+
+static void KernelSSE2(int k, const short* panel, const short* B, int ldb, int numCols, int* C, int ldc, bool accumulate)
+{
+    int j = 0;
+    for (; j + 2 <= numCols; j += 2)
+        KernelColumns2SSE2(k, panel, B + (size_t) j * ldb, ldb, C + (size_t) j * ldc, ldc, accumulate);
+    for (; j < numCols; j++)
+        KernelColumns1SSE2(k, panel, B + (size_t) j * ldb, C + (size_t) j * ldc, accumulate);
+}
+
+#endif
+
+static Kernel GetKernel()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    const SIMD::InstructionSet instructionSet = SIMD::GetInstructionSet();
+    if (instructionSet >= SIMD::InstructionSet::AVX2)
+        return &KernelAVX2;
+    if (instructionSet >= SIMD::InstructionSet::SSE4)
+        return &KernelSSE2;
+#endif
+    return &KernelScalar;
+}
+
+// -----------------------------------------------------------------------
+// product
+// -----------------------------------------------------------------------
+
+void Multiply(int m, int n, int k, const short* packedA, const short* B, int* C)
+{
+    const Kernel kernel = GetKernel();
+    const int numPanels = (m + PanelRows - 1) / PanelRows;
+    const int kPairs = (k + 1) / 2;
+    const int ldc = ResultLeadingDim(m);
+    const int numColumnBlocks = (n + ColumnBlockSize - 1) / ColumnBlockSize;
+    const int numTasks = numPanels * numColumnBlocks;
+
+#pragma omp parallel for schedule(dynamic) if (numTasks > 1 && (double) m * n * k >= MinOpsForThreads)
+    for (int task = 0; task < numTasks; task++)
+    {
+        // consecutive tasks share the same block of B
+        const int panelIndex = task % numPanels;
+        const int j0 = task / numPanels * ColumnBlockSize;
+        const int numCols = std::min(ColumnBlockSize, n - j0);
+        const short* panel = packedA + (size_t) panelIndex * kPairs * 2 * PanelRows;
+        int* c = C + (size_t) j0 * ldc + (size_t) panelIndex * PanelRows;
+        for (int k0 = 0; k0 < k; k0 += DepthBlockSize)
+        {
+            const int depth = std::min(DepthBlockSize, k - k0);
+            kernel(depth, panel + (size_t) k0 * PanelRows, B + (size_t) j0 * k + k0, k, numCols, c, ldc, k0 > 0);
+        }
+    }
+}
+
+}}}}
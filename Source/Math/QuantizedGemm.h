@@ -0,0 +1,48 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// QuantizedGemm.h -- int16 matrix product with int32 accumulation, used by QuantizedMultiplier
+//
+// A is packed into panels of QuantizedGemmPanelRows rows, in which each pair of consecutive
+// k-elements of a row is adjacent, i.e. the layout consumed by pmaddwd (_mm_madd_epi16). B is used
+// as is (column-major). The SIMD kernel (SSE2 or AVX2) is selected at runtime, see CPUTensorSIMD.h.
+//
+
+#pragma once
+
+#include "CommonMatrix.h" // for MATH_API
+#include <cstddef>
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace QuantizedGemm {
+
+// number of rows of A in one packed panel
+static const int PanelRows = 16;
+
+// number of shorts needed for packed A[m,k]
+MATH_API size_t PackedASize(int m, int k);
+
+// pack column-major A[m,k] into 'packedA' (PackedASize(m, k) elements); rows and k are zero-padded
+MATH_API void PackA(int m, int k, const short* A, short* packedA);
+
+// leading dimension of the result of Multiply(), i.e. m rounded up to a whole panel
+inline int ResultLeadingDim(int m)
+{
+    return (m + PanelRows - 1) / PanelRows * PanelRows;
+}
+
+// C[m,n] = A[m,k] * B[k,n] with A packed by PackA() and B column-major.
+// C is column-major with leading dimension ResultLeadingDim(m); rows past m are scratch.
+MATH_API void Multiply(int m, int n, int k, const short* packedA, const short* B, int* C);
+
+// -----------------------------------------------------------------------
+// implementation details: micro kernels
+// -----------------------------------------------------------------------
+
+// Computes (or, if 'accumulate', adds to) one panel of C[PanelRows, numCols] += panel * B[k, numCols],
+// with 'panel' pointing to the packed A panel at the first k-element of this block, and B to its first k-element.
+typedef void (*Kernel)(int k, const short* panel, const short* B, int ldb, int numCols, int* C, int ldc, bool accumulate);
+
+void KernelAVX2(int k, const short* panel, const short* B, int ldb, int numCols, int* C, int ldc, bool accumulate);
+
+}}}}
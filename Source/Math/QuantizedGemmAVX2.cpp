@@ -0,0 +1,118 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// QuantizedGemmAVX2.cpp -- AVX2 kernel of the int16 matrix product (QuantizedGemm.h)
+//
+// This file is compiled with -mavx2 (see Makefile) and must not instantiate any shared inline code
+// (e.g. std templates), since the linker might pick the AVX2 version for other callers.
+// It is only called after checking CPU support.
+//
+
+#include "QuantizedGemm.h"
+#include <string.h>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace QuantizedGemm {
+
+#if defined(_M_X64) || defined(__x86_64__)
+
+namespace AVX2 {
+
+// Multiply the pairs (A[r,l], A[r,l+1]) of the 16 panel rows (a0, a1) with the pair (B[l,j], B[l+1,j]) (vpmaddwd)
+// and add to the accumulators of column j.
+static inline void MultiplyAdd(__m256i& acc0, __m256i& acc1, __m256i a0, __m256i a1, int pair)
+{
+    const __m256i b = _mm256_set1_epi32(pair);
+    acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(a0, b));
+    acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(a1, b));
+}
+
+// pair (B[l,j], B[l+1,j]) for l = 2p; for odd k, the last element is paired with zero (the packed A is zero-padded as well)
+static inline int LoadPair(const short* B, int p, int k)
+{
+    int pair;
+    if (2 * p + 1 < k)
+        memcpy(&pair, B + 2 * p, sizeof(pair));
+    else
+        pair = (unsigned short) B[2 * p];
+    return pair;
+}
+
+static inline __m256i LoadAccumulator(const int* C, bool accumulate)
+{
+    return accumulate ? _mm256_loadu_si256((const __m256i*) C) : _mm256_setzero_si256();
+}
+
+// 4 columns; the accumulators are spelled out to keep them in registers
+static void KernelColumns4(int k, const short* panel, const short* B, int ldb, int* C, int ldc, bool accumulate)
+{
+    const short* B0 = B;
+    const short* B1 = B + ldb;
+    const short* B2 = B + 2 * (size_t) ldb;
+    const short* B3 = B + 3 * (size_t) ldb;
+    __m256i c00 = LoadAccumulator(C, accumulate),                 c01 = LoadAccumulator(C + 8, accumulate);
+    __m256i c10 = LoadAccumulator(C + ldc, accumulate),           c11 = LoadAccumulator(C + ldc + 8, accumulate);
+    __m256i c20 = LoadAccumulator(C + 2 * (size_t) ldc, accumulate), c21 = LoadAccumulator(C + 2 * (size_t) ldc + 8, accumulate);
+    __m256i c30 = LoadAccumulator(C + 3 * (size_t) ldc, accumulate), c31 = LoadAccumulator(C + 3 * (size_t) ldc + 8, accumulate);
+
+    const int kPairs = (k + 1) / 2;
+    for (int p = 0; p < kPairs; p++)
+    {
+        const short* a = panel + (size_t) p * 2 * PanelRows;
+        const __m256i a0 = _mm256_loadu_si256((const __m256i*) a);
+        const __m256i a1 = _mm256_loadu_si256((const __m256i*) (a + 16));
+        MultiplyAdd(c00, c01, a0, a1, LoadPair(B0, p, k));
+        MultiplyAdd(c10, c11, a0, a1, LoadPair(B1, p, k));
+        MultiplyAdd(c20, c21, a0, a1, LoadPair(B2, p, k));
+        MultiplyAdd(c30, c31, a0, a1, LoadPair(B3, p, k));
+    }
+
+    _mm256_storeu_si256((__m256i*) C, c00);
+    _mm256_storeu_si256((__m256i*) (C + 8), c01);
+    _mm256_storeu_si256((__m256i*) (C + ldc), c10);
+    _mm256_storeu_si256((__m256i*) (C + ldc + 8), c11);
+    _mm256_storeu_si256((__m256i*) (C + 2 * (size_t) ldc), c20);
+    _mm256_storeu_si256((__m256i*) (C + 2 * (size_t) ldc + 8), c21);
+    _mm256_storeu_si256((__m256i*) (C + 3 * (size_t) ldc), c30);
+    _mm256_storeu_si256((__m256i*) (C + 3 * (size_t) ldc + 8), c31);
+}
+
+static void KernelColumns1(int k, const short* panel, const short* B, int* C, bool accumulate)
+{
+    __m256i c0 = LoadAccumulator(C, accumulate), c1 = LoadAccumulator(C + 8, accumulate);
+    const int kPairs = (k + 1) / 2;
+    for (int p = 0; p < kPairs; p++)
+    {
+        const short* a = panel + (size_t) p * 2 * PanelRows;
+        MultiplyAdd(c0, c1, _mm256_loadu_si256((const __m256i*) a), _mm256_loadu_si256((const __m256i*) (a + 16)), LoadPair(B, p, k));
+    }
+    _mm256_storeu_si256((__m256i*) C, c0);
+    _mm256_storeu_si256((__m256i*) (C + 8), c1);
+}
+
+} // namespace AVX2
+
+void KernelAVX2(int k, const short* panel, const short* B, int ldb, int numCols, int* C, int ldc, bool accumulate)
+{
+    int j = 0;
+    for (; j + 4 <= numCols; j += 4)
+        AVX2::KernelColumns4(k, panel, B + (size_t) j * ldb, ldb, C + (size_t) j * ldc, ldc, accumulate);
+    for (; j < numCols; j++)
+        AVX2::KernelColumns1(k, panel, B + (size_t) j * ldb, C + (size_t) j * ldc, accumulate);
+    _mm256_zeroupper();
+}
+
+#else
+
+void KernelAVX2(int, const short*, const short*, int, int, int*, int, bool)
+{
+    LogicError("QuantizedGemm::KernelAVX2: not available on this platform.");
+}
+
+#endif
+
+}}}}
@@ -4,6 +4,9 @@
 //
 #pragma once
 #include "Quantizers.h"
+#include "QuantizedGemm.h"
+#include "HalfGemm.h"
+#include <type_traits>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -21,6 +24,13 @@ class QuantizedMultiplier
     // Placeholders for quantized matrices A and B
     vector<short> m_pMatA, m_pMatB;
 
+    // Quantized matrix A, packed for QuantizedGemm::Multiply(). If A is constant, it is only kept in this form.
+    vector<short> m_packedA;
+
+    // Product of the quantized matrices, before de-quantization
+    vector<int> m_product;
+
+protected:
     // Whether matrices A and B are constant (i.e. weights)
     // If the matrix is constant, the size of the underlying container for quatized values will be preserved for
     // the lifespan of the object
@@ -41,8 +51,10 @@ public:
     {
     };
 
+    virtual ~QuantizedMultiplier() {}
+
     // A[m,k]*B[k,n] = C[m,n]
-    void Multiply(int m, int n, int k, ElemType* A, ElemType* B, ElemType* C)
+    virtual void Multiply(int m, int n, int k, ElemType* A, ElemType* B, ElemType* C)
     {
         // Quantize
         if (!m_isAConstant || m_firstPass)
@@ -50,6 +62,11 @@ public:
             m_pMatA.resize(m*k);
             ArrayRef<short> refMatA(m_pMatA.data(), m_pMatA.size());
             m_pQuantizerA->Quantize(ArrayRef<ElemType>(A, m_pMatA.size()), refMatA);
+
+            m_packedA.resize(QuantizedGemm::PackedASize(m, k));
+            QuantizedGemm::PackA(m, k, m_pMatA.data(), m_packedA.data());
+            if (m_isAConstant)
+                vector<short>().swap(m_pMatA);
         }
         
         if (!m_isBConstant || m_firstPass)
@@ -62,19 +79,13 @@ public:
         m_firstPass = false;
 
         // Do multiply
-        // Naive inefficient product, just for demonstation
-        // TODO: replace with an efficient version, e.g. IPG, block multiplier, Eigen, gemmlowp, etc.
-        for (size_t i = 0; i < m; i++)
-            for (size_t j = 0; j < n; j++)
-            {
-                int dotProduct=0;
-                for (size_t l = 0; l < k; l++)
-                {
-                    // CNTK is using column-major storage
-                    dotProduct += m_pMatA[i + l*m] * m_pMatB[l + k*j];
-                }
-                C[i + j*m] = (ElemType)dotProduct;
-            }
+        // The result has a leading dimension of m rounded up to whole panels of QuantizedGemm.
+        const int ldc = QuantizedGemm::ResultLeadingDim(m);
+        m_product.resize((size_t) ldc * n);
+        QuantizedGemm::Multiply(m, n, k, m_packedA.data(), m_pMatB.data(), m_product.data());
+        for (int j = 0; j < n; j++)
+            for (int i = 0; i < m; i++)
+                C[i + (size_t)j*m] = (ElemType)m_product[i + (size_t)j*ldc];
 
         // De-quantize
         int mn = m*n;
@@ -84,6 +95,70 @@ public:
 
     void SetIsAConstant(bool v) { m_isAConstant = v; }
     void SetIsBConstant(bool v) { m_isBConstant = v; }
+
+protected:
+    // for derived multipliers that do not quantize to int16
+    QuantizedMultiplier(bool isAConstant) :
+        m_isAConstant(isAConstant), m_isBConstant(false), m_firstPass(true)
+    {
+    }
+};
+
+// Product of a matrix A stored in 16 bits (IEEE half or bfloat16) and a dense matrix B, see HalfGemm.h.
+// Meant for weights that are not updated: a constant A is converted and packed on the first call and
+// from then on only read in its 16-bit form, which halves the memory bandwidth spent on it. B and the
+// arithmetic stay in full precision.
+template <class ElemType>
+class HalfPrecisionMultiplier : public QuantizedMultiplier<ElemType>
+{
+    HalfGemm::Format m_format;
+
+    // A converted to 16 bits and packed for HalfGemm::Multiply()
+    vector<unsigned short> m_packedA;
+
+    // float copies of A, B and C, only used if ElemType is not float
+    vector<float> m_floatA, m_floatB, m_floatC;
+
+public:
+    HalfPrecisionMultiplier(HalfGemm::Format format, bool isAConstant = true) :
+        QuantizedMultiplier<ElemType>(isAConstant), m_format(format)
+    {
+    }
+
+    HalfGemm::Format Format() const { return m_format; }
+
+    // A[m,k]*B[k,n] = C[m,n]
+    virtual void Multiply(int m, int n, int k, ElemType* A, ElemType* B, ElemType* C) override
+    {
+        if (!this->m_isAConstant || this->m_firstPass)
+        {
+            m_packedA.resize(HalfGemm::PackedASize(m, k));
+            HalfGemm::PackA(m, k, AsFloat(A, (size_t) m * k, m_floatA), m_format, m_packedA.data());
+            vector<float>().swap(m_floatA);
+        }
+        this->m_firstPass = false;
+
+        if (std::is_same<ElemType, float>::value)
+        {
+            HalfGemm::Multiply(m, n, k, m_packedA.data(), m_format, reinterpret_cast<const float*>(B), reinterpret_cast<float*>(C));
+        }
+        else
+        {
+            m_floatC.resize((size_t) m * n);
+            HalfGemm::Multiply(m, n, k, m_packedA.data(), m_format, AsFloat(B, (size_t) k * n, m_floatB), m_floatC.data());
+            for (size_t i = 0; i < m_floatC.size(); i++)
+                C[i] = (ElemType) m_floatC[i];
+        }
+    }
+
+private:
+    static const float* AsFloat(const ElemType* data, size_t size, vector<float>& buffer)
+    {
+        if (std::is_same<ElemType, float>::value)
+            return reinterpret_cast<const float*>(data);
+        buffer.assign(data, data + size);
+        return buffer.data();
+    }
 };
 
 }}}
\ No newline at end of file
@@ -59,6 +59,8 @@ static const FixedEventDesc c_fixedEvtDesc[profilerEvtMax] = {
     { "__Get Minibatch", profilerEvtTime, true },                   // profilerEvtMainGetMinibatch
     { "__Forward + Backward", profilerEvtTime, true },              // profilerEvtMainFB
     { "__Gradient Aggregation", profilerEvtTime, true },            // profilerEvtMainGradient
+    { "___Wait for Gradient Buckets", profilerEvtTime, false },     // profilerEvtMainGradientWait
+    { "__Gradient Bucket All-Reduce", profilerEvtTime, false },     // profilerEvtMainGradientBucket
     { "__Weight Update", profilerEvtTime, true },                   // profilerEvtMainWeights
     { "__Post Processing", profilerEvtTime, true },                 // profilerEvtMainPost
 
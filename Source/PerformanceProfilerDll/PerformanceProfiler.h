@@ -69,6 +69,8 @@ enum ProfilerEvents
     profilerEvtMainGetMinibatch,            // GetMinibatch() function time
     profilerEvtMainFB,                      // Forward + Backward pass time
     profilerEvtMainGradient,                // Gradient aggregation time
+    profilerEvtMainGradientWait,            // Wait for gradient all-reduces that were started during backprop
+    profilerEvtMainGradientBucket,          // All-reduce of one gradient bucket, from its start during backprop until it completed
     profilerEvtMainWeights,                 // Weight update time
     profilerEvtMainPost,                    // Remainder time in minibatch loop
 
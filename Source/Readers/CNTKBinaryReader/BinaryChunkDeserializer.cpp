@@ -52,6 +52,9 @@ BinaryChunkDeserializer::BinaryChunkDeserializer(const BinaryConfigHelper& helpe
     SetTraceLevel(helper.GetTraceLevel());
 
     Initialize(helper.GetRename(), helper.GetElementType());
+
+    if (helper.ShouldMemoryMapFile())
+        m_mappedFile = make_shared<MemoryMappedFile>(helper.GetFilePath());
 }
 
 
@@ -188,8 +191,25 @@ unique_ptr<byte[]> BinaryChunkDeserializer::ReadChunk(ChunkIdType chunkId)
 }
 
 
+ChunkPtr BinaryChunkDeserializer::GetMappedChunk(ChunkIdType chunkId)
+{
+    size_t offset = m_chunkTable->GetDataStartOffset(chunkId);
+    size_t chunkSize = m_chunkTable->GetChunkSize(chunkId);
+    if (offset + chunkSize > m_mappedFile->Size())
+        RuntimeError("Chunk %u of '%ls' ends past the end of the file.", (unsigned int)chunkId, m_mappedFile->Filename().c_str());
+
+    // Start reading the chunk in the background. Usually this is called by the randomizer's prefetch,
+    // ahead of the chunk being needed.
+    m_mappedFile->WillNeed(offset, chunkSize);
+
+    return make_shared<BinaryDataChunk>(chunkId, m_chunkTable->GetNumSequences(chunkId), m_mappedFile, offset, chunkSize, m_deserializers);
+}
+
 ChunkPtr BinaryChunkDeserializer::GetChunk(ChunkIdType chunkId)
 {
+    if (m_mappedFile)
+        return GetMappedChunk(chunkId);
+
     // Read the chunk into memory
     unique_ptr<byte[]> buffer = ReadChunk(chunkId);
 
@@ -9,6 +9,7 @@
 #include "BinaryConfigHelper.h"
 #include "BinaryDataChunk.h"
 #include "BinaryDataDeserializer.h"
+#include "MemoryMappedFile.h"
 
 namespace CNTK {
 
@@ -111,6 +112,9 @@ private:
     // Reads a chunk from disk into buffer
     unique_ptr<byte[]> ReadChunk(ChunkIdType chunkId);
 
+    // Creates a chunk that points into the memory mapped file
+    ChunkPtr GetMappedChunk(ChunkIdType chunkId);
+
     BinaryChunkDeserializer(const wstring& filename);
 
     void SetTraceLevel(unsigned int traceLevel);
@@ -118,6 +122,9 @@ private:
 private:
     FileWrapper m_file;
 
+    // the whole file mapped into memory, if chunks are not read into buffers
+    MemoryMappedFilePtr m_mappedFile;
+
     int64_t m_headerOffset, m_chunkTableOffset;
 
     std::vector<BinaryDataDeserializerPtr> m_deserializers;
@@ -66,6 +66,9 @@ namespace CNTK {
 
         m_filepath = msra::strfun::utf16(config(L"file"));
         m_keepDataInMemory = config(L"keepDataInMemory", false);
+        size_t maxCacheSizeInMB = config(L"maxCacheSizeInMB", 0); // unlimited by default
+        m_maxCacheSizeBytes = maxCacheSizeInMB > 0 ? maxCacheSizeInMB * 1024 * 1024 : SIZE_MAX;
+        m_memoryMapFile = config(L"memoryMapping", false);
 
         m_randomizationWindow = GetRandomizationWindowFromConfig(config);
         m_sampleBasedRandomizationWindow = config(L"sampleBasedRandomizationWindow", false);
@@ -35,6 +35,10 @@ public:
 
     bool ShouldKeepDataInMemory() const { return m_keepDataInMemory; }
 
+    size_t GetMaxCacheSize() const { return m_maxCacheSizeBytes; }
+
+    bool ShouldMemoryMapFile() const { return m_memoryMapFile; }
+
     DataType GetElementType() const { return m_elementType; }
 
     DISABLE_COPY_AND_MOVE(BinaryConfigHelper);
@@ -49,6 +53,8 @@ private:
     bool m_sampleBasedRandomizationWindow;
     unsigned int m_traceLevel;
     bool m_keepDataInMemory; // if true the whole dataset is kept in memory
+    size_t m_maxCacheSizeBytes; // memory budget for the data kept in memory (SIZE_MAX if unlimited)
+    bool m_memoryMapFile; // if true chunks are read through a memory mapping of the file instead of into buffers
 };
 
 }
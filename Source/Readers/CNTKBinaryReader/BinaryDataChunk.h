@@ -9,6 +9,7 @@
 #include "BinaryConfigHelper.h"
 #include "BinaryChunkDeserializer.h"
 #include "BinaryDataDeserializer.h"
+#include "MemoryMappedFile.h"
 
 namespace CNTK {
 
@@ -22,8 +23,40 @@ public:
         : m_chunkId(chunkId),
         m_numSequences(numSequences), 
         m_buffer(std::move(buffer)), 
-        m_deserializers(deserializer)
-    { }
+        m_deserializers(deserializer),
+        m_offset(0),
+        m_size(0)
+    {
+        m_chunkData = m_buffer.get();
+    }
+
+    // A chunk that is the range [offset, offset + size) of a memory mapped file. The sequences point into
+    // the mapping, which is only read when they are accessed. The chunk is parsed right away, so that
+    // the pages are faulted in by the thread that asked for the chunk (e.g. the randomizer's prefetch).
+    BinaryDataChunk(ChunkIdType chunkId,
+        size_t numSequences,
+        MemoryMappedFilePtr file,
+        size_t offset,
+        size_t size,
+        std::vector<BinaryDataDeserializerPtr> deserializer)
+        : m_chunkId(chunkId),
+        m_numSequences(numSequences),
+        m_deserializers(deserializer),
+        m_file(file),
+        m_offset(offset),
+        m_size(size)
+    {
+        // the mapping is read-only; the deserializers only set up pointers into it
+        m_chunkData = (byte*)(m_file->Data() + offset);
+        ParseChunk();
+    }
+
+    ~BinaryDataChunk()
+    {
+        // the pages stay in the page cache, but do not count towards this process any longer
+        if (m_file)
+            m_file->DontNeed(m_offset, m_size);
+    }
 
     // Gets a sequence using its index inside the chunk.
     void GetSequence(size_t sequenceIdx, std::vector<SequenceDataPtr>& result) override
@@ -58,7 +91,7 @@ protected:
         size_t bytesProcessed = 0;
         // Now call all of the deserializers on the chunk, in order
         for (size_t i = 0; i < m_deserializers.size(); i++)
-            bytesProcessed += m_deserializers[i]->GetSequenceDataForChunk(m_numSequences, m_buffer.get() + bytesProcessed, m_data[i]);
+            bytesProcessed += m_deserializers[i]->GetSequenceDataForChunk(m_numSequences, m_chunkData + bytesProcessed, m_data[i]);
     }
 
     // chunk id (copied from the descriptor)
@@ -73,6 +106,12 @@ protected:
 
     // This is the deserializer who knows how to interpret the m_data chunk that we read in
     std::vector<BinaryDataDeserializerPtr> m_deserializers;
+
+    // The chunk data: either m_buffer, or the chunk's range of the memory mapped m_file.
+    byte* m_chunkData;
+    MemoryMappedFilePtr m_file;
+    size_t m_offset;
+    size_t m_size;
     
     // The parsed data. We will parse each chunk once, and store the data here. 
     // If we want to delay parsing, we will add that later as/if needed.
@@ -30,10 +30,12 @@ CNTKBinaryReader::CNTKBinaryReader(const ConfigParameters& config)
     try
     {
         m_deserializer = shared_ptr<DataDeserializer>(new BinaryChunkDeserializer(configHelper));
+        if (configHelper.ShouldMemoryMapFile())
+            log << " | memory mapping the file";
 
         if (configHelper.ShouldKeepDataInMemory())
         {
-            m_deserializer = shared_ptr<DataDeserializer>(new ChunkCache(m_deserializer));
+            m_deserializer = shared_ptr<DataDeserializer>(new ChunkCache(m_deserializer, configHelper.GetMaxCacheSize()));
             log << " | keeping data in memory";
         }
 
@@ -53,7 +55,8 @@ CNTKBinaryReader::CNTKBinaryReader(const ConfigParameters& config)
                 false, /* multithreadedGetNextSequences */
                  0, /*maxNumberOfInvalidSequences */
                 configHelper.UseSampleBasedRandomizationWindow() /*sampleBasedRandomizationWindow */,
-                GetRandomSeed(config) /*seedOffset*/);
+                GetRandomSeed(config) /*seedOffset*/,
+                config(L"prefetchChunks", (size_t)2) /*maxNumberOfPrefetchedChunks*/);
         }
         else
         {
@@ -35,7 +35,7 @@ CNTKTextFormatReader::CNTKTextFormatReader(const ConfigParameters& config)
             m_deserializer = make_shared<TextParser<double>>(corpus, configHelper, true);
 
         if (configHelper.ShouldKeepDataInMemory())
-            m_deserializer = make_shared<ChunkCache>(m_deserializer);
+            m_deserializer = make_shared<ChunkCache>(m_deserializer, configHelper.GetMaxCacheSize());
 
         size_t window = configHelper.GetRandomizationWindow();
         if (window > 0)
@@ -47,7 +47,8 @@ CNTKTextFormatReader::CNTKTextFormatReader(const ConfigParameters& config)
                                                                 /*multithreadedGetNextSequences =*/ false,
                                                                 /*maxNumberOfInvalidSequences =*/ 0,
                                                                 /*sampleBasedRandomizationWindow =*/ configHelper.UseSampleBasedRandomizationWindow(),
-                                                                /*seedOffset =*/ GetRandomSeed(config));
+                                                                /*seedOffset =*/ GetRandomSeed(config),
+                                                                /*maxNumberOfPrefetchedChunks =*/ config(L"prefetchChunks", (size_t)2));
         }
         else
         {
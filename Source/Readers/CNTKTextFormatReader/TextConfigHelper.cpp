@@ -126,6 +126,8 @@ TextConfigHelper::TextConfigHelper(const ConfigParameters& config)
     m_traceLevel = config(L"traceLevel", 1);
     m_chunkSizeBytes = config(L"chunkSizeInBytes", g_32MB); // 32 MB by default
     m_keepDataInMemory = config(L"keepDataInMemory", false);
+    size_t maxCacheSizeInMB = config(L"maxCacheSizeInMB", 0); // unlimited by default
+    m_maxCacheSizeBytes = maxCacheSizeInMB > 0 ? maxCacheSizeInMB * 1024 * 1024 : SIZE_MAX;
     m_frameMode = config(L"frameMode", false);
     m_cacheIndex = config(L"cacheIndex", false);
 
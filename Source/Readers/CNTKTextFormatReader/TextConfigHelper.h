@@ -41,6 +41,8 @@ public:
 
     bool ShouldKeepDataInMemory() const { return m_keepDataInMemory; }
 
+    size_t GetMaxCacheSize() const { return m_maxCacheSizeBytes; }
+
     bool IsInFrameMode() const { return m_frameMode; }
 
     DataType GetDataType() const { return m_elementType; }
@@ -60,6 +62,7 @@ private:
     unsigned int m_traceLevel;
     size_t m_chunkSizeBytes; // chunks size in bytes
     bool m_keepDataInMemory; // if true the whole dataset is kept in memory
+    size_t m_maxCacheSizeBytes; // memory budget for the data kept in memory (SIZE_MAX if unlimited)
     bool m_frameMode; // if true, the maximum expected sequence length in the dataset is one sample.
     bool m_cacheIndex; // When true, the index will be loaded from a cache file it if exists.
                        // If cache does not exist, the index, once created, will be written out to a file.
@@ -11,6 +11,7 @@
 #include "IndexBuilder.h"
 #include "TextParser.h"
 #include "TextReaderConstants.h"
+#include "TextParserFastPath.h"
 #include "File.h"
 
 #define isSign(c) ((c == '-' || c == '+'))
@@ -93,7 +94,8 @@ TextParser<ElemType>::TextParser(CorpusDescriptorPtr corpus, const std::wstring&
     m_numRetries(5),
     m_corpus(corpus),
     m_useMaximumAsSequenceLength(true),
-    m_cacheIndex(false)
+    m_cacheIndex(false),
+    m_useFastPath(true)
 {
     assert(streams.size() > 0);
 
@@ -705,6 +707,11 @@ bool TextParser<ElemType>::TryGetInputId(size_t& id, size_t& bytesToRead)
 template <class ElemType>
 bool TextParser<ElemType>::TryReadDenseSample(vector<ElemType>& values, size_t sampleSize, size_t& bytesToRead)
 {
+    if (m_useFastPath && TryReadDenseSampleFast(values, sampleSize, bytesToRead))
+    {
+        return true;
+    }
+
     size_t counter = 0;
     ElemType value;
 
@@ -790,6 +797,11 @@ template <class ElemType>
 bool TextParser<ElemType>::TryReadSparseSample(std::vector<ElemType>& values, std::vector<SparseIndexType>& indices,
     size_t sampleSize, size_t& bytesToRead)
 {
+    if (m_useFastPath && TryReadSparseSampleFast(values, indices, sampleSize, bytesToRead))
+    {
+        return true;
+    }
+
     size_t index = 0;
     ElemType value;
 
@@ -883,6 +895,106 @@ bool TextParser<ElemType>::TryReadSparseSample(std::vector<ElemType>& values, st
     return bytesToRead > 0 || values.size() > 0;
 }
 
+template <class ElemType>
+bool TextParser<ElemType>::TryReadDenseSampleFast(vector<ElemType>& values, size_t sampleSize, size_t& bytesToRead)
+{
+    size_t available;
+    const char* begin = m_fileReader->PeekSpan(available);
+    if (begin == nullptr)
+    {
+        return false;
+    }
+
+    const char* end = begin + min(available, bytesToRead);
+
+    // The sample must be terminated inside the buffer, otherwise the slow path takes care of the refill.
+    const char* sampleEnd = FastPath::FindEndOfSample(begin, end);
+    if (sampleEnd == end)
+    {
+        return false;
+    }
+
+    size_t size = values.size();
+    values.resize(size + sampleSize);
+    ElemType* output = values.data() + size;
+
+    size_t counter = 0;
+    double value;
+    for (const char* p = FastPath::SkipValueDelimiters(begin, sampleEnd); p < sampleEnd;
+         p = FastPath::SkipValueDelimiters(p, sampleEnd))
+    {
+        p = FastPath::TryParseRealNumber(p, sampleEnd, value);
+        if (p == nullptr || counter == sampleSize)
+        {
+            // malformed or oversized, the slow path will re-read the sample and report it.
+            values.resize(size);
+            return false;
+        }
+
+        output[counter++] = static_cast<ElemType>(value);
+    }
+
+    if (counter != sampleSize)
+    {
+        values.resize(size);
+        return false;
+    }
+
+    size_t consumed = sampleEnd - begin;
+    m_fileReader->SkipWithinLine(consumed);
+    bytesToRead -= consumed;
+    return true;
+}
+
+template <class ElemType>
+bool TextParser<ElemType>::TryReadSparseSampleFast(std::vector<ElemType>& values, std::vector<SparseIndexType>& indices,
+    size_t sampleSize, size_t& bytesToRead)
+{
+    size_t available;
+    const char* begin = m_fileReader->PeekSpan(available);
+    if (begin == nullptr)
+    {
+        return false;
+    }
+
+    const char* end = begin + min(available, bytesToRead);
+
+    const char* sampleEnd = FastPath::FindEndOfSample(begin, end);
+    if (sampleEnd == end)
+    {
+        return false;
+    }
+
+    // index:value pairs are parsed in a single pass.
+    size_t size = values.size();
+    size_t index;
+    double value;
+    for (const char* p = FastPath::SkipValueDelimiters(begin, sampleEnd); p < sampleEnd;
+         p = FastPath::SkipValueDelimiters(p, sampleEnd))
+    {
+        p = FastPath::TryParseIndex(p, sampleEnd, index);
+        if (p != nullptr && index < sampleSize)
+        {
+            p = FastPath::TryParseRealNumber(p + 1, sampleEnd, value); // skip index delimiter
+        }
+
+        if (p == nullptr || index >= sampleSize)
+        {
+            values.resize(size);
+            indices.resize(size);
+            return false;
+        }
+
+        values.push_back(static_cast<ElemType>(value));
+        indices.push_back(static_cast<SparseIndexType>(index));
+    }
+
+    size_t consumed = sampleEnd - begin;
+    m_fileReader->SkipWithinLine(consumed);
+    bytesToRead -= consumed;
+    return true;
+}
+
 template <class ElemType>
 void TextParser<ElemType>::SkipToNextInput(size_t& bytesToRead)
 {
@@ -1232,6 +1344,12 @@ void TextParser<ElemType>::SetCacheIndex(bool value)
     m_cacheIndex = value;
 }
 
+template <class ElemType>
+void TextParser<ElemType>::SetFastPath(bool value)
+{
+    m_useFastPath = value;
+}
+
 template<class ElemType>
 inline bool TextParser<ElemType>::CanRead()
 {
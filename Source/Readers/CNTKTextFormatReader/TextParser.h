@@ -133,6 +133,7 @@ private:
     unsigned int m_numAllowedErrors;
     bool m_skipSequenceIds;
     bool m_cacheIndex;
+    bool m_useFastPath; // parse well-formed samples directly from the reader buffer (default: true)
     unsigned int m_numRetries; // specifies the number of times an unsuccessful
                                // file operation should be repeated (default value is 5).
 
@@ -169,6 +170,13 @@ private:
     bool TryReadSparseSample(std::vector<ElemType>& values, std::vector<SparseIndexType>& indices,
         size_t sampleSize, size_t& bytesToRead);
 
+    // Fast paths of the two functions above: parse a whole sample at once if it is well-formed and fully
+    // contained in the current reader buffer. Return false without consuming any input otherwise.
+    bool TryReadDenseSampleFast(std::vector<ElemType>& values, size_t sampleSize, size_t& bytesToRead);
+
+    bool TryReadSparseSampleFast(std::vector<ElemType>& values, std::vector<SparseIndexType>& indices,
+        size_t sampleSize, size_t& bytesToRead);
+
     // Reads one sample (an input identifier followed by a list of values)
     bool TryReadSample(SequenceBuffer& sequence, size_t& bytesToRead);
 
@@ -203,6 +211,8 @@ private:
 
     void SetCacheIndex(bool value);
 
+    void SetFastPath(bool value);
+
     friend class CNTKTextFormatReaderTestRunner<ElemType>;
 
     DISABLE_COPY_AND_MOVE(TextParser);
@@ -0,0 +1,382 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+// Pointer-based helpers used by the TextParser to parse well-formed samples directly
+// from the reader buffer, without going through BufferedFileReader::Peek/Pop for every byte.
+// All functions only accept input in the canonical form; anything unusual is rejected
+// (nullptr is returned), and the caller falls back to the character-by-character parser,
+// which produces the same diagnostics as before.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "TextReaderConstants.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CNTK_TEXT_PARSER_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace CNTK {
+
+namespace FastPath {
+
+inline bool IsDigit(char c)
+{
+    return '0' <= c && c <= '9';
+}
+
+// Returns true for characters that terminate the values of a sample:
+// an input name prefix or a non-printable character other than a tab.
+inline bool IsEndOfSample(char c)
+{
+    return c == NAME_PREFIX || (isNonPrintable(c) && c != TAB_CHAR);
+}
+
+inline unsigned int CountTrailingZeros(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+inline unsigned int CountTrailingZeros64(uint64_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+// Returns the position of the first character in [begin, end) that terminates the values
+// of a sample (see IsEndOfSample), or 'end' if there is none. Scans 16 bytes at a time.
+inline const char* FindEndOfSample(const char* begin, const char* end)
+{
+    const char* p = begin;
+#ifdef CNTK_TEXT_PARSER_SSE2
+    const __m128i prefix = _mm_set1_epi8(NAME_PREFIX);
+    const __m128i space = _mm_set1_epi8(SPACE_CHAR);
+    const __m128i tab = _mm_set1_epi8(TAB_CHAR);
+    for (; end - p >= 16; p += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // signed comparison, bytes >= 0x80 are non-printable as well (same as isNonPrintable for a signed char).
+        __m128i stop = _mm_andnot_si128(_mm_cmpeq_epi8(bytes, tab), _mm_cmplt_epi8(bytes, space));
+        stop = _mm_or_si128(stop, _mm_cmpeq_epi8(bytes, prefix));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(stop));
+        if (mask != 0)
+            return p + CountTrailingZeros(mask);
+    }
+#endif
+    for (; p < end; ++p)
+    {
+        if (IsEndOfSample(*p))
+            return p;
+    }
+    return end;
+}
+
+inline const char* SkipValueDelimiters(const char* p, const char* end)
+{
+    while (p < end && isValueDelimiter(*p))
+        ++p;
+    return p;
+}
+
+// Accumulates the decimal digits starting at p into the mantissa, returns the position after the last digit.
+// Eight bytes are classified and converted at a time (SWAR, little-endian byte order), which avoids
+// a data-dependent branch per digit.
+inline const char* AccumulateDigits(const char* p, const char* end, uint64_t& mantissa)
+{
+    static const uint64_t s_powersOf10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+    while (end - p >= 8)
+    {
+        uint64_t bytes;
+        memcpy(&bytes, p, sizeof(bytes));
+
+        // The high bit of a byte is set if it is below '0' or above '9'. Carries/borrows only propagate
+        // towards higher bytes, so the lowest flagged byte is always correct. (No byte is >= 0x80 here.)
+        uint64_t nonDigits = ((bytes - 0x3030303030303030ull) | (bytes + 0x4646464646464646ull)) & 0x8080808080808080ull;
+        size_t numDigits = nonDigits == 0 ? 8 : CountTrailingZeros64(nonDigits) / 8;
+        if (numDigits == 0)
+            return p;
+
+        // Move the digits to the top bytes (the missing digits become leading zeros) and
+        // combine pairs, quadruples and octets of digits.
+        uint64_t digits = (bytes - 0x3030303030303030ull) << (8 * (8 - numDigits));
+        digits = ((digits & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+        digits = ((digits & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+        digits = ((digits & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32;
+
+        mantissa = mantissa * s_powersOf10[numDigits] + digits;
+        p += numDigits;
+        if (numDigits < 8)
+            return p;
+    }
+
+    unsigned int digit;
+    for (; p < end && (digit = static_cast<unsigned char>(*p) - '0') <= 9; ++p)
+        mantissa = mantissa * 10 + digit;
+    return p;
+}
+
+// Parses a non-negative decimal integer (a sparse index) that must be followed by the index delimiter.
+// Returns the position of the delimiter, or nullptr.
+inline const char* TryParseIndex(const char* p, const char* end, size_t& value)
+{
+    const char* start = p;
+    value = 0;
+    for (; p < end && IsDigit(*p); ++p)
+    {
+        if (p - start >= 18) // let the slow path deal with (and report) potential overflows
+            return nullptr;
+        value = value * 10 + (*p - '0');
+    }
+    if (p == start || p == end || *p != INDEX_DELIMITER)
+        return nullptr;
+    return p;
+}
+
+inline unsigned int CountLeadingZeros64(uint64_t value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return 63 - index;
+#else
+    return __builtin_clzll(value);
+#endif
+}
+
+// Returns the upper 64 bits of the 128-bit product, the lower ones are stored in 'low'.
+inline uint64_t MultiplyFull(uint64_t a, uint64_t b, uint64_t& low)
+{
+#ifdef _MSC_VER
+    uint64_t high;
+    low = _umul128(a, b, &high);
+    return high;
+#else
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    low = static_cast<uint64_t>(product);
+    return static_cast<uint64_t>(product >> 64);
+#endif
+}
+
+// Computes the double closest to mantissa * 10^exponent (mantissa > 0) following Eisel and Lemire:
+// the mantissa is multiplied by a 64-bit approximation of 5^exponent, and the powers of two go into the
+// binary exponent. Returns false if the result cannot be determined with certainty from the 128-bit
+// product (e.g., for ties or for subnormals), or if the exponent is outside of the tabulated range;
+// the caller then falls back to strtod.
+inline bool TryComputeDouble(uint64_t mantissa, int exponent, bool negative, double& value)
+{
+    const int minExponent = -64;
+    const int maxExponent = 64;
+    // 5^q normalized to [2^63, 2^64) and truncated, for q in [minExponent, maxExponent].
+    static const uint64_t s_powersOf5[] = {
+        0xa87fea27a539e9a5ull, 0xd29fe4b18e88640eull, 0x83a3eeeef9153e89ull, 0xa48ceaaab75a8e2bull,
+        0xcdb02555653131b6ull, 0x808e17555f3ebf11ull, 0xa0b19d2ab70e6ed6ull, 0xc8de047564d20a8bull,
+        0xfb158592be068d2eull, 0x9ced737bb6c4183dull, 0xc428d05aa4751e4cull, 0xf53304714d9265dfull,
+        0x993fe2c6d07b7fabull, 0xbf8fdb78849a5f96ull, 0xef73d256a5c0f77cull, 0x95a8637627989aadull,
+        0xbb127c53b17ec159ull, 0xe9d71b689dde71afull, 0x9226712162ab070dull, 0xb6b00d69bb55c8d1ull,
+        0xe45c10c42a2b3b05ull, 0x8eb98a7a9a5b04e3ull, 0xb267ed1940f1c61cull, 0xdf01e85f912e37a3ull,
+        0x8b61313bbabce2c6ull, 0xae397d8aa96c1b77ull, 0xd9c7dced53c72255ull, 0x881cea14545c7575ull,
+        0xaa242499697392d2ull, 0xd4ad2dbfc3d07787ull, 0x84ec3c97da624ab4ull, 0xa6274bbdd0fadd61ull,
+        0xcfb11ead453994baull, 0x81ceb32c4b43fcf4ull, 0xa2425ff75e14fc31ull, 0xcad2f7f5359a3b3eull,
+        0xfd87b5f28300ca0dull, 0x9e74d1b791e07e48ull, 0xc612062576589ddaull, 0xf79687aed3eec551ull,
+        0x9abe14cd44753b52ull, 0xc16d9a0095928a27ull, 0xf1c90080baf72cb1ull, 0x971da05074da7beeull,
+        0xbce5086492111aeaull, 0xec1e4a7db69561a5ull, 0x9392ee8e921d5d07ull, 0xb877aa3236a4b449ull,
+        0xe69594bec44de15bull, 0x901d7cf73ab0acd9ull, 0xb424dc35095cd80full, 0xe12e13424bb40e13ull,
+        0x8cbccc096f5088cbull, 0xafebff0bcb24aafeull, 0xdbe6fecebdedd5beull, 0x89705f4136b4a597ull,
+        0xabcc77118461cefcull, 0xd6bf94d5e57a42bcull, 0x8637bd05af6c69b5ull, 0xa7c5ac471b478423ull,
+        0xd1b71758e219652bull, 0x83126e978d4fdf3bull, 0xa3d70a3d70a3d70aull, 0xccccccccccccccccull,
+        0x8000000000000000ull, 0xa000000000000000ull, 0xc800000000000000ull, 0xfa00000000000000ull,
+        0x9c40000000000000ull, 0xc350000000000000ull, 0xf424000000000000ull, 0x9896800000000000ull,
+        0xbebc200000000000ull, 0xee6b280000000000ull, 0x9502f90000000000ull, 0xba43b74000000000ull,
+        0xe8d4a51000000000ull, 0x9184e72a00000000ull, 0xb5e620f480000000ull, 0xe35fa931a0000000ull,
+        0x8e1bc9bf04000000ull, 0xb1a2bc2ec5000000ull, 0xde0b6b3a76400000ull, 0x8ac7230489e80000ull,
+        0xad78ebc5ac620000ull, 0xd8d726b7177a8000ull, 0x878678326eac9000ull, 0xa968163f0a57b400ull,
+        0xd3c21bcecceda100ull, 0x84595161401484a0ull, 0xa56fa5b99019a5c8ull, 0xcecb8f27f4200f3aull,
+        0x813f3978f8940984ull, 0xa18f07d736b90be5ull, 0xc9f2c9cd04674edeull, 0xfc6f7c4045812296ull,
+        0x9dc5ada82b70b59dull, 0xc5371912364ce305ull, 0xf684df56c3e01bc6ull, 0x9a130b963a6c115cull,
+        0xc097ce7bc90715b3ull, 0xf0bdc21abb48db20ull, 0x96769950b50d88f4ull, 0xbc143fa4e250eb31ull,
+        0xeb194f8e1ae525fdull, 0x92efd1b8d0cf37beull, 0xb7abc627050305adull, 0xe596b7b0c643c719ull,
+        0x8f7e32ce7bea5c6full, 0xb35dbf821ae4f38bull, 0xe0352f62a19e306eull, 0x8c213d9da502de45ull,
+        0xaf298d050e4395d6ull, 0xdaf3f04651d47b4cull, 0x88d8762bf324cd0full, 0xab0e93b6efee0053ull,
+        0xd5d238a4abe98068ull, 0x85a36366eb71f041ull, 0xa70c3c40a64e6c51ull, 0xd0cf4b50cfe20765ull,
+        0x82818f1281ed449full, 0xa321f2d7226895c7ull, 0xcbea6f8ceb02bb39ull, 0xfee50b7025c36a08ull,
+        0x9f4f2726179a2245ull, 0xc722f0ef9d80aad6ull, 0xf8ebad2b84e0d58bull, 0x9b934c3b330c8577ull,
+        0xc2781f49ffcfa6d5ull
+    };
+
+    if (exponent < minExponent || exponent > maxExponent)
+        return false;
+
+    int leadingZeros = CountLeadingZeros64(mantissa);
+    uint64_t normalized = mantissa << leadingZeros;
+
+    uint64_t lower;
+    uint64_t upper = MultiplyFull(normalized, s_powersOf5[exponent - minExponent], lower);
+
+    // The table entries are truncated, so the exact product can be larger by less than 'normalized'.
+    // Give up if that could carry into the bits that determine the result.
+    if ((upper & 0x1FF) == 0x1FF && lower + normalized < lower)
+        return false;
+
+    int upperBit = static_cast<int>(upper >> 63);
+    uint64_t significand = upper >> (upperBit + 9); // 54 bits, the lowest one is used for rounding
+
+    // Possibly exactly halfway between two doubles, where round-half-to-even needs the exact value.
+    if (lower == 0 && (upper & 0x1FF) == 0 && (significand & 3) == 1)
+        return false;
+
+    significand += significand & 1;
+    significand >>= 1;
+    if (significand >= (1ull << 53))
+    {
+        // rounding overflowed into the next power of two.
+        significand = (1ull << 52);
+        --leadingZeros;
+    }
+    significand &= ~(1ull << 52);
+
+    // (217706 * q) >> 16 == floor(q * log2(10)) for the tabulated range.
+    int64_t biasedExponent = ((217706 * static_cast<int64_t>(exponent)) >> 16) + 1086 + upperBit - leadingZeros;
+    if (biasedExponent < 1 || biasedExponent > 2046)
+        return false;
+
+    uint64_t bits = significand | (static_cast<uint64_t>(biasedExponent) << 52) | (static_cast<uint64_t>(negative) << 63);
+    memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+// Parses a floating point number of the form [+-]digits[.[digits]][(e|E)[+-]digits], which must be
+// followed by a value delimiter or the end of the range. Returns the position after the number, or nullptr.
+//
+// Up to 19 significant digits are accumulated into a 64-bit integer. If it fits into the 53-bit
+// double mantissa and the decimal exponent is within [-22, 22], both operands are exact doubles and a
+// single multiplication/division gives the correctly rounded result (Clinger's fast path). Longer
+// mantissas (e.g., the 17 digits of a round-tripped double) go through TryComputeDouble, and what is
+// left (more than 19 digits, huge exponents, ties) is converted exactly with strtod.
+inline const char* TryParseRealNumber(const char* p, const char* end, double& value)
+{
+    static const double s_powersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const ptrdiff_t maxSignificantDigits = 19;
+
+    const char* start = p;
+    if (p == end)
+        return nullptr;
+
+    // Signs are random in typical data, so skip them without a branch.
+    bool negative = (*p == '-');
+    p += (negative || *p == '+');
+
+    if (p == end || !IsDigit(*p))
+        return nullptr;
+
+    // Leading zeros are not significant.
+    while (p < end && *p == '0')
+        ++p;
+
+    uint64_t mantissa = 0;
+    const char* integralStart = p;
+    p = AccumulateDigits(p, end, mantissa);
+
+    ptrdiff_t numDigits = p - integralStart;
+    int exponent = 0;
+
+    if (p < end && *p == '.')
+    {
+        ++p;
+        if (p < end && !IsDigit(*p) && !isValueDelimiter(*p))
+            return nullptr; // "45." is a valid number, "45.e1" is not (the slow path will report it).
+
+        const char* fractionStart = p;
+        if (mantissa == 0)
+        {
+            while (p < end && *p == '0')
+                ++p;
+        }
+        const char* significantStart = p;
+        p = AccumulateDigits(p, end, mantissa);
+
+        numDigits += p - significantStart;
+        exponent = -static_cast<int>(p - fractionStart);
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negativeExponent = (*p == '-');
+            ++p;
+        }
+
+        if (p == end || !IsDigit(*p))
+            return nullptr;
+
+        int explicitExponent = 0;
+        for (; p < end && IsDigit(*p); ++p)
+        {
+            if (explicitExponent < 100000)
+                explicitExponent = explicitExponent * 10 + (*p - '0');
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if (p < end && !isValueDelimiter(*p))
+        return nullptr;
+
+    // More than 19 significant digits overflow the mantissa.
+    bool truncated = numDigits > maxSignificantDigits;
+
+    double result;
+    if (!truncated && mantissa == 0)
+    {
+        result = 0;
+    }
+    else if (!truncated && mantissa <= (1ull << 53) && -22 <= exponent && exponent <= 22)
+    {
+        result = static_cast<double>(mantissa);
+        result = (exponent < 0) ? result / s_powersOf10[-exponent] : result * s_powersOf10[exponent];
+    }
+    else if (!truncated && TryComputeDouble(mantissa, exponent, negative, value))
+    {
+        return p;
+    }
+    else
+    {
+        // the token is a plain decimal literal at this point, strtod converts it exactly.
+        std::string token(start, p);
+        value = strtod(token.c_str(), nullptr);
+        return p;
+    }
+
+    value = negative ? -result : result;
+    return p;
+}
+
+}
+}
@@ -164,8 +164,14 @@ CompositeDataReader::CompositeDataReader(const ConfigParameters& config) :
             }
 
             bool shouldPrefetch = true;
+            // Number of chunks following the randomization window that are loaded in the background.
+            size_t prefetchChunks = config(L"prefetchChunks", (size_t)2);
+            // Optional ascending sequence lengths (e.g. 10:20:40) at which sequences of a randomized chunk are split into
+            // buckets of similar length, to reduce padding in minibatches of sequences.
+            argvector<size_t> lengthBuckets = config(L"lengthBuckets", ConfigParameters::Array(argvector<size_t>(vector<size_t> {})));
             m_sequenceEnumerator = std::make_shared<BlockRandomizer>(verbosity, randomizationWindow, deserializer, shouldPrefetch,
-                multiThreadedDeserialization, maxErrors, sampleBasedRandomizationWindow, GetRandomSeed(config));
+                multiThreadedDeserialization, maxErrors, sampleBasedRandomizationWindow, GetRandomSeed(config), prefetchChunks,
+                lengthBuckets.tovector());
         }
         else
             m_sequenceEnumerator = std::make_shared<NoRandomizer>(deserializer, multiThreadedDeserialization, maxErrors);
@@ -202,7 +208,8 @@ CompositeDataReader::CompositeDataReader(const ConfigParameters& config) :
             outputStreams,
             numAlternatingBuffers,
             localTimeline,
-            m_corpus);
+            m_corpus,
+            config(L"reportPaddingEfficiency", false));
         break;
     case PackingMode::truncated:
     {
@@ -6,6 +6,7 @@
 #include "stdafx.h"
 #include "HTKDeserializer.h"
 #include "ConfigHelper.h"
+#include "SequenceData.h"
 #include "Basics.h"
 #include "StringUtil.h"
 #include <unordered_set>
@@ -42,6 +43,7 @@ HTKDeserializer::HTKDeserializer(
     auto context = config.GetContextWindow();
 
     m_expandToPrimary = streamConfig(L"expandToUtterance", false);
+    m_deferSplicing = streamConfig(L"deferSplicing", false);
     if (m_expandToPrimary && m_primary)
     {
         InvalidArgument("Cannot expand utterances of the primary stream %ls, please change your configuration.", inputName.c_str());
@@ -82,6 +84,7 @@ HTKDeserializer::HTKDeserializer(
     m_dimension = m_dimension * (1 + context.first + context.second);
 
     m_expandToPrimary = feature(L"expandToUtterance", false);
+    m_deferSplicing = feature(L"deferSplicing", false);
     if (m_expandToPrimary && m_primary)
     {
         InvalidArgument("Cannot expand utterances of the primary stream %ls, please change your configuration.", featureName.c_str());
@@ -363,7 +366,7 @@ private:
 
 // Represents a chunk data in memory. Given up to the randomizer.
 // It is up to the randomizer to decide when to release a particular chunk.
-class HTKDeserializer::HTKChunk : public Chunk, boost::noncopyable
+class HTKDeserializer::HTKChunk : public Chunk, public std::enable_shared_from_this<HTKDeserializer::HTKChunk>, boost::noncopyable
 {
 public:
     HTKChunk(HTKDeserializer* parent, ChunkIdType chunkId) : m_parent(parent), m_chunkId(chunkId)
@@ -381,7 +384,7 @@ public:
     // Gets data for the sequence.
     virtual void GetSequence(size_t sequenceId, vector<SequenceDataPtr>& result) override
     {
-        m_parent->GetSequenceById(m_chunkId, sequenceId, result);
+        m_parent->GetSequenceById(shared_from_this(), m_chunkId, sequenceId, result);
     }
 
     // Unloads the data from memory.
@@ -500,6 +503,73 @@ private:
     const NDShape& m_frameShape;
 };
 
+// This class exposes frames of an utterance with their context window without materializing it.
+// The packer calls CopySampleTo for each sample, which gathers the neighbor frames directly from the chunk data
+// into the minibatch (converting them to ElemType on the fly). Boundary frames are repeated as in AugmentNeighbors.
+template <class ElemType>
+struct HTKSplicedSequenceData : DeferredDenseSequenceData
+{
+    HTKSplicedSequenceData(
+        const ChunkPtr& chunk,
+        msra::dbn::matrixstripe& utteranceFrames,
+        size_t firstFrame,
+        size_t frameStep,
+        size_t numberOfSamples,
+        const std::pair<size_t, size_t>& augmentationWindow,
+        const NDShape& frameShape)
+        : m_chunk(chunk),
+          m_frames(&utteranceFrames(0, 0)),
+          m_frameStride(utteranceFrames.getcolstride()),
+          m_frameDimension(utteranceFrames.rows()),
+          m_numberOfFrames(utteranceFrames.cols()),
+          m_firstFrame(firstFrame),
+          m_frameStep(frameStep),
+          m_augmentationWindow(augmentationWindow),
+          m_frameShape(frameShape)
+    {
+        m_numberOfSamples = (uint32_t)numberOfSamples;
+        if (m_numberOfSamples != numberOfSamples)
+            RuntimeError("Maximum number of samples per sequence exceeded.");
+    }
+
+    void CopySampleTo(size_t sampleIndex, char* destination) override
+    {
+        assert(sampleIndex < m_numberOfSamples);
+        const ptrdiff_t frameIndex = m_firstFrame + sampleIndex * m_frameStep;
+        const ptrdiff_t lastFrame = m_numberOfFrames - 1;
+
+        auto target = reinterpret_cast<ElemType*>(destination);
+        for (ptrdiff_t n = -(ptrdiff_t)m_augmentationWindow.first; n <= (ptrdiff_t)m_augmentationWindow.second; ++n)
+        {
+            // index does not move beyond boundary
+            const ptrdiff_t currentFrame = std::min(std::max(frameIndex + n, (ptrdiff_t)0), lastFrame);
+            const float* source = m_frames + currentFrame * m_frameStride;
+            std::copy(source, source + m_frameDimension, target);
+            target += m_frameDimension;
+        }
+    }
+
+    const NDShape& GetSampleShape() override
+    {
+        return m_frameShape;
+    }
+
+private:
+    // Keeps the frames in memory while the sequence is alive.
+    ChunkPtr m_chunk;
+    const float* m_frames;
+    size_t m_frameStride;
+    size_t m_frameDimension;
+    size_t m_numberOfFrames;
+
+    // Utterance frame of the first sample, and the number of frames between samples (0 when the frame is repeated).
+    size_t m_firstFrame;
+    size_t m_frameStep;
+
+    std::pair<size_t, size_t> m_augmentationWindow;
+    const NDShape& m_frameShape;
+};
+
 // Copies a source into a destination with the specified destination offset.
 static void CopyToOffset(const const_array_ref<float>& source, array_ref<float>& destination, size_t offset)
 {
@@ -535,7 +605,7 @@ static void AugmentNeighbors(const MatrixAsVectorOfVectors& utterance,
 
 // Get a sequence by its chunk id and sequence id.
 // Sequence ids are guaranteed to be unique inside a chunk.
-void HTKDeserializer::GetSequenceById(ChunkIdType chunkId, size_t id, vector<SequenceDataPtr>& r)
+void HTKDeserializer::GetSequenceById(const ChunkPtr& chunk, ChunkIdType chunkId, size_t id, vector<SequenceDataPtr>& r)
 {
     const auto& chunkInfo = m_chunks[chunkId];
     size_t utteranceIndex = m_frameMode ? chunkInfo.GetUtteranceForChunkFrameIndex(id) : id;
@@ -560,6 +630,24 @@ void HTKDeserializer::GetSequenceById(ChunkIdType chunkId, size_t id, vector<Seq
         utteranceLength = r.front()->m_numberOfSamples;
     }
 
+    if (m_deferSplicing)
+    {
+        // Only describe where the frames are, the packer splices them into the minibatch.
+        size_t firstFrame = m_frameMode ? id - chunkInfo.GetStartFrameIndexInsideChunk(utteranceIndex) : 0;
+        size_t frameStep = m_expandToPrimary ? 0 : 1;
+        DenseSequenceDataPtr result;
+        if (m_elementType == DataType::Double)
+            result = make_shared<HTKSplicedSequenceData<double>>(chunk, utteranceFrames, firstFrame, frameStep, utteranceLength, m_augmentationWindow, m_streams.front().m_sampleLayout);
+        else if (m_elementType == DataType::Float)
+            result = make_shared<HTKSplicedSequenceData<float>>(chunk, utteranceFrames, firstFrame, frameStep, utteranceLength, m_augmentationWindow, m_streams.front().m_sampleLayout);
+        else
+            LogicError("Currently, HTK Deserializer supports only double and float types.");
+
+        result->m_key.m_sequence = utterance->GetId();
+        r.push_back(result);
+        return;
+    }
+
     FeatureMatrix features(m_dimension, utteranceLength);
     if (m_frameMode)
     {
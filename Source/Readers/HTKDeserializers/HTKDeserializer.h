@@ -48,7 +48,8 @@ private:
     void InitializeAugmentationWindow(const std::pair<size_t, size_t>& augmentationWindow);
 
     // Gets sequence by its chunk id and id inside the chunk.
-    void GetSequenceById(ChunkIdType chunkId, size_t id, std::vector<SequenceDataPtr>&);
+    // The chunk is kept alive by sequences that reference its frames.
+    void GetSequenceById(const ChunkPtr& chunk, ChunkIdType chunkId, size_t id, std::vector<SequenceDataPtr>&);
 
     // Dimension of features.
     size_t m_dimension;
@@ -82,6 +83,10 @@ private:
     // A flag that indicates whether the utterance should be extended to match the length of the utterance from the primary deserializer.
     // TODO: This should be moved to the packers when deserializers work in sequence mode only.
     bool m_expandToPrimary;
+
+    // A flag that indicates whether the context window of frames should be spliced by the packer directly
+    // into the minibatch, instead of materializing the augmented frames of every sequence in the deserializer.
+    bool m_deferSplicing;
 };
 
 typedef std::shared_ptr<HTKDeserializer> HTKDeserializerPtr;
@@ -113,7 +113,8 @@ namespace CNTK {
             }
             else
             {
-                image = cv::imdecode(decodedImage, m_deserializer.m_grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+                auto data = reinterpret_cast<const unsigned char*>(decodedImage.data());
+                image = cv::imdecode(decodedImage, GetImageDecodingFlags(data, decodedImage.size(), m_deserializer.m_grayscale, m_deserializer.m_minDecodedShorterSide));
             }
 
             m_deserializer.PopulateSequenceData(image, classId, copyId, { sequence.m_key, 0 }, result);
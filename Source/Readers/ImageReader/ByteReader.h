@@ -6,11 +6,11 @@
 #pragma once
 #include <opencv2/core/mat.hpp>
 #include "Config.h"
+#include "ConcStack.h"
 #ifdef USE_ZIP
 #include <zip.h>
 #include <unordered_map>
 #include <memory>
-#include "ConcStack.h"
 #endif
 
 namespace CNTK {
@@ -24,7 +24,8 @@ public:
     virtual ~ByteReader() = default;
 
     virtual void Register(const MultiMap& sequences) = 0;
-    virtual cv::Mat Read(size_t seqId, const std::string& path, bool grayscale) = 0;
+    // Reads and decodes an image; JPEGs with a shorter side of at least twice minShorterSide (if not 0) are decoded at a reduced resolution.
+    virtual cv::Mat Read(size_t seqId, const std::string& path, bool grayscale, size_t minShorterSide) = 0;
 
     DISABLE_COPY_AND_MOVE(ByteReader);
 };
@@ -36,9 +37,12 @@ public:
     {}
 
     void Register(const MultiMap&) override {}
-    cv::Mat Read(size_t seqId, const std::string& path, bool grayscale) override;
+    cv::Mat Read(size_t seqId, const std::string& path, bool grayscale, size_t minShorterSide) override;
 
     std::string m_expandDirectory;
+
+private:
+    Microsoft::MSR::CNTK::conc_stack<std::vector<unsigned char>> m_workspace;
 };
 
 #ifdef USE_ZIP
@@ -48,7 +52,7 @@ public:
     ZipByteReader(const std::string& zipPath);
 
     void Register(const std::map<std::string, std::vector<size_t>>& sequences) override;
-    cv::Mat Read(size_t seqId, const std::string& path, bool grayscale) override;
+    cv::Mat Read(size_t seqId, const std::string& path, bool grayscale, size_t minShorterSide) override;
 
 private:
     using ZipPtr = std::unique_ptr<zip_t, void(*)(zip_t*)>;
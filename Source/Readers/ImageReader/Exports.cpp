@@ -15,6 +15,7 @@
 #include "ImageTransformers.h"
 #include "CorpusDescriptor.h"
 #include "Base64ImageDeserializer.h"
+#include "ImageShardDeserializer.h"
 #include "V2Dependencies.h"
 
 namespace CNTK {
@@ -48,6 +49,8 @@ extern "C" DATAREADER_API bool CreateDeserializer(DataDeserializerPtr& deseriali
         deserializer = make_shared<ImageDataDeserializer>(corpus, deserializerConfig, primary);
     else if (type == L"Base64ImageDeserializer")
         deserializer = make_shared<Base64ImageDeserializerImpl>(corpus, deserializerConfig, primary);
+    else if (type == L"ImageShardDeserializer")
+        deserializer = make_shared<ImageShardDeserializer>(corpus, deserializerConfig, primary);
     else
         // Unknown type.
         return false;
@@ -73,6 +76,8 @@ extern "C" DATAREADER_API bool CreateTransformer(Transformer** transformer, cons
         *transformer = new TransposeTransformer(config);
     else if (type == L"Cast")
         *transformer = new CastTransformer(config);
+    else if (type == L"FusedImage")
+        *transformer = new FusedImageTransformer(config);
     else
         // Unknown type.
         return false;
@@ -286,16 +286,33 @@ cv::Mat ImageDataDeserializer::ReadImage(size_t seqId, const std::string& path,
 
     ImageDataDeserializer::SeqReaderMap::const_iterator r;
     if (m_readers.empty() || (r = m_readers.find(seqId)) == m_readers.end())
-        return m_defaultReader->Read(seqId, path, grayscale);
-    return (*r).second->Read(seqId, path, grayscale);
+        return m_defaultReader->Read(seqId, path, grayscale, m_minDecodedShorterSide);
+    return (*r).second->Read(seqId, path, grayscale, m_minDecodedShorterSide);
 }
 
-cv::Mat FileByteReader::Read(size_t, const std::string& seqPath, bool grayscale)
+cv::Mat FileByteReader::Read(size_t, const std::string& seqPath, bool grayscale, size_t minShorterSide)
 {
     assert(!seqPath.empty());
     auto path = Expand3Dots(seqPath, m_expandDirectory);
 
-    return cv::imread(path, grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+    if (minShorterSide == 0)
+        return cv::imread(path, grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+
+    // Read the file ourselves, so that the size of a JPEG can be checked before decoding it.
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return cv::Mat();
+    size_t size = (size_t)file.tellg();
+    auto contents = m_workspace.pop_or_create([size]() { return vector<unsigned char>(size); });
+    contents.resize(size);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(contents.data()), size);
+
+    cv::Mat image;
+    if (file)
+        image = cv::imdecode(contents, GetImageDecodingFlags(contents.data(), size, grayscale, minShorterSide));
+    m_workspace.push(std::move(contents));
+    return image;
 }
 
 bool ImageDataDeserializer::GetSequenceInfoByKey(const SequenceKey& key, SequenceInfo& result)
@@ -20,7 +20,7 @@ using namespace Microsoft::MSR::CNTK;
     ImageDeserializerBase::ImageDeserializerBase() 
         : DataDeserializerBase(true),
           m_precision(DataType::Float),
-          m_grayscale(false), m_verbosity(0), m_multiViewCrop(false)
+          m_grayscale(false), m_verbosity(0), m_multiViewCrop(false), m_minDecodedShorterSide(0)
     {}
 
     ImageDeserializerBase::ImageDeserializerBase(CorpusDescriptorPtr corpus, const ConfigParameters& config, bool primary)
@@ -74,6 +74,12 @@ using namespace Microsoft::MSR::CNTK;
         // TODO: multiview should be done on the level of randomizer/transformers - it is responsiblity of the
         // TODO: randomizer to collect how many copies each transform needs and request same sequence several times.
         m_multiViewCrop = config(L"multiViewCrop", false);
+
+        // If the features are first transformed by a FusedImage transform, its crop and scale tell how small the images can be decoded.
+        m_minDecodedShorterSide = 0;
+        argvector<ConfigParameters> transforms = featureSection("transforms");
+        if (transforms.size() > 0 && AreEqualIgnoreCase(std::wstring(transforms[0](L"type", L"")), L"FusedImage"))
+            m_minDecodedShorterSide = FusedImageTransformer::MinDecodedShorterSide(transforms[0]);
     }
 
     void ImageDeserializerBase::PopulateSequenceData(
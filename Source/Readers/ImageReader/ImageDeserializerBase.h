@@ -49,6 +49,9 @@ namespace CNTK {
         // Flag indicating whether to generate images for multi crop.
         bool m_multiViewCrop;
 
+        // Images whose shorter side is at least twice as long are decoded at a reduced resolution; 0 to always decode fully.
+        size_t m_minDecodedShorterSide;
+
         // Corpus descriptor.
         CorpusDescriptorPtr m_corpus;
     };
@@ -0,0 +1,245 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <opencv2/opencv.hpp>
+#include "ImageShardDeserializer.h"
+#include "ImageTransformers.h"
+#include "ReaderUtil.h"
+#include "ReaderConstants.h"
+#include "Index.h"
+#include "IndexBuilder.h"
+
+namespace CNTK {
+    using namespace Microsoft::MSR::CNTK;
+
+    struct ShardHeader
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t reserved;
+    };
+
+    struct ShardFooter
+    {
+        uint64_t numberOfRecords;
+        uint64_t tableOffset;
+        uint64_t magic;
+    };
+
+    // Builds the index from the offset table at the end of the shard, without touching the records.
+    class ImageShardIndexBuilder : public IndexBuilder
+    {
+    public:
+        ImageShardIndexBuilder(const FileWrapper& input) : IndexBuilder(input)
+        {}
+
+        virtual std::wstring GetCacheFilename() override
+        {
+            std::wstringstream wss;
+            wss << m_input.Filename() << L".v" << IndexBuilder::s_version << L".cache";
+            return wss.str();
+        }
+
+    private:
+        virtual void Populate(std::shared_ptr<Index>& index) override
+        {
+            m_input.CheckIsOpenOrDie();
+
+            if (!m_corpus)
+                RuntimeError("ImageShardIndexBuilder: corpus descriptor was not specified.");
+
+            const std::wstring& fileName = m_input.Filename();
+            size_t fileSize = m_input.Filesize();
+            if (fileSize < sizeof(ShardHeader) + sizeof(ShardFooter))
+                RuntimeError("Image shard '%ls' is too small (%zu bytes).", fileName.c_str(), fileSize);
+
+            ShardHeader header;
+            m_input.SeekOrDie(0, SEEK_SET);
+            m_input.ReadOrDie(header);
+            if (header.magic != ImageShardDeserializer::s_magic)
+                RuntimeError("File '%ls' is not an image shard.", fileName.c_str());
+            if (header.version != ImageShardDeserializer::s_version)
+                RuntimeError("Image shard '%ls' has unsupported version %u (expected %u).",
+                    fileName.c_str(), header.version, ImageShardDeserializer::s_version);
+
+            ShardFooter footer;
+            m_input.SeekOrDie(fileSize - sizeof(ShardFooter), SEEK_SET);
+            m_input.ReadOrDie(footer);
+            if (footer.magic != ImageShardDeserializer::s_magic)
+                RuntimeError("Image shard '%ls' is truncated.", fileName.c_str());
+            if (footer.tableOffset < sizeof(ShardHeader) || footer.tableOffset > fileSize - sizeof(ShardFooter))
+                RuntimeError("Image shard '%ls' has an invalid table offset %" PRIu64 ".", fileName.c_str(), footer.tableOffset);
+
+            std::vector<char> table(fileSize - sizeof(ShardFooter) - footer.tableOffset);
+            if (!table.empty())
+            {
+                m_input.SeekOrDie(footer.tableOffset, SEEK_SET);
+                m_input.ReadOrDie(table.data(), table.size(), 1);
+            }
+
+            index->Reserve(footer.tableOffset);
+
+            const size_t entrySize = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+            IndexedSequence sequence;
+            std::string key;
+            size_t position = 0;
+            for (uint64_t i = 0; i < footer.numberOfRecords; ++i)
+            {
+                if (table.size() - position < entrySize)
+                    RuntimeError("Image shard '%ls': offset table ends after %" PRIu64 " of %" PRIu64 " records.",
+                        fileName.c_str(), i, footer.numberOfRecords);
+
+                uint64_t offset;
+                uint32_t size, keyLength;
+                memcpy(&offset, &table[position], sizeof(offset));
+                memcpy(&size, &table[position + sizeof(offset)], sizeof(size));
+                memcpy(&keyLength, &table[position + sizeof(offset) + sizeof(size)], sizeof(keyLength));
+                position += entrySize;
+
+                if (table.size() - position < keyLength)
+                    RuntimeError("Image shard '%ls': key of record %" PRIu64 " exceeds the offset table.", fileName.c_str(), i);
+                key.assign(&table[position], keyLength);
+                position += keyLength;
+
+                if (offset < sizeof(ShardHeader) || size <= sizeof(uint32_t) || offset + size > footer.tableOffset)
+                    RuntimeError("Image shard '%ls': record '%s' lies outside of the data section.", fileName.c_str(), key.c_str());
+
+                sequence.SetKey(m_corpus->KeyToId(key)).SetNumberOfSamples(1).SetOffset(offset).SetSize(size);
+                index->AddSequence(sequence);
+            }
+
+            if (index->IsEmpty())
+                RuntimeError("Image shard '%ls' does not contain any images.", fileName.c_str());
+        }
+    };
+
+    class ImageShardDeserializer::ImageChunk : public Chunk, public std::enable_shared_from_this<ImageChunk>
+    {
+        ChunkDescriptor m_descriptor;
+        ImageShardDeserializer& m_deserializer;
+        std::vector<unsigned char> m_buffer;
+
+    public:
+        ImageChunk(const ChunkDescriptor& descriptor, ImageShardDeserializer& parent)
+            : m_descriptor(descriptor), m_deserializer(parent)
+        {
+            // Let's see if the open descriptor has problems.
+            if (ferror(m_deserializer.m_dataFile.get()) != 0)
+                m_deserializer.m_dataFile.reset(fopenOrDie(m_deserializer.m_fileName.c_str(), L"rbS"), [](FILE* f) { if (f) fclose(f); });
+
+            if (descriptor.Sequences().empty() || !descriptor.SizeInBytes())
+                LogicError("Empty chunks are not supported.");
+
+            // Read the whole chunk with a single sequential read.
+            m_buffer.resize(descriptor.SizeInBytes());
+            size_t chunkOffset = descriptor.StartOffset();
+            int rc = _fseeki64(m_deserializer.m_dataFile.get(), chunkOffset, SEEK_SET);
+            if (rc)
+                RuntimeError("Error seeking to position '%" PRId64 "' in the input file '%ls', error code '%d'", chunkOffset, m_deserializer.m_fileName.c_str(), rc);
+
+            freadOrDie(m_buffer.data(), descriptor.SizeInBytes(), 1, m_deserializer.m_dataFile.get());
+        }
+
+        void GetSequence(size_t sequenceIndex, std::vector<SequenceDataPtr>& result) override
+        {
+            const size_t innerSequenceIndex = m_deserializer.m_multiViewCrop ? sequenceIndex / ImageDeserializerBase::NumMultiViewCopies : sequenceIndex;
+            const size_t copyId = m_deserializer.m_multiViewCrop ? sequenceIndex % ImageDeserializerBase::NumMultiViewCopies : 0;
+
+            const auto& sequence = m_descriptor.Sequences()[innerSequenceIndex];
+            unsigned char* record = &m_buffer[sequence.OffsetInChunk()];
+
+            uint32_t classId;
+            memcpy(&classId, record, sizeof(classId));
+
+            size_t labelDimension = m_deserializer.m_labelGenerator->LabelDimension();
+            if (classId >= labelDimension)
+                RuntimeError(
+                    "Image with id '%s' has invalid class id '%u'. It is exceeding the label dimension of '%zu'",
+                    m_deserializer.m_corpus->IdToKey(sequence.m_key).c_str(), classId, labelDimension);
+
+            unsigned char* data = record + sizeof(classId);
+            size_t size = sequence.SizeInBytes() - sizeof(classId);
+            cv::Mat image = cv::imdecode(cv::Mat(1, static_cast<int>(size), CV_8UC1, data),
+                GetImageDecodingFlags(data, size, m_deserializer.m_grayscale, m_deserializer.m_minDecodedShorterSide));
+
+            m_deserializer.PopulateSequenceData(image, classId, copyId, { sequence.m_key, 0 }, result);
+        }
+    };
+
+    ImageShardDeserializer::ImageShardDeserializer(CorpusDescriptorPtr corpus, const ConfigParameters& config, bool primary) : ImageDeserializerBase(corpus, config, primary)
+    {
+        std::wstring shardFile = config(L"file");
+        m_fileName = shardFile;
+
+        size_t chunkSize = config(L"chunkSizeInBytes", g_32MB);
+
+        attempt(5, [this, chunkSize, corpus]()
+        {
+            if (!m_dataFile || ferror(m_dataFile.get()) != 0)
+                m_dataFile.reset(fopenOrDie(m_fileName, L"rbS"), [](FILE* f) { if (f) fclose(f); });
+
+            m_index = ImageShardIndexBuilder(FileWrapper(m_fileName, m_dataFile.get()))
+                .SetPrimary(m_primary)
+                .SetCorpus(corpus)
+                .SetChunkSize(chunkSize)
+                .Build();
+        });
+    }
+
+    std::vector<ChunkInfo> ImageShardDeserializer::ChunkInfos()
+    {
+        // In case of multi crop the deserializer provides the same sequence NumMultiViewCopies times.
+        size_t sequencesPerInitialSequence = m_multiViewCrop ? ImageDeserializerBase::NumMultiViewCopies : 1;
+        std::vector<ChunkInfo> result;
+        result.reserve(m_index->NumberOfChunks());
+        for (uint32_t i = 0; i < m_index->NumberOfChunks(); ++i)
+        {
+            const auto& chunk = m_index->Chunks()[i];
+            ChunkInfo c;
+            c.m_id = i;
+            c.m_numberOfSamples = c.m_numberOfSequences = chunk.NumberOfSequences() * sequencesPerInitialSequence;
+            result.push_back(c);
+        }
+        return result;
+    }
+
+    void ImageShardDeserializer::SequenceInfosForChunk(ChunkIdType chunkId, std::vector<SequenceInfo>& result)
+    {
+        const auto& chunk = m_index->Chunks()[chunkId];
+        size_t sequenceCopies = m_multiViewCrop ? NumMultiViewCopies : 1;
+        result.reserve(sequenceCopies * chunk.NumberOfSequences());
+        size_t currentId = 0;
+        for (uint32_t indexInChunk = 0; indexInChunk < chunk.NumberOfSequences(); ++indexInChunk)
+        {
+            auto const& s = chunk[indexInChunk];
+            for (size_t i = 0; i < sequenceCopies; ++i)
+            {
+                result.push_back(
+                {
+                    currentId,
+                    s.m_numberOfSamples,
+                    chunkId,
+                    { s.m_key, 0 }
+                });
+
+                currentId++;
+            }
+        }
+    }
+
+    ChunkPtr ImageShardDeserializer::GetChunk(ChunkIdType chunkId)
+    {
+        const auto& chunkDescriptor = m_index->Chunks()[chunkId];
+        return make_shared<ImageChunk>(chunkDescriptor, *this);
+    }
+
+    bool ImageShardDeserializer::GetSequenceInfoByKey(const SequenceKey& key, SequenceInfo& r)
+    {
+        return DataDeserializerBase::GetSequenceInfoByKey(*m_index, key, r);
+    }
+}
@@ -0,0 +1,52 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include "ImageDeserializerBase.h"
+#include "Config.h"
+#include "CorpusDescriptor.h"
+
+namespace CNTK {
+
+    // Image shard deserializer.
+    // Reads encoded images and their labels packed into a single file (written by Scripts/img2shard.py),
+    // so that a chunk is one large sequential read instead of a file or zip lookup per image.
+    //
+    // Shard layout (all integers little endian):
+    //     header:  uint64 magic ('cntk_ims'), uint32 version, uint32 reserved
+    //     records: [uint32 class id, encoded image bytes]*
+    //     table:   [uint64 record offset, uint32 record size, uint32 key length, key bytes]*
+    //     footer:  uint64 number of records, uint64 table offset, uint64 magic
+    // The table is read in one go to build the index, records are grouped into chunks of 'chunkSizeInBytes'.
+    class ImageShardDeserializer : public ImageDeserializerBase
+    {
+    public:
+        ImageShardDeserializer(CorpusDescriptorPtr corpus, const Microsoft::MSR::CNTK::ConfigParameters& config, bool primary);
+
+        // Get a chunk by id.
+        ChunkPtr GetChunk(ChunkIdType chunkId) override;
+
+        // Get chunk descriptions.
+        std::vector<ChunkInfo> ChunkInfos() override;
+
+        // Gets sequence descriptions for the chunk.
+        void SequenceInfosForChunk(ChunkIdType, std::vector<SequenceInfo>&) override;
+
+        // Gets sequence description by key.
+        bool GetSequenceInfoByKey(const SequenceKey&, SequenceInfo&) override;
+
+        static const uint64_t s_magic = 0x636e746b5f696d73; // 'cntk_ims'
+        static const uint32_t s_version = 1;
+
+    private:
+        class ImageChunk;
+
+        std::shared_ptr<Index> m_index;
+        std::shared_ptr<FILE> m_dataFile;
+        std::wstring m_fileName;
+    };
+
+}
@@ -126,6 +126,19 @@ StreamInformation CropTransformer::Transform(const StreamInformation& inputStrea
 }
 
 void CropTransformer::Apply(uint8_t copyId, cv::Mat &mat)
+{
+    cv::Rect rect;
+    bool flip;
+    SelectCrop(copyId, mat.rows, mat.cols, rect, flip);
+
+    mat = mat(rect);
+    if (flip)
+    {
+        cv::flip(mat, mat, 1);
+    }
+}
+
+void CropTransformer::SelectCrop(uint8_t copyId, int rows, int cols, cv::Rect& rect, bool& flip)
 {
     auto seed = GetSeed();
     auto rng = m_rngs.pop_or_create([seed]() { return std::make_unique<std::mt19937>(seed); }); 
@@ -134,16 +147,16 @@ void CropTransformer::Apply(uint8_t copyId, cv::Mat &mat)
     switch (m_cropType)
     {
     case CropType::Center: 
-        mat = mat(GetCropRectCenter(mat.rows, mat.cols, *rng));
+        rect = GetCropRectCenter(rows, cols, *rng);
         break; 
     case CropType::RandomSide: 
-        mat = mat(GetCropRectRandomSide(mat.rows, mat.cols, *rng)); 
+        rect = GetCropRectRandomSide(rows, cols, *rng); 
         break; 
     case CropType::RandomArea: 
-        mat = mat(GetCropRectRandomArea(mat.rows, mat.cols, *rng));
+        rect = GetCropRectRandomArea(rows, cols, *rng);
         break;
     case CropType::MultiView10: 
-        mat = mat(GetCropRectMultiView10(viewIndex, mat.rows, mat.cols, *rng));
+        rect = GetCropRectMultiView10(viewIndex, rows, cols, *rng);
         break; 
     default: 
         RuntimeError("Invalid crop type."); 
@@ -151,15 +164,23 @@ void CropTransformer::Apply(uint8_t copyId, cv::Mat &mat)
     }
 
     // for MultiView10 m_hFlip is false, hence the first 5 will be unflipped, the later 5 will be flipped
-    if ((m_hFlip && boost::random::bernoulli_distribution<>()(*rng)) ||
-        viewIndex >= 5)
-    {
-        cv::flip(mat, mat, 1);
-    }
+    flip = (m_hFlip && boost::random::bernoulli_distribution<>()(*rng)) ||
+           viewIndex >= 5;
 
     m_rngs.push(std::move(rng));
 }
 
+double CropTransformer::MinCropSideRatio() const
+{
+    if (m_cropWidth > 0 && m_cropHeight > 0)
+        return 0;
+
+    // A square crop of the given area ratio has at least sqrt(areaRatio) times the shorter side;
+    // the aspect ratio then shortens one side by up to sqrt(aspectRatio).
+    double ratio = m_useSideRatio ? m_sideRatioMin : (m_useAreaRatio ? std::sqrt(m_areaRatioMin) : 1.0);
+    return ratio / std::sqrt(m_aspectRatioMax);
+}
+
 CropTransformer::RatioJitterType
 CropTransformer::ParseJitterType(const std::string &src)
 {
@@ -369,10 +390,17 @@ StreamInformation ScaleTransformer::Transform(const StreamInformation& inputStre
 }
 
 void ScaleTransformer::Apply(uint8_t, cv::Mat &mat)
+{
+    cv::Mat buffer;
+    mat = Scale(mat, buffer);
+}
+
+cv::Mat ScaleTransformer::Scale(const cv::Mat& mat, cv::Mat& buffer) const
 {
     if (m_scaleMode == ScaleMode::Fill)
     { // warp the image to the given target size
-        cv::resize(mat, mat, cv::Size((int)m_imgWidth, (int)m_imgHeight), 0, 0, m_interp);
+        cv::resize(mat, buffer, cv::Size((int)m_imgWidth, (int)m_imgHeight), 0, 0, m_interp);
+        return buffer;
     }
     else
     {
@@ -398,24 +426,26 @@ void ScaleTransformer::Apply(uint8_t, cv::Mat &mat)
             targetW = (size_t)round(width * m_imgHeight / (double)height);
         }
 
-        cv::resize(mat, mat, cv::Size((int)targetW, (int)targetH), 0, 0, m_interp);
+        cv::resize(mat, buffer, cv::Size((int)targetW, (int)targetH), 0, 0, m_interp);
 
         if (m_scaleMode == ScaleMode::Crop)
         { // crop the overlap
             size_t xOff = max((size_t)0, (targetW - m_imgWidth) / 2);
             size_t yOff = max((size_t)0, (targetH - m_imgHeight) / 2);
-            mat = mat(cv::Rect((int)xOff, (int)yOff, (int)m_imgWidth, (int)m_imgHeight));
+            return buffer(cv::Rect((int)xOff, (int)yOff, (int)m_imgWidth, (int)m_imgHeight));
         }
         else
         { // ScaleMode::PAD --> center it and pad the rest
-            size_t hdiff = max((size_t)0, (m_imgHeight - mat.rows) / 2);
-            size_t wdiff = max((size_t)0, (m_imgWidth - mat.cols) / 2);
+            size_t hdiff = max((size_t)0, (m_imgHeight - buffer.rows) / 2);
+            size_t wdiff = max((size_t)0, (m_imgWidth - buffer.cols) / 2);
 
             size_t top = hdiff;
-            size_t bottom = m_imgHeight - top - mat.rows;
+            size_t bottom = m_imgHeight - top - buffer.rows;
             size_t left = wdiff;
-            size_t right = m_imgWidth - left - mat.cols;
-            cv::copyMakeBorder(mat, mat, (int)top, (int)bottom, (int)left, (int)right, m_borderType, cv::Scalar(m_padValue, m_padValue, m_padValue));
+            size_t right = m_imgWidth - left - buffer.cols;
+            cv::Mat padded;
+            cv::copyMakeBorder(buffer, padded, (int)top, (int)bottom, (int)left, (int)right, m_borderType, cv::Scalar(m_padValue, m_padValue, m_padValue));
+            return padded;
         }
     }
 }
@@ -425,27 +455,31 @@ void ScaleTransformer::Apply(uint8_t, cv::Mat &mat)
 MeanTransformer::MeanTransformer(const ConfigParameters& config) : ImageTransformerBase(config)
 {
     std::wstring meanFile = config(L"meanFile", L"");
+    m_meanImg = ReadMeanImage(meanFile);
+}
+
+/*static*/ cv::Mat MeanTransformer::ReadMeanImage(const std::wstring& meanFile)
+{
+    cv::Mat meanImg;
     if (meanFile.empty())
-        m_meanImg.release();
-    else
-    {
-        cv::FileStorage fs;
-        fs.open(msra::strfun::utf8(meanFile).c_str(), cv::FileStorage::READ);
-        if (!fs.isOpened())
-            RuntimeError("Could not open file: %ls", meanFile.c_str());
-        fs["MeanImg"] >> m_meanImg;
-        int cchan;
-        fs["Channel"] >> cchan;
-        int crow;
-        fs["Row"] >> crow;
-        int ccol;
-        fs["Col"] >> ccol;
-        if (cchan * crow * ccol !=
-            m_meanImg.channels() * m_meanImg.rows * m_meanImg.cols)
-            RuntimeError("Invalid data in file: %ls", meanFile.c_str());
-        fs.release();
-        m_meanImg = m_meanImg.reshape(cchan, crow);
-    }
+        return meanImg;
+
+    cv::FileStorage fs;
+    fs.open(msra::strfun::utf8(meanFile).c_str(), cv::FileStorage::READ);
+    if (!fs.isOpened())
+        RuntimeError("Could not open file: %ls", meanFile.c_str());
+    fs["MeanImg"] >> meanImg;
+    int cchan;
+    fs["Channel"] >> cchan;
+    int crow;
+    fs["Row"] >> crow;
+    int ccol;
+    fs["Col"] >> ccol;
+    if (cchan * crow * ccol !=
+        meanImg.channels() * meanImg.rows * meanImg.cols)
+        RuntimeError("Invalid data in file: %ls", meanFile.c_str());
+    fs.release();
+    return meanImg.reshape(cchan, crow);
 }
 
 void MeanTransformer::Apply(uint8_t, cv::Mat &mat)
@@ -594,6 +628,127 @@ SequenceDataPtr TransposeTransformer::TypedTranspose<TElementTo>::Apply(ImageSeq
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+FusedImageTransformer::FusedImageTransformer(const ConfigParameters& config) : TransformBase(config),
+    m_crop(config), m_scale(config)
+{
+    m_imgWidth    = config(L"width");
+    m_imgHeight   = config(L"height");
+    m_imgChannels = config(L"channels");
+
+    std::wstring meanFile = config(L"meanFile", L"");
+    cv::Mat meanImg = MeanTransformer::ReadMeanImage(meanFile);
+    if (!meanImg.empty())
+    {
+        if (meanImg.cols == (int)m_imgWidth && meanImg.rows == (int)m_imgHeight && meanImg.channels() == (int)m_imgChannels)
+            meanImg.convertTo(m_meanImg, m_precision == DataType::Float ? CV_32F : CV_64F);
+        else
+            fprintf(stderr, "WARNING: Mean file does not match the size of the scaled image, will be ignored.\n");
+    }
+}
+
+/*static*/ size_t FusedImageTransformer::MinDecodedShorterSide(const ConfigParameters& config)
+{
+    if (!config(L"reducedDecoding", true))
+        return 0;
+
+    double ratio = CropTransformer(config).MinCropSideRatio();
+    if (ratio <= 0)
+        return 0;
+
+    size_t width = config(L"width");
+    size_t height = config(L"height");
+    return (size_t)std::ceil(std::max(width, height) / ratio);
+}
+
+// The output stream has the scaled size in CHW and the required precision.
+StreamInformation FusedImageTransformer::Transform(const StreamInformation& inputStream)
+{
+    TransformBase::Transform(inputStream);
+
+    auto dims = ImageDimensions(m_imgWidth, m_imgHeight, m_imgChannels).AsTensorShape(CHW).GetDims();
+    m_outputStream.m_sampleLayout = NDShape(std::vector<size_t>(dims.begin(), dims.end()));
+    m_outputStream.m_elementType = m_precision;
+    return m_outputStream;
+}
+
+SequenceDataPtr FusedImageTransformer::Transform(SequenceDataPtr sequence)
+{
+    auto inputSequence = dynamic_cast<ImageSequenceData*>(sequence.get());
+    if (inputSequence == nullptr)
+        RuntimeError("Currently FusedImage transform only works with images.");
+
+    const cv::Mat& image = inputSequence->m_image;
+    cv::Rect rect;
+    bool flip;
+    m_crop.SelectCrop(inputSequence->m_copyIndex, image.rows, image.cols, rect, flip);
+
+    // Flipping commutes with scaling, so it is done by the final pass over the smaller scaled image.
+    auto buffer = m_scaleBuffers.pop_or_create([]() { return std::make_unique<cv::Mat>(); });
+    cv::Mat scaled = m_scale.Scale(image(rect), *buffer);
+    if (scaled.channels() != (int)m_imgChannels)
+        RuntimeError("Image with %d channels does not match the %d channels of the FusedImage transform.", scaled.channels(), (int)m_imgChannels);
+
+    SequenceDataPtr result = m_precision == DataType::Float ?
+        Write<float>(scaled, flip, m_floatBuffers) :
+        Write<double>(scaled, flip, m_doubleBuffers);
+    m_scaleBuffers.push(std::move(buffer));
+
+    result->m_key = inputSequence->m_key;
+    result->m_numberOfSamples = inputSequence->m_numberOfSamples;
+    return result;
+}
+
+template <class TElementTo>
+SequenceDataPtr FusedImageTransformer::Write(const cv::Mat& image, bool flip, conc_stack<std::vector<TElementTo>>& memBuffers)
+{
+    auto result = std::make_shared<DenseSequenceWithBuffer<TElementTo>>(memBuffers, m_outputStream.m_sampleLayout.TotalSize(), m_outputStream.m_sampleLayout);
+    switch (image.depth())
+    {
+    case CV_8U:
+        Write<TElementTo, unsigned char>(image, flip, result->GetBuffer());
+        break;
+    case CV_32F:
+        Write<TElementTo, float>(image, flip, result->GetBuffer());
+        break;
+    case CV_64F:
+        Write<TElementTo, double>(image, flip, result->GetBuffer());
+        break;
+    default:
+        RuntimeError("Unsupported OpenCV type '%d'", image.depth());
+    }
+    return result;
+}
+
+// dst[c, i, j] = image[i, flip ? cols - 1 - j : j, c] - mean[i, j, c]
+template <class TElementTo, class TElementFrom>
+void FusedImageTransformer::Write(const cv::Mat& image, bool flip, TElementTo* dst) const
+{
+    size_t rows = image.rows;
+    size_t cols = image.cols;
+    size_t channels = image.channels();
+    size_t planeSize = rows * cols;
+
+    for (size_t i = 0; i < rows; i++)
+    {
+        const TElementFrom* src = image.ptr<TElementFrom>((int)i);
+        const TElementTo* mean = m_meanImg.empty() ? nullptr : m_meanImg.ptr<TElementTo>((int)i);
+        TElementTo* dstRow = dst + i * cols;
+        for (size_t j = 0; j < cols; j++)
+        {
+            const TElementFrom* pixel = src + (flip ? cols - 1 - j : j) * channels;
+            for (size_t c = 0; c < channels; c++)
+            {
+                TElementTo value = static_cast<TElementTo>(pixel[c]);
+                if (mean)
+                    value -= mean[j * channels + c];
+                dstRow[c * planeSize + j] = value;
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 IntensityTransformer::IntensityTransformer(const ConfigParameters &config) : ImageTransformerBase(config)
 {
     m_stdDev = config(L"intensityStdDev", "0.0");
@@ -92,6 +92,12 @@ public:
 
     StreamInformation Transform(const StreamInformation& inputStream);
 
+    // Selects the crop of an image with the given size, and whether it is to be flipped horizontally.
+    void SelectCrop(uint8_t copyId, int rows, int cols, cv::Rect& rect, bool& flip);
+
+    // Lower bound of the side lengths of a crop relative to the shorter image side, or 0 if the crop size is given in pixels.
+    double MinCropSideRatio() const;
+
 private:
     void Apply(uint8_t copyId, cv::Mat &mat) override;
 
@@ -141,6 +147,10 @@ public:
 
     StreamInformation Transform(const StreamInformation& inputStream) override;
 
+    // Scales the image into 'buffer' (reallocated only if its size or type changes); returns the scaled image,
+    // which may be a region of 'buffer'.
+    cv::Mat Scale(const cv::Mat& mat, cv::Mat& buffer) const;
+
 private:
     enum class ScaleMode
     {
@@ -166,6 +176,9 @@ class MeanTransformer : public ImageTransformerBase
 public:
     explicit MeanTransformer(const Microsoft::MSR::CNTK::ConfigParameters& config);
 
+    // Reads the mean image from an OpenCV file storage, with the layout of the images (HWC).
+    static cv::Mat ReadMeanImage(const std::wstring& meanFile);
+
 private:
     void Apply(uint8_t copyId, cv::Mat &mat) override;
 
@@ -205,6 +218,46 @@ private:
     TypedTranspose<double> m_doubleTransform;
 };
 
+// Crop, scale, mean subtraction, transposition from HWC to CHW and cast to the required precision in a single transform,
+// taking the parameters of the Crop, Scale and Mean transforms. The crop is resized into a per-thread buffer, from which
+// a single pass subtracts the mean and writes the transposed (and possibly flipped) image straight into the sequence.
+// If it is the first transform of an image deserializer, the deserializer decodes JPEG images at a reduced resolution
+// when that still covers the crop at the target size (reducedDecoding = true, the default).
+class FusedImageTransformer : public TransformBase
+{
+public:
+    explicit FusedImageTransformer(const Microsoft::MSR::CNTK::ConfigParameters& config);
+
+    // Transformation of the stream.
+    StreamInformation Transform(const StreamInformation& inputStream) override;
+
+    // Transformation of the sequence.
+    SequenceDataPtr Transform(SequenceDataPtr sequence) override;
+
+    // The shorter image side that is still large enough for the crops of the transform with the given config,
+    // or 0 if the images must not be decoded at a reduced resolution.
+    static size_t MinDecodedShorterSide(const Microsoft::MSR::CNTK::ConfigParameters& config);
+
+private:
+    template <class TElementTo>
+    SequenceDataPtr Write(const cv::Mat& image, bool flip, Microsoft::MSR::CNTK::conc_stack<std::vector<TElementTo>>& memBuffers);
+
+    template <class TElementTo, class TElementFrom>
+    void Write(const cv::Mat& image, bool flip, TElementTo* dst) const;
+
+    CropTransformer m_crop;
+    ScaleTransformer m_scale;
+    cv::Mat m_meanImg; // in the required precision; empty if no mean is subtracted
+
+    size_t m_imgWidth;
+    size_t m_imgHeight;
+    size_t m_imgChannels;
+
+    Microsoft::MSR::CNTK::conc_stack<std::unique_ptr<cv::Mat>> m_scaleBuffers;
+    Microsoft::MSR::CNTK::conc_stack<std::vector<float>> m_floatBuffers;
+    Microsoft::MSR::CNTK::conc_stack<std::vector<double>> m_doubleBuffers;
+};
+
 // Intensity jittering based on PCA transform as described in original AlexNet paper
 // (http://papers.nips.cc/paper/4824-imagenet-classification-with-deep-convolutional-neural-networks.pdf)
 // Currently uses precomputed values from 
@@ -9,6 +9,7 @@
 #include "SequenceData.h"
 #include "DataDeserializer.h"
 #include <numeric>
+#include <algorithm>
 
 namespace CNTK {
 
@@ -53,6 +54,70 @@ namespace CNTK {
         return resultType;
     }
 
+    // Reads the size of a JPEG image from its frame header, without decoding the image.
+    inline bool GetJpegImageSize(const unsigned char* data, size_t size, int& width, int& height)
+    {
+        if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) // SOI
+            return false;
+
+        size_t pos = 2;
+        while (pos + 4 <= size)
+        {
+            if (data[pos] != 0xFF)
+                return false;
+
+            unsigned char marker = data[pos + 1];
+            if (marker == 0xFF) // fill byte
+            {
+                pos++;
+                continue;
+            }
+            if (marker == 0xD9 || marker == 0xDA) // EOI or SOS before any frame header
+                return false;
+
+            // SOF0..SOF15 except DHT, JPG and DAC
+            if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+            {
+                if (pos + 9 > size)
+                    return false;
+                height = (data[pos + 5] << 8) | data[pos + 6];
+                width = (data[pos + 7] << 8) | data[pos + 8];
+                return width > 0 && height > 0;
+            }
+
+            if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) // markers without a segment
+                pos += 2;
+            else
+                pos += 2 + ((data[pos + 2] << 8) | data[pos + 3]);
+        }
+        return false;
+    }
+
+    // Returns the OpenCV flags to decode the given encoded image. If the image is a JPEG whose shorter side is at least
+    // twice (four, eight times) 'minShorterSide', it is decoded at half (a quarter, an eighth) of its resolution,
+    // which libjpeg does by a scaled inverse DCT, much faster than a full decode and a resize.
+    inline int GetImageDecodingFlags(const unsigned char* data, size_t size, bool grayscale, size_t minShorterSide)
+    {
+#if CV_VERSION_MAJOR > 3 || (CV_VERSION_MAJOR == 3 && CV_VERSION_MINOR >= 1)
+        int width, height;
+        if (minShorterSide > 0 && GetJpegImageSize(data, size, width, height))
+        {
+            size_t shorterSide = (size_t)std::min(width, height);
+            if (shorterSide >= 8 * minShorterSide)
+                return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+            if (shorterSide >= 4 * minShorterSide)
+                return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+            if (shorterSide >= 2 * minShorterSide)
+                return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+        }
+#else
+        UNUSED(data);
+        UNUSED(size);
+        UNUSED(minShorterSide);
+#endif
+        return grayscale ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+    }
+
     // A helper interface to generate a typed label in a sparse format for categories.
     // It is represented as an array indexed by the category, containing zero values for all categories the sequence does not belong to,
     // and a single one for a category it belongs to: [ 0 .. 0.. 1 .. 0 ]
@@ -24,7 +24,9 @@ BlockRandomizer::BlockRandomizer(
     bool multithreadedGetNextSequence,
     size_t maxNumberOfInvalidSequences,
     bool sampleBasedRandomizationWindow,
-    size_t seedOffset)
+    size_t seedOffset,
+    size_t maxNumberOfPrefetchedChunks,
+    const std::vector<size_t>& lengthBucketBoundaries)
     : m_verbosity(verbosity),
       m_deserializer(deserializer),
       m_sweep(SIZE_MAX),
@@ -34,16 +36,21 @@ BlockRandomizer::BlockRandomizer(
       m_sweepSizeInSamples(0),
       m_chunkRandomizer(std::make_shared<ChunkRandomizer>(deserializer, randomizationRange, sampleBasedRandomizationWindow)),
       m_multithreadedGetNextSequences(multithreadedGetNextSequence),
-      m_prefetchedChunk(ChunkIdMax),
+      m_maxNumberOfPrefetchedChunks(shouldPrefetch ? maxNumberOfPrefetchedChunks : 0),
+      m_nextSweep(SIZE_MAX),
       m_cleaner(maxNumberOfInvalidSequences),
       m_seedOffset(seedOffset)
 {
     assert(deserializer != nullptr);
 
-    m_launchType = shouldPrefetch ? launch::async : launch::deferred;
-
     m_streams = m_deserializer->StreamInfos();
-    m_sequenceRandomizer = std::make_shared<SequenceRandomizer>(verbosity, m_deserializer, m_chunkRandomizer);
+    m_sequenceRandomizer = std::make_shared<SequenceRandomizer>(verbosity, m_deserializer, m_chunkRandomizer, lengthBucketBoundaries);
+
+    if (m_maxNumberOfPrefetchedChunks > 0)
+        m_nextSweepChunkRandomizer = std::make_shared<ChunkRandomizer>(deserializer, randomizationRange, sampleBasedRandomizationWindow);
+
+    // Created last, after this point the deserializer can be called from the background thread of the loader.
+    m_chunkLoader = std::make_shared<ChunkLoader>(m_deserializer, shouldPrefetch, m_maxNumberOfPrefetchedChunks);
 
     // Calculate total number of samples.
     m_sweepSizeInSamples = 0;
@@ -61,6 +68,7 @@ std::map<std::wstring, size_t> BlockRandomizer::GetState()
 // Start a new epoch.
 void BlockRandomizer::StartEpoch(const EpochConfiguration& config)
 {
+    ReportChunkLoaderStatistics();
     m_currentWindowRange = ClosedOpenChunkInterval{};
 
     m_config = config;
@@ -234,8 +242,7 @@ std::pair<size_t, size_t> BlockRandomizer::LoadSequenceData(size_t globalSampleC
     }
 
     // Now it is safe to start the new chunk prefetch.
-    ChunkIdType chunkToPrefetchNext = GetChunkToPrefetch(windowRange);
-    Prefetch(chunkToPrefetchNext);
+    Prefetch(windowRange);
 
     return { numGlobalSamples, numLocalSamples };
 }
@@ -394,32 +401,14 @@ void BlockRandomizer::LoadDataChunks(const ClosedOpenChunkInterval& windowRange)
             continue;
         }
 
+        // Takes the prefetched chunk, or waits for it to be loaded.
         auto const& chunk = m_chunkRandomizer->GetRandomizedChunks()[i];
-        if (chunk.m_original->m_id == m_prefetchedChunk && m_prefetch.valid())
-        {
-            // Taking prefetched chunk.
-            m_chunks[chunk.m_original->m_id] = m_prefetch.get();
-            if (m_verbosity >= Information)
-                fprintf(stderr, "BlockRandomizer::RetrieveDataChunks: paged in prefetched chunk %u (original chunk: %u), now %" PRIu64 " chunks in memory\n",
-                chunk.m_chunkId,
-                chunk.m_original->m_id,
-                ++numLoadedChunks);
-        }
-        else
-        {
-            // Make sure we have no outstanding prefetches.
-            if (m_prefetch.valid())
-            {
-                m_prefetch.wait();
-            }
-
-            m_chunks[chunk.m_original->m_id] = m_deserializer->GetChunk(chunk.m_original->m_id);
-            if (m_verbosity >= Information)
-                fprintf(stderr, "BlockRandomizer::RetrieveDataChunks: paged in randomized chunk %u (original chunk: %u), now %" PRIu64 " chunks in memory\n",
-                chunk.m_chunkId,
-                chunk.m_original->m_id,
-                ++numLoadedChunks);
-        }
+        m_chunks[chunk.m_original->m_id] = m_chunkLoader->GetChunk(chunk.m_original->m_id);
+        if (m_verbosity >= Information)
+            fprintf(stderr, "BlockRandomizer::RetrieveDataChunks: paged in randomized chunk %u (original chunk: %u), now %" PRIu64 " chunks in memory\n",
+            chunk.m_chunkId,
+            chunk.m_original->m_id,
+            ++numLoadedChunks);
     }
 
     if (m_verbosity >= Notification)
@@ -429,45 +418,78 @@ void BlockRandomizer::LoadDataChunks(const ClosedOpenChunkInterval& windowRange)
                 m_chunkRandomizer->GetRandomizedChunks()[windowRange.m_end - 1].m_chunkId);
 }
 
-// Identifies chunk id that should be prefetched.
-ChunkIdType BlockRandomizer::GetChunkToPrefetch(const ClosedOpenChunkInterval& windowRange)
+// Identifies chunks that should be prefetched.
+std::vector<ChunkIdType> BlockRandomizer::GetChunksToPrefetch(const ClosedOpenChunkInterval& windowRange)
 {
-    ChunkIdType toBePrefetched = ChunkIdMax;
-    auto current = windowRange.m_end;
-    while (current < m_chunkRandomizer->GetRandomizedChunks().size())
+    std::vector<ChunkIdType> toBePrefetched;
+    auto add = [&](const RandomizedChunk& chunk)
     {
-        const auto& chunk = m_chunkRandomizer->GetRandomizedChunks()[current];
         if (chunk.m_chunkId % m_config.m_numberOfWorkers == m_config.m_workerRank &&
-            m_chunks.find(chunk.m_original->m_id) == m_chunks.end())
+            m_chunks.find(chunk.m_original->m_id) == m_chunks.end() &&
+            std::find(toBePrefetched.begin(), toBePrefetched.end(), chunk.m_original->m_id) == toBePrefetched.end())
         {
-            toBePrefetched = chunk.m_original->m_id;
-            break;
+            toBePrefetched.push_back(chunk.m_original->m_id);
         }
-        ++current;
+        return toBePrefetched.size() < m_maxNumberOfPrefetchedChunks;
+    };
+
+    const auto& chunks = m_chunkRandomizer->GetRandomizedChunks();
+    for (auto current = windowRange.m_end; current < chunks.size(); ++current)
+    {
+        if (!add(chunks[current]))
+            return toBePrefetched;
     }
-    return toBePrefetched;
-}
 
-// Performs io prefetch of the specified chunk if needed.
-void BlockRandomizer::Prefetch(ChunkIdType chunkId)
-{
-    // Start new prefetch if necessary.
-    if (m_prefetchedChunk != chunkId && chunkId != ChunkIdMax)
+    // Reached the end of the sweep, continuing with the first chunks of the next one,
+    // so that the new sweep does not start with an empty pipeline.
+    if (m_nextSweepChunkRandomizer && m_sweep != SIZE_MAX)
     {
-        // Wait to make sure there is no outstanding prefetches.
-        if (m_prefetch.valid())
+        if (m_nextSweep != m_sweep + 1)
         {
-            m_prefetch.wait();
+            m_nextSweep = m_sweep + 1;
+            m_nextSweepChunkRandomizer->Randomize(m_seedOffset + m_nextSweep);
         }
 
-        m_prefetchedChunk = chunkId;
-        m_prefetch = std::async(m_launchType, [this, chunkId]() { return m_deserializer->GetChunk(chunkId); });
+        for (const auto& chunk : m_nextSweepChunkRandomizer->GetRandomizedChunks())
+        {
+            if (!add(chunk))
+                break;
+        }
+    }
+
+    return toBePrefetched;
+}
 
-        if (m_verbosity >= Debug)
+// Performs io prefetch of the chunks following the window if needed.
+void BlockRandomizer::Prefetch(const ClosedOpenChunkInterval& windowRange)
+{
+    if (m_maxNumberOfPrefetchedChunks == 0)
+        return;
+
+    auto chunks = GetChunksToPrefetch(windowRange);
+    m_chunkLoader->Prefetch(chunks);
+
+    if (m_verbosity >= Debug)
+    {
+        for (auto chunkId : chunks)
             fprintf(stderr, "BlockRandomizer::Prefetch: prefetching original chunk: %u\n", chunkId);
     }
 }
 
+void BlockRandomizer::ReportChunkLoaderStatistics()
+{
+    auto statistics = m_chunkLoader->GetStatistics();
+    m_chunkLoader->ResetStatistics();
+    if (m_verbosity >= Notification && statistics.m_numberOfRequestedChunks > 0)
+        fprintf(stderr, "BlockRandomizer::ReportChunkLoaderStatistics: %" PRIu64 " chunks paged in, %" PRIu64 " of them prefetched, "
+                "%" PRIu64 " stalls for a total of %.3f seconds, %" PRIu64 " prefetched chunks not used\n",
+                statistics.m_numberOfRequestedChunks,
+                statistics.m_numberOfPrefetchedChunks,
+                statistics.m_numberOfStalls,
+                statistics.m_stallTimeInSeconds,
+                statistics.m_numberOfWastedChunks);
+}
+
 void BlockRandomizer::SetState(const std::map<std::wstring, size_t>& state)
 {
     auto it = state.find(g_minibatchSourcePosition);
@@ -12,7 +12,7 @@
 #include "ChunkRandomizer.h"
 #include "SequenceRandomizer.h"
 #include "ReaderUtil.h"
-#include <future>
+#include "ChunkLoader.h"
 
 namespace CNTK {
 
@@ -44,7 +44,9 @@ public:
         bool multithreadedGetNextSequences = false,
         size_t maxNumberOfInvalidSequences = 0, // per worker
         bool sampleBasedRandomizationWindow = true,
-        size_t seedOffset = 0);
+        size_t seedOffset = 0,
+        size_t maxNumberOfPrefetchedChunks = 2,
+        const std::vector<size_t>& lengthBucketBoundaries = std::vector<size_t>()); // see SequenceRandomizer
 
     // Starts a new epoch.
     virtual void StartEpoch(const EpochConfiguration& config) override;
@@ -63,14 +65,6 @@ public:
     // Returns current position in the global timeline. The returned value is in samples.
     std::map<std::wstring, size_t> GetState() override;
 
-    ~BlockRandomizer()
-    {
-        if (m_prefetch.valid())
-        {
-            m_prefetch.wait();
-        }
-    }
-
     void SetState(const std::map<std::wstring, size_t>& state) override;
 
     void SetConfiguration(const ReaderConfiguration& config) override;
@@ -97,11 +91,15 @@ private:
     // Prepares a new sweep if needed.
     void PrepareNewSweepIfNeeded(size_t samplePosition);
 
-    // Performs io prefetch of the specified chunk if needed.
-    void Prefetch(ChunkIdType chunkId);
+    // Starts io prefetch of the chunks following the given window.
+    void Prefetch(const ClosedOpenChunkInterval& windowRange);
 
-    // Returns next candidate for the prefetch in the given range.
-    ChunkIdType GetChunkToPrefetch(const ClosedOpenChunkInterval& windowRange);
+    // Returns the next local chunks that are not loaded yet following the given window, in the order of their use.
+    // Continues into the next sweep when the end of the current one is reached.
+    std::vector<ChunkIdType> GetChunksToPrefetch(const ClosedOpenChunkInterval& windowRange);
+
+    // Reports chunk loader statistics.
+    void ReportChunkLoaderStatistics();
 
     // Global sample position on the timeline.
     size_t m_globalSamplePosition;
@@ -153,12 +151,15 @@ private:
 
     int m_verbosity;
 
-    // Prefetch future.
-    std::future<ChunkPtr> m_prefetch;
-    // Whether to have async or deferred prefetch.
-    launch m_launchType;
-    // Prefetched original chunk id.
-    ChunkIdType m_prefetchedChunk;
+    // Loads chunks ahead of the window.
+    ChunkLoaderPtr m_chunkLoader;
+
+    // Maximum number of chunks loaded ahead of the window.
+    size_t m_maxNumberOfPrefetchedChunks;
+
+    // Chunk randomization of the next sweep, to start loading its first chunks before the sweep begins.
+    ChunkRandomizerPtr m_nextSweepChunkRandomizer;
+    size_t m_nextSweep;
 
     // Current loaded chunks.
     ClosedOpenChunkInterval m_currentWindowRange;
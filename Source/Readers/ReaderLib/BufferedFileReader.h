@@ -6,6 +6,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <assert.h>
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include "ReaderConstants.h"
@@ -59,6 +61,35 @@ public:
         return true;
     }
 
+    // Returns a pointer to the current position and sets 'size' to the number of bytes
+    // that are available in the buffer from there on (without a refill).
+    inline const char* PeekSpan(size_t& size) const
+    {
+        if (m_done)
+        {
+            size = 0;
+            return nullptr;
+        }
+
+        size = m_buffer.size() - m_index;
+        return m_buffer.data() + m_index;
+    }
+
+    // Advances the current position by 'count' bytes, which must not exceed the size returned
+    // by PeekSpan and must not contain an EOL (the line counter is not updated).
+    // Returns true, unless the EOF has been reached.
+    inline bool SkipWithinLine(size_t count)
+    {
+        assert(count <= m_buffer.size() - m_index);
+        assert(std::find(m_buffer.begin() + m_index, m_buffer.begin() + m_index + count, g_eol) == m_buffer.begin() + m_index + count);
+
+        m_index += count;
+        if (m_index == m_buffer.size())
+            Refill();
+
+        return !m_done;
+    }
+
     // Moves the current position to the next line (the position following an EOL delimiter).
     // Returns true, unless the EOF has been reached.
     bool TryMoveToNextLine();
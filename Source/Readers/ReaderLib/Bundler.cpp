@@ -8,6 +8,7 @@
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 #include <set>
+#include <future>
 
 namespace CNTK {
 
@@ -245,25 +246,15 @@ public:
 
         // Creating chunk mapping.
         m_parent->m_primaryDeserializer->SequenceInfosForChunk(original.m_id, sequences);
-        ChunkPtr drivingChunk = m_parent->m_primaryDeserializer->GetChunk(original.m_id);
         m_sequenceToSequence.resize(deserializers.size() * sequences.size());
         m_innerChunks.resize(deserializers.size() * sequences.size());
-        for (size_t sequenceIndex = 0; sequenceIndex < sequences.size(); ++sequenceIndex)
-        {
-            if (chunk.m_invalid.find(sequenceIndex) != chunk.m_invalid.end())
-            {
-                continue;
-            }
-
-            size_t currentIndex = sequenceIndex * deserializers.size();
-            m_sequenceToSequence[currentIndex] = sequences[sequenceIndex].m_indexInChunk;
-            m_innerChunks[currentIndex] = drivingChunk;
-        }
 
         // Creating sequence mapping and requiring underlying chunks.
-        SequenceInfo s;
-        for (size_t deserializerIndex = 1; deserializerIndex < deserializers.size(); ++deserializerIndex)
+        // Deserializers are independent of each other, so their chunks are decoded in parallel,
+        // each deserializer (and its chunk table) being accessed by a single thread only.
+        auto loadSecondaryChunks = [&](size_t deserializerIndex)
         {
+            SequenceInfo s;
             auto& chunkTable = m_parent->m_weakChunkTable[deserializerIndex];
             for (size_t sequenceIndex = 0; sequenceIndex < sequences.size(); ++sequenceIndex)
             {
@@ -285,7 +276,28 @@ public:
 
                 m_innerChunks[currentIndex] = secondaryChunk;
             }
+        };
+
+        std::vector<std::future<void>> secondaryLoads;
+        for (size_t deserializerIndex = 1; deserializerIndex < deserializers.size(); ++deserializerIndex)
+            secondaryLoads.push_back(std::async(std::launch::async, loadSecondaryChunks, deserializerIndex));
+
+        ChunkPtr drivingChunk = m_parent->m_primaryDeserializer->GetChunk(original.m_id);
+        for (size_t sequenceIndex = 0; sequenceIndex < sequences.size(); ++sequenceIndex)
+        {
+            if (chunk.m_invalid.find(sequenceIndex) != chunk.m_invalid.end())
+            {
+                continue;
+            }
+
+            size_t currentIndex = sequenceIndex * deserializers.size();
+            m_sequenceToSequence[currentIndex] = sequences[sequenceIndex].m_indexInChunk;
+            m_innerChunks[currentIndex] = drivingChunk;
         }
+
+        // Rethrows the first failure of the secondary deserializers.
+        for (auto& load : secondaryLoads)
+            load.get();
     }
 
     // Gets sequence by its index.
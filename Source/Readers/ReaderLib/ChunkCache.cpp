@@ -9,16 +9,67 @@
 
 namespace CNTK {
 
+ChunkCache::ChunkCache(DataDeserializerPtr deserializer, size_t maxSizeInBytes)
+    : m_deserializer(deserializer),
+      m_maxSizeInBytes(maxSizeInBytes),
+      m_sizeInBytes(0),
+      m_bytesPerSample(0)
+{
+    if (m_maxSizeInBytes == SIZE_MAX)
+        return;
+
+    for (const auto& stream : m_deserializer->StreamInfos())
+    {
+        size_t elementSize = DataTypeSize(stream.m_elementType);
+        if (stream.m_storageFormat != StorageFormat::Dense)
+            m_bytesPerSample += elementSize + sizeof(SparseIndexType);
+        else if (!stream.m_sampleLayout.IsUnknown() && !stream.m_sampleLayout.HasUnboundDimension())
+            m_bytesPerSample += elementSize * stream.m_sampleLayout.TotalSize();
+    }
+
+    for (const auto& chunk : m_deserializer->ChunkInfos())
+        m_numberOfSamples[chunk.m_id] = chunk.m_numberOfSamples;
+}
+
+size_t ChunkCache::EstimateSizeInBytes(ChunkIdType chunkId) const
+{
+    auto it = m_numberOfSamples.find(chunkId);
+    return it == m_numberOfSamples.end() ? 0 : it->second * m_bytesPerSample;
+}
+
 ChunkPtr ChunkCache::GetChunk(ChunkIdType chunkId)
 {
     auto it = m_chunkMap.find(chunkId);
     if (it != m_chunkMap.end())
     {
-        return it->second;
+        if (it->second.m_lruPosition != m_lru.end())
+            m_lru.splice(m_lru.begin(), m_lru, it->second.m_lruPosition);
+        return it->second.m_chunk;
     }
  
     ChunkPtr chunk = m_deserializer->GetChunk(chunkId);
-    m_chunkMap[chunkId] = chunk;
+    if (m_maxSizeInBytes == SIZE_MAX)
+    {
+        m_chunkMap[chunkId] = CachedChunk{ chunk, 0, m_lru.end() };
+        return chunk;
+    }
+
+    size_t size = EstimateSizeInBytes(chunkId);
+    if (size > m_maxSizeInBytes)
+        return chunk; // Does not fit at all, not evicting everything else for it.
+
+    // Evicting the least recently used chunks, they stay alive while in use by the caller.
+    while (m_sizeInBytes + size > m_maxSizeInBytes)
+    {
+        auto evicted = m_chunkMap.find(m_lru.back());
+        m_sizeInBytes -= evicted->second.m_sizeInBytes;
+        m_chunkMap.erase(evicted);
+        m_lru.pop_back();
+    }
+
+    m_lru.push_front(chunkId);
+    m_chunkMap[chunkId] = CachedChunk{ chunk, size, m_lru.begin() };
+    m_sizeInBytes += size;
  
     return chunk;
 }
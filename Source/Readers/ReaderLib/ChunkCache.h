@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <list>
 #include <map>
 #include "DataDeserializer.h"
 
@@ -16,11 +17,15 @@ namespace CNTK {
 // when the whole dataset fits in memory.
 // Implemented as a wrapping proxy around a deserializer that stores pointers to
 // all chunks it sees in an internal map.
+// Optionally the cache can be given a memory budget, in which case the least recently
+// used chunks are evicted once the estimated size of the cached chunks exceeds it.
+// The estimate is based on the stream layouts: dense samples are counted in full,
+// sparse samples are counted with a single non-zero value.
 class ChunkCache : public DataDeserializer
 {
 public:
 
-    ChunkCache(DataDeserializerPtr deserializer) : m_deserializer(deserializer) { }
+    ChunkCache(DataDeserializerPtr deserializer, size_t maxSizeInBytes = SIZE_MAX);
 
     virtual std::vector<StreamInformation> StreamInfos() override
     {
@@ -45,11 +50,35 @@ public:
     // Gets chunk data given its id.
     virtual ChunkPtr GetChunk(ChunkIdType chunkId);
 
+    // Returns the estimated size of the currently cached chunks.
+    size_t GetSizeInBytes() const { return m_sizeInBytes; }
+
 private:
+    struct CachedChunk
+    {
+        ChunkPtr m_chunk;
+        size_t m_sizeInBytes;
+        std::list<ChunkIdType>::iterator m_lruPosition;
+    };
+
+    // Estimates the size of the chunk in memory.
+    size_t EstimateSizeInBytes(ChunkIdType chunkId) const;
+
     // A map of currently loaded chunks
-    std::map<size_t, ChunkPtr> m_chunkMap;
+    std::map<size_t, CachedChunk> m_chunkMap;
     DataDeserializerPtr m_deserializer;
 
+    // Cached chunks, the most recently used first.
+    std::list<ChunkIdType> m_lru;
+
+    // Memory budget and the estimated size of the cached chunks.
+    size_t m_maxSizeInBytes;
+    size_t m_sizeInBytes;
+
+    // Number of samples in each chunk and the estimated number of bytes per sample.
+    std::map<ChunkIdType, size_t> m_numberOfSamples;
+    size_t m_bytesPerSample;
+
     DISABLE_COPY_AND_MOVE(ChunkCache);
 };
 
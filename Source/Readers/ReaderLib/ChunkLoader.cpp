@@ -0,0 +1,198 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "ChunkLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <set>
+
+namespace CNTK {
+
+ChunkLoader::ChunkLoader(DataDeserializerPtr deserializer, bool async, size_t maxNumberOfPrefetchedChunks)
+    : m_deserializer(deserializer),
+      m_async(async && maxNumberOfPrefetchedChunks > 0),
+      m_maxNumberOfPrefetchedChunks(maxNumberOfPrefetchedChunks),
+      m_inProgress(ChunkIdMax),
+      m_dropInProgress(false),
+      m_deserializerBusy(false),
+      m_stop(false)
+{
+    assert(deserializer != nullptr);
+
+    if (m_async)
+        m_thread = std::thread([this]() { Run(); });
+}
+
+ChunkLoader::~ChunkLoader()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            m_stop = true;
+        }
+        m_changed.notify_all();
+        m_thread.join();
+    }
+}
+
+void ChunkLoader::Run()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    for (;;)
+    {
+        m_changed.wait(guard, [this]()
+        {
+            return m_stop || (!m_deserializerBusy && !m_queue.empty() && m_loaded.size() < m_maxNumberOfPrefetchedChunks);
+        });
+
+        if (m_stop)
+            return;
+
+        m_inProgress = m_queue.front();
+        m_queue.pop_front();
+        m_dropInProgress = false;
+        m_deserializerBusy = true;
+        guard.unlock();
+
+        LoadedChunk result;
+        try
+        {
+            result.m_chunk = m_deserializer->GetChunk(m_inProgress);
+        }
+        catch (...)
+        {
+            // Rethrown on the consumer thread in case the chunk is requested.
+            result.m_exception = std::current_exception();
+        }
+
+        guard.lock();
+        if (m_dropInProgress)
+            m_statistics.m_numberOfWastedChunks++;
+        else
+            m_loaded[m_inProgress] = std::move(result);
+
+        m_inProgress = ChunkIdMax;
+        m_deserializerBusy = false;
+        m_changed.notify_all();
+    }
+}
+
+void ChunkLoader::Prefetch(const std::vector<ChunkIdType>& chunkIds)
+{
+    if (!m_async)
+        return;
+
+    {
+        std::unique_lock<std::mutex> guard(m_lock);
+        std::set<ChunkIdType> wanted(chunkIds.begin(), chunkIds.end());
+        for (auto it = m_loaded.begin(); it != m_loaded.end();)
+        {
+            if (wanted.find(it->first) == wanted.end())
+            {
+                it = m_loaded.erase(it);
+                m_statistics.m_numberOfWastedChunks++;
+            }
+            else
+                ++it;
+        }
+
+        m_queue.clear();
+        for (auto chunkId : chunkIds)
+        {
+            if (chunkId != m_inProgress && m_loaded.find(chunkId) == m_loaded.end())
+                m_queue.push_back(chunkId);
+        }
+
+        m_dropInProgress = m_inProgress != ChunkIdMax && wanted.find(m_inProgress) == wanted.end();
+    }
+    m_changed.notify_all();
+}
+
+ChunkPtr ChunkLoader::GetChunk(ChunkIdType chunkId)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto recordStall = [&]()
+    {
+        m_statistics.m_numberOfStalls++;
+        m_statistics.m_stallTimeInSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_statistics.m_numberOfRequestedChunks++;
+
+    auto queued = std::find(m_queue.begin(), m_queue.end(), chunkId);
+    if (queued != m_queue.end())
+        m_queue.erase(queued);
+
+    auto loaded = m_loaded.find(chunkId);
+    if (loaded != m_loaded.end())
+    {
+        m_statistics.m_numberOfPrefetchedChunks++;
+        return Take(loaded);
+    }
+
+    if (m_inProgress == chunkId)
+    {
+        // The background thread is on it, waiting for the result.
+        m_dropInProgress = false;
+        m_changed.wait(guard, [this, chunkId]() { return m_loaded.find(chunkId) != m_loaded.end(); });
+        recordStall();
+        return Take(m_loaded.find(chunkId));
+    }
+
+    // Not prefetched, loading the chunk on this thread as soon as the deserializer is free.
+    m_changed.wait(guard, [this]() { return !m_deserializerBusy; });
+    m_deserializerBusy = true;
+    guard.unlock();
+
+    ChunkPtr chunk;
+    try
+    {
+        chunk = m_deserializer->GetChunk(chunkId);
+    }
+    catch (...)
+    {
+        guard.lock();
+        m_deserializerBusy = false;
+        m_changed.notify_all();
+        throw;
+    }
+
+    guard.lock();
+    m_deserializerBusy = false;
+    m_changed.notify_all();
+    recordStall();
+    return chunk;
+}
+
+// Hands a loaded chunk over to the consumer, freeing its prefetch slot.
+ChunkPtr ChunkLoader::Take(std::map<ChunkIdType, LoadedChunk>::iterator it)
+{
+    LoadedChunk result = std::move(it->second);
+    m_loaded.erase(it);
+    m_changed.notify_all();
+
+    if (result.m_exception)
+        std::rethrow_exception(result.m_exception);
+
+    return result.m_chunk;
+}
+
+ChunkLoaderStatistics ChunkLoader::GetStatistics()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    return m_statistics;
+}
+
+void ChunkLoader::ResetStatistics()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_statistics = ChunkLoaderStatistics();
+}
+
+}
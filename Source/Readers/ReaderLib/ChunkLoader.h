@@ -0,0 +1,108 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DataDeserializer.h"
+
+namespace CNTK {
+
+// Statistics of a chunk loader, used to see how often the consumer had to wait for the data.
+struct ChunkLoaderStatistics
+{
+    // Number of chunks requested by the consumer.
+    size_t m_numberOfRequestedChunks = 0;
+
+    // Number of requested chunks that were already loaded in the background.
+    size_t m_numberOfPrefetchedChunks = 0;
+
+    // Number of requested chunks the consumer had to wait for.
+    size_t m_numberOfStalls = 0;
+
+    // Total time the consumer spent waiting for chunks.
+    double m_stallTimeInSeconds = 0;
+
+    // Number of chunks that were loaded in the background but never requested.
+    size_t m_numberOfWastedChunks = 0;
+};
+
+// Loads chunks of a deserializer ahead of their use.
+// The consumer announces the chunks it is going to need (in the order of their use) with Prefetch,
+// and a background thread loads up to a given number of them, while the consumer is still busy with the current ones.
+// Deserializers are not required to be thread safe, so all calls into the deserializer (including the ones
+// of a chunk that has not been prefetched) are serialized; chunk decoding is parallelized inside of the deserializer
+// where possible (i.e. by the Bundler across its deserializers).
+// If asynchronous loading is switched off, chunks are loaded on the consumer thread when requested.
+class ChunkLoader
+{
+public:
+    ChunkLoader(DataDeserializerPtr deserializer, bool async, size_t maxNumberOfPrefetchedChunks);
+    ~ChunkLoader();
+
+    // Replaces the list of chunks to be loaded in the background with the given one.
+    // Loaded chunks that are not in the list anymore are released.
+    void Prefetch(const std::vector<ChunkIdType>& chunkIds);
+
+    // Returns the chunk with the given id, waiting for the background load if the chunk
+    // is in progress, or loading it if it has not been prefetched.
+    ChunkPtr GetChunk(ChunkIdType chunkId);
+
+    // Returns statistics accumulated since the last reset.
+    ChunkLoaderStatistics GetStatistics();
+
+    void ResetStatistics();
+
+private:
+    DISABLE_COPY_AND_MOVE(ChunkLoader);
+
+    // Background thread loop.
+    void Run();
+
+    // Result of a background load.
+    struct LoadedChunk
+    {
+        ChunkPtr m_chunk;
+        std::exception_ptr m_exception;
+    };
+
+    ChunkPtr Take(std::map<ChunkIdType, LoadedChunk>::iterator it);
+
+    DataDeserializerPtr m_deserializer;
+    bool m_async;
+    size_t m_maxNumberOfPrefetchedChunks;
+
+    // Chunks that wait to be loaded, in the order of their use.
+    std::deque<ChunkIdType> m_queue;
+
+    // Chunks that have been loaded and are not requested yet.
+    std::map<ChunkIdType, LoadedChunk> m_loaded;
+
+    // Chunk currently loaded by the background thread.
+    ChunkIdType m_inProgress;
+
+    // Whether the chunk in progress is not needed anymore.
+    bool m_dropInProgress;
+
+    // Whether there is a call into the deserializer.
+    bool m_deserializerBusy;
+
+    bool m_stop;
+    ChunkLoaderStatistics m_statistics;
+
+    std::mutex m_lock;
+    std::condition_variable m_changed;
+    std::thread m_thread;
+};
+
+typedef std::shared_ptr<ChunkLoader> ChunkLoaderPtr;
+
+}
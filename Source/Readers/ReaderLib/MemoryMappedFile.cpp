@@ -0,0 +1,137 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#define _CRT_SECURE_NO_WARNINGS
+#include "MemoryMappedFile.h"
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "Platform.h"
+
+namespace CNTK {
+
+using namespace Microsoft::MSR::CNTK;
+
+#ifdef _WIN32
+
+MemoryMappedFile::MemoryMappedFile(const std::wstring& filename)
+    : m_filename(filename), m_data(nullptr), m_size(0), m_fileHandle(INVALID_HANDLE_VALUE), m_mappingHandle(nullptr)
+{
+    m_fileHandle = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_fileHandle == INVALID_HANDLE_VALUE)
+        RuntimeError("Cannot open file '%ls' for memory mapping (error %u).", filename.c_str(), (unsigned int)GetLastError());
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_fileHandle, &size))
+    {
+        CloseHandle(m_fileHandle);
+        RuntimeError("Cannot determine the size of file '%ls' (error %u).", filename.c_str(), (unsigned int)GetLastError());
+    }
+    m_size = (size_t)size.QuadPart;
+    if (m_size == 0)
+        return;
+
+    m_mappingHandle = CreateFileMappingW(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mappingHandle != nullptr)
+        m_data = (char*)MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (m_data == nullptr)
+    {
+        auto error = GetLastError();
+        if (m_mappingHandle != nullptr)
+            CloseHandle(m_mappingHandle);
+        CloseHandle(m_fileHandle);
+        RuntimeError("Cannot memory map file '%ls' (error %u).", filename.c_str(), (unsigned int)error);
+    }
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mappingHandle != nullptr)
+        CloseHandle(m_mappingHandle);
+    if (m_fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(m_fileHandle);
+}
+
+// Windows reads mapped files ahead on its own; there is no cheap per-range hint before Windows 8.
+void MemoryMappedFile::WillNeed(size_t, size_t) const
+{
+}
+
+void MemoryMappedFile::DontNeed(size_t, size_t) const
+{
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(const std::wstring& filename)
+    : m_filename(filename), m_data(nullptr), m_size(0), m_fd(-1)
+{
+    m_fd = open(wtocharpath(filename).c_str(), O_RDONLY);
+    if (m_fd < 0)
+        RuntimeError("Cannot open file '%ls' for memory mapping: %s.", filename.c_str(), strerror(errno));
+
+    struct stat info;
+    if (fstat(m_fd, &info) != 0)
+    {
+        auto error = errno;
+        close(m_fd);
+        RuntimeError("Cannot determine the size of file '%ls': %s.", filename.c_str(), strerror(error));
+    }
+    m_size = (size_t)info.st_size;
+    if (m_size == 0)
+        return;
+
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        auto error = errno;
+        close(m_fd);
+        RuntimeError("Cannot memory map file '%ls': %s.", filename.c_str(), strerror(error));
+    }
+    m_data = (char*)data;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (m_data != nullptr)
+        munmap(m_data, m_size);
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+// madvise() needs page-aligned addresses; widen the range to whole pages
+static void AdviseRange(char* data, size_t fileSize, size_t offset, size_t size, int advice)
+{
+    if (data == nullptr || offset >= fileSize || size == 0)
+        return;
+    static const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t begin = offset / pageSize * pageSize;
+    size_t end = std::min(offset + size, fileSize);
+    madvise(data + begin, end - begin, advice); // only a hint, failures do not matter
+}
+
+void MemoryMappedFile::WillNeed(size_t offset, size_t size) const
+{
+    AdviseRange(m_data, m_size, offset, size, MADV_WILLNEED);
+}
+
+void MemoryMappedFile::DontNeed(size_t offset, size_t size) const
+{
+    AdviseRange(m_data, m_size, offset, size, MADV_DONTNEED);
+}
+
+#endif
+
+}
@@ -0,0 +1,50 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include "Basics.h"
+
+namespace CNTK {
+
+// A read-only mapping of a whole file into memory. The data is backed by the OS page cache rather than by
+// buffers of the process, so that deserializers can expose pointers into the file without reading (and
+// copying) it first.
+class MemoryMappedFile
+{
+public:
+    explicit MemoryMappedFile(const std::wstring& filename);
+    ~MemoryMappedFile();
+
+    const char* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+    const std::wstring& Filename() const { return m_filename; }
+
+    // Hints that the given range will be read soon, so the OS can start reading it in the background.
+    void WillNeed(size_t offset, size_t size) const;
+
+    // Hints that the given range is not needed any longer, so its pages can be dropped from the process.
+    void DontNeed(size_t offset, size_t size) const;
+
+private:
+    std::wstring m_filename;
+    char* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#else
+    int m_fd;
+#endif
+
+    DISABLE_COPY_AND_MOVE(MemoryMappedFile);
+};
+
+typedef std::shared_ptr<MemoryMappedFile> MemoryMappedFilePtr;
+
+}
@@ -10,6 +10,7 @@
 #include "SequenceEnumerator.h"
 #include "Packer.h"
 #include "CorpusDescriptor.h"
+#include "SequenceData.h"
 
 namespace CNTK {
 
@@ -60,6 +61,7 @@ protected:
     // the data portion of the source sequence to the destination block of memory. sampleOffset 
     // specifies the offset of the first value from the given sample in the sequence data/ array 
     // (sampleOffset is equal to the sum of sample sizes of all preceding samples).
+    // Sequences without a data buffer (DeferredDenseSequenceData) write the sample themselves.
     void PackDenseSample(char* destination, SequenceDataPtr sequence, size_t sampleOffset, size_t sampleSize);
 
     // Establishes a mapping between id inside the mb layout and the global key in the corpus.
@@ -129,8 +131,16 @@ inline void PackerBase::PackSparseSampleAsDense(char* destination, SparseSequenc
 
 inline void PackerBase::PackDenseSample(char* destination, SequenceDataPtr sequence, size_t sampleOffset, size_t sampleSize)
 {
+    const void* buffer = sequence->GetDataBuffer();
+    if (!buffer)
+    {
+        // The samples are not materialized, the sequence produces them directly in the output.
+        static_cast<DeferredDenseSequenceData&>(*sequence).CopySampleTo(sampleOffset / sampleSize, destination);
+        return;
+    }
+
     // Because the sample is dense - simply copying it to the output.
-    memcpy(destination, (const char*)(sequence->GetDataBuffer()) + sampleOffset, sampleSize);
+    memcpy(destination, (const char*)buffer + sampleOffset, sampleSize);
 }
 
 }
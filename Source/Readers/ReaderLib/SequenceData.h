@@ -39,6 +39,21 @@ namespace CNTK {
 
     typedef std::shared_ptr<CategorySequenceData> CategorySequenceDataPtr;
 
+    // Class represents a dense sequence whose samples are not materialized in a contiguous buffer,
+    // i.e. GetDataBuffer returns nullptr. Instead, the packer asks the sequence to write
+    // each sample directly into the minibatch, which avoids an intermediate copy when samples
+    // are cheap to compute from shared data (e.g. spliced speech frames).
+    struct DeferredDenseSequenceData : DenseSequenceData
+    {
+        const void* GetDataBuffer() override
+        {
+            return nullptr;
+        }
+
+        // Writes the sample with the given index (of the size of GetSampleShape() elements) to the destination.
+        virtual void CopySampleTo(size_t sampleIndex, char* destination) = 0;
+    };
+
     // The class represents a sequence that returns the internal data buffer
     // back to the stack when destroyed.
     template<class TElemType>
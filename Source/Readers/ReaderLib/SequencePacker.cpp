@@ -71,6 +71,9 @@ Minibatch SequencePacker::ReadMinibatch()
         streamMinibatch->m_sampleShape = m_outputStreamDescriptions[streamIndex].m_sampleLayout;
 
         minibatch.m_data.push_back(streamMinibatch);
+
+        if (m_reportPaddingEfficiency && streamIndex == 0)
+            ReportPaddingEfficiency(pMBLayout);
     }
 
     EstablishIdToKey(minibatch, sequences);
@@ -79,6 +82,24 @@ Minibatch SequencePacker::ReadMinibatch()
     return minibatch;
 }
 
+void SequencePacker::ReportPaddingEfficiency(const MBLayoutPtr& layout)
+{
+    size_t actualSamples = layout->GetActualNumSamples();
+    size_t paddedSamples = layout->GetNumCols();
+    if (paddedSamples == 0)
+        return;
+
+    m_totalActualSamples += actualSamples;
+    m_totalPaddedSamples += paddedSamples;
+
+    fprintf(stderr, "SequencePacker: minibatch of %" PRIu64 " samples in %" PRIu64 " parallel sequences x %" PRIu64 " time steps, padding efficiency %.2f%% (%.2f%% so far)\n",
+        actualSamples,
+        layout->GetNumParallelSequences(),
+        layout->GetNumTimeSteps(),
+        100.0 * actualSamples / paddedSamples,
+        100.0 * m_totalActualSamples / m_totalPaddedSamples);
+}
+
 void SequencePacker::SetConfiguration(const ReaderConfiguration& config, const std::vector<MemoryProviderPtr>& memoryProviders)
 {
     PackerBase::SetConfiguration(config, memoryProviders);
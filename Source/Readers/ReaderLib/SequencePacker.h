@@ -19,11 +19,15 @@ public:
         const std::vector<StreamInformation>& streams,
         size_t numberOfBuffers = 2,
         bool useLocalTimeline = false,
-        CorpusDescriptorPtr corpus = nullptr) :
+        CorpusDescriptorPtr corpus = nullptr,
+        bool reportPaddingEfficiency = false) :
         PackerBase(corpus, sequenceEnumerator, streams, numberOfBuffers),
         m_useLocalTimeline(useLocalTimeline),
         m_globalMinibatchSizeInSamples(0),
-        m_localMinibatchSizeInSamples(0)
+        m_localMinibatchSizeInSamples(0),
+        m_reportPaddingEfficiency(reportPaddingEfficiency),
+        m_totalActualSamples(0),
+        m_totalPaddedSamples(0)
     {}
 
     virtual Minibatch ReadMinibatch() override;
@@ -42,6 +46,10 @@ protected:
     // Helper function to check and refresh the sample shape of input samples.
     void RefreshSampleShape(const std::vector<SequenceDataPtr>& minibatch, StreamInformation& outputStream);
 
+    // Prints the fraction of the minibatch layout occupied by actual samples (as opposed to gaps), for this minibatch
+    // and accumulated over all minibatches read so far.
+    void ReportPaddingEfficiency(const MBLayoutPtr& layout);
+
     // A flag indicating whether to use local timeline for data.
     bool m_useLocalTimeline;
 
@@ -51,6 +59,12 @@ protected:
     // A minibatch size for this worker in global samples.
     size_t m_globalMinibatchSizeInSamples;
 
+    // A flag indicating whether to report the padding efficiency of each minibatch.
+    bool m_reportPaddingEfficiency;
+
+    // Number of actual samples and of all (actual and gap) columns in all minibatches read so far.
+    size_t m_totalActualSamples;
+    size_t m_totalPaddedSamples;
 };
 
 typedef std::shared_ptr<SequencePacker> SequencePackerPtr;
@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <utility>
 #include <deque>
+#include <numeric>
 #include "RandomOrdering.h"
 
 namespace CNTK {
@@ -18,7 +19,8 @@ namespace CNTK {
     SequenceRandomizer::SequenceRandomizer(
         int verbosity,
         DataDeserializerPtr deserializer,
-        ChunkRandomizerPtr chunkRandomizer)
+        ChunkRandomizerPtr chunkRandomizer,
+        const std::vector<size_t>& lengthBucketBoundaries)
         : m_verbosity(verbosity),
         m_randomizedChunks(chunkRandomizer->GetRandomizedChunks()),
         m_chunkWindowBegin(0),
@@ -28,8 +30,13 @@ namespace CNTK {
         m_currentSequenceCursor(0),
         m_currentChunkCursor(0),
         m_currentSampleCursor(0),
-        m_deserializer(deserializer)
+        m_deserializer(deserializer),
+        m_lengthBucketBoundaries(lengthBucketBoundaries)
     {
+        if (!std::is_sorted(m_lengthBucketBoundaries.begin(), m_lengthBucketBoundaries.end()))
+            InvalidArgument("SequenceRandomizer: length bucket boundaries must be in ascending order.");
+        m_lengthBuckets.resize(m_lengthBucketBoundaries.size() + 1);
+
         size_t max = 0;
         for (const auto& c : m_randomizedChunks)
         {
@@ -232,6 +239,9 @@ namespace CNTK {
         // Let's recalculate number of samples in the randomized chunks for efficient indexing in seek.
         size_t sampleCount = 0;
         size_t randomizedChunk = m_randomizedWindowEnd - m_chunkWindowBegin;
+        if (!m_lengthBucketBoundaries.empty())
+            GroupSequencesByLength(m_sequenceWindow[randomizedChunk]);
+
         for (size_t index = 0; index < m_sequenceWindow[randomizedChunk].size(); index++)
         {
             sampleCount += m_sequenceWindow[randomizedChunk][index].m_numberOfSamples;
@@ -366,6 +376,31 @@ namespace CNTK {
         m_chunkWindowEnd++;
     }
 
+    // Reorders the sequences of a fully randomized chunk by length buckets.
+    void SequenceRandomizer::GroupSequencesByLength(std::vector<RandomizedSequenceDescription>& sequences)
+    {
+        for (auto& bucket : m_lengthBuckets)
+            bucket.clear();
+
+        for (const auto& sequence : sequences)
+        {
+            size_t bucket = std::upper_bound(m_lengthBucketBoundaries.begin(), m_lengthBucketBoundaries.end(), (size_t)sequence.m_numberOfSamples) - m_lengthBucketBoundaries.begin();
+            m_lengthBuckets[bucket].push_back(sequence);
+        }
+
+        m_lengthBucketOrder.resize(m_lengthBuckets.size());
+        std::iota(m_lengthBucketOrder.begin(), m_lengthBucketOrder.end(), 0);
+        Microsoft::MSR::CNTK::RandomShuffleMT(m_lengthBucketOrder, m_rng);
+
+        size_t position = 0;
+        for (size_t bucket : m_lengthBucketOrder)
+        {
+            std::copy(m_lengthBuckets[bucket].begin(), m_lengthBuckets[bucket].end(), sequences.begin() + position);
+            position += m_lengthBuckets[bucket].size();
+        }
+        assert(position == sequences.size());
+    }
+
     // Gets randomized sequence by the sequence position in the sweep and randomized chunk index.
     RandomizedSequenceDescription& SequenceRandomizer::GetRandomizedSequenceDescriptionByPosition(ChunkIdType chunkIndex, size_t sequenceSweepPosition)
     {
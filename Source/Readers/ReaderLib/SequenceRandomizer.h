@@ -32,10 +32,13 @@ struct RandomizedSequenceDescription
 class SequenceRandomizer
 {
 public:
+    // If lengthBucketBoundaries (ascending sequence lengths in samples) are given, the sequences of each randomized chunk
+    // are grouped into buckets of similar length, see GroupSequencesByLength().
     SequenceRandomizer(
         int verbosity,
         DataDeserializerPtr deserializer,
-        ChunkRandomizerPtr chunkRandomizer);
+        ChunkRandomizerPtr chunkRandomizer,
+        const std::vector<size_t>& lengthBucketBoundaries = std::vector<size_t>());
 
     // Resets the current sweep according to the randomization seed provided.
     void Reset(size_t seed);
@@ -70,6 +73,12 @@ private:
     // Add randomizes sequences for the chunk with a given index.
     void AddRandomizedSequencesForChunk(ChunkIdType chunkIndex);
 
+    // Reorders the sequences of a fully randomized chunk such that sequences of the same length bucket are adjacent,
+    // so that minibatches taken from the chunk need less padding. The buckets are placed in random order, and sequences
+    // keep their randomized order within a bucket. The chunk keeps the same set of sequences, so the randomization
+    // guarantees of the sweep and the sample positions of the chunks (used by Seek()) do not change.
+    void GroupSequencesByLength(std::vector<RandomizedSequenceDescription>& sequences);
+
     // Move the chunk cursor to the next chunk, randomizing more sequences if necessary.
     void MoveChunkCursor();
 
@@ -157,6 +166,13 @@ private:
     int m_verbosity;
 
     std::mt19937_64 m_rng;
+
+    // Upper bounds (exclusive) of the length buckets; empty if sequences are not grouped by length.
+    std::vector<size_t> m_lengthBucketBoundaries;
+
+    // Used only as buffers to group sequences by length without memory reallocation.
+    std::vector<std::vector<RandomizedSequenceDescription>> m_lengthBuckets;
+    std::vector<size_t> m_lengthBucketOrder;
 };
 
 typedef std::shared_ptr<SequenceRandomizer> SequenceRandomizerPtr;
@@ -19,6 +19,20 @@ public:
     // Returns a boolean indicating if any samples were processed
     virtual bool AggregateGradients(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool resetState) = 0;
 
+    // Aggregation overlapped with backprop: if supported, the caller calls BeginOverlappedAggregation() before the backprop
+    // of the minibatch with the gradients later passed to AggregateGradients(), and then GradientFinalized() for each of
+    // them as soon as backprop has finished computing it. AggregateGradients() then only waits for what is in flight.
+    virtual bool SupportsOverlappedAggregation() const
+    {
+        return false;
+    }
+
+    virtual void BeginOverlappedAggregation(const std::vector<Matrix<ElemType>*>& /*gradients*/)
+    {}
+
+    virtual void GradientFinalized(const Matrix<ElemType>* /*gradient*/)
+    {}
+
     size_t NumProc()
     {
         return m_mpi->NumNodesInUse();
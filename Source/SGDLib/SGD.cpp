@@ -507,6 +507,12 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         tensorBoardWriter = make_shared<::CNTK::Internal::TensorBoardFileWriter>(m_tensorBoardLogDir, net);
     }
 
+    // Only the main node writes models and checkpoints.
+    if (m_asyncCheckpointing && ((m_mpi == nullptr) || m_mpi->IsMainNode()))
+    {
+        m_checkpointWriter.reset(new AsyncFileWriter(m_maxPendingCheckpoints));
+    }
+
     // --- MAIN EPOCH LOOP
     for (int i = startEpoch; i < (int) m_maxEpochs; i++) // TODO: why is this an int, and not a size_t?
     {
@@ -781,6 +787,8 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                 {
                     // roll back
                     auto bestModelPath = GetModelNameForEpoch(i - m_learnRateAdjustInterval);
+                    // the model to roll back to may still be written in the background
+                    WaitForPendingCheckpoints();
                     LOGPRINTF(stderr, "Loading (rolling back to) previous model with best training-criterion value: %ls.\n", bestModelPath.c_str());
                     net->RereadPersistableParameters<ElemType>(bestModelPath);
                     LoadCheckPointInfo(i - m_learnRateAdjustInterval,
@@ -868,8 +876,8 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                 {
                     int epochToDelete = i - j;
                     LOGPRINTF(stderr, "SGD: removing model and checkpoint files for epoch %d after rollback to epoch %lu\n", epochToDelete + 1, (unsigned long)(i - m_learnRateAdjustInterval) + 1);  // report 1 based epoch number
-                    _wunlink(GetModelNameForEpoch(epochToDelete).c_str());
-                    _wunlink(GetCheckPointFileNameForEpoch(epochToDelete).c_str());
+                    RemoveFileAfterPendingWrites(GetModelNameForEpoch(epochToDelete));
+                    RemoveFileAfterPendingWrites(GetCheckPointFileNameForEpoch(epochToDelete));
                 }
 
                 // Set i back to the loaded model
@@ -897,7 +905,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                 auto modelName = GetModelNameForEpoch(i);
                 if (m_traceLevel > 0)
                     LOGPRINTF(stderr, "SGD: Saving checkpoint model '%ls'\n", modelName.c_str());
-                net->Save(modelName);
+                SaveModel(net, modelName);
                 if (!m_keepCheckPointFiles)
                 {
                     // delete previous checkpoint file to save space
@@ -905,16 +913,16 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     {
                         if (epochsSinceLastLearnRateAdjust != 1)
                         {
-                            _wunlink(GetCheckPointFileNameForEpoch(i - 1).c_str());
+                            RemoveFileAfterPendingWrites(GetCheckPointFileNameForEpoch(i - 1));
                         }
                         if (epochsSinceLastLearnRateAdjust == m_learnRateAdjustInterval)
                         {
-                            _wunlink(GetCheckPointFileNameForEpoch(i - m_learnRateAdjustInterval).c_str());
+                            RemoveFileAfterPendingWrites(GetCheckPointFileNameForEpoch(i - m_learnRateAdjustInterval));
                         }
                     }
                     else
                     {
-                        _wunlink(GetCheckPointFileNameForEpoch(i - 1).c_str());
+                        RemoveFileAfterPendingWrites(GetCheckPointFileNameForEpoch(i - 1));
                     }
                 }
             }
@@ -936,6 +944,13 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     }
     // --- END OF MAIN EPOCH LOOP
 
+    if (m_checkpointWriter)
+    {
+        m_checkpointWriter->Wait();
+        m_checkpointWriter.reset();
+        m_modelSnapshots.clear();
+    }
+
     // Check if we need to save best model per criterion and this is the main node as well.
     if (m_saveBestModelPerCriterion && ((m_mpi == nullptr) || m_mpi->IsMainNode()))
     {
@@ -1032,7 +1047,42 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         blockSizePerWorker = m_modelAggregationBlockSize / m_mpi->NumNodesInUse();
     }
 
+    // lazily form the list of gradients to exchange
     std::vector<Matrix<ElemType>*> learnParamsGradients;
+    auto formLearnParamsGradients = [&]()
+    {
+        if (learnParamsGradients.size() != 0)
+            return;
+
+        learnParamsGradients.reserve(learnableNodes.size());
+        for (auto nodeIter = learnableNodes.begin(); nodeIter != learnableNodes.end(); nodeIter++)
+        {
+            ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(*nodeIter);
+            if (node->IsParameterUpdateRequired())
+            {
+                Matrix<ElemType>* currParamsGradient = &(node->Gradient()); // TODO: we can use shared_ptrs now
+
+                // Sometimes, in parallel training, the current node may not get any samples to process
+                // In this case, the gradient matrix may not have been sized yet. If so, lets size it.
+                if (currParamsGradient->GetNumCols() == 0)
+                {
+                    Matrix<ElemType>* currParamsValues = &(node->Value());
+                    currParamsGradient->Resize(currParamsValues->GetNumRows(), currParamsValues->GetNumCols());
+                }
+
+                learnParamsGradients.push_back(currParamsGradient);
+            }
+        }
+    };
+
+    // With overlapped aggregation, the all-reduce of a parameter's gradient can start as soon as backprop has finalized it.
+    bool overlapGradientAggregation = useGradientAggregation && m_distGradAgg->SupportsOverlappedAggregation();
+    auto onNodeBackpropDone = [&](const ComputationNodeBasePtr& node)
+    {
+        if (node->IsParameterUpdateRequired() && node->OperationName() == OperationNameOf(LearnableParameter))
+            m_distGradAgg->GradientFinalized(&dynamic_pointer_cast<ComputationNode<ElemType>>(node)->Gradient());
+    };
+
     Profiler profiler(m_numMBsToCUDAProfile);
 
     // resetting this, so profiling is performed for one epoch only
@@ -1254,7 +1304,17 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                 // ===========================================================
 
                 if (learnRatePerSample > 0.01 * m_minLearnRate) // only compute gradient when learning rate is large enough
-                    net->Backprop(criterionNodes[0]);
+                {
+                    // only the last sub-minibatch finalizes the gradients
+                    if (overlapGradientAggregation && ismb + 1 == actualNumSubminibatches)
+                    {
+                        formLearnParamsGradients();
+                        m_distGradAgg->BeginOverlappedAggregation(learnParamsGradients);
+                        net->Backprop(criterionNodes[0], onNodeBackpropDone);
+                    }
+                    else
+                        net->Backprop(criterionNodes[0]);
+                }
 
                 // house-keeping for sub-minibatching
                 if (actualNumSubminibatches > 1)
@@ -1300,29 +1360,7 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
         else
         {
             // distributed gradient aggregation
-            if (learnParamsGradients.size() == 0)
-            {
-                // lazily form the list of smoothedGradients to exchange
-                learnParamsGradients.reserve(learnableNodes.size());
-                for (auto nodeIter = learnableNodes.begin(); nodeIter != learnableNodes.end(); nodeIter++)
-                {
-                    ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(*nodeIter);
-                    if (node->IsParameterUpdateRequired())
-                    {
-                        Matrix<ElemType>* currParamsGradient = &(node->Gradient()); // TODO: we can use shared_ptrs now
-
-                        // Sometimes, in parallel training, the current node may not get any samples to process
-                        // In this case, the gradient matrix may not have been sized yet. If so, lets size it.
-                        if (currParamsGradient->GetNumCols() == 0)
-                        {
-                            Matrix<ElemType>* currParamsValues = &(node->Value());
-                            currParamsGradient->Resize(currParamsValues->GetNumRows(), currParamsValues->GetNumCols());
-                        }
-
-                        learnParamsGradients.push_back(currParamsGradient);
-                    }
-                }
-            }
+            formLearnParamsGradients();
 
             // hoist the criterion into CPU space for all-reduce
             localEpochCriterion.Assign(0, numSamplesWithLabelOfNetwork);
@@ -2291,7 +2329,8 @@ void SGD<ElemType>::InitDistGradAgg(int numEvalNodes, int numGradientBits, int d
         if (Globals::UseV2Aggregator()) // Currently used to check V2 against baselines.
             m_distGradAgg = std::make_shared<V2SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, deviceId, m_syncStatsTrace, ::CNTK::MPICommunicator(m_packThresholdSizeInBytes));
         else
-            m_distGradAgg = std::make_shared<SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, deviceId, m_syncStatsTrace, m_packThresholdSizeInBytes);
+            m_distGradAgg = std::make_shared<SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, deviceId, m_syncStatsTrace, m_packThresholdSizeInBytes, m_bucketSizeInBytes,
+                                                                                     m_hierarchicalAllReduce, m_hierarchicalAllReduceRanksPerGroup);
     }
 
     m_gradHeader.reset(DistGradHeader::Create(numEvalNodes), [](DistGradHeader* ptr) { DistGradHeader::Destroy(ptr); });
@@ -2481,66 +2520,158 @@ void SGD<ElemType>::SaveCheckPointInfo(const size_t epoch, const size_t totalSam
     if ((m_mpi == nullptr) || m_mpi->IsMainNode())
     {
         wstring checkPointFileName = GetCheckPointFileNameForEpoch(int(epoch));
+
+        // The state of model averaging can only be written on the training thread.
+        if (m_checkpointWriter && !m_pMASGDHelper)
+        {
+            // Take a host copy of the smoothed gradients and serialize it in the background.
+            auto snapshot = make_shared<std::list<Matrix<ElemType>>>();
+            for (const auto& smoothedGradientValues : smoothedGradients)
+            {
+                snapshot->emplace_back(CPUDEVICE);
+                snapshot->back().AssignValuesOf(smoothedGradientValues);
+            }
+
+            auto criteriaBestEpoch = m_criteriaBestEpoch;
+            m_checkpointWriter->Write(checkPointFileName, [=](const wstring& tempFileName)
+            {
+                WriteCheckPointInfo(tempFileName, totalSamplesSeen, learnRatePerSample, *snapshot, smoothedCounts, prevCriterion, minibatchSize, criteriaBestEpoch);
+            });
+            return;
+        }
+
         // Saving into temporary file and then renaming it to the checkPointFileName
         // This is a standard trick to avoid havign corrupted checkpoints files if process dies during writing
         wstring tempFileName = checkPointFileName + L".tmp";
+        WriteCheckPointInfo(tempFileName, totalSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, minibatchSize, m_criteriaBestEpoch);
 
-        {
-            File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
-            // Buffer writes in memory then flush to filesystem, which reduces number of small writes
-            fstream.Setvbuf();
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
-            fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
+        _wunlink(checkPointFileName.c_str());
+        renameOrDie(tempFileName, checkPointFileName);
+    }
+}
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
-            fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
+template <class ElemType>
+void SGD<ElemType>::WriteCheckPointInfo(const wstring& fileName, const size_t totalSamplesSeen,
+                                        const double learnRatePerSample,
+                                        const std::list<Matrix<ElemType>>& smoothedGradients,
+                                        const std::vector<double>& smoothedCounts,
+                                        const double prevCriterion,
+                                        const size_t minibatchSize,
+                                        const std::map<std::wstring, BestEpoch>& criteriaBestEpoch)
+{
+    File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
+    // Buffer writes in memory then flush to filesystem, which reduces number of small writes
+    fstream.Setvbuf();
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
+    fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
-            fstream << minibatchSize;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
+    fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
+    fstream << minibatchSize;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
 
-            for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
-            {
-                const Matrix<ElemType>& smoothedGradientValues = *smoothedGradientIter;
-                fstream << smoothedGradientValues;
-            }
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
+    for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+    {
+        const Matrix<ElemType>& smoothedGradientValues = *smoothedGradientIter;
+        fstream << smoothedGradientValues;
+    }
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"BCount");
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
 
-            for (auto sc : smoothedCounts)
-                fstream << sc;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"BCount");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECount");
+    for (auto sc : smoothedCounts)
+        fstream << sc;
 
-            if (m_saveBestModelPerCriterion)
-            {
-                fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCriteria");
-                const int32_t criteriaSize = static_cast<int32_t>(m_criteriaBestEpoch.size());
-                fstream << criteriaSize;
-                for (const auto& criterion : m_criteriaBestEpoch)
-                {
-                    fstream << criterion.second.criterionMinValue << criterion.second.epochIndex;
-                }
-                fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECriteria");
-            }
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECount");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
-            if (m_pMASGDHelper)
-                m_pMASGDHelper->SaveToCheckPoint(fstream);
-            // Ensuring that data is written
-            fstream.Flush();
+    if (m_saveBestModelPerCriterion)
+    {
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCriteria");
+        const int32_t criteriaSize = static_cast<int32_t>(criteriaBestEpoch.size());
+        fstream << criteriaSize;
+        for (const auto& criterion : criteriaBestEpoch)
+        {
+            fstream << criterion.second.criterionMinValue << criterion.second.epochIndex;
         }
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECriteria");
+    }
 
-        _wunlink(checkPointFileName.c_str());
-        renameOrDie(tempFileName, checkPointFileName);
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
+    if (m_pMASGDHelper)
+        m_pMASGDHelper->SaveToCheckPoint(fstream);
+    // Ensuring that data is written
+    fstream.Flush();
+}
+
+template <class ElemType>
+void SGD<ElemType>::SaveModel(const ComputationNetworkPtr& net, const wstring& modelFileName)
+{
+    if (!m_checkpointWriter)
+        return net->Save(modelFileName);
+
+    // Find a snapshot that is not referenced by a pending write.
+    m_checkpointWriter->WaitForAvailableSlot();
+    auto snapshot = find_if(m_modelSnapshots.begin(), m_modelSnapshots.end(), [](const ComputationNetworkPtr& s) { return s.use_count() == 1; });
+    if (snapshot == m_modelSnapshots.end() && m_modelSnapshots.size() >= m_maxPendingCheckpoints)
+    {
+        m_checkpointWriter->Wait();
+        snapshot = m_modelSnapshots.begin();
     }
+
+    // Snapshots of a network that was edited since are dropped.
+    if (snapshot != m_modelSnapshots.end() && !(*snapshot)->CopyLearnableParameterValuesFrom(*net))
+    {
+        m_modelSnapshots.clear();
+        snapshot = m_modelSnapshots.end();
+    }
+
+    if (snapshot == m_modelSnapshots.end())
+    {
+        m_checkpointWriter->Wait();
+        net->Save(modelFileName);
+        m_modelSnapshots.push_back(ComputationNetwork::CreateFromFile<ElemType>(CPUDEVICE, modelFileName));
+        return;
+    }
+
+    auto snapshotNet = *snapshot;
+    m_checkpointWriter->Write(modelFileName, [snapshotNet](const wstring& tempFileName)
+    {
+        snapshotNet->Save(tempFileName);
+    });
+}
+
+template <class ElemType>
+void SGD<ElemType>::RemoveFileAfterPendingWrites(const wstring& fileName)
+{
+    if (!m_checkpointWriter)
+    {
+        _wunlink(fileName.c_str());
+        return;
+    }
+
+    m_checkpointWriter->Enqueue([fileName]()
+    {
+        _wunlink(fileName.c_str());
+    });
+}
+
+template <class ElemType>
+void SGD<ElemType>::WaitForPendingCheckpoints()
+{
+    if (!m_asyncCheckpointing)
+        return;
+
+    if (m_checkpointWriter)
+        m_checkpointWriter->Wait();
+    SynchronizeWorkers();
 }
 
 template <class ElemType>
@@ -2916,6 +3047,7 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_numSubminiBatches = configSGD(L"numSubminibatches", (size_t) 1);
 
     m_packThresholdSizeInBytes = configSGD(L"packThresholdSizeInKB", DEFAULT_PACK_THRESHOLD_SIZE_IN_KB) * 1024;
+    m_bucketSizeInBytes = configSGD(L"bucketSizeInKB", (size_t) 0) * 1024;
 
     if (configAALR.Exists(L"numMiniBatch4LRSearch"))
     {
@@ -3128,6 +3260,8 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_numGradientBits = vector<int>{8 * (int)sizeofElemType}; // means no quantization
     m_zeroThresholdFor1Bit = true;
     m_bufferedAsyncGradientAggregation = false;
+    m_hierarchicalAllReduce = false;
+    m_hierarchicalAllReduceRanksPerGroup = 0;
     m_enableDistributedMBReading = false;
     m_parallelizationStartEpochNum = 0;
     m_modelAggregationBlockSize = 0; 
@@ -3161,6 +3295,8 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
             m_numGradientBits = configDataParallelSGD(L"gradientBits", ConfigRecordType::Array(intargvector(vector<int>{defaultGradientBits})));
             m_zeroThresholdFor1Bit = configDataParallelSGD(L"useZeroThresholdFor1BitQuantization", true);
             m_bufferedAsyncGradientAggregation = configDataParallelSGD(L"useBufferedAsyncGradientAggregation", false);
+            m_hierarchicalAllReduce = configDataParallelSGD(L"hierarchicalAllReduce", false);
+            m_hierarchicalAllReduceRanksPerGroup = configDataParallelSGD(L"hierarchicalAllReduceRanksPerGroup", (size_t)0);
             for (size_t i = 0; i < m_numGradientBits.size(); i++)
             {
                 if (m_numGradientBits[i] < 1 || m_numGradientBits[i] > defaultGradientBits)
@@ -20,6 +20,7 @@
 #include "Profiler.h"
 #include "MASGD.h"
 #include "ASGDHelper.h"
+#include "AsyncFileWriter.h"
 #include <map>
 using namespace std; // ugh! TODO: get rid of this from .h files!!!
 
@@ -217,6 +218,9 @@ protected:
     // Threshold size in bytes for single gradient to do packing
     size_t m_packThresholdSizeInBytes;
 
+    // Size in bytes of the buckets of gradients that are all-reduced while backprop continues (0 = aggregate after backprop)
+    size_t m_bucketSizeInBytes;
+
     LearningRateSearchAlgorithm m_autoLearnRateSearchType;
 
     AdaptationRegType m_adaptationRegType;
@@ -293,6 +297,8 @@ protected:
     intargvector m_numGradientBits;
     bool m_bufferedAsyncGradientAggregation;
     bool m_zeroThresholdFor1Bit;
+    bool m_hierarchicalAllReduce;
+    size_t m_hierarchicalAllReduceRanksPerGroup;
 
     // Parallel training related with MA / BM
     size_t m_modelAggregationBlockSize;
@@ -362,7 +368,9 @@ public:
           m_prevChosenMinibatchSize(0),
           m_lastFinishedEpochTrainLoss(0.0),
           m_distGradAgg(nullptr),
-          m_gradHeader(nullptr)
+          m_gradHeader(nullptr),
+          m_asyncCheckpointing(configSGD(L"asyncCheckpointing", false)),
+          m_maxPendingCheckpoints(configSGD(L"maxPendingCheckpoints", (size_t) 1))
     {
         msra::files::make_intermediate_dirs(m_modelPath);
     }
@@ -554,8 +562,23 @@ protected:
                             /*out*/ double& prevCriterion,
                             /*out*/ size_t& minibatchSize);
 
+    void WriteCheckPointInfo(const wstring& fileName, const size_t totalSamplesSeen,
+                             const double learnRatePerSample,
+                             const std::list<Matrix<ElemType>>& smoothedGradients,
+                             const std::vector<double>& smoothedCounts,
+                             const double prevCriterion,
+                             const size_t minibatchSize,
+                             const std::map<std::wstring, BestEpoch>& criteriaBestEpoch);
+
     wstring GetCheckPointFileNameForEpoch(const int epoch);
 
+    // Saves the model, in the background if asyncCheckpointing is enabled.
+    void SaveModel(const ComputationNetworkPtr& net, const wstring& modelFileName);
+    // Deletes a model or checkpoint file once all files queued for writing before have been written.
+    void RemoveFileAfterPendingWrites(const wstring& fileName);
+    // Waits until the main node has written all pending models and checkpoints. Must be called by all workers.
+    void WaitForPendingCheckpoints();
+
     GradientsUpdateType GradUpdateType() const
     {
         return m_gradType.type;
@@ -596,6 +619,15 @@ protected:
 
     shared_ptr<IMASGD<ElemType>> m_pMASGDHelper;
 
+    // Models and checkpoints are written by a background thread on the main node, while training continues.
+    bool m_asyncCheckpointing;
+    size_t m_maxPendingCheckpoints;
+    // Host copies of the network, one per model that can be in flight. They are refreshed from the trained
+    // network before each save; the first save of a network is synchronous and creates them from its file.
+    std::vector<ComputationNetworkPtr> m_modelSnapshots;
+    // Declared after the members that pending writes use, so that the writes finish before those are destroyed.
+    std::unique_ptr<AsyncFileWriter> m_checkpointWriter;
+
 private:
     void MarkDropoutNodesEvalTimeStampAsOutdated(const ComputationNetworkPtr& net, const ComputationNodeBasePtr& criterionNode);
     std::shared_ptr<ASGDHelper<ElemType>> m_pASGDHelper;
@@ -14,6 +14,7 @@
 #include "GPUDataTransferer.h"
 #include "TimerUtility.h"
 #include "MatrixQuantizerImpl.h"
+#include "PerformanceProfiler.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -23,9 +24,11 @@ class SimpleDistGradAggregator : public IDistGradAggregator<ElemType>
     UsingIDistGradAggregatorMembers;
 
 public:
-    SimpleDistGradAggregator(const MPIWrapperPtr& mpi, bool useAsyncAggregation, int deviceId, int syncStatsTrace, size_t packThresholdSizeInBytes = DEFAULT_PACK_THRESHOLD_SIZE_IN_BYTES)
+    SimpleDistGradAggregator(const MPIWrapperPtr& mpi, bool useAsyncAggregation, int deviceId, int syncStatsTrace, size_t packThresholdSizeInBytes = DEFAULT_PACK_THRESHOLD_SIZE_IN_BYTES,
+                             size_t bucketSizeInBytes = 0, bool useHierarchicalAllReduce = false, size_t hierarchicalAllReduceRanksPerGroup = 0)
         : IDistGradAggregator<ElemType>(mpi), m_useAsyncAggregation(useAsyncAggregation), m_initialized(false), m_bufferedGradHeader(nullptr), m_syncStatsTrace(syncStatsTrace),
-        m_iterationCount(0), m_nccl(deviceId, mpi), m_packThresholdSizeInBytes(packThresholdSizeInBytes)
+        m_iterationCount(0), m_nccl(deviceId, mpi), m_packThresholdSizeInBytes(packThresholdSizeInBytes), m_deviceId(deviceId), m_bucketSizeInBytes(bucketSizeInBytes),
+        m_overlapping(false), m_useHierarchicalAllReduce(useHierarchicalAllReduce), m_hierarchicalAllReduceRanksPerGroup(hierarchicalAllReduceRanksPerGroup)
     {}
 
     ~SimpleDistGradAggregator()
@@ -118,6 +121,11 @@ public:
 
             return false;
         }
+        else if (SupportsOverlappedAggregation())
+        {
+            AggregateGradientsInBuckets(gradients, headerCPU, showSyncPerfStats);
+            return (headerCPU->numSamples != 0);
+        }
         else
         {
             AggregateGradientsImpl(gradients, headerCPU, showSyncPerfStats);
@@ -125,6 +133,56 @@ public:
         }
     }
 
+    // Overlapping with backprop is done for synchronous aggregation on the CPU, where the all-reduce of a bucket is
+    // a non-blocking MPI_Iallreduce. GPU gradients would first need a sync with the compute stream and a copy to the host
+    // (or NCCL on a separate stream) per bucket; they use the regular aggregation after backprop.
+    // The hierarchical all-reduce is blocking, so it cannot overlap either.
+    bool SupportsOverlappedAggregation() const override
+    {
+        return (m_bucketSizeInBytes > 0) && !m_useAsyncAggregation && (m_deviceId == CPUDEVICE) && !m_useHierarchicalAllReduce;
+    }
+
+    void BeginOverlappedAggregation(const std::vector<Matrix<ElemType>*>& gradients) override
+    {
+        if (!SupportsOverlappedAggregation())
+            return;
+
+        InitializeGradientIndex(gradients);
+        if (m_overlapping)
+            LogicError("BeginOverlappedAggregation: Called twice without aggregating the gradients in between.");
+
+        m_overlappedGradients = gradients;
+        m_overlapping = true;
+    }
+
+    void GradientFinalized(const Matrix<ElemType>* gradient) override
+    {
+        if (!m_overlapping)
+            return;
+
+        auto iter = m_gradientIndex.find(gradient);
+        if (iter == m_gradientIndex.end() || m_gradientFinalized[iter->second])
+            return;
+
+        size_t i = iter->second;
+        m_gradientFinalized[i] = true;
+
+        // The first minibatch only records the order in which backprop produces the gradients; the buckets are formed from it.
+        if (m_buckets.empty())
+        {
+            m_backpropOrder.push_back(i);
+            return;
+        }
+
+        auto& bucket = m_buckets[m_bucketOfGradient[i]];
+        bucket.numFinalized++;
+        if (bucket.numFinalized == bucket.gradientIndices.size())
+            StartBucket(bucket, m_overlappedGradients);
+
+        // Give MPI a chance to progress the reductions in flight and record the ones that are done.
+        TestBuckets();
+    }
+
 private:
     std::shared_ptr<ElemType> AllocateIntermediateBuffer(int deviceID, size_t numElements)
     {
@@ -168,7 +226,7 @@ private:
             size_t packedGradientsSizeInElements = 0;
             for (size_t i = 0; i < gradients.size(); i++)
             {
-                if (!m_useAsyncAggregation && sizeof(ElemType) * gradients[i]->GetNumElements() <= m_packThresholdSizeInBytes)
+                if (!m_useAsyncAggregation && !SupportsOverlappedAggregation() && sizeof(ElemType) * gradients[i]->GetNumElements() <= m_packThresholdSizeInBytes)
                 {
                     packedGradientsSizeInElements += gradients[i]->GetNumElements();
                     m_packedGradientsIndex.push_back(i);
@@ -288,23 +346,9 @@ private:
             offset += gradients[i]->GetNumElements();
         }
 
-        // Initiate receive of the header on the main node
         std::vector<MPI_Request> recvHeaderRequests(NumProc() - 1);
-        if (m_mpi->IsMainNode())
-        {
-            for (size_t j = 0; j < NumProc() - 1; ++j)
-            {
-                int source = (j >= MyRank()) ? (j + 1) : j;
-                // We use a tag of 'numGradMatrices' for the pre-aggregation header
-                m_mpi->Irecv(m_recvHeaders[j], m_recvHeaders[j]->Size(), MPI_CHAR, source, numGradMatrices, &(recvHeaderRequests[j])) || MpiFail("MPI_Irecv");
-            }
-        }
-
-        // Send the headers from all nodes but the main node
         MPI_Request sendHeaderRequest;
-        if (!m_mpi->IsMainNode())
-            m_mpi->Isend(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices, &sendHeaderRequest) || MpiFail("MPI_Isend");
-
+        StartHeaderExchange(headerCPU, numGradMatrices, recvHeaderRequests, sendHeaderRequest);
 
         // New aggregation pipeline for non-GDR, perform sync allreduce on the gradient data
         // For CPU, still use async allreduce
@@ -364,7 +408,7 @@ private:
                     
                     // Allreduce
                     reductionBuffer = m_intermediateCPUBuffers[allReduceIndex].get();
-                    m_mpi->AllReduce(reductionBuffer, (currentGradientIndex == -1) ? m_aggregationBuffer->GetNumElements() : gradients[currentGradientIndex]->GetNumElements());
+                    AllReduceOnHost(reductionBuffer, (currentGradientIndex == -1) ? m_aggregationBuffer->GetNumElements() : gradients[currentGradientIndex]->GetNumElements());
 
                     // Create async H-to-G copy
                     cpuToGpuIndex = allReduceIndex;
@@ -384,8 +428,14 @@ private:
                 {
                     allReduceRequests.push_back(MPI_Request());
                     reductionBuffer = (i == -1)? m_aggregationBuffer->Data() : gradients[i]->Data();
+                    // CPU, hierarchical (blocking)
+                    if ((m_mpi->UseGpuGdr() == 0) && m_useHierarchicalAllReduce)
+                    {
+                        allReduceRequests.pop_back();
+                        AllReduceOnHost(reductionBuffer, (i == -1) ? m_aggregationBuffer->GetNumElements() : gradients[i]->GetNumElements());
+                    }
                     // CPU
-                    if (m_mpi->UseGpuGdr() == 0)
+                    else if (m_mpi->UseGpuGdr() == 0)
                     {
                         m_mpi->Iallreduce(MPI_IN_PLACE, reductionBuffer, (i == -1) ? m_aggregationBuffer->GetNumElements() : gradients[i]->GetNumElements(),
                             MPIWrapper::GetDataType(reductionBuffer), MPI_SUM, &allReduceRequests.back()) || MpiFail("MPI_Iallreduce");
@@ -409,7 +459,68 @@ private:
             }
         }
 
-        // On the main node wait for the headers to arrive and aggregate
+        FinishHeaderExchange(headerCPU, recvHeaderRequests);
+
+        if (m_nccl.IsSupported())
+        {
+            m_nccl.Sync();
+        }
+        // Non-GDR && GPU
+        else if ((m_mpi->UseGpuGdr() == 0) && (deviceId != CPUDEVICE))
+        {
+            // Wait for async CPU-to-GPU copy (non-GDR)
+            for (size_t i = 0; i < allReduceIndex; i++)
+                m_gpuDataTransferers[i]->WaitForCopyCPUToGPUAsync();
+        }
+        // CPU
+        else if (m_mpi->UseGpuGdr() == 0)
+        {
+            // Wait for the Iallreduce operations to finish
+            for (size_t i = 0; i < allReduceIndex; i++)
+            {
+                m_mpi->Wait(&allReduceRequests[i], MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+            }
+        }
+
+        // Copy data back to the packed gradients from the continous buffer
+        offset = 0;
+        for (size_t i : m_packedGradientsIndex)
+        {
+            gradients[i]->AssignValuesOf(m_aggregationBuffer->ColumnSlice(offset, gradients[i]->GetNumElements()).Reshaped(gradients[i]->GetNumRows(), gradients[i]->GetNumCols()));
+            offset += gradients[i]->GetNumElements();
+        }
+
+        // Wait for completion of the async send requests
+        if (!m_mpi->IsMainNode())
+            m_mpi->Wait(&sendHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+
+        if (showSyncPerfStats)
+        {
+            aggregationTimer.Stop();
+            double gradientAggregationTime = aggregationTimer.ElapsedSeconds();
+            fprintf(stderr, "Actual gradient aggregation time: %.6g\n", gradientAggregationTime);
+        }
+    }
+
+    // Initiate receive of the headers on the main node and send the headers from all other nodes
+    void StartHeaderExchange(DistGradHeader* headerCPU, size_t numGradMatrices, std::vector<MPI_Request>& recvHeaderRequests, MPI_Request& sendHeaderRequest)
+    {
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int source = (j >= MyRank()) ? (j + 1) : j;
+                // We use a tag of 'numGradMatrices' for the pre-aggregation header
+                m_mpi->Irecv(m_recvHeaders[j], m_recvHeaders[j]->Size(), MPI_CHAR, source, numGradMatrices, &(recvHeaderRequests[j])) || MpiFail("MPI_Irecv");
+            }
+        }
+        else
+            m_mpi->Isend(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices, &sendHeaderRequest) || MpiFail("MPI_Isend");
+    }
+
+    // On the main node wait for the headers to arrive and aggregate, then broadcast the aggregated header to all nodes
+    void FinishHeaderExchange(DistGradHeader* headerCPU, std::vector<MPI_Request>& recvHeaderRequests)
+    {
         if (m_mpi->IsMainNode())
         {
             size_t numNodesHeadersReceivedFrom = 0;
@@ -430,47 +541,215 @@ private:
             assert(numNodesHeadersReceivedFrom == (NumProc() - 1));
         }
 
-        // Broadcast the aggregated header to all nodes
         m_mpi->Bcast(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank());
+    }
 
-        if (m_nccl.IsSupported())
+    // -----------------------------------------------------------------------
+    // aggregation in buckets, overlapped with backprop
+    // -----------------------------------------------------------------------
+
+    // A set of gradients that is all-reduced with one MPI call. Small gradients are packed into 'buffer';
+    // a bucket with a single gradient (e.g. one at least as large as the bucket size) is reduced in place.
+    struct GradientBucket
+    {
+        std::vector<size_t> gradientIndices; // in the order in which backprop finalizes them
+        std::unique_ptr<Matrix<ElemType>> buffer;
+        size_t numFinalized;
+        bool started;
+        bool completed;
+        MPI_Request request;
+        long long profilerState; // from the start of the all-reduce until it was seen completed
+    };
+
+    void InitializeGradientIndex(const std::vector<Matrix<ElemType>*>& gradients)
+    {
+        if (!m_gradientIndex.empty())
         {
-            m_nccl.Sync();
+            if (m_gradientIndex.size() != gradients.size())
+                LogicError("SimpleDistGradAggregator: The set of gradients to aggregate changed.");
+            return;
         }
-        // Non-GDR && GPU
-        else if ((m_mpi->UseGpuGdr() == 0) && (deviceId != CPUDEVICE))
+
+        for (size_t i = 0; i < gradients.size(); i++)
+            m_gradientIndex[gradients[i]] = i;
+        m_gradientFinalized.assign(gradients.size(), false);
+    }
+
+    // Groups the gradients into buckets of up to m_bucketSizeInBytes, in the order recorded during the first backprop.
+    // Gradients that were not seen during backprop (e.g. of parameters that no criterion depends on) go last.
+    void CreateBuckets(const std::vector<Matrix<ElemType>*>& gradients)
+    {
+        std::vector<bool> ordered(gradients.size(), false);
+        for (size_t i : m_backpropOrder)
+            ordered[i] = true;
+        for (size_t i = 0; i < gradients.size(); i++)
         {
-            // Wait for async CPU-to-GPU copy (non-GDR)
-            for (size_t i = 0; i < allReduceIndex; i++)
-                m_gpuDataTransferers[i]->WaitForCopyCPUToGPUAsync();
+            if (!ordered[i])
+                m_backpropOrder.push_back(i);
         }
-        // CPU
-        else if (m_mpi->UseGpuGdr() == 0)
+
+        m_bucketOfGradient.assign(gradients.size(), 0);
+        std::vector<std::vector<size_t>> bucketIndices;
+        size_t currentBucketSizeInBytes = 0;
+        for (size_t i : m_backpropOrder)
         {
-            // Wait for the Iallreduce operations to finish
-            for (size_t i = 0; i < allReduceIndex; i++)
+            size_t sizeInBytes = sizeof(ElemType) * gradients[i]->GetNumElements();
+            if (bucketIndices.empty() || currentBucketSizeInBytes + sizeInBytes > m_bucketSizeInBytes)
             {
-                m_mpi->Wait(&allReduceRequests[i], MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+                bucketIndices.push_back(std::vector<size_t>());
+                currentBucketSizeInBytes = 0;
             }
+
+            bucketIndices.back().push_back(i);
+            currentBucketSizeInBytes += sizeInBytes;
+            m_bucketOfGradient[i] = bucketIndices.size() - 1;
         }
 
-        // Copy data back to the packed gradients from the continous buffer
-        offset = 0;
-        for (size_t i : m_packedGradientsIndex)
+        m_buckets.resize(bucketIndices.size());
+        for (size_t b = 0; b < m_buckets.size(); b++)
         {
-            gradients[i]->AssignValuesOf(m_aggregationBuffer->ColumnSlice(offset, gradients[i]->GetNumElements()).Reshaped(gradients[i]->GetNumRows(), gradients[i]->GetNumCols()));
-            offset += gradients[i]->GetNumElements();
+            auto& bucket = m_buckets[b];
+            bucket.gradientIndices = std::move(bucketIndices[b]);
+            bucket.numFinalized = 0;
+            bucket.started = false;
+            bucket.completed = false;
+            if (bucket.gradientIndices.size() > 1)
+            {
+                size_t numElements = 0;
+                for (size_t i : bucket.gradientIndices)
+                    numElements += gradients[i]->GetNumElements();
+                bucket.buffer.reset(new Matrix<ElemType>(1, numElements, m_deviceId));
+            }
+        }
+
+        if (m_syncStatsTrace > 0)
+            fprintf(stderr, "Gradient aggregation: %d gradients in %d buckets of up to %d KB, overlapped with backprop.\n",
+                    (int)gradients.size(), (int)m_buckets.size(), (int)(m_bucketSizeInBytes / 1024));
+    }
+
+    void StartBucket(GradientBucket& bucket, const std::vector<Matrix<ElemType>*>& gradients)
+    {
+        assert(!bucket.started);
+        bucket.profilerState = ProfilerTimeBegin();
+
+        Matrix<ElemType>* reductionBuffer = gradients[bucket.gradientIndices[0]];
+        if (bucket.buffer)
+        {
+            size_t offset = 0;
+            for (size_t i : bucket.gradientIndices)
+            {
+                bucket.buffer->ColumnSlice(offset, gradients[i]->GetNumElements()).AssignValuesOf(gradients[i]->Reshaped(1, gradients[i]->GetNumElements()));
+                offset += gradients[i]->GetNumElements();
+            }
+            reductionBuffer = bucket.buffer.get();
+        }
+
+        m_mpi->Iallreduce(MPI_IN_PLACE, reductionBuffer->Data(), (int)reductionBuffer->GetNumElements(),
+                          MPIWrapper::GetDataType(reductionBuffer->Data()), MPI_SUM, &bucket.request) || MpiFail("MPI_Iallreduce");
+        bucket.started = true;
+    }
+
+    // Blocking in-place sum of a host buffer over all workers
+    void AllReduceOnHost(ElemType* data, size_t numElements)
+    {
+        if (m_useHierarchicalAllReduce)
+            m_mpi->AllReduceHierarchical(data, numElements, m_hierarchicalAllReduceRanksPerGroup);
+        else
+            m_mpi->AllReduce(data, numElements);
+    }
+
+    void TestBuckets()
+    {
+        for (auto& bucket : m_buckets)
+        {
+            if (!bucket.started || bucket.completed)
+                continue;
+
+            int completed = 0;
+            m_mpi->Test(&bucket.request, &completed, MPI_STATUS_IGNORE) || MpiFail("MPI_Test");
+            if (completed)
+            {
+                bucket.completed = true;
+                ProfilerTimeEnd(bucket.profilerState, profilerEvtMainGradientBucket);
+            }
         }
+    }
+
+    void AggregateGradientsInBuckets(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool showSyncPerfStats)
+    {
+        Timer aggregationTimer;
+        if (showSyncPerfStats)
+            aggregationTimer.Start();
+
+        InitializeGradientIndex(gradients);
+        if (m_buckets.empty())
+            CreateBuckets(gradients);
+
+        if (headerCPU->numSamples == 0)
+        {
+            // If the current node did not process any samples, the gradients should be zero'd.
+            // No backprop was done in that case, hence none of the buckets can have been started.
+            for (auto& bucket : m_buckets)
+            {
+                if (bucket.started)
+                    LogicError("SimpleDistGradAggregator: Gradients were finalized by backprop although no samples were processed.");
+            }
+
+            for (size_t i = 0; i < gradients.size(); ++i)
+                gradients[i]->SetValue(0);
+        }
+
+        std::vector<MPI_Request> recvHeaderRequests(NumProc() - 1);
+        MPI_Request sendHeaderRequest;
+        StartHeaderExchange(headerCPU, gradients.size(), recvHeaderRequests, sendHeaderRequest);
+
+        // Start the buckets backprop did not finalize, e.g. in the first minibatch, or if backprop was skipped
+        for (auto& bucket : m_buckets)
+        {
+            if (!bucket.started)
+                StartBucket(bucket, gradients);
+        }
+
+        FinishHeaderExchange(headerCPU, recvHeaderRequests);
+
+        auto profWait = ProfilerTimeBegin();
+        for (auto& bucket : m_buckets)
+        {
+            if (!bucket.completed)
+            {
+                m_mpi->Wait(&bucket.request, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+                ProfilerTimeEnd(bucket.profilerState, profilerEvtMainGradientBucket);
+            }
+
+            // Copy data back to the packed gradients
+            if (bucket.buffer)
+            {
+                size_t offset = 0;
+                for (size_t i : bucket.gradientIndices)
+                {
+                    gradients[i]->AssignValuesOf(bucket.buffer->ColumnSlice(offset, gradients[i]->GetNumElements()).Reshaped(gradients[i]->GetNumRows(), gradients[i]->GetNumCols()));
+                    offset += gradients[i]->GetNumElements();
+                }
+            }
+
+            bucket.numFinalized = 0;
+            bucket.started = false;
+            bucket.completed = false;
+        }
+        ProfilerTimeEnd(profWait, profilerEvtMainGradientWait);
 
         // Wait for completion of the async send requests
         if (!m_mpi->IsMainNode())
             m_mpi->Wait(&sendHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
 
+        m_gradientFinalized.assign(gradients.size(), false);
+        m_overlapping = false;
+
         if (showSyncPerfStats)
         {
             aggregationTimer.Stop();
             double gradientAggregationTime = aggregationTimer.ElapsedSeconds();
-            fprintf(stderr, "Actual gradient aggregation time: %.6g\n", gradientAggregationTime);
+            fprintf(stderr, "Actual gradient aggregation time (after backprop): %.6g\n", gradientAggregationTime);
         }
     }
 
@@ -507,5 +786,22 @@ private:
     bool m_initialized;
 
     NcclComm m_nccl;
+
+    const int m_deviceId;
+
+    // Aggregation overlapped with backprop, in buckets of gradients of up to m_bucketSizeInBytes (tunable by "bucketSizeInKB=[value]", 0 = off)
+    const size_t m_bucketSizeInBytes;
+    std::vector<GradientBucket> m_buckets;
+    std::unordered_map<const Matrix<ElemType>*, size_t> m_gradientIndex; // gradient -> its index in the list of gradients
+    std::vector<size_t> m_bucketOfGradient;
+    std::vector<size_t> m_backpropOrder;   // gradient indices in the order in which the first backprop finalized them
+    std::vector<bool> m_gradientFinalized; // for the current minibatch
+    std::vector<Matrix<ElemType>*> m_overlappedGradients;
+    bool m_overlapping;                    // between BeginOverlappedAggregation() and AggregateGradients()
+
+    // Reduce within groups of workers on the same host through shared memory and only across hosts with MPI,
+    // see MPIWrapper::AllReduceHierarchical() (tunable by "hierarchicalAllReduce" and "hierarchicalAllReduceRanksPerGroup")
+    const bool m_useHierarchicalAllReduce;
+    const size_t m_hierarchicalAllReduceRanksPerGroup; // 0 = all workers of a host
 };
 } } }
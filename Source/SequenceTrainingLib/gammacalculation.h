@@ -8,6 +8,7 @@
 #include "Matrix.h"
 #include "CUDAPageLockedMemAllocator.h"
 
+#include <exception>
 #include <memory>
 #include <vector>
 
@@ -100,7 +101,6 @@ public:
     {
         // check total frame number to be added ?
         // int deviceid = loglikelihood.GetDeviceId();
-        size_t boundaryframenum;
         std::vector<size_t> validframes; // [s] cursor pointing to next utterance begin within a single parallel sequence [s]
         validframes.assign(samplesInRecurrentStep, 0);
         ElemType objectValue = 0.0;
@@ -126,18 +126,25 @@ public:
             assert(T == pMBLayout->GetNumTimeSteps());
         }
 
-        size_t mapi = 0; // parallel-sequence index for utterance [i]
         // cal gamma for each utterance
+        // On the GPU, the lattice state holds the LLs of one utterance at a time, so utterances are processed one by one.
+        // On the CPU, the utterances are independent of each other and their forward-backward runs concurrently.
+        const bool concurrentutterances = (m_deviceid == CPUDEVICE);
+        std::vector<utterancestate> utterances(lattices.size());
         size_t ts = 0;
         for (size_t i = 0; i < lattices.size(); i++)
         {
-            const size_t numframes = lattices[i]->getnumframes();
+            auto& utt = utterances[i];
+            utt.ts = ts;
+            utt.numframes = lattices[i]->getnumframes();
+            const size_t numframes = utt.numframes;
 
-            msra::dbn::matrixstripe predstripe(pred, ts, numframes);           // logLLs for this utterance
-            msra::dbn::matrixstripe dengammasstripe(dengammas, ts, numframes); // denominator gammas
+            msra::dbn::matrixstripe predstripe(pred, ts, numframes); // logLLs for this utterance
 
             if (samplesInRecurrentStep == 1) // no sequence parallelism
             {
+                utt.mapi = 0;
+                utt.mapt = ts;
                 tempmatrix = loglikelihood.ColumnSlice(ts, numframes);
                 // if (m_deviceid == CPUDEVICE)
                 {
@@ -150,7 +157,9 @@ public:
             else // multiple parallel sequences
             {
                 // get number of frames for the utterance
-                mapi = extrauttmap[i]; // parallel-sequence index; in case of >1 utterance within this parallel sequence, this is in order of concatenation
+                const size_t mapi = extrauttmap[i]; // parallel-sequence index; in case of >1 utterance within this parallel sequence, this is in order of concatenation
+                utt.mapi = mapi;
+                utt.mapt = validframes[mapi];
 
                 // scan MBLayout for end of utterance
                 size_t mapframenum = SIZE_MAX; // duration of utterance [i] as determined from MBLayout
@@ -184,73 +193,128 @@ public:
                 {
                     parallellattice.setloglls(tempmatrix);
                 }
-            }
 
-            array_ref<size_t> uidsstripe(&uids[ts], numframes);
+                validframes[mapi] += numframes; // advance the cursor within the parallel sequence
+            }
 
-            if (doreferencealign)
+            if (!concurrentutterances)
             {
-                boundaryframenum = numframes;
+                forwardbackwardutterance(*lattices[i], utt, uids, boundaries, doreferencealign);
+                storeutterancegammas(utt, gammafromlattice, labels, tempmatrix, uids, numrows, samplesInRecurrentStep, doreferencealign);
             }
-            else
-                boundaryframenum = 0;
-            array_ref<size_t> boundariesstripe(&boundaries[ts], boundaryframenum);
+            ts += numframes;
+        }
 
-            double numavlogp = 0;
-            foreach_column (t, dengammasstripe) // we do not allocate memory for numgamma now, should be the same as numgammasstripe
+        if (concurrentutterances)
+        {
+            std::exception_ptr firsterror;
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < (int) lattices.size(); i++)
             {
-                const size_t s = uidsstripe[t];
-                numavlogp += predstripe(s, t) / amf;
+                try
+                {
+                    forwardbackwardutterance(*lattices[i], utterances[i], uids, boundaries, doreferencealign);
+                }
+                catch (...)
+                {
+#pragma omp critical
+                    if (!firsterror)
+                        firsterror = std::current_exception();
+                }
             }
-            numavlogp /= numframes;
+            if (firsterror)
+                std::rethrow_exception(firsterror);
 
-            // auto_timer dengammatimer;
-            double denavlogp = lattices[i]->second.forwardbackward(parallellattice,
-                                                                   (const msra::math::ssematrixbase&) predstripe, (const msra::asr::simplesenonehmm&) m_hset,
-                                                                   (msra::math::ssematrixbase&) dengammasstripe, (msra::math::ssematrixbase&) gammasbuffer /*empty, not used*/,
-                                                                   lmf, wp, amf, boostmmifactor, seqsMBRmode, uidsstripe, boundariesstripe);
-            objectValue += (ElemType)((numavlogp - denavlogp) * numframes);
+            for (const auto& utt : utterances)
+                storeutterancegammas(utt, gammafromlattice, labels, tempmatrix, uids, numrows, samplesInRecurrentStep, doreferencealign);
+        }
 
-            if (samplesInRecurrentStep == 1)
-            {
-                tempmatrix = gammafromlattice.ColumnSlice(ts, numframes);
-            }
+        for (const auto& utt : utterances)
+            objectValue += (ElemType)((utt.numavlogp - utt.denavlogp) * utt.numframes);
+        functionValues.SetValue(objectValue);
+    }
 
-            // copy gamma to tempmatrix
-            if (m_deviceid == CPUDEVICE)
-            {
-                CopyFromSSEMatrixToCNTKMatrix(dengammas, numrows, numframes, tempmatrix, gammafromlattice.GetDeviceId());
-            }
-            else
-                parallellattice.getgamma(tempmatrix);
 
-            // set gamma for multi channel
-            if (samplesInRecurrentStep > 1)
-            {
-                Microsoft::MSR::CNTK::Matrix<ElemType> gammaFromLatticeForCurrentParallelUtterance = gammafromlattice.ColumnSlice(mapi + (validframes[mapi] * samplesInRecurrentStep), ((numframes - 1) * samplesInRecurrentStep) + 1);
-                gammaFromLatticeForCurrentParallelUtterance.CopyColumnsStrided(tempmatrix, numframes, 1, samplesInRecurrentStep);
-            }
+private:
+    // location and results of one utterance of the minibatch in calgammaformb()
+    struct utterancestate
+    {
+        size_t ts;        // first column of the utterance in pred and dengammas
+        size_t numframes;
+        size_t mapi;      // parallel-sequence index
+        size_t mapt;      // first time step of the utterance within its parallel sequence
+        double numavlogp; // av. numerator log LL
+        double denavlogp; // av. denominator (lattice) score
+    };
+
+    // runs the lattice forward-backward of one utterance whose LLs are in pred; writes its gammas into dengammas
+    // Touches only the columns of this utterance, so different utterances may be processed concurrently on the CPU.
+    void forwardbackwardutterance(const msra::dbn::latticepair& lattice, utterancestate& utt,
+                                  std::vector<size_t>& uids, std::vector<size_t>& boundaries, bool doreferencealign)
+    {
+        const size_t numframes = utt.numframes;
+        msra::dbn::matrixstripe predstripe(pred, utt.ts, numframes);           // logLLs for this utterance
+        msra::dbn::matrixstripe dengammasstripe(dengammas, utt.ts, numframes); // denominator gammas
+
+        array_ref<size_t> uidsstripe(&uids[utt.ts], numframes);
+        array_ref<size_t> boundariesstripe(&boundaries[utt.ts], doreferencealign ? numframes : 0);
+
+        double numavlogp = 0;
+        foreach_column (t, dengammasstripe) // we do not allocate memory for numgamma now, should be the same as numgammasstripe
+        {
+            const size_t s = uidsstripe[t];
+            numavlogp += predstripe(s, t) / amf;
+        }
+        utt.numavlogp = numavlogp / numframes;
+
+        // auto_timer dengammatimer;
+        utt.denavlogp = lattice.second.forwardbackward(parallellattice,
+                                                       (const msra::math::ssematrixbase&) predstripe, (const msra::asr::simplesenonehmm&) m_hset,
+                                                       (msra::math::ssematrixbase&) dengammasstripe, (msra::math::ssematrixbase&) gammasbuffer /*empty, not used*/,
+                                                       lmf, wp, amf, boostmmifactor, seqsMBRmode, uidsstripe, boundariesstripe);
+    }
 
-            if (doreferencealign)
+    // copies the gammas (and reference alignment) of one utterance into the minibatch matrices
+    void storeutterancegammas(const utterancestate& utt,
+                              Microsoft::MSR::CNTK::Matrix<ElemType>& gammafromlattice, Microsoft::MSR::CNTK::Matrix<ElemType>& labels,
+                              Microsoft::MSR::CNTK::Matrix<ElemType>& tempmatrix, const std::vector<size_t>& uids,
+                              size_t numrows, size_t samplesInRecurrentStep, bool doreferencealign)
+    {
+        const size_t numframes = utt.numframes;
+
+        if (samplesInRecurrentStep == 1)
+        {
+            tempmatrix = gammafromlattice.ColumnSlice(utt.ts, numframes);
+        }
+
+        // copy gamma to tempmatrix
+        if (m_deviceid == CPUDEVICE)
+        {
+            msra::dbn::matrixstripe dengammasstripe(dengammas, utt.ts, numframes);
+            CopyFromSSEMatrixToCNTKMatrix(dengammasstripe, numrows, numframes, tempmatrix, gammafromlattice.GetDeviceId());
+        }
+        else
+            parallellattice.getgamma(tempmatrix);
+
+        // set gamma for multi channel
+        if (samplesInRecurrentStep > 1)
+        {
+            Microsoft::MSR::CNTK::Matrix<ElemType> gammaFromLatticeForCurrentParallelUtterance = gammafromlattice.ColumnSlice(utt.mapi + (utt.mapt * samplesInRecurrentStep), ((numframes - 1) * samplesInRecurrentStep) + 1);
+            gammaFromLatticeForCurrentParallelUtterance.CopyColumnsStrided(tempmatrix, numframes, 1, samplesInRecurrentStep);
+        }
+
+        if (doreferencealign)
+        {
+            for (size_t nframe = 0; nframe < numframes; nframe++)
             {
-                for (size_t nframe = 0; nframe < numframes; nframe++)
-                {
-                    size_t uid = uidsstripe[nframe];
-                    if (samplesInRecurrentStep > 1)
-                        labels(uid, (nframe + validframes[mapi]) * samplesInRecurrentStep + mapi) = 1.0;
-                    else
-                        labels(uid, ts + nframe) = 1.0;
-                }
+                size_t uid = uids[utt.ts + nframe];
+                labels(uid, (nframe + utt.mapt) * samplesInRecurrentStep + utt.mapi) = 1.0;
             }
-            if (samplesInRecurrentStep > 1)
-                validframes[mapi] += numframes; // advance the cursor within the parallel sequence
-            fprintf(stderr, "dengamma value %f\n", denavlogp);
-            ts += numframes;
         }
-        functionValues.SetValue(objectValue);
+        fprintf(stderr, "dengamma value %f\n", utt.denavlogp);
     }
 
-
+public:
     // Calculate CTC score
     // totalScore (output): total CTC score at element (0,0)
     // prob (input): the posterior output from the network (log softmax of right)
@@ -15,6 +15,7 @@
 #include <unordered_map>
 #include <list>
 #include <stdexcept>
+#include <exception>
 
 using namespace std;
 
@@ -952,7 +953,8 @@ void lattice::forwardbackwardalign(parallelstate &parallelstate,
             parallelstate.getedgeacscores(edgeacscoresgpu);
             parallelstate.copyalignments(thisedgealignmentsgpu);
         }
-        foreach_index (j, edges)
+        // the edges are aligned independently of each other, each into its own abcs[j] and thisedgealignments[j]
+        auto alignedgej = [&](size_t j)
         {
             const edgeinfowithscores &e = edges[j];
             const size_t ts = nodes[e.S].t;
@@ -970,8 +972,36 @@ void lattice::forwardbackwardalign(parallelstate &parallelstate,
                 else
                     edgeacscores[j] = alignedge(aligntokens, hset, edgeLLs, *abcs[j], j, returnsenoneids, thisedgealignments[j]);
             }
-            if (cpuverification)
+        };
+
+        if (!cpuverification) // distribute the edges over the CPU cores (serial if already inside a parallel region over utterances)
+        {
+            std::exception_ptr firsterror;
+#pragma omp parallel for schedule(dynamic, 16)
+            for (int j = 0; j < (int) edges.size(); j++)
+            {
+                try
+                {
+                    alignedgej(j);
+                }
+                catch (...)
+                {
+#pragma omp critical
+                    if (!firsterror)
+                        firsterror = std::current_exception();
+                }
+            }
+            if (firsterror)
+                std::rethrow_exception(firsterror);
+        }
+        else // verification: align serially and compare each edge against the GPU result
+        {
+            foreach_index (j, edges)
             {
+                alignedgej(j);
+                const edgeinfowithscores &e = edges[j];
+                const size_t ts = nodes[e.S].t;
+                const size_t te = nodes[e.E].t;
                 const auto &aligntokens = getaligninfo(j); // get alignment tokens
                 bool edgehassil = false;
                 foreach_index (i, aligntokens)
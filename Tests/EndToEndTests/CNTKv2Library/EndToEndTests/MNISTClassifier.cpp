@@ -133,6 +133,78 @@ void TrainMNISTClassifier(const DeviceDescriptor& device)
     }
 }
 
+// Trains the MNIST classifier data-parallel, with each worker reading its partition of the data, and the gradients
+// aggregated by 'communicator'. Returns the average training loss over the last minibatches.
+double TrainDistributedMNISTClassifier(const DeviceDescriptor& device, const std::wstring& name, const DistributedCommunicatorPtr& communicator)
+{
+    printf("Training MNIST classifier with %ls aggregation.\n", name.c_str());
+
+    const size_t inputDim = 784;
+    const size_t numOutputClasses = 10;
+    const size_t hiddenLayerDim = 200;
+
+    auto input = InputVariable({ inputDim }, DataType::Float, L"features");
+    auto scaledInput = ElementTimes(Constant::Scalar(0.00390625f, device), input);
+    auto classifierOutput = FullyConnectedDNNLayer(scaledInput, hiddenLayerDim, device, std::bind(Sigmoid, _1, L""));
+    auto outputTimesParam = Parameter(NDArrayView::RandomUniform<float>({ numOutputClasses, hiddenLayerDim }, -0.05, 0.05, 1, device));
+    auto outputBiasParam = Parameter(NDArrayView::RandomUniform<float>({ numOutputClasses }, -0.05, 0.05, 1, device));
+    classifierOutput = Plus(outputBiasParam, Times(outputTimesParam, classifierOutput), L"classifierOutput");
+
+    auto labels = InputVariable({ numOutputClasses }, DataType::Float, L"labels");
+    auto trainingLoss = CNTK::CrossEntropyWithSoftmax(classifierOutput, labels, L"lossFunction");
+    auto prediction = CNTK::ClassificationError(classifierOutput, labels, L"classificationError");
+
+    const size_t minibatchSize = 128; // over all workers
+    const size_t numSamplesPerSweep = 60000;
+    const size_t numMinibatchesToTrain = numSamplesPerSweep / minibatchSize;
+    const size_t numMinibatchesToAverage = 100;
+
+    auto featureStreamName = L"features";
+    auto labelsStreamName = L"labels";
+    auto minibatchSource = TextFormatMinibatchSource(L"Train-28x28_cntk_text.txt", { { featureStreamName, inputDim }, { labelsStreamName, numOutputClasses } });
+    auto featureStreamInfo = minibatchSource->StreamInfo(featureStreamName);
+    auto labelStreamInfo = minibatchSource->StreamInfo(labelsStreamName);
+
+    LearningRateSchedule learningRatePerSample = TrainingParameterPerSampleSchedule(0.003125);
+    auto learner = CreateDataParallelDistributedLearner(communicator, SGDLearner(classifierOutput->Parameters(), learningRatePerSample), 0);
+    auto trainer = CreateTrainer(classifierOutput, trainingLoss, prediction, { learner });
+
+    size_t numWorkers = communicator->Workers().size();
+    size_t workerRank = communicator->CurrentWorker().m_globalRank;
+    size_t outputFrequencyInMinibatches = 50;
+    double lossSum = 0;
+    for (size_t i = 0; i < numMinibatchesToTrain; ++i)
+    {
+        auto minibatchData = minibatchSource->GetNextMinibatch(0, minibatchSize, numWorkers, workerRank, device);
+        trainer->TrainMinibatch({ { input, minibatchData[featureStreamInfo] }, { labels, minibatchData[labelStreamInfo] } }, device);
+        PrintTrainingProgress(trainer, i, outputFrequencyInMinibatches);
+
+        // the loss is aggregated over all workers
+        if (i >= numMinibatchesToTrain - numMinibatchesToAverage)
+            lossSum += trainer->PreviousMinibatchLossAverage();
+    }
+
+    return lossSum / numMinibatchesToAverage;
+}
+
+// Convergence regression test of top-k gradient sparsification: with 1% of the gradient entries exchanged per minibatch,
+// the training loss after one sweep has to stay close to the one of dense aggregation.
+void MNISTClassifierSparsifiedDistributionTests()
+{
+    auto device = ShouldRunOnGpu() ? DeviceDescriptor::GPUDevice(0) : DeviceDescriptor::CPUDevice();
+    auto sync = MPICommunicator();
+
+    sync->Barrier();
+    double denseLoss = TrainDistributedMNISTClassifier(device, L"dense", MPICommunicator());
+    sync->Barrier();
+    double sparsifiedLoss = TrainDistributedMNISTClassifier(device, L"sparsified", SparsifiedMPICommunicator(0.01));
+    sync->Barrier();
+
+    printf("Average training loss of the last minibatches: dense %.4f, sparsified %.4f\n", denseLoss, sparsifiedLoss);
+    if (sparsifiedLoss > 1.2 * denseLoss)
+        ReportFailure("Training with sparsified gradients does not converge: average loss %g, expected at most %g.", sparsifiedLoss, 1.2 * denseLoss);
+}
+
 void MNISTClassifierTests()
 {
     fprintf(stderr, "\nMNISTClassifierTests..\n");
@@ -292,6 +292,60 @@ BOOST_AUTO_TEST_CASE(EvalSparseTimesTest)
     eval->Destroy();
 }
 
+BOOST_AUTO_TEST_CASE(EvalBatchedTimesTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(4) \n"
+        "o1 = Times(Constant(2, rows=1, cols=4), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    IEvaluateModelBatched<float>* eval;
+    GetEvalBatchedF(&eval);
+    eval->Init("numWorkers=2 maxBatchSize=4 maxBatchLatencyMs=20");
+    eval->CreateNetwork(modelDefinition);
+    eval->StartForwardEvaluation({ eval->GetOutputSchema()[0].m_name });
+    BOOST_REQUIRE_EQUAL(eval->GetInputSchema().size(), 1);
+
+    // Sequences of different lengths are coalesced into minibatches; each request gets back its own sequence.
+    const size_t numRequests = 10;
+    std::vector<std::future<Values<float>>> results;
+    for (size_t r = 0; r < numRequests; r++)
+    {
+        Values<float> inputs(1);
+        for (size_t i = 0; i < 4 * (r % 4 + 1); i++)
+            inputs[0].m_buffer.push_back((float)(r + i));
+        results.push_back(eval->ForwardPassAsync(std::move(inputs)));
+    }
+
+    // An invalid request fails without affecting the others.
+    Values<float> invalidInputs(1);
+    invalidInputs[0].m_buffer = { 1, 2, 3 };
+    auto invalidResult = eval->ForwardPassAsync(std::move(invalidInputs));
+
+    for (size_t r = 0; r < numRequests; r++)
+    {
+        Values<float> outputs = results[r].get();
+        BOOST_REQUIRE_EQUAL(outputs.size(), 1);
+
+        std::vector<float> expected;
+        for (size_t t = 0; t < r % 4 + 1; t++)
+        {
+            float base = (float)(r + 4 * t);
+            expected.push_back(2 * (4 * base + 6));
+        }
+        BOOST_CHECK_EQUAL_COLLECTIONS(outputs[0].m_buffer.begin(), outputs[0].m_buffer.end(), expected.begin(), expected.end());
+    }
+    BOOST_REQUIRE_THROW(invalidResult.get(), std::exception);
+
+    eval->Destroy();
+}
+
 BOOST_AUTO_TEST_CASE(EvalRNNTest)
 {
     std::string modelDefinition =
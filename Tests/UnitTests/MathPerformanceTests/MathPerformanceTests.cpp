@@ -11,6 +11,7 @@
 #include "CPUMatrix.h"
 #include "TensorView.h"
 #include "Sequences.h"
+#include "ConvolutionEngine.h"
 #include <chrono>
 #include <iostream>
 #include <vector>
@@ -279,6 +280,161 @@ struct TensorTest
     }
 };
 
+// CPU tensor op bandwidth for common broadcast and reduction shapes
+//  - reports the effective memory bandwidth in GB/s (bytes of all operands touched once, divided by time)
+//  - run with different OMP_NUM_THREADS settings to measure multi-threaded scaling
+template <class ElemType>
+struct TensorOpBandwidthTest
+{
+    static TensorView<ElemType> CreateTensor(TensorShape shape)
+    {
+        let numElements = shape.GetNumElements();
+        vector<ElemType> init(numElements);
+        mt19937 rng(1);
+        uniform_real_distribution<float> nd(-1, 1);
+        generate(begin(init), end(init), [&] { return nd(rng); });
+        let sob = make_shared<Matrix<ElemType>>(numElements/*rows*/, 1/*cols*/, init.data(), CPUDEVICE);
+        return TensorView<ElemType>(sob, shape);
+    }
+
+    // time 'fn' and print the bandwidth, given the number of elements of all operands
+    template<typename FN>
+    static void Measure(const char* what, size_t numElementsTouched, const FN& fn)
+    {
+        const int repetitions = 20;
+        fn(); // warm up
+        auto t_start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < repetitions; i++)
+            fn();
+        auto t_end = chrono::high_resolution_clock::now();
+        double seconds = chrono::duration<double>(t_end - t_start).count() / repetitions;
+        double gbs = numElementsTouched * sizeof(ElemType) / seconds / 1e9;
+        cout << "  " << what << ": " << seconds * 1000 << " ms, " << gbs << " GB/s" << endl;
+    }
+
+    // c = a + b, with b broadcast
+    static void Broadcasting(const char* what, TensorShape layerShape, TensorShape biasShape)
+    {
+        auto input  = CreateTensor(layerShape);
+        auto bias   = CreateTensor(biasShape);
+        auto result = CreateTensor(layerShape);
+        Measure(what, 2 * layerShape.GetNumElements() + biasShape.GetNumElements(), [&] { result.AssignSumOf(input, bias); });
+    }
+
+    // c += reduce(a), e.g. a bias gradient
+    static void Reduction(const char* what, TensorShape layerShape, TensorShape biasShape)
+    {
+        auto gradient = CreateTensor(layerShape);
+        auto bias     = CreateTensor(biasShape);
+        Measure(what, layerShape.GetNumElements() + 2 * biasShape.GetNumElements(), [&] { bias.DoCopyOf(1, gradient, 1); });
+    }
+
+    // c = sigmoid(a)
+    static void Elementwise(const char* what, TensorShape layerShape)
+    {
+        auto input  = CreateTensor(layerShape);
+        auto result = CreateTensor(layerShape);
+        Measure(what, 2 * layerShape.GetNumElements(), [&] { result.AssignSigmoidOf(input); });
+    }
+
+    // main entry point (misusing the constructor)
+    /*void*/ TensorOpBandwidthTest()
+    {
+        cout << "===== CPU tensor op bandwidth (" << CPUMatrix<ElemType>::GetMaxNumThreads() << " threads)" << endl;
+        Elementwise ("elementwise sigmoid [2048 x 1024]",                     TensorShape(2048, 1024));
+        Broadcasting("elementwise addition [2048 x 1024]",                    TensorShape(2048, 1024), TensorShape(2048, 1024));
+        Broadcasting("bias addition FF-DNN [2048 x 1024] + [2048]",           TensorShape(2048, 1024), TensorShape(2048));
+        Broadcasting("bias addition conv [28 x 28 x 128 x 32] + [1 x 1 x 128]", TensorShape(28, 28, 128, 32), TensorShape(1, 1, 128));
+        Broadcasting("row broadcast [2048 x 1024] + [1 x 1024]",              TensorShape(2048, 1024), TensorShape(1, 1024));
+        Reduction   ("bias gradient FF-DNN [2048 x 1024] -> [2048]",          TensorShape(2048, 1024), TensorShape(2048));
+        Reduction   ("bias gradient conv [28 x 28 x 128 x 32] -> [1 x 1 x 128]", TensorShape(28, 28, 128, 32), TensorShape(1, 1, 128));
+        Reduction   ("full reduction [2048 x 1024] -> [1]",                   TensorShape(2048, 1024), TensorShape(1));
+    }
+};
+
+// compare QuantizedMultiplier (int16, weights pre-packed) against float GEMM for typical acoustic-model layer sizes
+template <class ElemType>
+void QuantizedMultiplyTest(int m, int n, int k)
+{
+    CPUMatrix<ElemType> A(m, k), B(k, n), C(m, n);
+    randomInitializeCPUMatrix<ElemType>(A, -1, 2);
+    randomInitializeCPUMatrix<ElemType>(B, -1, 2);
+    shared_ptr<QuantizerBase<ElemType, short>> quantA(new SymmetricQuantizer<ElemType, short>(1));
+    shared_ptr<QuantizerBase<ElemType, short>> quantB(new SymmetricQuantizer<ElemType, short>(2));
+    auto mult = make_shared<QuantizedMultiplier<ElemType>>(quantA, true, quantB, false);
+
+    const int repetitions = 20;
+    double seconds[2];
+    for (int quantized = 0; quantized < 2; quantized++)
+    {
+        auto fn = [&] { CPUMatrix<ElemType>::MultiplyAndWeightedAdd(1, A, false, B, false, 0, C, quantized ? mult : nullptr); };
+        fn(); // warm up (and pack A)
+        auto t_start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < repetitions; i++)
+            fn();
+        auto t_end = chrono::high_resolution_clock::now();
+        seconds[quantized] = chrono::duration<double>(t_end - t_start).count() / repetitions;
+    }
+    cout << "  [" << m << " x " << k << "] * [" << k << " x " << n << "]: float " << seconds[0] * 1000 << " ms, int16 " << seconds[1] * 1000
+         << " ms, speed-up " << seconds[0] / seconds[1] << endl;
+}
+
+// compare the CPU convolution engines on a batch of images; the reference engine is only timed once, as it is very slow
+template <class ElemType>
+void ConvolutionEngineTest(const char* name, ConvolveGeometryPtr g, size_t batchSize)
+{
+    Matrix<ElemType> in(g->InputShape().GetNumElements(), batchSize, CPUDEVICE);
+    Matrix<ElemType> kernel(g->KernelCount(), g->KernelShape().GetNumElements(), CPUDEVICE);
+    Matrix<ElemType> out(g->OutputShape().GetNumElements(), batchSize, CPUDEVICE);
+    Matrix<ElemType> workspace(CPUDEVICE);
+    in.SetUniformRandomValue(-1, 1, 1);
+    kernel.SetUniformRandomValue(-1, 1, 2);
+
+    cout << "  " << name << ":";
+    for (auto kind : { ConvolutionEngineKind::Reference, ConvolutionEngineKind::Gemm, ConvolutionEngineKind::Direct })
+    {
+        const char* kindName = kind == ConvolutionEngineKind::Reference ? "reference" : kind == ConvolutionEngineKind::Gemm ? "GEMM" : "direct";
+        if (kind == ConvolutionEngineKind::Gemm && g->KernelShape()[2] != g->InputShape()[2])
+        {
+            cout << (kind == ConvolutionEngineKind::Reference ? " " : ", ") << kindName << " n/a";
+            continue;
+        }
+        auto engine = ConvolutionEngine<ElemType>::Create(g, CPUDEVICE, ImageLayoutKind::CHW, 0, PoolKind::None, kind);
+        const int repetitions = kind == ConvolutionEngineKind::Reference ? 1 : 10;
+        engine->Forward(in, kernel, out, workspace); // warm up
+        auto t_start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < repetitions; i++)
+            engine->Forward(in, kernel, out, workspace);
+        auto t_end = chrono::high_resolution_clock::now();
+        cout << (kind == ConvolutionEngineKind::Reference ? " " : ", ") << kindName << " " << chrono::duration<double>(t_end - t_start).count() / repetitions * 1000 << " ms";
+    }
+    cout << endl;
+}
+
+// the 3x3 and 1x1 convolutions of ResNet-50 and a depthwise 3x3 convolution (MobileNet)
+template <class ElemType>
+void ConvolutionEnginesTest(size_t batchSize)
+{
+    auto conv = [](size_t w, size_t c, size_t k, size_t kernelSize, size_t stride)
+    {
+        return make_shared<ConvolveGeometry>(TensorShape(w, w, c), TensorShape(kernelSize, kernelSize, c), TensorShape(k), TensorShape(stride, stride, c),
+                                             ConvolveGeometry::BoolVec{true}, ConvolveGeometry::BoolVec{true, true, false}, TensorShape(0), TensorShape(0));
+    };
+    cout << "===== CPU convolution engines, forward, batch of " << batchSize << endl;
+    ConvolutionEngineTest<ElemType>("3x3 [56 x 56 x 64] -> 64",   conv(56, 64, 64, 3, 1), batchSize);
+    ConvolutionEngineTest<ElemType>("3x3 [28 x 28 x 128] -> 128", conv(28, 128, 128, 3, 1), batchSize);
+    ConvolutionEngineTest<ElemType>("3x3 [14 x 14 x 256] -> 256", conv(14, 256, 256, 3, 1), batchSize);
+    ConvolutionEngineTest<ElemType>("3x3 [7 x 7 x 512] -> 512",   conv(7, 512, 512, 3, 1), batchSize);
+    ConvolutionEngineTest<ElemType>("1x1 [56 x 56 x 64] -> 256",  conv(56, 64, 256, 1, 1), batchSize);
+    ConvolutionEngineTest<ElemType>("1x1 [14 x 14 x 1024] -> 256", conv(14, 1024, 256, 1, 1), batchSize);
+    ConvolutionEngineTest<ElemType>("1x1/2 [56 x 56 x 256] -> 512", conv(56, 256, 512, 1, 2), batchSize);
+    ConvolutionEngineTest<ElemType>("depthwise 3x3 [56 x 56 x 128]",
+                                    make_shared<ConvolveGeometry>(TensorShape(56, 56, 128), TensorShape(3, 3, 1), TensorShape(1), TensorShape(1, 1, 1),
+                                                                  ConvolveGeometry::BoolVec{true, true, false}, ConvolveGeometry::BoolVec{true, true, false},
+                                                                  TensorShape(0), TensorShape(0)),
+                                    batchSize);
+}
+
 template <class ElemType>
 void MandSTest(int count, int devId)
 {
@@ -338,6 +494,16 @@ void MandSTest(int count, int devId)
 
 int wmain()
 {
+    TensorOpBandwidthTest<float>();
+    TensorOpBandwidthTest<double>();
+
+    cout << "===== Quantized (int16) vs. float product" << endl;
+    QuantizedMultiplyTest<float>(2048, 256, 512);
+    QuantizedMultiplyTest<float>(2048, 16, 2048);
+    QuantizedMultiplyTest<float>(9000, 64, 1024);
+
+    ConvolutionEnginesTest<float>(8);
+
     // MandSTest<float>(100, 2);
 
     /*cout<<endl<<"********************Matrix SquareMultiplyAndWeightedAdd10TimesAvg TEST********************"<<endl;
@@ -61,6 +61,29 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixConstructorFormatRowMajor, RandomSeedFixture)
     BOOST_CHECK_EQUAL(m(1, 2), 12);
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixExternalBufferResize, RandomSeedFixture)
+{
+    std::array<float, 12> buffer = {};
+    SMatrix m;
+    m.SetValue(12, 1, buffer.data(), matrixFlagDontOwnBuffer);
+
+    // reshaping within the buffer keeps using it, also when shrinking
+    m.Resize(2, 3, /*growOnly=*/false);
+    BOOST_CHECK_EQUAL(m.Data(), buffer.data());
+    m(1, 2) = 7;
+    BOOST_CHECK_EQUAL(buffer[5], 7);
+    m.Resize(3, 4);
+    BOOST_CHECK_EQUAL(m.Data(), buffer.data());
+
+    // but it cannot be reallocated
+    BOOST_CHECK_THROW(m.Resize(4, 4), std::logic_error);
+
+    // rebinding to another external buffer must not free the previous one
+    std::array<float, 6> other = {};
+    m.SetValue(2, 3, other.data(), matrixFlagDontOwnBuffer);
+    BOOST_CHECK_EQUAL(m.Data(), other.data());
+}
+
 BOOST_FIXTURE_TEST_CASE(CPUMatrixAddAndSub, RandomSeedFixture)
 {
     DMatrix m0(2, 3);
@@ -0,0 +1,200 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// Tests the CPU implementation of OptimizedRNNStack (CPURNN.h) against a straightforward per-sequence
+// implementation of the cuDNN equations, and its gradients against finite differences.
+//
+#include "stdafx.h"
+#include <random>
+#include "../../../Source/Math/Matrix.h"
+#include "../../../Source/Math/RNNCommon.h"
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+struct RNNTest
+{
+    RnnAttributes attributes;
+    size_t xDim;
+    vector<size_t> numSequencesForFrame;
+
+    size_t NumGates() const { return attributes.m_recurrentOp == L"lstm" ? 4 : attributes.m_recurrentOp == L"gru" ? 3 : 1; }
+    size_t NumDirections() const { return attributes.m_bidirectional ? 2 : 1; }
+    size_t YDim() const { return NumDirections() * attributes.m_hiddenSize; }
+    size_t NumColumns() const { size_t n = 0; for (auto num : numSequencesForFrame) n += num; return n; }
+    size_t NumParameters() const { auto p = attributes.GetNumParameters(xDim); return p.first * p.second; }
+
+    static double Sigmoid(double x) { return 1 / (1 + exp(-x)); }
+
+    // forward pass, one sequence at a time, with the parameter layout spelled out
+    vector<double> ReferenceForward(const vector<double>& x, const vector<double>& w) const
+    {
+        const size_t H = attributes.m_hiddenSize, G = NumGates(), D = NumDirections(), L = attributes.m_numLayers, T = numSequencesForFrame.size();
+        const wstring& op = attributes.m_recurrentOp;
+        vector<size_t> offsets(T);
+        for (size_t t = 1; t < T; t++)
+            offsets[t] = offsets[t - 1] + numSequencesForFrame[t - 1];
+
+        size_t biasOffset = 0;
+        for (size_t layer = 0, inDim = xDim; layer < L; layer++, inDim = D * H)
+            biasOffset += D * (inDim + H) * G * H;
+
+        vector<double> input = x;
+        size_t inDim = xDim, wOffset = 0;
+        for (size_t layer = 0; layer < L; layer++)
+        {
+            vector<double> output(D * H * NumColumns());
+            for (size_t dir = 0; dir < D; dir++)
+            {
+                const double* W = &w[wOffset];
+                const double* R = W + inDim * G * H;
+                const double* bW = &w[biasOffset + (layer * D + dir) * 2 * G * H];
+                const double* bR = bW + G * H;
+                wOffset += (inDim + H) * G * H;
+                for (size_t s = 0; s < numSequencesForFrame[0]; s++)
+                {
+                    size_t len = 0;
+                    while (len < T && numSequencesForFrame[len] > s)
+                        len++;
+                    vector<double> h(H), c(H), a(G * H), ra(G * H);
+                    for (size_t k = 0; k < len; k++)
+                    {
+                        const size_t col = offsets[dir == 0 ? k : len - 1 - k] + s;
+                        for (size_t gj = 0; gj < G * H; gj++)
+                        {
+                            a[gj] = bW[gj];
+                            for (size_t i = 0; i < inDim; i++)
+                                a[gj] += W[gj * inDim + i] * input[col * inDim + i];
+                            ra[gj] = bR[gj];
+                            for (size_t i = 0; i < H; i++)
+                                ra[gj] += R[gj * H + i] * h[i];
+                        }
+                        for (size_t j = 0; j < H; j++)
+                        {
+                            if (op == L"lstm")
+                            {
+                                const double ig = Sigmoid(a[j] + ra[j]), fg = Sigmoid(a[H + j] + ra[H + j]);
+                                const double cc = tanh(a[2 * H + j] + ra[2 * H + j]), og = Sigmoid(a[3 * H + j] + ra[3 * H + j]);
+                                c[j] = fg * c[j] + ig * cc;
+                                h[j] = og * tanh(c[j]);
+                            }
+                            else if (op == L"gru")
+                            {
+                                const double r = Sigmoid(a[j] + ra[j]), z = Sigmoid(a[H + j] + ra[H + j]);
+                                const double hh = tanh(a[2 * H + j] + r * ra[2 * H + j]);
+                                h[j] = (1 - z) * hh + z * h[j];
+                            }
+                            else if (op == L"rnnReLU")
+                                h[j] = max(0.0, a[j] + ra[j]);
+                            else
+                                h[j] = tanh(a[j] + ra[j]);
+                        }
+                        for (size_t j = 0; j < H; j++)
+                            output[col * D * H + dir * H + j] = h[j];
+                    }
+                }
+            }
+            input = output;
+            inDim = D * H;
+        }
+        return input;
+    }
+
+    static vector<double> Random(size_t n, int seed, double range)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> dist(-range, range);
+        vector<double> v(n);
+        for (auto& e : v)
+            e = dist(rng);
+        return v;
+    }
+
+    static vector<double> ToVector(const Matrix<double>& m)
+    {
+        double* data = m.CopyToArray();
+        vector<double> v(data, data + m.GetNumElements());
+        delete[] data;
+        return v;
+    }
+
+    void Run() const
+    {
+        const size_t N = NumColumns(), yDim = YDim();
+        const vector<double> xValues = Random(xDim * N, 1, 1), wValues = Random(NumParameters(), 2, 0.5), dyValues = Random(yDim * N, 3, 1);
+
+        Matrix<double> x(xDim, N, const_cast<double*>(xValues.data()), CPUDEVICE);
+        Matrix<double> w(NumParameters(), 1, const_cast<double*>(wValues.data()), CPUDEVICE);
+        Matrix<double> y(yDim, N, CPUDEVICE), reserve(CPUDEVICE), workspace(CPUDEVICE);
+        y.RNNForward(x, w, xDim, yDim, numSequencesForFrame, attributes, reserve, workspace);
+
+        const vector<double> expected = ReferenceForward(xValues, wValues), actual = ToVector(y);
+        double maxError = 0;
+        for (size_t i = 0; i < expected.size(); i++)
+            maxError = max(maxError, fabs(expected[i] - actual[i]));
+        BOOST_CHECK_LT(maxError, 1e-12);
+
+        // loss = sum(y .* dy), so dy is its gradient w.r.t. y
+        Matrix<double> dy(yDim, N, const_cast<double*>(dyValues.data()), CPUDEVICE);
+        Matrix<double> dx(xDim, N, CPUDEVICE);
+        Matrix<double> dw = Matrix<double>::Ones(NumParameters(), 1, CPUDEVICE); // the weight gradient is accumulated
+        y.RNNBackwardData(dy, w, dx, attributes, reserve, workspace);
+        y.RNNBackwardWeights(x, y, dw, attributes, reserve, workspace);
+
+        auto loss = [&](const vector<double>& xv, const vector<double>& wv)
+        {
+            const vector<double> yv = ReferenceForward(xv, wv);
+            double sum = 0;
+            for (size_t i = 0; i < yv.size(); i++)
+                sum += yv[i] * dyValues[i];
+            return sum;
+        };
+        auto check = [&](const char* what, const vector<double>& values, const vector<double>& gradient, double offset, bool isX)
+        {
+            const double eps = 1e-6;
+            size_t numMismatches = 0;
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                vector<double> plus = values, minus = values;
+                plus[i] += eps;
+                minus[i] -= eps;
+                const double numeric = isX ? (loss(plus, wValues) - loss(minus, wValues)) / (2 * eps) : (loss(xValues, plus) - loss(xValues, minus)) / (2 * eps);
+                const double analytic = gradient[i] - offset;
+                if (fabs(numeric - analytic) > 1e-6 * max(1.0, fabs(numeric)) && numMismatches++ < 3)
+                    fprintf(stderr, "%ls %s[%d]: numeric %.10g, analytic %.10g\n", attributes.m_recurrentOp.c_str(), what, (int) i, numeric, analytic);
+            }
+            BOOST_CHECK_EQUAL(numMismatches, 0);
+        };
+        check("dx", xValues, ToVector(dx), 0, true);
+        check("dw", wValues, ToVector(dw), 1, false);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(CPURNNSuite)
+
+BOOST_AUTO_TEST_CASE(CPURNNMatchesReferenceAndGradients)
+{
+    // sequences of lengths 5, 4, 2, 2, packed by time step
+    const vector<size_t> numSequencesForFrame = { 4, 4, 2, 2, 1 };
+    for (const wchar_t* op : { L"lstm", L"gru", L"rnnReLU", L"rnnTanh" })
+    {
+        for (bool bidirectional : { false, true })
+        {
+            RNNTest test = { RnnAttributes(bidirectional, 2, 5, op, -1), 3, numSequencesForFrame };
+            test.Run();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(CPURNNRejectsWrongParameterSize)
+{
+    RnnAttributes attributes(false, 1, 4, L"lstm", -1);
+    Matrix<float> x(3, 2, CPUDEVICE), w(10, 1, CPUDEVICE), y(4, 2, CPUDEVICE), reserve(CPUDEVICE), workspace(CPUDEVICE);
+    x.SetValue(0);
+    w.SetValue(0);
+    BOOST_CHECK_THROW(y.RNNForward(x, w, 3, 4, vector<size_t>{ 1, 1 }, attributes, reserve, workspace), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
@@ -0,0 +1,132 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// Compares the SIMD kernels of the CPU tensor ops (CPUTensorSIMD.h) against the scalar path.
+//
+#include "stdafx.h"
+#include <random>
+#include "TensorView.h"
+#include "../../../Source/Math/CPUTensorSIMD.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+template <class ElemType>
+struct SIMDTensorTest
+{
+    // restores the instruction set on exit, also if a check throws
+    struct InstructionSetGuard
+    {
+        ~InstructionSetGuard() { SIMD::SetMaxInstructionSet(SIMD::InstructionSet::AVX512); }
+    };
+
+    static TensorView<ElemType> CreateTensor(const TensorShape& shape, int randomSeed)
+    {
+        std::mt19937 rng(randomSeed);
+        std::uniform_real_distribution<double> nd(-3, 3);
+        vector<ElemType> init(shape.GetNumElements());
+        for (auto& v : init)
+            v = (ElemType) nd(rng);
+        auto sob = make_shared<Matrix<ElemType>>(init.size(), 1, init.data(), CPUDEVICE);
+        return TensorView<ElemType>(sob, shape);
+    }
+
+    static vector<ElemType> ToVector(const TensorView<ElemType>& t)
+    {
+        const auto& sob = t.GetSOB();
+        ElemType* data = sob.CopyToArray();
+        vector<ElemType> result(data, data + sob.GetNumElements());
+        delete[] data;
+        return result;
+    }
+
+    // run 'fn' on a fresh result tensor with the scalar path and with the best instruction set, and compare
+    template <typename FN>
+    static void Compare(const char* what, const TensorShape& resultShape, double tolerance, const FN& fn)
+    {
+        InstructionSetGuard guard;
+        vector<ElemType> results[2];
+        for (int useSIMD = 0; useSIMD < 2; useSIMD++)
+        {
+            SIMD::SetMaxInstructionSet(useSIMD ? SIMD::InstructionSet::AVX512 : SIMD::InstructionSet::None);
+            auto result = CreateTensor(resultShape, 4);
+            fn(result);
+            results[useSIMD] = ToVector(result);
+        }
+        size_t numMismatches = 0;
+        for (size_t i = 0; i < results[0].size(); i++)
+        {
+            const double expected = results[0][i], actual = results[1][i];
+            if (std::isnan(expected) && std::isnan(actual))
+                continue;
+            if (!(fabs(expected - actual) <= tolerance * max(1.0, fabs(expected))) && numMismatches++ < 3)
+                fprintf(stderr, "%s [%s]: element %d: expected %.17g, got %.17g\n", what, SIMD::ToString(SIMD::GetSupportedInstructionSet()), (int) i, expected, actual);
+        }
+        BOOST_CHECK_MESSAGE(numMismatches == 0, what);
+    }
+
+    struct NamedOp
+    {
+        ElementWiseOperator op;
+        const char* name;
+    };
+
+    static void Run(const TensorShape& shape, const TensorShape& argShape, double tolerance)
+    {
+#define NAMED_OP(name) { op##name, #name }
+        const NamedOp unaryOps[] =
+        {
+            NAMED_OP(Copy), NAMED_OP(Negate), NAMED_OP(Abs), NAMED_OP(Reciprocal), NAMED_OP(Sigmoid), NAMED_OP(Tanh), NAMED_OP(Sqr), NAMED_OP(Sqrt), NAMED_OP(Exp), NAMED_OP(Log),
+            NAMED_OP(LinearRectifier), NAMED_OP(ExponentialLinearUnit), NAMED_OP(StableSigmoid)
+        };
+        const NamedOp binaryOps[] =
+        {
+            NAMED_OP(Sum), NAMED_OP(Difference), NAMED_OP(ElementwiseProduct), NAMED_OP(Max), NAMED_OP(Min), NAMED_OP(MaskNegative),
+            NAMED_OP(ElementwiseProductWithSigmoidDerivativeFromOutput), NAMED_OP(ElementwiseProductWithTanhDerivativeFromOutput),
+            NAMED_OP(ElementwiseProductWithLinearRectifierDerivativeFromOutput), NAMED_OP(ElementwiseProductWithLogDerivativeFromOutput),
+            NAMED_OP(ElementwiseProductWithExponentialLinearUnitDerivativeFromOutput), NAMED_OP(SqrOfDifference)
+        };
+        const NamedOp ternaryOps[] =
+        {
+            NAMED_OP(Cond), NAMED_OP(CopyIfEqual), NAMED_OP(Clip), NAMED_OP(ElementwiseProductWithLogSumDerivative), NAMED_OP(ElementwiseProductWithExpOfDiff)
+        };
+#undef NAMED_OP
+
+        auto a = CreateTensor(shape, 1);
+        auto b = CreateTensor(argShape, 2);
+        auto c = CreateTensor(shape, 3);
+        for (ElemType beta : {(ElemType) 0, (ElemType) 0.5})
+        {
+            for (auto op : unaryOps)
+                Compare(op.name, shape, tolerance, [&](TensorView<ElemType>& result) { result.DoUnaryOpOf(beta, a, 2, op.op, opSum); });
+            for (auto op : binaryOps)
+                Compare(op.name, shape, tolerance, [&](TensorView<ElemType>& result) { result.DoBinaryOpOf(beta, a, b, 2, op.op, opSum); });
+            for (auto op : ternaryOps)
+                Compare(op.name, shape, tolerance, [&](TensorView<ElemType>& result) { result.DoTernaryOpOf(beta, a, b, c, 2, op.op, opSum); });
+        }
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(CPUTensorSIMDSuite)
+
+BOOST_AUTO_TEST_CASE(SIMDTensorOpsMatchScalarFloat)
+{
+    fprintf(stderr, "SIMD instruction set: %s\n", SIMD::ToString(SIMD::GetSupportedInstructionSet()));
+    SIMDTensorTest<float>::Run(TensorShape(37, 5), TensorShape(37, 5), 1e-5);      // rows with a remainder
+    SIMDTensorTest<float>::Run(TensorShape(100003), TensorShape(100003), 1e-5);    // long row, split over threads
+    SIMDTensorTest<float>::Run(TensorShape(64, 3, 4), TensorShape(64, 1, 4), 1e-5); // broadcasting outer dimension
+    SIMDTensorTest<float>::Run(TensorShape(64, 3), TensorShape(1, 3), 1e-5);       // broadcasting inner dimension: scalar path
+}
+
+BOOST_AUTO_TEST_CASE(SIMDTensorOpsMatchScalarDouble)
+{
+    SIMDTensorTest<double>::Run(TensorShape(37, 5), TensorShape(37, 5), 1e-12);
+    SIMDTensorTest<double>::Run(TensorShape(100003), TensorShape(100003), 1e-12);
+    SIMDTensorTest<double>::Run(TensorShape(64, 3, 4), TensorShape(64, 1, 4), 1e-12);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
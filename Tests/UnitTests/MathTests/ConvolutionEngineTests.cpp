@@ -371,6 +371,85 @@ BOOST_AUTO_TEST_CASE(ConvolutionBackwardKernel)
     }
 }
 
+// The direct engine (CPU only) is compared against the reference engine on the CPU, forward and backward.
+// Winograd transforms lose a few bits compared to a direct sum, hence the larger tolerance.
+BOOST_AUTO_TEST_CASE(DirectConvolution)
+{
+    std::mt19937 rng(0);
+    boost::random::uniform_int_distribution<> batchSizeG(1, 8);
+    boost::random::normal_distribution<float> nd;
+
+    auto geometry = [](TensorShape in, TensorShape kernel, size_t mapCount, TensorShape stride, ConvolveGeometry::BoolVec sharing, ConvolveGeometry::BoolVec autoPad)
+    {
+        return std::make_shared<ConvolveGeometry>(in, kernel, TensorShape(mapCount), stride, sharing, autoPad, TensorShape(0), TensorShape(0));
+    };
+    std::vector<ConvolveGeometryPtr> configs =
+    {
+        // 3x3 stride 1: Winograd F(4x4,3x3), also with partial tiles, and F(2x2,3x3) for small outputs
+        geometry(TensorShape(8, 8, 4), TensorShape(3, 3, 4), 6, TensorShape(1, 1, 4), {true}, {true, true, false}),
+        geometry(TensorShape(9, 6, 3), TensorShape(3, 3, 3), 5, TensorShape(1, 1, 3), {true}, {true, true, false}),
+        geometry(TensorShape(9, 7, 2), TensorShape(3, 3, 2), 3, TensorShape(1, 1, 2), {true}, {false}),
+        geometry(TensorShape(3, 3, 5), TensorShape(3, 3, 5), 2, TensorShape(1, 1, 5), {true}, {true, true, false}),
+        // 1x1, also strided (ResNet shortcuts)
+        geometry(TensorShape(7, 6, 5), TensorShape(1, 1, 5), 4, TensorShape(1, 1, 5), {true}, {false}),
+        geometry(TensorShape(8, 8, 3), TensorShape(1, 1, 3), 4, TensorShape(2, 2, 3), {true}, {false}),
+        // depthwise, with kernels shared across channels or one per channel
+        geometry(TensorShape(9, 8, 3), TensorShape(3, 3, 1), 2, TensorShape(1, 1, 1), {true}, {true, true, false}),
+        geometry(TensorShape(9, 8, 3), TensorShape(3, 3, 1), 2, TensorShape(2, 2, 1), {true, true, false}, {true, true, false}),
+        geometry(TensorShape(10, 9, 4), TensorShape(5, 5, 1), 1, TensorShape(2, 2, 1), {true, true, false}, {false}),
+    };
+
+    int deviceId = -1;
+    for (size_t maxTempMem : {0, 3})
+    {
+        for (const auto& g : configs)
+        {
+            auto baseEng = ConvEng::Create(g, deviceId, ImageLayoutKind::CHW, 0, PoolKind::None, ConvolutionEngineKind::Reference);
+            auto testEng = ConvEng::Create(g, deviceId, ImageLayoutKind::CHW, maxTempMem, PoolKind::None, ConvolutionEngineKind::Direct);
+
+            size_t n = batchSizeG(rng);
+            size_t crowIn = g->InputShape().GetNumElements();
+            size_t crowOut = g->OutputShape().GetNumElements();
+            size_t kernelSize = g->KernelShape().GetNumElements();
+            vec buf(crowIn * n);
+            std::generate(begin(buf), end(buf), [&] { return nd(rng); });
+            SingleMatrix in(crowIn, n, buf.data(), deviceId, matrixFlagNormal);
+            buf.resize(g->KernelCount() * kernelSize);
+            std::generate(begin(buf), end(buf), [&] { return nd(rng); });
+            SingleMatrix kernel(g->KernelCount(), kernelSize, buf.data(), deviceId, matrixFlagNormal);
+            buf.resize(crowOut * n);
+            std::generate(begin(buf), end(buf), [&] { return nd(rng); });
+            SingleMatrix srcGrad(crowOut, n, buf.data(), deviceId, matrixFlagNormal);
+
+            SingleMatrix out(crowOut, n, deviceId), outB(crowOut, n, deviceId);
+            SingleMatrix grad = SingleMatrix::Zeros(crowIn, n, deviceId), gradB = SingleMatrix::Zeros(crowIn, n, deviceId);
+            SingleMatrix kernelGrad = SingleMatrix::Zeros(g->KernelCount(), kernelSize, deviceId), kernelGradB = SingleMatrix::Zeros(g->KernelCount(), kernelSize, deviceId);
+            SingleMatrix workspace(deviceId);
+            SingleMatrix workspaceB(deviceId);
+
+            testEng->Forward(in, kernel, out, workspace);
+            baseEng->Forward(in, kernel, outB, workspaceB);
+            testEng->BackwardData(srcGrad, kernel, grad, true, workspace);
+            baseEng->BackwardData(srcGrad, kernel, gradB, true, workspaceB);
+            testEng->BackwardKernel(srcGrad, in, kernelGrad, true, false, workspace);
+            baseEng->BackwardKernel(srcGrad, in, kernelGradB, true, false, workspaceB);
+
+            std::stringstream tmsg;
+            tmsg << "Geometry: " << (std::string)(*g) << ", Batch: " << n << ", MaxTempMem: " << maxTempMem;
+            std::string msg = " are not equal, " + tmsg.str();
+            std::string emsg;
+
+            BOOST_REQUIRE_MESSAGE(CheckEqual(out, outB, emsg, 1e-4f, 1e-4f), "out" << msg << ". " << emsg);
+            BOOST_REQUIRE_MESSAGE(CheckEqual(grad, gradB, emsg, Err<float>::Rel * 16, Err<float>::Abs * 16), "grad" << msg << ". " << emsg);
+            BOOST_REQUIRE_MESSAGE(CheckEqual(kernelGrad, kernelGradB, emsg, Err<float>::Rel * 192, Err<float>::Abs * 32), "kernel" << msg << ". " << emsg);
+        }
+    }
+
+    // Other geometries are left to the other engines.
+    auto g5x5 = geometry(TensorShape(8, 8, 2), TensorShape(5, 5, 2), 2, TensorShape(1, 1, 2), {true}, {true, true, false});
+    BOOST_CHECK_THROW(ConvEng::Create(g5x5, deviceId, ImageLayoutKind::CHW, 0, PoolKind::None, ConvolutionEngineKind::Direct), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_CASE(PoolingForward)
 {
     std::mt19937 rng(0);
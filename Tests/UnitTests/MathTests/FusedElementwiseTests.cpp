@@ -0,0 +1,130 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// Compares fused elementwise programs (FusedElementwise.h) against evaluating the ops one at a time with TensorView.
+//
+#include "stdafx.h"
+#include <random>
+#include "TensorView.h"
+#include "../../../Source/Math/FusedElementwise.h"
+#include "../../../Source/Math/CPUTensorSIMD.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+template <class ElemType>
+struct FusedElementwiseTest
+{
+    // restores the instruction set on exit, also if a check throws
+    struct InstructionSetGuard
+    {
+        ~InstructionSetGuard() { SIMD::SetMaxInstructionSet(SIMD::InstructionSet::AVX512); }
+    };
+
+    static TensorView<ElemType> CreateTensor(size_t n, int randomSeed)
+    {
+        std::mt19937 rng(randomSeed);
+        std::uniform_real_distribution<double> nd(-3, 3);
+        vector<ElemType> init(n);
+        for (auto& v : init)
+            v = (ElemType) nd(rng);
+        auto sob = make_shared<Matrix<ElemType>>(init.size(), 1, init.data(), CPUDEVICE);
+        return TensorView<ElemType>(sob, TensorShape(n));
+    }
+
+    static vector<ElemType> ToVector(const TensorView<ElemType>& t)
+    {
+        const auto& sob = t.GetSOB();
+        ElemType* data = sob.CopyToArray();
+        vector<ElemType> result(data, data + sob.GetNumElements());
+        delete[] data;
+        return result;
+    }
+
+    // the LSTM cell c = sigmoid(f) .* cPrev + sigmoid(i) .* tanh(z); h = sigmoid(o) .* tanh(c)
+    // over inputs i, f, z, o, cPrev
+    static vector<FusedElementwise::Instruction> LSTMCellProgram()
+    {
+        using FusedElementwise::InputArg;
+        return vector<FusedElementwise::Instruction>
+        {
+            { opSigmoid,            1, { InputArg(0), 0 } }, // 0
+            { opSigmoid,            1, { InputArg(1), 0 } }, // 1
+            { opTanh,               1, { InputArg(2), 0 } }, // 2
+            { opSigmoid,            1, { InputArg(3), 0 } }, // 3
+            { opElementwiseProduct, 2, { 1, InputArg(4) } }, // 4
+            { opElementwiseProduct, 2, { 0, 2 } },           // 5
+            { opSum,                2, { 4, 5 } },           // 6: c
+            { opTanh,               1, { 6, 0 } },           // 7
+            { opElementwiseProduct, 2, { 3, 7 } },           // 8: h
+        };
+    }
+
+    static void Run(size_t n, double tolerance)
+    {
+        InstructionSetGuard guard;
+        for (auto instructionSet : { SIMD::InstructionSet::None, SIMD::InstructionSet::AVX512 })
+        {
+            SIMD::SetMaxInstructionSet(instructionSet);
+
+            vector<TensorView<ElemType>> inputs;
+            for (int k = 0; k < 5; k++)
+                inputs.push_back(CreateTensor(n, k + 1));
+
+            // one op at a time, as the nodes would do it
+            const auto program = LSTMCellProgram();
+            vector<TensorView<ElemType>> results;
+            for (const auto& instruction : program)
+            {
+                auto arg = [&](int a) { return a < 0 ? inputs[-1 - a] : results[a]; };
+                auto result = CreateTensor(n, 0);
+                if (instruction.numArgs == 1)
+                    result.DoUnaryOpOf(0, arg(instruction.args[0]), 1, instruction.op, opSum);
+                else
+                    result.DoBinaryOpOf(0, arg(instruction.args[0]), arg(instruction.args[1]), 1, instruction.op, opSum);
+                results.push_back(result);
+            }
+            const vector<ElemType> expected = ToVector(results.back());
+
+            vector<const ElemType*> inputPointers;
+            for (const auto& input : inputs)
+                inputPointers.push_back(input.GetSOB().Data());
+            vector<ElemType> actual(n);
+            FusedElementwise::Evaluate(program, inputPointers, actual.data(), n);
+
+            size_t numMismatches = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                if (!(fabs(expected[i] - actual[i]) <= tolerance) && numMismatches++ < 3)
+                    fprintf(stderr, "[%s] element %d: expected %.17g, got %.17g\n", SIMD::ToString(SIMD::GetInstructionSet()), (int) i, (double) expected[i], (double) actual[i]);
+            }
+            BOOST_CHECK_EQUAL(numMismatches, 0);
+        }
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(FusedElementwiseSuite)
+
+BOOST_AUTO_TEST_CASE(FusedElementwiseMatchesTensorOps)
+{
+    FusedElementwiseTest<float>::Run(1000, 1e-6);     // several blocks and a partial one
+    FusedElementwiseTest<float>::Run(100003, 1e-6);   // split over threads
+    FusedElementwiseTest<double>::Run(1000, 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE(FusedElementwiseRejectsMalformedPrograms)
+{
+    using FusedElementwise::InputArg;
+    typedef vector<FusedElementwise::Instruction> Program;
+    BOOST_CHECK_THROW(FusedElementwise::Verify(Program{ { opSum, 1, { InputArg(0), 0 } } }, 1), std::invalid_argument);                   // wrong arity
+    BOOST_CHECK_THROW(FusedElementwise::Verify(Program{ { opSigmoid, 1, { InputArg(1), 0 } } }, 1), std::invalid_argument);               // no such input
+    BOOST_CHECK_THROW(FusedElementwise::Verify(Program{ { opSum, 2, { InputArg(0), 0 } } }, 1), std::invalid_argument);                   // not computed yet
+    BOOST_CHECK_THROW(FusedElementwise::Verify(Program{ { opCond, 2, { InputArg(0), InputArg(0) } } }, 1), std::invalid_argument);         // ternary
+    BOOST_CHECK_NO_THROW(FusedElementwise::Verify(Program{ { opTanh, 1, { InputArg(0), 0 } }, { opSum, 2, { 0, InputArg(0) } } }, 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
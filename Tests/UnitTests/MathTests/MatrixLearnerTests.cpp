@@ -44,20 +44,25 @@ public:
         matM = SingleMatrix::RandomGaussian(dim1, dim2, c_deviceIdZero, -1.0f, 1.0f, IncrementCounter());
         matMsparse = SingleMatrix(matM.DeepClone());
 
-        // generates gradient
-        SingleMatrix matG1(c_deviceIdZero);
-        matG1.AssignTruncateBottomOf(Matrix<float>::RandomUniform(dim2, dim3, c_deviceIdZero, -300.0f, 0.1f, IncrementCounter()), 0);
+        GenerateGradient(matG, matGsparseBSC, c_deviceIdZero);
+        timestamps = SingleMatrix::RandomGaussian(1, dim2, c_deviceIdZero, -1.0f, 1.0f, IncrementCounter());
+    }
+
+    // generates a gradient in which about half of the columns are zero, as a dense and a block sparse column matrix
+    void GenerateGradient(SingleMatrix& gradient, SingleMatrix& gradientSparseBSC, int deviceId)
+    {
+        SingleMatrix matG1(deviceId);
+        matG1.AssignTruncateBottomOf(Matrix<float>::RandomUniform(dim2, dim3, deviceId, -300.0f, 0.1f, IncrementCounter()), 0);
 
         SingleMatrix matG1sparseCSC(matG1.DeepClone());
         matG1sparseCSC.SwitchToMatrixType(MatrixType::SPARSE, matrixFormatSparseCSC, true);
 
-        SingleMatrix matG2 = SingleMatrix::RandomGaussian(dim1, dim3, c_deviceIdZero, -1.0f, 1.0f, IncrementCounter());
+        SingleMatrix matG2 = SingleMatrix::RandomGaussian(dim1, dim3, deviceId, -1.0f, 1.0f, IncrementCounter());
 
-        SingleMatrix::MultiplyAndWeightedAdd(1, matG2, false, matG1, true, 0, matG);
+        SingleMatrix::MultiplyAndWeightedAdd(1, matG2, false, matG1, true, 0, gradient);
 
-        matGsparseBSC.SwitchToMatrixType(MatrixType::SPARSE, matrixFormatSparseBlockCol, false);
-        SingleMatrix::MultiplyAndAdd(matG2, false, matG1sparseCSC, true, matGsparseBSC);
-        timestamps = SingleMatrix::RandomGaussian(1, dim2, c_deviceIdZero, -1.0f, 1.0f, IncrementCounter());
+        gradientSparseBSC.SwitchToMatrixType(MatrixType::SPARSE, matrixFormatSparseBlockCol, false);
+        SingleMatrix::MultiplyAndAdd(matG2, false, matG1sparseCSC, true, gradientSparseBSC);
     }
 
     void RunOnDevices(std::function<void()> func)
@@ -74,6 +79,32 @@ public:
             func();
         }
     }
+
+    // Runs a dense and a lazy sparse learner on the CPU over several minibatches, each with different zero columns,
+    // and then brings the lazy state up to date.
+    void RunLazyUpdates(const std::function<void(SingleMatrix& gradient, SingleMatrix& smoothedGradient, SingleMatrix& model, int* timestamps, int time)>& update,
+                        const std::function<void(SingleMatrix& smoothedGradient, SingleMatrix& model, int* timestamps, int time)>& flush)
+    {
+        matSG.TransferToDeviceIfNotThere(CPUDEVICE, true);
+        matSGsparse.TransferToDeviceIfNotThere(CPUDEVICE, true);
+        matM.TransferToDeviceIfNotThere(CPUDEVICE, true);
+        matMsparse.TransferToDeviceIfNotThere(CPUDEVICE, true);
+        timestamps.TransferToDeviceIfNotThere(CPUDEVICE, true);
+        timestamps.SetValue(0.0f);
+        auto ts = reinterpret_cast<int*>(timestamps.Data());
+
+        const int numMinibatches = 8;
+        for (int time = 1; time <= numMinibatches; time++)
+        {
+            SingleMatrix gradient(CPUDEVICE);
+            SingleMatrix gradientSparseBSC(CPUDEVICE);
+            GenerateGradient(gradient, gradientSparseBSC, CPUDEVICE);
+
+            update(gradient, matSG, matM, nullptr, 0);
+            update(gradientSparseBSC, matSGsparse, matMsparse, ts, time);
+        }
+        flush(matSGsparse, matMsparse, ts, numMinibatches);
+    }
 };
 
 namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
@@ -121,5 +152,70 @@ BOOST_FIXTURE_TEST_CASE(AdaDeltaSparse, MatrixLearnerFixture)
     });
 }
 
+// tests lazy momentum SGD on sparse gradients vs. dense
+BOOST_FIXTURE_TEST_CASE(MomentumSGDLazySparse, MatrixLearnerFixture)
+{
+    RunLazyUpdates(
+        [](SingleMatrix& gradient, SingleMatrix& smoothedGradient, SingleMatrix& model, int* ts, int time)
+        {
+            model.MomentumSGDUpdate(gradient, smoothedGradient, 0.01f, 0.9f, 0.1f, ts, time);
+        },
+        [](SingleMatrix& smoothedGradient, SingleMatrix& model, int* ts, int time)
+        {
+            model.MomentumSGDFlushState(smoothedGradient, 0.9f, ts, time);
+        });
+
+    BOOST_CHECK(matSG.IsEqualTo(matSGsparse, c_epsilonFloatE4));
+    BOOST_CHECK(matM.IsEqualTo(matMsparse, c_epsilonFloatE4));
+}
+
+// tests lazy FSAdagrad on sparse gradients vs. dense
+BOOST_FIXTURE_TEST_CASE(FSAdagradLazySparse, MatrixLearnerFixture)
+{
+    RunLazyUpdates(
+        [](SingleMatrix& gradient, SingleMatrix& smoothedGradient, SingleMatrix& model, int* ts, int time)
+        {
+            smoothedGradient.FSAdagradUpdate(gradient, model, 0.5, 0.0001, 0.9, 0.99, 0.1f, ts, time);
+        },
+        [](SingleMatrix& smoothedGradient, SingleMatrix& model, int* ts, int time)
+        {
+            smoothedGradient.FSAdagradFlushState(model, 0.0001, 0.9, 0.99, ts, time);
+        });
+
+    BOOST_CHECK(matSG.IsEqualTo(matSGsparse, c_epsilonFloatE4));
+    BOOST_CHECK(matM.IsEqualTo(matMsparse, c_epsilonFloatE4));
+}
+
+// tests lazy Adam and Adamax on sparse gradients vs. dense
+BOOST_FIXTURE_TEST_CASE(AdamLazySparse, MatrixLearnerFixture)
+{
+    for (bool adamax : { false, true })
+    {
+        const double momentum = 0.9, varMomentum = 0.999;
+        std::vector<double> biasCorrections(1, 0.0);
+        auto biasCorrection = [=](double count)
+        {
+            return adamax ? 1. / (1 - pow(momentum, count)) : sqrt(1 - pow(varMomentum, count)) / (1 - pow(momentum, count));
+        };
+
+        RunLazyUpdates(
+            [&](SingleMatrix& gradient, SingleMatrix& smoothedGradient, SingleMatrix& model, int* ts, int time)
+            {
+                // the dense update runs first, the minibatch count is its number of calls
+                if (!ts)
+                    biasCorrections.push_back(biasCorrection((double)biasCorrections.size()));
+                smoothedGradient.AdamUpdate(gradient, model, (double)biasCorrections.size() - 1, 0.001, momentum, varMomentum, 1e-8, 0.1f, adamax,
+                                            ts ? biasCorrections.data() : nullptr, ts, time);
+            },
+            [&](SingleMatrix& smoothedGradient, SingleMatrix& model, int* ts, int time)
+            {
+                smoothedGradient.AdamFlushState(model, 0.001, momentum, varMomentum, 1e-8, adamax, biasCorrections.data(), ts, time);
+            });
+
+        BOOST_CHECK(matSG.IsEqualTo(matSGsparse, c_epsilonFloatE4));
+        BOOST_CHECK(matM.IsEqualTo(matMsparse, c_epsilonFloatE4));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }}}}
@@ -5,6 +5,11 @@
 #include "stdafx.h"
 #include "../../../Source/Math/QuantizedOperations.h"
 #include "../../../Source/Math/Helpers.h"
+#include "../../../Source/Math/CPUTensorSIMD.h"
+#include "../../../Source/Math/HalfGemm.h"
+#include <random>
+#include <cmath>
+#include <limits>
 
 using namespace Microsoft::MSR::CNTK;
 namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
@@ -51,6 +56,118 @@ BOOST_FIXTURE_TEST_CASE(MultiplyIntToShort, RandomSeedFixture)
 }
 
 
+// The packed int16 product must match the naive product exactly, for all kernels and shapes that don't fill whole panels.
+BOOST_FIXTURE_TEST_CASE(PackedProductMatchesNaive, RandomSeedFixture)
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> values(-1023, 1023); // small enough to not overflow the int32 accumulators
+
+    const int shapes[][3] = { { 1, 1, 1 }, { 5, 4, 3 }, { 16, 4, 2 }, { 37, 13, 301 }, { 130, 70, 513 } }; // m, n, k
+    const SIMD::InstructionSet instructionSets[] = { SIMD::InstructionSet::None, SIMD::InstructionSet::SSE4, SIMD::InstructionSet::AVX2 };
+    for (const auto& shape : shapes)
+    {
+        const int m = shape[0], n = shape[1], k = shape[2];
+        std::vector<short> A(m * k), B(k * n);
+        for (auto& v : A)
+            v = (short) values(rng);
+        for (auto& v : B)
+            v = (short) values(rng);
+
+        std::vector<int> expected(m * n);
+        for (int i = 0; i < m; i++)
+            for (int j = 0; j < n; j++)
+            {
+                int dotProduct = 0;
+                for (int l = 0; l < k; l++)
+                    dotProduct += A[i + l * m] * B[l + k * j];
+                expected[i + j * m] = dotProduct;
+            }
+
+        std::vector<short> packedA(QuantizedGemm::PackedASize(m, k));
+        QuantizedGemm::PackA(m, k, A.data(), packedA.data());
+        const int ldc = QuantizedGemm::ResultLeadingDim(m);
+        for (auto instructionSet : instructionSets)
+        {
+            SIMD::SetMaxInstructionSet(instructionSet);
+            std::vector<int> C((size_t) ldc * n);
+            QuantizedGemm::Multiply(m, n, k, packedA.data(), B.data(), C.data());
+            for (int i = 0; i < m; i++)
+                for (int j = 0; j < n; j++)
+                    BOOST_REQUIRE_EQUAL(C[i + j * ldc], expected[i + j * m]);
+        }
+        SIMD::SetMaxInstructionSet(SIMD::InstructionSet::AVX512);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(HalfConversions)
+{
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToHalf(1.0f), 0x3c00);
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToHalf(-2.0f), 0xc000);
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToHalf(65504.0f), 0x7bff);         // largest half
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToHalf(1e6f), 0x7c00);             // overflows to infinity
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToHalf(ldexpf(1.0f, -24)), 0x0001); // smallest subnormal
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToHalf(1.0f + ldexpf(1.0f, -11)), 0x3c00); // tie rounds to even
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToHalf(1.0f + 3 * ldexpf(1.0f, -11)), 0x3c02);
+    BOOST_CHECK_EQUAL(HalfGemm::HalfToFloat(0x3555), 0.333251953125f);
+    BOOST_CHECK_EQUAL(HalfGemm::HalfToFloat(0x0001), ldexpf(1.0f, -24));
+    BOOST_CHECK(std::isnan(HalfGemm::HalfToFloat(HalfGemm::FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToBFloat16(1.0f), 0x3f80);
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToBFloat16(1.0f + ldexpf(1.0f, -8)), 0x3f80); // tie rounds to even
+    BOOST_CHECK_EQUAL(HalfGemm::FloatToBFloat16(1.0f + 3 * ldexpf(1.0f, -8)), 0x3f82);
+    BOOST_CHECK_EQUAL(HalfGemm::BFloat16ToFloat(0xc040), -3.0f);
+    BOOST_CHECK(std::isnan(HalfGemm::BFloat16ToFloat(HalfGemm::FloatToBFloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+// The product with 16-bit A must match the float product with A rounded to 16 bits, for all kernels and shapes that don't fill whole panels.
+BOOST_FIXTURE_TEST_CASE(HalfProductMatchesNaive, RandomSeedFixture)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+
+    const int shapes[][3] = { { 1, 1, 1 }, { 5, 4, 3 }, { 16, 4, 2 }, { 37, 13, 301 }, { 130, 70, 513 } }; // m, n, k
+    const SIMD::InstructionSet instructionSets[] = { SIMD::InstructionSet::None, SIMD::InstructionSet::AVX2 };
+    for (auto format : { HalfGemm::Format::Float16, HalfGemm::Format::BFloat16 })
+    {
+        for (const auto& shape : shapes)
+        {
+            const int m = shape[0], n = shape[1], k = shape[2];
+            std::vector<float> A(m * k), B(k * n);
+            for (auto& v : A)
+                v = values(rng);
+            for (auto& v : B)
+                v = values(rng);
+
+            std::vector<double> expected(m * n);
+            for (int i = 0; i < m; i++)
+                for (int j = 0; j < n; j++)
+                {
+                    double dotProduct = 0;
+                    for (int l = 0; l < k; l++)
+                    {
+                        float a = format == HalfGemm::Format::Float16 ? HalfGemm::HalfToFloat(HalfGemm::FloatToHalf(A[i + l * m]))
+                                                                      : HalfGemm::BFloat16ToFloat(HalfGemm::FloatToBFloat16(A[i + l * m]));
+                        dotProduct += (double) a * B[l + k * j];
+                    }
+                    expected[i + j * m] = dotProduct;
+                }
+
+            std::vector<unsigned short> packedA(HalfGemm::PackedASize(m, k));
+            HalfGemm::PackA(m, k, A.data(), format, packedA.data());
+            for (auto instructionSet : instructionSets)
+            {
+                SIMD::SetMaxInstructionSet(instructionSet);
+                std::vector<float> C(m * n);
+                HalfGemm::Multiply(m, n, k, packedA.data(), format, B.data(), C.data());
+                for (int i = 0; i < m; i++)
+                    for (int j = 0; j < n; j++)
+                        BOOST_REQUIRE_SMALL(C[i + j * m] - expected[i + j * m], 1e-5 * k); // float accumulation order differs
+            }
+            SIMD::SetMaxInstructionSet(SIMD::InstructionSet::AVX512);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } } } }
\ No newline at end of file
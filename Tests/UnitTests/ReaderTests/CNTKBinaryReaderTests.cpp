@@ -4,13 +4,31 @@
 //
 #include "stdafx.h"
 #include <algorithm>
+#include <chrono>
 #include <boost/scope_exit.hpp>
 #include "Common/ReaderTestHelper.h"
+#ifdef __unix__
+#include <fstream>
+#include <unistd.h>
+#endif
 
 using namespace Microsoft::MSR::CNTK;
 
 namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
 
+// Resident set size of the test process in MB (only available on Linux).
+static double ResidentMemoryMB()
+{
+#ifdef __unix__
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0, residentPages = 0;
+    statm >> totalPages >> residentPages;
+    return residentPages * (double)sysconf(_SC_PAGESIZE) / (1024 * 1024);
+#else
+    return 0;
+#endif
+}
+
 struct CNTKBinaryReaderFixture : ReaderFixture
 {
     CNTKBinaryReaderFixture()
@@ -131,6 +149,77 @@ BOOST_AUTO_TEST_CASE(CNTKBinaryReader_50x20_jagged_sequences_sparse)
         true);
 };
 
+// Same as CNTKBinaryReader_10x10_dense, but the chunks point into a memory mapping of the file
+BOOST_AUTO_TEST_CASE(CNTKBinaryReader_10x10_dense_mmap)
+{
+    HelperRunReaderTest<float>(
+        testDataPath() + "/Config/CNTKBinaryReader/test.cntk",
+        testDataPath() + "/Control/CNTKTextFormatReader/10x10_dense.txt",
+        testDataPath() + "/Control/CNTKBinaryReader/10x10_dense_mmap_Output.txt",
+        "10x10_dense_mmap",
+        "reader",
+        100, // epoch size
+        100, // mb size
+        1, // num epochs
+        1,
+        0, // no labels
+        0,
+        1);
+};
+
+// Same as CNTKBinaryReader_50x20_jagged_sequences_sparse, but the chunks point into a memory mapping of the file
+BOOST_AUTO_TEST_CASE(CNTKBinaryReader_50x20_jagged_sequences_sparse_mmap)
+{
+    HelperRunReaderTest<float>(
+        testDataPath() + "/Config/CNTKBinaryReader/test.cntk",
+        testDataPath() + "/Control/CNTKTextFormatReader/50x20_jagged_sequences_sparse.txt",
+        testDataPath() + "/Control/CNTKBinaryReader/50x20_jagged_sequences_sparse_mmap_Output.txt",
+        "50x20_jagged_sequences_sparse_mmap",
+        "reader",
+        564,  // epoch size
+        564,  // mb size 
+        1,  // num epochs
+        1,
+        0,
+        0,
+        1,
+        true);
+};
+
+// Reads the same file with buffered and with memory mapped chunks and reports the throughput
+// and the resident memory of both; the two modes must deliver the same number of samples.
+BOOST_AUTO_TEST_CASE(CNTKBinaryReader_MemoryMapping_Throughput)
+{
+    const size_t epochSize = 1000;
+    const size_t mbSize = 250;
+    const size_t numEpochs = 200;
+
+    auto readAll = [&](const string& testSectionName)
+    {
+        auto inputs = CreateStreamMinibatchInputs<float>(1, 1);
+        auto reader = GetDataReader(testDataPath() + "/Config/CNTKBinaryReader/test.cntk", testSectionName, "reader", {});
+
+        size_t numSamples = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t epoch = 0; epoch < numEpochs; epoch++)
+        {
+            reader->StartMinibatchLoop(mbSize, epoch, inputs->GetStreamDescriptions(), epochSize);
+            while (reader->GetMinibatch(*inputs))
+                numSamples += inputs->GetInput(L"features").pMBLayout->GetActualNumSamples();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        fprintf(stderr, "%s: %d samples in %.3f seconds (%.0f samples/s), resident memory %.1f MB\n",
+                testSectionName.c_str(), (int)numSamples, seconds, numSamples / std::max(seconds, 1e-9), ResidentMemoryMB());
+        return numSamples;
+    };
+
+    size_t buffered = readAll("Simple_benchmark");
+    size_t mapped = readAll("Simple_benchmark_mmap");
+    BOOST_CHECK_EQUAL(buffered, epochSize * numEpochs);
+    BOOST_CHECK_EQUAL(mapped, buffered);
+};
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } } } }
@@ -13,6 +13,8 @@
 #define _fileno fileno
 #endif
 #include <cstdio>
+#include <chrono>
+#include <random>
 #include <boost/scope_exit.hpp>
 #include "Common/ReaderTestHelper.h"
 #include "TextParser.h"
@@ -47,6 +49,17 @@ namespace CNTK {
         {
             m_chunk = m_parser.GetChunk(0);
         }
+
+        void SetTraceLevel(unsigned int traceLevel)
+        {
+            m_parser.SetTraceLevel(traceLevel);
+        }
+
+        // Enables/disables parsing of well-formed samples directly from the reader buffer.
+        void SetFastPath(bool value)
+        {
+            m_parser.SetFastPath(value);
+        }
     };
 }
 
@@ -1062,6 +1075,95 @@ BOOST_AUTO_TEST_CASE(CNTKTextFormatReaderNoFirstMinibatchData)
         2);
 };
 
+// Parses a synthetic corpus (dense and sparse inputs, numbers in various notations) with and without
+// the fast path, checks that both produce the same data and reports the parsing throughput.
+BOOST_AUTO_TEST_CASE(CNTKTextFormatReader_fast_path_throughput)
+{
+    const size_t numSequences = 5000;
+    const size_t denseDim = 100;
+    const size_t sparseDim = 10000;
+    const size_t nnz = 20;
+
+    vector<StreamDescriptor> streams(2);
+    streams[0].m_alias = "F";
+    streams[0].m_name = L"F";
+    streams[0].m_storageFormat = StorageFormat::Dense;
+    streams[0].m_sampleDimension = denseDim;
+
+    streams[1].m_alias = "L";
+    streams[1].m_name = L"L";
+    streams[1].m_storageFormat = StorageFormat::SparseCSC;
+    streams[1].m_sampleDimension = sparseDim;
+
+    string filename = "fast_path_corpus.txt";
+    size_t fileSize = 0;
+    {
+        std::mt19937 rng(13);
+        std::uniform_real_distribution<double> uniform(-10, 10);
+        const char* formats[] = { "%.6g", "%.9g", "%.17g", "%.3f", "%e", "%.0f." };
+        std::ofstream file(filename, std::ofstream::out | std::ofstream::binary);
+        char buffer[64];
+        for (size_t i = 0; i < numSequences; ++i)
+        {
+            file << i << "\t|F";
+            for (size_t j = 0; j < denseDim; ++j)
+            {
+                sprintf(buffer, formats[(i + j) % 6], uniform(rng) * pow(10.0, (int)(rng() % 9) - 4));
+                file << " " << buffer;
+            }
+            file << " |L";
+            for (size_t j = 0; j < nnz; ++j)
+            {
+                sprintf(buffer, "%.6g", uniform(rng));
+                file << " " << (j * (sparseDim / nnz) + rng() % (sparseDim / nnz)) << ":" << buffer;
+            }
+            file << "\n";
+        }
+        fileSize = (size_t)file.tellp();
+    }
+
+    vector<vector<SequenceDataPtr>> results[2];
+    for (int fastPath = 0; fastPath < 2; ++fastPath)
+    {
+        CNTKTextFormatReaderTestRunner<float> testRunner(filename, streams, 0);
+        testRunner.SetTraceLevel(0);
+        testRunner.SetFastPath(fastPath != 0);
+
+        auto start = std::chrono::steady_clock::now();
+        testRunner.LoadChunk();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fprintf(stderr, "Parsed %.1f MB %s the fast path in %.3f seconds (%.1f MB/s).\n",
+                fileSize / 1e6, fastPath ? "with" : "without", seconds, fileSize / 1e6 / std::max(seconds, 1e-9));
+
+        results[fastPath].resize(numSequences);
+        for (size_t i = 0; i < numSequences; ++i)
+            testRunner.m_chunk->GetSequence(i, results[fastPath][i]);
+    }
+
+    boost::filesystem::remove(filename);
+
+    // The fast path rounds correctly, the slow path may differ in the last bit.
+    for (size_t i = 0; i < numSequences; ++i)
+    {
+        auto slowDense = reinterpret_cast<const float*>(results[0][i][0]->GetDataBuffer());
+        auto fastDense = reinterpret_cast<const float*>(results[1][i][0]->GetDataBuffer());
+        for (size_t j = 0; j < denseDim; ++j)
+            BOOST_REQUIRE_CLOSE(slowDense[j], fastDense[j], 0.0001);
+
+        auto slowSparse = static_pointer_cast<SparseSequenceData>(results[0][i][1]);
+        auto fastSparse = static_pointer_cast<SparseSequenceData>(results[1][i][1]);
+        BOOST_REQUIRE_EQUAL(slowSparse->m_totalNnzCount, fastSparse->m_totalNnzCount);
+        BOOST_REQUIRE_EQUAL(fastSparse->m_totalNnzCount, nnz);
+        auto slowValues = reinterpret_cast<const float*>(slowSparse->GetDataBuffer());
+        auto fastValues = reinterpret_cast<const float*>(fastSparse->GetDataBuffer());
+        for (size_t j = 0; j < nnz; ++j)
+        {
+            BOOST_REQUIRE_EQUAL(slowSparse->m_indices[j], fastSparse->m_indices[j]);
+            BOOST_REQUIRE_CLOSE(slowValues[j], fastValues[j], 0.0001);
+        }
+    }
+};
+
 BOOST_AUTO_TEST_SUITE_END()
 
 } } } }
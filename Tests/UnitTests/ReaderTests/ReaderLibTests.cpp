@@ -10,6 +10,7 @@
 #include "NoRandomizer.h"
 #include "DataDeserializer.h"
 #include "BlockRandomizer.h"
+#include "ChunkCache.h"
 #include "CorpusDescriptor.h"
 #include "FramePacker.h"
 #include "SequencePacker.h"
@@ -847,6 +848,112 @@ BOOST_AUTO_TEST_CASE(RandomizerChaosMonkey)
     RandomizerChaosMonkeyTest(blockRandomizerNoPrefetch, sweepSize, 42);
     RandomizerChaosMonkeyTest(blockRandomizerWithPrefetch, sweepSize, 43);
     RandomizerChaosMonkeyTest(norandomizer, sweepSize, 44);
+
+    BlockRandomizer blockRandomizerWithDeepPrefetch(0, windowSize, mockDeserializer, true, false, 0, true, 0, /*maxNumberOfPrefetchedChunks =*/ 7);
+    RandomizerChaosMonkeyTest(blockRandomizerWithDeepPrefetch, sweepSize, 45);
+}
+
+vector<float> ReadSweeps(BlockRandomizer& randomizer, size_t sweepSize, size_t numberOfSweeps, size_t minibatchSize)
+{
+    EpochConfiguration epochConfiguration;
+    epochConfiguration.m_numberOfWorkers = 1;
+    epochConfiguration.m_workerRank = 0;
+    epochConfiguration.m_minibatchSizeInSamples = minibatchSize;
+    epochConfiguration.m_totalEpochSizeInSamples = sweepSize * numberOfSweeps;
+    epochConfiguration.m_epochIndex = 0;
+    randomizer.StartEpoch(epochConfiguration);
+
+    vector<float> result;
+    for (;;)
+    {
+        Sequences sequences = randomizer.GetNextSequences(minibatchSize, minibatchSize);
+        for (auto& sequence : sequences.m_data.empty() ? vector<SequenceDataPtr>() : sequences.m_data[0])
+        {
+            auto& data = reinterpret_cast<DenseSequenceData&>(*sequence);
+            result.push_back(*(float*)data.GetDataBuffer());
+        }
+
+        if (sequences.m_endOfEpoch)
+            break;
+    }
+    return result;
+}
+
+BOOST_AUTO_TEST_CASE(BlockRandomizerPrefetchAcrossSweeps)
+{
+    const size_t numChunks = 30;
+    const size_t numSequencesPerChunk = 4;
+    vector<float> data(numChunks * numSequencesPerChunk);
+    iota(data.begin(), data.end(), 0.0f);
+    auto mockDeserializer = make_shared<MockDeserializer>(numChunks, numSequencesPerChunk, data);
+
+    BlockRandomizer noPrefetch(0, 5, mockDeserializer, false, false, 0, false);
+    auto expected = ReadSweeps(noPrefetch, data.size(), 3, 3);
+    BOOST_REQUIRE_EQUAL(expected.size(), data.size() * 3);
+
+    // Prefetching several chunks ahead (and into the next sweep) must not change the order of the data.
+    for (size_t maxNumberOfPrefetchedChunks : { 1, 2, 5, 100 })
+    {
+        BlockRandomizer prefetch(0, 5, mockDeserializer, true, false, 0, false, 0, maxNumberOfPrefetchedChunks);
+        auto actual = ReadSweeps(prefetch, data.size(), 3, 3);
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(expected.begin(), expected.end(), actual.begin(), actual.end());
+    }
+}
+
+class CountingDeserializer : public MockDeserializer
+{
+public:
+    CountingDeserializer(size_t numChunks, size_t numSequencesPerChunks, const vector<float>& data)
+        : MockDeserializer(numChunks, numSequencesPerChunks, data), m_numberOfLoads(0)
+    {}
+
+    ChunkPtr GetChunk(ChunkIdType chunkId) override
+    {
+        m_numberOfLoads++;
+        return MockDeserializer::GetChunk(chunkId);
+    }
+
+    // Samples of a single float value, for the cache to be able to estimate the chunk size.
+    vector<StreamInformation> StreamInfos() override
+    {
+        auto streams = MockDeserializer::StreamInfos();
+        streams.front().m_sampleLayout = NDShape({ 1 });
+        return streams;
+    }
+
+    size_t m_numberOfLoads;
+};
+
+BOOST_AUTO_TEST_CASE(ChunkCacheMemoryBudget)
+{
+    vector<float> data(10);
+    iota(data.begin(), data.end(), 0.0f);
+    auto deserializer = make_shared<CountingDeserializer>(5, 2, data);
+
+    // Each chunk holds two float samples, the budget fits two chunks.
+    ChunkCache cache(deserializer, 2 * 2 * sizeof(float));
+
+    cache.GetChunk(0);
+    cache.GetChunk(1);
+    cache.GetChunk(0);
+    BOOST_REQUIRE_EQUAL(deserializer->m_numberOfLoads, 2);
+    BOOST_REQUIRE_EQUAL(cache.GetSizeInBytes(), 4 * sizeof(float));
+
+    // Evicts chunk 1, the least recently used one.
+    cache.GetChunk(2);
+    cache.GetChunk(0);
+    BOOST_REQUIRE_EQUAL(deserializer->m_numberOfLoads, 3);
+    cache.GetChunk(1);
+    BOOST_REQUIRE_EQUAL(deserializer->m_numberOfLoads, 4);
+    BOOST_REQUIRE_EQUAL(cache.GetSizeInBytes(), 4 * sizeof(float));
+
+    // Without a budget everything stays in memory.
+    auto unlimitedDeserializer = make_shared<CountingDeserializer>(5, 2, data);
+    ChunkCache unlimited(unlimitedDeserializer);
+    for (int i = 0; i < 3; i++)
+        for (ChunkIdType chunkId = 0; chunkId < 5; chunkId++)
+            unlimited.GetChunk(chunkId);
+    BOOST_REQUIRE_EQUAL(unlimitedDeserializer->m_numberOfLoads, 5);
 }
 
 void BlockRandomizerOneEpochLegacyRandomizationTest(bool prefetch)
@@ -1759,6 +1866,76 @@ BOOST_AUTO_TEST_CASE(SequencePackerSmallChunksWithSequences)
     }
 }
 
+// Returns the fraction of actual samples among all columns of the minibatch layouts of one epoch.
+double GetPaddingEfficiency(PackerPtr packer, SequenceEnumeratorPtr randomizer, size_t epochSize, size_t minibatchSize)
+{
+    EpochConfiguration config;
+    config.m_minibatchSizeInSamples = minibatchSize;
+    config.m_truncationSize = 0;
+    config.m_epochIndex = 0;
+    config.m_totalEpochSizeInSamples = epochSize;
+    config.m_numberOfWorkers = 1;
+    config.m_workerRank = 0;
+
+    packer->SetConfiguration(config, std::vector<MemoryProviderPtr> { std::make_shared<HeapMemoryProvider>() });
+    randomizer->StartEpoch(config);
+
+    size_t actualSamples = 0;
+    size_t paddedSamples = 0;
+    for (;;)
+    {
+        auto minibatch = packer->ReadMinibatch();
+        if (!minibatch.m_data.empty())
+        {
+            actualSamples += minibatch.m_data.front()->m_layout->GetActualNumSamples();
+            paddedSamples += minibatch.m_data.front()->m_layout->GetNumCols();
+        }
+
+        if (minibatch.m_endOfEpoch)
+            break;
+    }
+
+    BOOST_REQUIRE_EQUAL(actualSamples, epochSize);
+    return (double)actualSamples / paddedSamples;
+}
+
+BOOST_AUTO_TEST_CASE(SequencePackerWithLengthBuckets)
+{
+    size_t chunkSizeInSamples = 5000;
+    size_t sweepNumberOfSamples = 21335;
+    uint32_t maxSequenceLength = 100;
+    size_t randomizationWindow = chunkSizeInSamples * 2;
+    std::vector<size_t> lengthBuckets { 10, 20, 30, 40, 50, 60, 70, 80, 90 };
+
+    auto deserializer = make_shared<SequentialDeserializer>(0, chunkSizeInSamples, sweepNumberOfSamples, maxSequenceLength);
+
+    // Grouping by length keeps every sequence in its chunk.
+    {
+        auto blockRandomizer = make_shared<BlockRandomizer>(0, randomizationWindow, deserializer, true, false, 0, true, 0, 2, lengthBuckets);
+        PackerPtr packer = std::make_shared<SequencePacker>(blockRandomizer, deserializer->StreamInfos(), 1, true);
+
+        CheckPackerOnSweep(packer, blockRandomizer, deserializer, 1, 256, false, true);
+        CheckPackerOnSweep(packer, blockRandomizer, deserializer, 5, 255, false, true);
+    }
+
+    // And needs less padding than plain randomization.
+    {
+        auto blockRandomizer = make_shared<BlockRandomizer>(0, randomizationWindow, deserializer, true);
+        PackerPtr packer = std::make_shared<SequencePacker>(blockRandomizer, deserializer->StreamInfos(), 1, true);
+        double efficiency = GetPaddingEfficiency(packer, blockRandomizer, sweepNumberOfSamples, 256);
+
+        auto bucketedRandomizer = make_shared<BlockRandomizer>(0, randomizationWindow, deserializer, true, false, 0, true, 0, 2, lengthBuckets);
+        PackerPtr bucketedPacker = std::make_shared<SequencePacker>(bucketedRandomizer, deserializer->StreamInfos(), 1, true);
+        double bucketedEfficiency = GetPaddingEfficiency(bucketedPacker, bucketedRandomizer, sweepNumberOfSamples, 256);
+
+        BOOST_CHECK_GT(bucketedEfficiency, efficiency);
+    }
+
+    BOOST_CHECK_THROW(
+        make_shared<BlockRandomizer>(0, randomizationWindow, deserializer, true, false, 0, true, 0, 2, std::vector<size_t> { 20, 10 }),
+        std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(TestTruncatedBpttPacker)
 {
     size_t chunkSizeInSamples = 100;
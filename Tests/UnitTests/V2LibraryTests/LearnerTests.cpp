@@ -141,6 +141,109 @@ void TestUniversalLearner(size_t numParameters, size_t numMinibatches, const Dev
 
 }
 
+template <typename ElementType>
+void TestFusedUpdate(const function<LearnerPtr(const vector<Parameter>&, const AdditionalLearningOptions&)>& createLearner)
+{
+    auto device = DeviceDescriptor::CPUDevice();
+
+    // The last parameter is large enough to be split into several work items of the fused update.
+    vector<NDShape> shapes = { { 1 }, { 3, 4 }, { 7 }, { 100, 50 } };
+    for (auto truncation : { true, false })
+    {
+        AdditionalLearningOptions options;
+        options.l1RegularizationWeight = 0.0001;
+        options.l2RegularizationWeight = 0.01;
+        options.gradientClippingThresholdPerSample = 0.3;
+        options.gradientClippingWithTruncation = truncation;
+
+        vector<Parameter> expectedParameters, actualParameters;
+        for (size_t i = 0; i < shapes.size(); i++)
+        {
+            auto value = NDArrayView::RandomUniform<ElementType>(shapes[i], -1.0, 1.0, i, device);
+            expectedParameters.push_back(Parameter(value->DeepClone(), L"parameter_" + to_wstring(i)));
+            actualParameters.push_back(Parameter(value, L"parameter_" + to_wstring(i)));
+        }
+
+        auto expectedLearner = createLearner(expectedParameters, options);
+        auto actualLearner = createLearner(actualParameters, options);
+        actualLearner->SetFusedUpdate(true);
+
+        for (size_t minibatch = 0; minibatch < 3; minibatch++)
+        {
+            unordered_map<Parameter, NDArrayViewPtr> expectedGradients, actualGradients;
+            for (size_t i = 0; i < shapes.size(); i++)
+            {
+                auto gradient = NDArrayView::RandomUniform<ElementType>(shapes[i], -1.0, 1.0, 100 + minibatch * shapes.size() + i, device);
+                expectedGradients[expectedParameters[i]] = gradient->DeepClone();
+                actualGradients[actualParameters[i]] = gradient;
+            }
+
+            expectedLearner->Update(expectedGradients, 2, false);
+            actualLearner->Update(actualGradients, 2, false);
+        }
+
+        for (size_t i = 0; i < shapes.size(); i++)
+        {
+            auto size = shapes[i].TotalSize();
+            auto expected = expectedParameters[i].Value()->DataBuffer<ElementType>();
+            auto actual = actualParameters[i].Value()->DataBuffer<ElementType>();
+            FloatingPointVectorCompare(vector<ElementType>(actual, actual + size), vector<ElementType>(expected, expected + size),
+                                       "Fused update does not match the regular update");
+        }
+    }
+}
+
+template <typename ElementType>
+void TestFusedUpdateOfAllLearners()
+{
+    LearningRateSchedule learningRate = TrainingParameterPerSampleSchedule<double>({ 0.05 });
+    MomentumSchedule momentum = MomentumAsTimeConstantSchedule(100.0);
+
+    TestFusedUpdate<ElementType>([&](const vector<Parameter>& parameters, const AdditionalLearningOptions& options)
+    {
+        return SGDLearner(parameters, learningRate, options);
+    });
+
+    for (auto gain : { true, false })
+    {
+        TestFusedUpdate<ElementType>([&](const vector<Parameter>& parameters, const AdditionalLearningOptions& options)
+        {
+            return MomentumSGDLearner(parameters, learningRate, momentum, gain, options);
+        });
+
+        TestFusedUpdate<ElementType>([&](const vector<Parameter>& parameters, const AdditionalLearningOptions& options)
+        {
+            return NesterovLearner(parameters, learningRate, momentum, gain, options);
+        });
+
+        TestFusedUpdate<ElementType>([&](const vector<Parameter>& parameters, const AdditionalLearningOptions& options)
+        {
+            return FSAdaGradLearner(parameters, learningRate, momentum, gain, MomentumSchedule(0.99, 1), options);
+        });
+
+        for (auto adamax : { true, false })
+        {
+            TestFusedUpdate<ElementType>([&](const vector<Parameter>& parameters, const AdditionalLearningOptions& options)
+            {
+                return AdamLearner(parameters, learningRate, momentum, gain, MomentumSchedule(0.99, 1), 1e-8, adamax, options);
+            });
+        }
+    }
+
+    for (auto needAveMultiplier : { true, false })
+    {
+        TestFusedUpdate<ElementType>([&](const vector<Parameter>& parameters, const AdditionalLearningOptions& options)
+        {
+            return AdaGradLearner(parameters, learningRate, needAveMultiplier, options);
+        });
+
+        TestFusedUpdate<ElementType>([&](const vector<Parameter>& parameters, const AdditionalLearningOptions& options)
+        {
+            return RMSPropLearner(parameters, learningRate, 0.95, 1.2, 0.7, 10.0, 0.001, needAveMultiplier, options);
+        });
+    }
+}
+
 void TestTrainingParametersSchedule()
 {
     LearningRateSchedule schedule1(0.5, 1);
@@ -477,6 +580,15 @@ BOOST_AUTO_TEST_CASE(CreateAndUpdateAdamaxLearner)
     }
 }
 
+BOOST_AUTO_TEST_CASE(FusedUpdateMatchesRegularUpdate)
+{
+    if (ShouldRunOnCpu())
+    {
+        TestFusedUpdateOfAllLearners<float>();
+        TestFusedUpdateOfAllLearners<double>();
+    }
+}
+
 BOOST_AUTO_TEST_CASE(TestResettingLearningRate)
 {
     NDShape shape = { 1 };
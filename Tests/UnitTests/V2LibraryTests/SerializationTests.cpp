@@ -415,6 +415,17 @@ void TestFunctionSaveAndLoad(const FunctionPtr& function, const DeviceDescriptor
     {
         BOOST_ERROR("TestFunctionSaveAndLoad: original and reloaded functions are not identical.");
     }
+
+    // memory-mappable model files are loaded through the default format
+    auto mappableFile = L"TestFunctionSaveAndLoad.mappable.out";
+    function->Save(mappableFile, ModelFormat::CNTKv2MemoryMappable);
+
+    auto mappedFunction = Function::Load(mappableFile, device);
+
+    if (!AreEqual(function, mappedFunction))
+    {
+        BOOST_ERROR("TestFunctionSaveAndLoad: original and memory-mapped functions are not identical.");
+    }
 }
 
 void TestFunctionsForEquality(const DeviceDescriptor& device)
@@ -576,9 +587,13 @@ void TestTrainingWithCheckpointing(const FunctionPtr& function1, const FunctionP
         BOOST_ERROR("TestModelSerialization: reloaded function is not identical to the original.");
     }
 
-    for (int i = 0; i < 3; ++i)
+    for (int i = 0; i < 4; ++i)
     {
-        trainer2->SaveCheckpoint(L"trainer.v2.checkpoint");
+        // every other checkpoint is written in the background, restoring waits for it
+        if (i % 2)
+            trainer2->SaveCheckpointAsync(L"trainer.v2.checkpoint");
+        else
+            trainer2->SaveCheckpoint(L"trainer.v2.checkpoint");
         trainer2->RestoreFromCheckpoint(L"trainer.v2.checkpoint");
 
         if (!AreEqual(function1, function2))
@@ -243,6 +243,7 @@ IGNORE_CLASS CNTK::DistributedCommunicator;
 IGNORE_CLASS CNTK::QuantizedDistributedCommunicator;
 IGNORE_FUNCTION CNTK::MPICommunicator;
 IGNORE_FUNCTION CNTK::QuantizedMPICommunicator;
+IGNORE_FUNCTION CNTK::SparsifiedMPICommunicator;
 IGNORE_STRUCT CNTK::CrossValidationConfig;
 IGNORE_STRUCT CNTK::CheckpointConfig;
 IGNORE_STRUCT CNTK::TestConfig;
@@ -523,6 +524,7 @@ IGNORE_FUNCTION CNTK::ROIPooling;
 IGNORE_FUNCTION CNTK::ReaderCrop;
 IGNORE_FUNCTION CNTK::ImageDeserializer;
 IGNORE_FUNCTION CNTK::Base64ImageDeserializer;
+IGNORE_FUNCTION CNTK::ImageShardDeserializer;
 IGNORE_FUNCTION CNTK::CTFDeserializer;
 IGNORE_FUNCTION CNTK::CBFDeserializer;
 IGNORE_FUNCTION CNTK::HTKFeatureDeserializer;
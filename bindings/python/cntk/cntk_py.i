@@ -61,6 +61,7 @@
 %rename(_next_minibatch) CNTK::SwigMinibatchSource::_GetNextMinibatch;
 %rename(_register_udf_deserialize_callback) CNTK::Internal::RegisterUDFDeserializeCallbackWrapper;
 %rename(base64_image_deserializer) CNTK::Base64ImageDeserializer;
+%rename(image_shard_deserializer) CNTK::ImageShardDeserializer;
 %rename(_none) CNTK::DictionaryValue::Type::None;
 %rename(nce_loss) CNTK::NCELoss;
 
@@ -887,6 +887,21 @@ def Base64ImageDeserializer(filename, streams):
         'Base64ImageDeserializer')
     return cntk_py.base64_image_deserializer(*args)
 
+def ImageShardDeserializer(filename, streams):
+    '''
+    Configures the image reader that reads encoded images and corresponding
+    labels packed into a single shard file. The shard is written from an
+    ImageDeserializer map file by ``Scripts/img2shard.py``. Images are read
+    in large chunks (``chunkSizeInBytes``, 32 MB by default), which avoids a
+    file lookup per image.
+
+    Args:
+        filename (str): file name of the image shard
+    '''
+    args = _process_image_deserializer_args(filename, streams,
+        'ImageShardDeserializer')
+    return cntk_py.image_shard_deserializer(*args)
+
 def CTFDeserializer(filename, streams):
     '''
     Configures the CNTK text-format reader that reads text-based files with
@@ -44,6 +44,13 @@ class ModelFormat(Enum):
     subset of CNTK functionalities.
     '''
 
+    CNTKv2MemoryMappable = cntk_py.ModelFormat_CNTKv2MemoryMappable
+    '''
+    CNTK version 2 format that stores parameter values as aligned raw data, so that
+    loading maps them into memory instead of parsing and copying them. It is loaded
+    with the default CNTKv2 format.
+    '''
+
 @unique
 class CloneMethod(Enum):
     '''
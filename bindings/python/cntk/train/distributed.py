@@ -120,7 +120,7 @@ class DistributedLearner(cntk_py.DistributedLearner):
         return super(DistributedLearner, self).total_number_of_samples_seen()
 
 @typemap
-def data_parallel_distributed_learner(learner, distributed_after=0, num_quantization_bits=32, use_async_buffered_parameter_update=False):
+def data_parallel_distributed_learner(learner, distributed_after=0, num_quantization_bits=32, use_async_buffered_parameter_update=False, gradient_density=1.0):
     '''
     Creates a data parallel distributed learner
 
@@ -129,10 +129,21 @@ def data_parallel_distributed_learner(learner, distributed_after=0, num_quantiza
         distributed_after (int): number of samples after which distributed training starts
         num_quantization_bits (int): number of bits for quantization (1 to 32)
         use_async_buffered_parameter_update (bool): use async buffered parameter update
+        gradient_density (float): fraction of the entries of each gradient to exchange, in (0, 1]. Below 1, only the
+         entries largest in magnitude are sent and the rest is carried over to the next minibatch (top-k sparsification)
     Returns:
         a distributed learner instance
     '''
-    if (num_quantization_bits < 32):
+    if (num_quantization_bits < 32 and gradient_density < 1.0):
+        raise ValueError('quantization and gradient sparsification cannot be combined')
+
+    if (gradient_density < 1.0):
+        return cntk_py.create_data_parallel_distributed_learner(
+            cntk_py.sparsified_mpicommunicator(gradient_density),
+            learner,
+            distributed_after,
+            use_async_buffered_parameter_update)
+    elif (num_quantization_bits < 32):
         return cntk_py.create_quantized_data_parallel_distributed_learner(
             cntk_py.quantized_mpicommunicator(True, True, num_quantization_bits),
             learner,